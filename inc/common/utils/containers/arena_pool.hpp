@@ -0,0 +1,161 @@
+/*
+ * File:   arena_pool.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 2:55 AM
+ */
+
+#ifndef ARENA_POOL_HPP
+#define ARENA_POOL_HPP
+
+#include <vector>       // std::vector
+#include <algorithm>    // std::max
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+
+using namespace std;
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+
+namespace uva {
+    namespace utils {
+        namespace containers {
+
+            /**
+             * This is the arena pool class, it allocates the elements from large blocks
+             * of memory. The elements allocated with one call are contiguous, the blocks
+             * are never moved so the pointers to the allocated elements stay valid until
+             * the pool is destroyed. The elements can not be freed one by one, they are
+             * all destroyed together with the pool.
+             * @param elem_type the type of the element that the pool can store.
+             */
+            template<typename elem_type>
+            class arena_pool {
+            public:
+
+                /**
+                 * The basic constructor
+                 * @param block_size the default number of elements in one memory block
+                 */
+                explicit arena_pool(const size_t block_size)
+                : m_block_size(block_size), m_blocks(), m_next(NULL), m_num_free(0), m_num_elems(0), m_capacity(0) {
+                    ASSERT_SANITY_THROW((m_block_size == 0), "The arena pool block size must be positive!");
+                }
+
+                /**
+                 * The copy constructor
+                 */
+                arena_pool(const arena_pool & other) : m_block_size(other.m_block_size) {
+                    THROW_EXCEPTION("The arena_pool is not to be copied!");
+                }
+
+                /**
+                 * The basic destructor, deallocates all the blocks
+                 */
+                ~arena_pool() {
+                    for (typename vector<elem_type *>::iterator iter = m_blocks.begin(); iter != m_blocks.end(); ++iter) {
+                        delete[] *iter;
+                    }
+                }
+
+                /**
+                 * Allows to make sure that the given number of elements will be allocated
+                 * from the same memory block. If the current block does not have enough
+                 * room then the new block of exactly the given size is allocated. This is
+                 * useful if the total number of elements is known beforehand.
+                 * @param num_elems the number of elements to reserve
+                 */
+                inline void reserve(const size_t num_elems) {
+                    if (m_num_free < num_elems) {
+                        add_block(num_elems);
+                    }
+                }
+
+                /**
+                 * Allows to allocate the given number of contiguous elements
+                 * @param num_elems the number of elements to allocate
+                 * @return the pointer to the first allocated element
+                 */
+                inline elem_type * allocate(const size_t num_elems) {
+                    //Get a new block if there is no enough room in the current one
+                    if (m_num_free < num_elems) {
+                        add_block(max(num_elems, m_block_size));
+                    }
+
+                    //Allocate the elements from the current block
+                    elem_type * const result = m_next;
+                    m_next += num_elems;
+                    m_num_free -= num_elems;
+                    m_num_elems += num_elems;
+
+                    return result;
+                }
+
+                /**
+                 * Allows to get the number of allocated elements
+                 * @return the number of allocated elements
+                 */
+                inline size_t get_num_elems() const {
+                    return m_num_elems;
+                }
+
+                /**
+                 * Allows to get the number of bytes occupied by the memory blocks
+                 * @return the number of bytes occupied by the memory blocks
+                 */
+                inline size_t get_num_bytes() const {
+                    return m_capacity * sizeof (elem_type);
+                }
+
+            private:
+                //Stores the default number of elements in one block
+                const size_t m_block_size;
+                //Stores the allocated memory blocks
+                vector<elem_type *> m_blocks;
+                //Stores the pointer to the next free element of the current block
+                elem_type * m_next;
+                //Stores the number of free elements in the current block
+                size_t m_num_free;
+                //Stores the number of allocated elements
+                size_t m_num_elems;
+                //Stores the number of elements in all the blocks
+                size_t m_capacity;
+
+                /**
+                 * Allows to add a new memory block, the rest of the current one is abandoned
+                 * @param num_elems the number of elements in the new block
+                 */
+                inline void add_block(const size_t num_elems) {
+                    LOG_DEBUG1 << "Allocating a new arena block of " << num_elems << " elements" << END_LOG;
+
+                    m_next = new elem_type[num_elems];
+                    m_blocks.push_back(m_next);
+                    m_num_free = num_elems;
+                    m_capacity += num_elems;
+                }
+            };
+        }
+    }
+}
+
+#endif /* ARENA_POOL_HPP */
+
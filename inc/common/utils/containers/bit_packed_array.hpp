@@ -0,0 +1,163 @@
+/*
+ * File:   bit_packed_array.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 11:55 PM
+ */
+
+#ifndef BIT_PACKED_ARRAY_HPP
+#define BIT_PACKED_ARRAY_HPP
+
+#include <cstdint>
+#include <cstring>
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
+
+using namespace std;
+
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+
+namespace uva {
+    namespace utils {
+        namespace containers {
+
+            /**
+             * This class represents a fixed size array of unsigned integer values where each
+             * value takes the same number of bits, from 0 to 57. The values are stored one
+             * after another in 64 bit words, so a value can span two words. The random access
+             * is a shift and a mask of one unaligned 64 bit read.
+             */
+            class bit_packed_array {
+            public:
+                //Stores the maximum supported number of bits per value, a value is read with one 64 bit load
+                static constexpr uint8_t MAX_NUM_BITS = 57;
+
+                /**
+                 * The basic constructor, does not allocate anything
+                 */
+                bit_packed_array() : m_size(0), m_num_bits(0), m_mask(0), m_words(NULL) {
+                }
+
+                /**
+                 * The basic destructor
+                 */
+                ~bit_packed_array() {
+                    huge_page_allocator::deallocate(m_words);
+                }
+
+                /**
+                 * Allows to get the number of bits needed to store the given value
+                 * @param max_value the maximum value to be stored
+                 * @return the number of bits
+                 */
+                static inline uint8_t get_num_bits(uint64_t max_value) {
+                    uint8_t num_bits = 0;
+                    while (max_value != 0) {
+                        ++num_bits;
+                        max_value >>= 1;
+                    }
+                    return num_bits;
+                }
+
+                /**
+                 * Allows to allocate the zeroed array
+                 * @param size the number of values
+                 * @param num_bits the number of bits per value
+                 */
+                inline void allocate(const uint64_t size, const uint8_t num_bits) {
+                    ASSERT_SANITY_THROW((m_words != NULL), "The bit packed array is already allocated!");
+                    ASSERT_CONDITION_THROW((num_bits > MAX_NUM_BITS), string("Unsupported number of bits per value: ") +
+                            to_string(num_bits) + string(", the maximum is: ") + to_string(MAX_NUM_BITS));
+
+                    m_size = size;
+                    m_num_bits = num_bits;
+                    m_mask = (static_cast<uint64_t> (1) << num_bits) - 1;
+
+                    //Allocate an extra word so that the last value can be read with a 64 bit load
+                    m_words = huge_page_allocator::allocate<uint64_t>((size * num_bits + 63) / 64 + 1);
+                }
+
+                /**
+                 * Allows to set the value, the previous value must be zero
+                 * @param idx the value index
+                 * @param value the value to set
+                 */
+                inline void set(const uint64_t idx, const uint64_t value) {
+                    ASSERT_SANITY_THROW((idx >= m_size) || ((value & ~m_mask) != 0),
+                            string("Can not set value: ") + to_string(value) + string(" at index: ") + to_string(idx));
+
+                    const uint64_t bit_pos = idx * m_num_bits;
+                    const uint64_t word_idx = bit_pos >> 6;
+                    const uint8_t shift = bit_pos & 63;
+                    m_words[word_idx] |= (value << shift);
+                    if (shift + m_num_bits > 64) {
+                        m_words[word_idx + 1] |= (value >> (64 - shift));
+                    }
+                }
+
+                /**
+                 * Allows to get the value
+                 * @param idx the value index
+                 * @return the value
+                 */
+                inline uint64_t get(const uint64_t idx) const {
+                    const uint64_t bit_pos = idx * m_num_bits;
+                    //The value fits into the 64 bits starting from its first byte
+                    uint64_t value = 0;
+                    memcpy(&value, reinterpret_cast<const uint8_t *> (m_words) + (bit_pos >> 3), sizeof (uint64_t));
+                    return (value >> (bit_pos & 7)) & m_mask;
+                }
+
+                /**
+                 * Allows to get the number of values
+                 * @return the number of values
+                 */
+                inline uint64_t size() const {
+                    return m_size;
+                }
+
+                /**
+                 * Allows to get the number of bytes taken by the values
+                 * @return the number of bytes
+                 */
+                inline uint64_t get_num_bytes() const {
+                    return ((m_size * m_num_bits + 63) / 64 + 1) * sizeof (uint64_t);
+                }
+
+            private:
+                //Stores the number of values
+                uint64_t m_size;
+                //Stores the number of bits per value
+                uint8_t m_num_bits;
+                //Stores the value mask
+                uint64_t m_mask;
+                //Stores the packed values
+                uint64_t * m_words;
+            };
+        }
+    }
+}
+
+#endif /* BIT_PACKED_ARRAY_HPP */
+
@@ -0,0 +1,224 @@
+/*
+ * File:   concurrent_lru_cache.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 3:05 AM
+ */
+
+#ifndef CONCURRENT_LRU_CACHE_HPP
+#define CONCURRENT_LRU_CACHE_HPP
+
+#include <list>             // std::list
+#include <unordered_map>    // std::unordered_map
+#include <functional>       // std::hash
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+#include "common/utils/threads/threads.hpp"
+
+using namespace std;
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+using namespace uva::utils::threads;
+
+namespace uva {
+    namespace utils {
+        namespace containers {
+
+            /**
+             * This is the bounded least recently used cache which can be used by several
+             * threads at the same time. The cache is split into a number of shards, each
+             * with its own lock, the key hash defines the shard. Each shard evicts its
+             * least recently used elements once its part of the capacity is exceeded.
+             * The values are returned by copy so the value type shall be cheap to copy,
+             * e.g. a shared pointer, which also keeps the evicted elements alive while
+             * they are still in use.
+             * @param key_type the type of the key
+             * @param value_type the type of the value
+             */
+            template<typename key_type, typename value_type>
+            class concurrent_lru_cache {
+            public:
+
+                /**
+                 * The basic constructor
+                 * @param capacity the maximum number of cached elements, must be positive
+                 * @param num_shards the number of shards, must be positive
+                 */
+                concurrent_lru_cache(const size_t capacity, const size_t num_shards)
+                : m_num_shards(num_shards), m_shards(NULL), m_num_hits(0), m_num_misses(0) {
+                    ASSERT_CONDITION_THROW((capacity == 0), "The LRU cache capacity must be positive!");
+                    ASSERT_SANITY_THROW((m_num_shards == 0), "The number of LRU cache shards must be positive!");
+
+                    //Split the capacity between the shards
+                    m_shards = new shard[m_num_shards];
+                    for (size_t idx = 0; idx < m_num_shards; ++idx) {
+                        m_shards[idx].m_capacity = (capacity + idx) / m_num_shards;
+                    }
+                }
+
+                /**
+                 * The copy constructor
+                 */
+                concurrent_lru_cache(const concurrent_lru_cache & other) : m_num_shards(other.m_num_shards) {
+                    THROW_EXCEPTION("The concurrent_lru_cache is not to be copied!");
+                }
+
+                /**
+                 * The basic destructor
+                 */
+                ~concurrent_lru_cache() {
+                    delete[] m_shards;
+                }
+
+                /**
+                 * Allows to get the cached value, if found the value
+                 * becomes the most recently used one in its shard.
+                 * @param key the key to look for
+                 * @param value [out] the value to be set if the key is found
+                 * @return true if the key is found, otherwise false
+                 */
+                inline bool get(const key_type & key, value_type & value) {
+                    shard & sh = get_shard(key);
+                    scoped_guard guard(sh.m_lock);
+
+                    typename shard::elems_map::iterator iter = sh.m_map.find(key);
+                    if (iter != sh.m_map.end()) {
+                        //Move the element to the front of the list
+                        sh.m_list.splice(sh.m_list.begin(), sh.m_list, iter->second);
+                        value = iter->second->second;
+                        m_num_hits.fetch_add(1, memory_order_relaxed);
+                        return true;
+                    } else {
+                        m_num_misses.fetch_add(1, memory_order_relaxed);
+                        return false;
+                    }
+                }
+
+                /**
+                 * Allows to put the value into the cache, as the most recently used
+                 * one. If the key is already cached then its value is replaced.
+                 * @param key the key to put
+                 * @param value the value to put
+                 */
+                inline void put(const key_type & key, const value_type & value) {
+                    shard & sh = get_shard(key);
+                    scoped_guard guard(sh.m_lock);
+
+                    typename shard::elems_map::iterator iter = sh.m_map.find(key);
+                    if (iter != sh.m_map.end()) {
+                        //Replace the value and move the element to the front of the list
+                        iter->second->second = value;
+                        sh.m_list.splice(sh.m_list.begin(), sh.m_list, iter->second);
+                    } else {
+                        //Add the new element to the front of the list
+                        sh.m_list.push_front(elem(key, value));
+                        sh.m_map[key] = sh.m_list.begin();
+
+                        //Evict the least recently used elements, if needed
+                        while (sh.m_map.size() > sh.m_capacity) {
+                            sh.m_map.erase(sh.m_list.back().first);
+                            sh.m_list.pop_back();
+                        }
+                    }
+                }
+
+                /**
+                 * Allows to get the number of cached elements
+                 * @return the number of cached elements
+                 */
+                inline size_t get_size() const {
+                    size_t size = 0;
+                    for (size_t idx = 0; idx < m_num_shards; ++idx) {
+                        scoped_guard guard(m_shards[idx].m_lock);
+                        size += m_shards[idx].m_map.size();
+                    }
+                    return size;
+                }
+
+                /**
+                 * Allows to get the number of the get hits
+                 * @return the number of the get hits
+                 */
+                inline uint64_t get_num_hits() const {
+                    return m_num_hits.load(memory_order_relaxed);
+                }
+
+                /**
+                 * Allows to get the number of the get misses
+                 * @return the number of the get misses
+                 */
+                inline uint64_t get_num_misses() const {
+                    return m_num_misses.load(memory_order_relaxed);
+                }
+
+            private:
+                //Define the cached element type
+                typedef pair<key_type, value_type> elem;
+
+                /**
+                 * This structure stores the shard of the cache, the list
+                 * is ordered from the most to the least recently used
+                 * element, the map allows to find the list elements.
+                 */
+                struct shard {
+                    //Define the list type
+                    typedef list<elem> elems_list;
+                    //Define the map type
+                    typedef unordered_map<key_type, typename elems_list::iterator> elems_map;
+
+                    //Stores the maximum number of elements in the shard
+                    size_t m_capacity;
+                    //Stores the elements list
+                    elems_list m_list;
+                    //Stores the elements map
+                    elems_map m_map;
+                    //Stores the shard lock
+                    mutable mutex m_lock;
+                };
+
+                //Stores the number of shards
+                const size_t m_num_shards;
+                //Stores the shards
+                shard * m_shards;
+                //Stores the number of the get hits
+                atomic<uint64_t> m_num_hits;
+                //Stores the number of the get misses
+                atomic<uint64_t> m_num_misses;
+
+                /**
+                 * Allows to get the shard for the given key
+                 * @param key the key
+                 * @return the shard reference
+                 */
+                inline shard & get_shard(const key_type & key) {
+                    //Mix the hash bits as the standard hash can be the identity
+                    //function and the keys' lower bits are not always uniform
+                    const uint64_t mixed = static_cast<uint64_t> (hash<key_type>()(key)) * 0x9E3779B97F4A7C15ULL;
+                    return m_shards[(mixed >> 32) % m_num_shards];
+                }
+            };
+        }
+    }
+}
+
+#endif /* CONCURRENT_LRU_CACHE_HPP */
+
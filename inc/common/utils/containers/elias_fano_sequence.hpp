@@ -0,0 +1,218 @@
+/*
+ * File:   elias_fano_sequence.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 11:58 PM
+ */
+
+#ifndef ELIAS_FANO_SEQUENCE_HPP
+#define ELIAS_FANO_SEQUENCE_HPP
+
+#include <cstdint>
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/containers/bit_packed_array.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
+
+using namespace std;
+
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+
+namespace uva {
+    namespace utils {
+        namespace containers {
+
+            /**
+             * This class stores a non-decreasing sequence of n unsigned integer values, bounded
+             * by u, with the Elias-Fano encoding. The lowest l = floor(log2(u/n)) bits of each
+             * value are kept in a bit packed array. The highest bits are kept in unary, as the
+             * positions of n one bits in a bit vector of n + u/2^l + 1 bits: the i'th value has
+             * its bit at the position (value >> l) + i. This takes about 2 + log2(u/n) bits per
+             * value. To find the i'th one bit quickly the position of every SELECT_SAMPLE_RATE'th
+             * one bit is sampled, the rest is found by counting bits from the sample on.
+             */
+            class elias_fano_sequence {
+            public:
+                //Stores the number of one bits between the two select samples
+                static constexpr uint64_t SELECT_SAMPLE_RATE = 256;
+
+                /**
+                 * The basic constructor, does not allocate anything
+                 */
+                elias_fano_sequence()
+                : m_num_values(0), m_num_low_bits(0), m_low_bits(), m_num_high_words(0),
+                m_high_bits(NULL), m_num_samples(0), m_samples(NULL) {
+                }
+
+                /**
+                 * The basic destructor
+                 */
+                ~elias_fano_sequence() {
+                    huge_page_allocator::deallocate(m_high_bits);
+                    huge_page_allocator::deallocate(m_samples);
+                }
+
+                /**
+                 * Allows to encode the sequence of values
+                 * @param values the non-decreasing values
+                 * @param num_values the number of values, must be larger than zero
+                 */
+                inline void build(const uint64_t * values, const uint64_t num_values) {
+                    ASSERT_SANITY_THROW((m_high_bits != NULL), "The Elias-Fano sequence is already built!");
+                    ASSERT_CONDITION_THROW((num_values == 0), "Can not build an empty Elias-Fano sequence!");
+
+                    //Compute the number of low bits
+                    m_num_values = num_values;
+                    const uint64_t max_value = values[num_values - 1];
+                    m_num_low_bits = (max_value > num_values) ? bit_packed_array::get_num_bits(max_value / num_values) - 1 : 0;
+
+                    //Allocate the data
+                    m_low_bits.allocate(num_values, m_num_low_bits);
+                    m_num_high_words = (num_values + (max_value >> m_num_low_bits) + 1 + 63) / 64;
+                    m_high_bits = huge_page_allocator::allocate<uint64_t>(m_num_high_words);
+                    m_num_samples = (num_values + SELECT_SAMPLE_RATE - 1) / SELECT_SAMPLE_RATE;
+                    m_samples = huge_page_allocator::allocate<uint64_t>(m_num_samples);
+
+                    //Encode the values
+                    const uint64_t low_mask = (static_cast<uint64_t> (1) << m_num_low_bits) - 1;
+                    for (uint64_t idx = 0; idx < num_values; ++idx) {
+                        ASSERT_SANITY_THROW((idx > 0) && (values[idx] < values[idx - 1]),
+                                string("The values are not sorted at index: ") + to_string(idx));
+
+                        m_low_bits.set(idx, values[idx] & low_mask);
+                        const uint64_t high_pos = (values[idx] >> m_num_low_bits) + idx;
+                        m_high_bits[high_pos >> 6] |= (static_cast<uint64_t> (1) << (high_pos & 63));
+                        if ((idx % SELECT_SAMPLE_RATE) == 0) {
+                            m_samples[idx / SELECT_SAMPLE_RATE] = high_pos;
+                        }
+                    }
+
+                    LOG_DEBUG << "EF: num_values: " << num_values << ", max_value: " << max_value
+                            << ", low bits: " << to_string(m_num_low_bits) << ", bytes: "
+                            << get_num_bytes() << END_LOG;
+                }
+
+                /**
+                 * Allows to get the value
+                 * @param idx the value index
+                 * @return the value
+                 */
+                inline uint64_t get(const uint64_t idx) const {
+                    return get_value(idx, select(idx));
+                }
+
+                /**
+                 * Allows to get two consecutive values at once, the second
+                 * one bit is found by continuing from the first one.
+                 * @param idx the index of the first value, must be smaller than size() - 1
+                 * @param first [out] the value with the given index
+                 * @param second [out] the value with the next index
+                 */
+                inline void get_pair(const uint64_t idx, uint64_t & first, uint64_t & second) const {
+                    const uint64_t first_pos = select(idx);
+                    first = get_value(idx, first_pos);
+
+                    //Search for the next one bit
+                    uint64_t word_idx = first_pos >> 6;
+                    uint64_t word = m_high_bits[word_idx] & (~static_cast<uint64_t> (1) << (first_pos & 63));
+                    while (word == 0) {
+                        word = m_high_bits[++word_idx];
+                    }
+                    second = get_value(idx + 1, (word_idx << 6) + __builtin_ctzll(word));
+                }
+
+                /**
+                 * Allows to get the number of values
+                 * @return the number of values
+                 */
+                inline uint64_t size() const {
+                    return m_num_values;
+                }
+
+                /**
+                 * Allows to get the number of bytes taken by the encoded values
+                 * @return the number of bytes
+                 */
+                inline uint64_t get_num_bytes() const {
+                    return m_low_bits.get_num_bytes() + (m_num_high_words + m_num_samples) * sizeof (uint64_t);
+                }
+
+            private:
+                //Stores the number of values
+                uint64_t m_num_values;
+                //Stores the number of low bits per value
+                uint8_t m_num_low_bits;
+                //Stores the low bits of the values
+                bit_packed_array m_low_bits;
+                //Stores the number of words in the high bits vector
+                uint64_t m_num_high_words;
+                //Stores the high bits vector
+                uint64_t * m_high_bits;
+                //Stores the number of select samples
+                uint64_t m_num_samples;
+                //Stores the positions of every SELECT_SAMPLE_RATE'th one bit
+                uint64_t * m_samples;
+
+                /**
+                 * Allows to compose the value from its high bits position and low bits
+                 * @param idx the value index
+                 * @param high_pos the position of the value's one bit in the high bits vector
+                 * @return the value
+                 */
+                inline uint64_t get_value(const uint64_t idx, const uint64_t high_pos) const {
+                    return ((high_pos - idx) << m_num_low_bits) | m_low_bits.get(idx);
+                }
+
+                /**
+                 * Allows to find the position of the idx'th one bit in the high bits vector
+                 * @param idx the index of the one bit, starting from zero
+                 * @return the one bit position
+                 */
+                inline uint64_t select(const uint64_t idx) const {
+                    //Start from the sampled one bit
+                    const uint64_t sample_pos = m_samples[idx / SELECT_SAMPLE_RATE];
+                    uint64_t num_left = idx % SELECT_SAMPLE_RATE;
+                    uint64_t word_idx = sample_pos >> 6;
+                    uint64_t word = m_high_bits[word_idx] & (~static_cast<uint64_t> (0) << (sample_pos & 63));
+
+                    //Skip the words with not enough one bits
+                    uint64_t num_ones = __builtin_popcountll(word);
+                    while (num_left >= num_ones) {
+                        num_left -= num_ones;
+                        word = m_high_bits[++word_idx];
+                        num_ones = __builtin_popcountll(word);
+                    }
+
+                    //Clear the lowest one bits before the needed one
+                    while (num_left-- != 0) {
+                        word &= (word - 1);
+                    }
+                    return (word_idx << 6) + __builtin_ctzll(word);
+                }
+            };
+        }
+    }
+}
+
+#endif /* ELIAS_FANO_SEQUENCE_HPP */
+
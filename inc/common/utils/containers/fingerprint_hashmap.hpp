@@ -0,0 +1,502 @@
+/*
+ * File:   fingerprint_hashmap.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 6:05 PM
+ */
+
+#ifndef FINGERPRINT_HASHMAP_HPP
+#define FINGERPRINT_HASHMAP_HPP
+
+#include <cstdint>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+#include "common/utils/math_utils.hpp"
+#include "common/utils/hashing_utils.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
+
+using namespace std;
+using namespace uva::utils::hashing;
+using namespace uva::utils::math;
+
+namespace uva {
+    namespace utils {
+        namespace containers {
+
+            /**
+             * This class represents a fixed size hash map that stores a pre-defined number of elements.
+             * It has the same interface as fixed_size_hashmap but the buckets are organized in the
+             * SwissTable style: the buckets are grouped by one cache line, each group stores 16 control
+             * bytes followed by the element indexes of the group. A control byte is either empty or
+             * keeps the 7 bit fingerprint of the element's key uid. The look-up matches all the control
+             * bytes of a group at once, with SSE2 if available, and only the elements with a matching
+             * fingerprint are compared to the key. So a look-up costs one cache miss for the group plus
+             * one for the element, if it is present, and the colliding elements are almost never touched.
+             * The groups are probed linearly.
+             *
+             * @param ELEMENT_TYPE the element type, this type is expected to have the following interface:
+             *          1. operator==(const KEY_TYPE &); the comparison operator for the key value
+             *          2. static void clear(ELEMENT_TYPE & ); the cleaning method to destroy contents of the element.
+             * @param KEY_TYPE the key type for retrieving the element
+             * @param IDX_TYPE the index type, is related to the number of elements
+             */
+            template<typename ELEMENT_TYPE, typename KEY_TYPE, typename IDX_TYPE = uint32_t>
+            class fingerprint_hashmap {
+            public:
+                typedef ELEMENT_TYPE TElemType;
+
+                //Stores the index that of the non-used element
+                static constexpr IDX_TYPE NO_ELEMENT_INDEX = 0;
+                //Stores the minimal valid element index
+                static constexpr IDX_TYPE MIN_ELEMENT_INDEX = NO_ELEMENT_INDEX + 1;
+                //Stores the maximum valid element index
+                const IDX_TYPE MAX_ELEMENT_INDEX;
+
+                //Stores the number of bytes in one group, is the size of the cache line
+                static constexpr uint32_t GROUP_NUM_BYTES = 64;
+                //Stores the number of control bytes in one group, is the SSE2 register size
+                static constexpr uint32_t NUM_CTRL_BYTES = 16;
+                //Stores the number of buckets in one group, the element indexes take the rest of the cache line
+                static constexpr uint32_t NUM_GROUP_SLOTS = ((GROUP_NUM_BYTES - NUM_CTRL_BYTES) / sizeof (IDX_TYPE) < NUM_CTRL_BYTES) ?
+                        (GROUP_NUM_BYTES - NUM_CTRL_BYTES) / sizeof (IDX_TYPE) : NUM_CTRL_BYTES;
+
+                //Stores the control byte value of an empty bucket
+                static constexpr uint8_t CTRL_EMPTY = 0x80;
+                //Stores the control byte value of a control byte with no bucket, never matches anything
+                static constexpr uint8_t CTRL_NO_SLOT = 0xFE;
+
+                /**
+                 * This structure represents a group of buckets occupying one cache line
+                 * @param m_ctrl the control bytes, one per bucket
+                 * @param m_elem_idx the element indexes, one per bucket
+                 */
+                typedef struct {
+                    uint8_t m_ctrl[NUM_CTRL_BYTES];
+                    IDX_TYPE m_elem_idx[NUM_GROUP_SLOTS];
+                } s_group;
+
+                /**
+                 * The basic constructor that allows to instantiate the map for the given number of elements.
+                 * The number of buckets is computed based on the value:
+                 *     buckets_factor * (num_elems + 1)
+                 * The latter is then turned into the number of groups being a power of two. The latter is
+                 * needed to speed up the internal index computations.
+                 * @param buckets_factor the factor to compute the number of buckets from the number of elements
+                 * @param num_elems the number of elements that will be stored in the map
+                 */
+                explicit fingerprint_hashmap(const double buckets_factor, const IDX_TYPE num_elems)
+                : MAX_ELEMENT_INDEX(num_elems), m_is_mapped(false) {
+                    //Compute and set the number of groups
+                    set_number_of_elements(buckets_factor, num_elems);
+                    //Set the current number of stored elements to zero
+                    m_next_elem_idx = MIN_ELEMENT_INDEX;
+
+                    //Allocate the groups, add an extra one to align the groups to the cache line
+                    m_groups_alloc = huge_page_allocator::allocate<s_group>(m_num_groups + 1);
+                    const size_t offset = (GROUP_NUM_BYTES - (reinterpret_cast<uintptr_t> (m_groups_alloc) % GROUP_NUM_BYTES)) % GROUP_NUM_BYTES;
+                    m_groups = reinterpret_cast<s_group *> (reinterpret_cast<uint8_t *> (m_groups_alloc) + offset);
+
+                    //Initialize the control bytes
+                    for (uint_fast64_t group_idx = 0; group_idx < m_num_groups; ++group_idx) {
+                        fill_n(m_groups[group_idx].m_ctrl, NUM_GROUP_SLOTS, CTRL_EMPTY);
+                        fill_n(m_groups[group_idx].m_ctrl + NUM_GROUP_SLOTS, NUM_CTRL_BYTES - NUM_GROUP_SLOTS, CTRL_NO_SLOT);
+                    }
+
+                    //Allocate the elements, add an extra one, the 0'th
+                    //element will never be used its index is reserved.
+                    m_elems = huge_page_allocator::allocate<ELEMENT_TYPE>(num_elems + 1);
+                }
+
+                /**
+                 * The constructor that allows to attach the map to the data previously
+                 * written by the write method. The data is not copied but is used in
+                 * place, i.e. the groups and elements arrays point into the memory
+                 * provided by the reader. The resulting map is read-only and shall
+                 * not be used after the reader's memory is released.
+                 * @param reader the binary reader to get the map's data from
+                 */
+                template<typename READER_TYPE>
+                explicit fingerprint_hashmap(READER_TYPE & reader)
+                : MAX_ELEMENT_INDEX(read_max_element_index(reader)), m_groups_alloc(NULL), m_is_mapped(true) {
+                    //Read the map's dimensions
+                    reader.read(m_num_groups);
+                    reader.read(m_next_elem_idx);
+                    m_groups_capacity = m_num_groups - 1;
+
+                    //Get the groups and elements arrays, they are read only
+                    m_groups = const_cast<s_group *> (reader.template get<s_group>(m_num_groups));
+                    m_elems = const_cast<ELEMENT_TYPE *> (reader.template get<ELEMENT_TYPE>(MAX_ELEMENT_INDEX + 1));
+
+                    LOG_DEBUG << "FPHM: attached num_elems: " << MAX_ELEMENT_INDEX << ", m_num_groups: "
+                            << m_num_groups << ", m_next_elem_idx: " << m_next_elem_idx << END_LOG;
+                }
+
+                /**
+                 * Allows to write the map's data with the given binary writer.
+                 * The element type is written as is so it must be a plain type
+                 * with no dynamically allocated data.
+                 * @param writer the binary writer to write the data with
+                 */
+                template<typename WRITER_TYPE>
+                void write(WRITER_TYPE & writer) const {
+                    writer.write(MAX_ELEMENT_INDEX);
+                    writer.write(m_num_groups);
+                    writer.write(m_next_elem_idx);
+                    writer.write(m_groups, m_num_groups);
+                    writer.write(m_elems, MAX_ELEMENT_INDEX + 1);
+                }
+
+                /**
+                 * Allows to get the number of added elements
+                 * @return the number of added elements
+                 */
+                inline size_t get_num_elements() const {
+                    return m_next_elem_idx - MIN_ELEMENT_INDEX;
+                }
+
+                /**
+                 * Allows to get the added elements, in the order they were added
+                 * @return the pointer to the first of the get_num_elements() elements
+                 */
+                inline const ELEMENT_TYPE * get_elements() const {
+                    return m_elems + MIN_ELEMENT_INDEX;
+                }
+
+                /**
+                 * Allows to add a new element for the given hash value
+                 * @param key_uid the unique identifier representing the actual
+                 *        key value of the element. It can be e.g. a hash value
+                 *        of the key. Note that if one uses hash for a key uid
+                 *        then he or she has to accept the risk of collisions.
+                 * @return the reference to the new element
+                 */
+                ELEMENT_TYPE & add_new_element(const uint_fast64_t key_uid) {
+                    //Check that the map is not attached to read-only data
+                    ASSERT_SANITY_THROW(m_is_mapped, "Adding an element to a memory mapped map!");
+
+                    //Check if the capacity is exceeded.
+                    ASSERT_SANITY_THROW((m_next_elem_idx > MAX_ELEMENT_INDEX),
+                            string("Used up all the elements, the last ") +
+                            string("issued id was: ") + std::to_string(m_next_elem_idx));
+
+                    //Get the group index and the fingerprint from the hash
+                    const uint_fast64_t mixed_uid = get_mixed_uid(key_uid);
+                    uint_fast64_t group_idx = get_group_idx(mixed_uid);
+
+                    //Search for the first group with an empty bucket
+                    uint32_t empty_mask = match_ctrl(m_groups[group_idx], CTRL_EMPTY);
+                    while (empty_mask == 0) {
+                        LOG_DEBUG3 << "The group: " << group_idx << " is full, skipping to the next." << END_LOG;
+                        get_next_group_idx(group_idx);
+                        empty_mask = match_ctrl(m_groups[group_idx], CTRL_EMPTY);
+                    }
+
+                    //Get the element index and increment
+                    const IDX_TYPE elem_idx = m_next_elem_idx++;
+
+                    //Set the first empty bucket of the group to point to the given element
+                    s_group & group = m_groups[group_idx];
+                    const uint32_t slot_idx = __builtin_ctz(empty_mask);
+                    group.m_elem_idx[slot_idx] = elem_idx;
+                    group.m_ctrl[slot_idx] = get_fingerprint(mixed_uid);
+
+                    LOG_DEBUG3 << "The element index: " << elem_idx << " is put into group: "
+                            << group_idx << ", slot: " << slot_idx << END_LOG;
+
+                    //Return the element under the index
+                    return m_elems[elem_idx];
+                }
+
+                /**
+                 * Allows to add a new element for the given hash value, this method is
+                 * safe to be called from several threads at the same time. However it
+                 * can not be combined with the concurrent element retrievals, i.e. the
+                 * elements are only to be retrieved once all the threads adding the
+                 * elements have been joined.
+                 * @param key_uid the unique identifier representing the actual
+                 *        key value of the element. It can be e.g. a hash value
+                 *        of the key. Note that if one uses hash for a key uid
+                 *        then he or she has to accept the risk of collisions.
+                 * @return the reference to the new element
+                 */
+                ELEMENT_TYPE & add_new_element_concurrent(const uint_fast64_t key_uid) {
+                    //Check that the map is not attached to read-only data
+                    ASSERT_SANITY_THROW(m_is_mapped, "Adding an element to a memory mapped map!");
+
+                    //Atomically get the element index and increment
+                    const IDX_TYPE elem_idx = __sync_fetch_and_add(&m_next_elem_idx, 1);
+
+                    //Check if the capacity is exceeded.
+                    ASSERT_CONDITION_THROW((elem_idx > MAX_ELEMENT_INDEX),
+                            string("Used up all the elements, the last ") +
+                            string("issued id was: ") + std::to_string(elem_idx));
+
+                    //Get the group index and the fingerprint from the hash
+                    const uint_fast64_t mixed_uid = get_mixed_uid(key_uid);
+                    uint_fast64_t group_idx = get_group_idx(mixed_uid);
+
+                    //Atomically claim the first empty bucket, the control bytes may not be
+                    //set yet by the other threads so the element indexes are to be used
+                    while (true) {
+                        s_group & group = m_groups[group_idx];
+                        for (uint32_t slot_idx = 0; slot_idx < NUM_GROUP_SLOTS; ++slot_idx) {
+                            if ((group.m_elem_idx[slot_idx] == NO_ELEMENT_INDEX) &&
+                                    (__sync_val_compare_and_swap(&group.m_elem_idx[slot_idx], NO_ELEMENT_INDEX, elem_idx) == NO_ELEMENT_INDEX)) {
+                                //The bucket is ours, the control byte is only read once all the threads are joined
+                                group.m_ctrl[slot_idx] = get_fingerprint(mixed_uid);
+
+                                LOG_DEBUG3 << "The element index: " << elem_idx << " is put into group: "
+                                        << group_idx << ", slot: " << slot_idx << END_LOG;
+
+                                //Return the element under the index
+                                return m_elems[elem_idx];
+                            }
+                        }
+                        get_next_group_idx(group_idx);
+                    }
+                }
+
+                /**
+                 * Allows to retrieve the element for the given hash value and key
+                 * @param key_uid the unique identifier representing the actual
+                 *        key value of the element. It can be e.g. a hash value
+                 *        of the key. Note that if one uses hash for a key uid
+                 *        then he or she has to accept the risk of collisions.
+                 * @param key the key value of the element
+                 * @return the pointer to the found element or NULL if nothing is found
+                 */
+                ELEMENT_TYPE * get_element(const uint_fast64_t key_uid, const KEY_TYPE & key) const {
+                    //Get the group index and the fingerprint from the hash
+                    const uint_fast64_t mixed_uid = get_mixed_uid(key_uid);
+                    const uint8_t fingerprint = get_fingerprint(mixed_uid);
+                    uint_fast64_t group_idx = get_group_idx(mixed_uid);
+
+                    LOG_DEBUG3 << "Got group_idx: " << group_idx << " for uid value: " << key_uid << END_LOG;
+
+                    while (true) {
+                        const s_group & group = m_groups[group_idx];
+
+                        //Check the elements with the matching fingerprints only
+                        uint32_t match_mask = match_ctrl(group, fingerprint);
+                        while (match_mask != 0) {
+                            const IDX_TYPE elem_idx = group.m_elem_idx[__builtin_ctz(match_mask)];
+                            if (m_elems[elem_idx] == key) {
+                                LOG_DEBUG3 << "Found the element index: " << elem_idx
+                                        << " in group: " << group_idx << END_LOG;
+                                return &m_elems[elem_idx];
+                            }
+                            //Clear the lowest set bit
+                            match_mask &= (match_mask - 1);
+                        }
+
+                        //If the group has an empty bucket then the element is not present
+                        if (match_ctrl(group, CTRL_EMPTY) != 0) {
+                            LOG_DEBUG3 << "Could not find an element for key uid: " << key_uid
+                                    << ", last group index: " << group_idx << END_LOG;
+                            return NULL;
+                        }
+
+                        //The group is full, move to the next one
+                        get_next_group_idx(group_idx);
+                    }
+                }
+
+                /**
+                 * Allows to issue a software prefetch for the data that is to be
+                 * touched by the get_element method for the given key uid. The
+                 * prefetching is done in two stages, first the group is to be
+                 * prefetched and then, once it is expected to be in cache, the
+                 * first element with the matching fingerprint. Issuing the stages
+                 * for a number of keys before retrieving them allows to overlap
+                 * the memory access latencies of the independent look-ups.
+                 * @param is_elem if false then the group is prefetched, if true
+                 *        then the matching element of the group is prefetched
+                 * @param key_uid the unique identifier of the element key
+                 */
+                template<bool is_elem>
+                inline void prefetch(const uint_fast64_t key_uid) const {
+                    //Get the group index from the hash
+                    const uint_fast64_t mixed_uid = get_mixed_uid(key_uid);
+                    const s_group & group = m_groups[get_group_idx(mixed_uid)];
+
+                    if (is_elem) {
+                        //The group is supposed to be in cache already, match it
+                        const uint32_t match_mask = match_ctrl(group, get_fingerprint(mixed_uid));
+                        //If there is a matching bucket then prefetch the element
+                        if (match_mask != 0) {
+                            __builtin_prefetch(&m_elems[group.m_elem_idx[__builtin_ctz(match_mask)]], 0, 1);
+                        }
+                    } else {
+                        __builtin_prefetch(&group, 0, 1);
+                    }
+                }
+
+                /**
+                 * The basic destructor
+                 */
+                ~fingerprint_hashmap() {
+                    if ((m_elems != NULL) && !m_is_mapped) {
+                        //Free the allocated arrays
+                        huge_page_allocator::deallocate(m_elems);
+                        huge_page_allocator::deallocate(m_groups_alloc);
+                    }
+                }
+
+            private:
+                //Stores the number of groups
+                uint_fast64_t m_num_groups;
+                //Stores the groups capacity, is used as the group index mask
+                uint_fast64_t m_groups_capacity;
+
+                //Stores the current number of stored elements
+                IDX_TYPE m_next_elem_idx;
+
+                //Stores the allocated groups, NULL if the map is attached to external memory
+                s_group * m_groups_alloc;
+                //Stores the cache line aligned groups
+                s_group * m_groups;
+                //Stores the array of reserved elements
+                ELEMENT_TYPE * m_elems;
+                //Stores the flag indicating whether the arrays are attached to external memory
+                const bool m_is_mapped;
+
+                /**
+                 * Allows to read the maximum element index from the binary reader
+                 * @param reader the binary reader
+                 * @return the maximum element index
+                 */
+                template<typename READER_TYPE>
+                static inline IDX_TYPE read_max_element_index(READER_TYPE & reader) {
+                    IDX_TYPE max_elem_idx = 0;
+                    reader.read(max_elem_idx);
+                    return max_elem_idx;
+                }
+
+                /**
+                 * Sets the number of groups as a power of two, based on the number of elements
+                 * @param buckets_factor the buckets factor that the number of elements will be
+                 * multiplied with before converting it into the number of buckets.
+                 * @param num_elems the number of elements to compute the buckets for
+                 */
+                inline void set_number_of_elements(const double buckets_factor, const IDX_TYPE num_elems) {
+                    //Do a compulsory assert on the buckets factor
+                    ASSERT_CONDITION_THROW((buckets_factor < 1.0), string("buckets_factor: ") +
+                            std::to_string(buckets_factor) + string(", must be >= 1.0"));
+
+                    //Compute the number of groups
+                    const double num_groups = (buckets_factor * (num_elems + 1)) / NUM_GROUP_SLOTS;
+                    m_num_groups = (num_groups <= 1.0) ? 1 : const_expr::power(2, const_expr::ceil(const_expr::log2(num_groups)));
+                    //Compute the groups index mask
+                    m_groups_capacity = m_num_groups - 1;
+
+                    //There must be at least one empty bucket for the probing to stop
+                    ASSERT_CONDITION_THROW((num_elems >= m_num_groups * NUM_GROUP_SLOTS), string("Insufficient buckets capacity: ") +
+                            std::to_string(m_num_groups * NUM_GROUP_SLOTS) + string(" need more than ") + std::to_string(num_elems));
+
+                    LOG_DEBUG << "FPHM: num_elems: " << num_elems << ", m_num_groups: " << m_num_groups
+                            << ", slots per group: " << NUM_GROUP_SLOTS << END_LOG;
+                }
+
+                /**
+                 * Allows to get the mixed hash value for the given key uid
+                 * @param key_uid the key uid value to mix
+                 * @return the mixed key uid value
+                 */
+                static inline uint_fast64_t get_mixed_uid(uint_fast64_t key_uid) {
+                    return mix_hash(key_uid);
+                }
+
+                /**
+                 * Allows to get the group index for the given mixed hash value
+                 * @param mixed_uid the mixed key uid value
+                 * @param return the resulting group index
+                 */
+                inline uint_fast64_t get_group_idx(const uint_fast64_t mixed_uid) const {
+                    //The number of groups is the power of two, so the mask gives the remainder
+                    return mixed_uid & m_groups_capacity;
+                }
+
+                /**
+                 * Allows to get the 7 bit fingerprint for the given mixed hash value, the
+                 * highest bits are used as the lowest ones are used for the group index.
+                 * @param mixed_uid the mixed key uid value
+                 * @return the fingerprint being the control byte of the element's bucket
+                 */
+                static inline uint8_t get_fingerprint(const uint_fast64_t mixed_uid) {
+                    return static_cast<uint8_t> (mixed_uid >> 57);
+                }
+
+                /**
+                 * Provides the next group index
+                 * @param group_idx [in/out] the group index
+                 */
+                inline void get_next_group_idx(uint_fast64_t & group_idx) const {
+                    group_idx = (group_idx + 1) & m_groups_capacity;
+                    LOG_DEBUG3 << "Moving on to the next group: " << group_idx << END_LOG;
+                }
+
+                /**
+                 * Allows to match all the control bytes of the group with the given value
+                 * @param group the group to match
+                 * @param value the control byte value to match with
+                 * @return the bit mask with the i'th bit set if the i'th control byte matches
+                 */
+                static inline uint32_t match_ctrl(const s_group & group, const uint8_t value) {
+#ifdef __SSE2__
+                    const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *> (group.m_ctrl));
+                    return static_cast<uint32_t> (_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char> (value)))));
+#else
+                    uint32_t mask = 0;
+                    for (uint32_t idx = 0; idx < NUM_GROUP_SLOTS; ++idx) {
+                        mask |= (static_cast<uint32_t> (group.m_ctrl[idx] == value) << idx);
+                    }
+                    return mask;
+#endif
+                }
+            };
+
+            template<typename ELEMENT_TYPE, typename KEY_TYPE, typename IDX_TYPE>
+            constexpr IDX_TYPE fingerprint_hashmap<ELEMENT_TYPE, KEY_TYPE, IDX_TYPE>::NO_ELEMENT_INDEX;
+
+            template<typename ELEMENT_TYPE, typename KEY_TYPE, typename IDX_TYPE>
+            constexpr IDX_TYPE fingerprint_hashmap<ELEMENT_TYPE, KEY_TYPE, IDX_TYPE>::MIN_ELEMENT_INDEX;
+
+            template<typename ELEMENT_TYPE, typename KEY_TYPE, typename IDX_TYPE>
+            constexpr uint32_t fingerprint_hashmap<ELEMENT_TYPE, KEY_TYPE, IDX_TYPE>::NUM_GROUP_SLOTS;
+
+            template<typename ELEMENT_TYPE, typename KEY_TYPE, typename IDX_TYPE>
+            constexpr uint8_t fingerprint_hashmap<ELEMENT_TYPE, KEY_TYPE, IDX_TYPE>::CTRL_EMPTY;
+
+            template<typename ELEMENT_TYPE, typename KEY_TYPE, typename IDX_TYPE>
+            constexpr uint8_t fingerprint_hashmap<ELEMENT_TYPE, KEY_TYPE, IDX_TYPE>::CTRL_NO_SLOT;
+
+        }
+    }
+}
+
+#endif /* FINGERPRINT_HASHMAP_HPP */
+
@@ -0,0 +1,366 @@
+/*
+ * File:   fingerprint_slot_hashmap.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 11:40 PM
+ */
+
+#ifndef FINGERPRINT_SLOT_HASHMAP_HPP
+#define FINGERPRINT_SLOT_HASHMAP_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+#include "common/utils/hashing_utils.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
+
+using namespace std;
+using namespace uva::utils::hashing;
+
+namespace uva {
+    namespace utils {
+        namespace containers {
+
+#pragma pack(push, 1) // exact fit - no padding
+
+            /**
+             * This template structure represents one bucket of the fingerprint_slot_hashmap.
+             * The bucket stores the payload together with the fingerprint of the key, the
+             * key itself is not stored. A zero fingerprint marks an empty bucket.
+             * @param PAYLOAD_TYPE the payload type
+             * @param NUM_FP_BYTES the number of bytes in the fingerprint
+             */
+            template<typename PAYLOAD_TYPE, uint8_t NUM_FP_BYTES>
+            struct fingerprint_slot {
+                //The field storing the key fingerprint, little endian
+                uint8_t m_fp[NUM_FP_BYTES];
+
+                //The field storing the payload
+                PAYLOAD_TYPE m_payload;
+
+                /**
+                 * Allows to get the fingerprint value
+                 * @return the fingerprint value
+                 */
+                inline uint32_t get_fp() const {
+                    uint32_t fp = 0;
+                    memcpy(&fp, m_fp, NUM_FP_BYTES);
+                    return fp;
+                }
+
+                /**
+                 * Allows to set the fingerprint value
+                 * @param fp the fingerprint value
+                 */
+                inline void set_fp(const uint32_t fp) {
+                    memcpy(m_fp, &fp, NUM_FP_BYTES);
+                }
+            };
+#pragma pack(pop) //back to whatever the previous packing mode was
+
+            /**
+             * This class represents a fixed size lossy hash map in the style of the randomized
+             * language models. Unlike fixed_size_hashmap and fingerprint_hashmap it does not
+             * store the keys nor the element indexes. Each bucket only keeps a 16 or 24 bit
+             * fingerprint of the key uid next to the payload, so the look-up of a key that is
+             * not in the map returns a wrong payload if an occupied bucket of its probe run has
+             * the same fingerprint. The probability of that is bounded by the probe run length
+             * divided by 2^NUM_FP_BITS, see get_false_positive_rate. The buckets are probed
+             * linearly and there is no power of two rounding, so the buckets factor is honored.
+             *
+             * @param PAYLOAD_TYPE the payload type, must be a plain type
+             * @param NUM_FP_BITS the number of fingerprint bits, 16 or 24
+             */
+            template<typename PAYLOAD_TYPE, uint8_t NUM_FP_BITS>
+            class fingerprint_slot_hashmap {
+            public:
+                //Stores the number of bytes in the fingerprint
+                static constexpr uint8_t NUM_FP_BYTES = NUM_FP_BITS / 8;
+                //Stores the fingerprint value mask
+                static constexpr uint32_t FP_MASK = static_cast<uint32_t> ((static_cast<uint64_t> (1) << NUM_FP_BITS) - 1);
+                //Stores the fingerprint value of an empty bucket
+                static constexpr uint32_t NO_FINGERPRINT = 0;
+
+                typedef fingerprint_slot<PAYLOAD_TYPE, NUM_FP_BYTES> TElemType;
+
+                /**
+                 * The basic constructor that allows to instantiate the map for the given number of elements.
+                 * The number of buckets is computed based on the value:
+                 *     buckets_factor * (num_elems + 1)
+                 * @param buckets_factor the factor to compute the number of buckets from the number of elements
+                 * @param num_elems the number of elements that will be stored in the map
+                 */
+                explicit fingerprint_slot_hashmap(const double buckets_factor, const uint32_t num_elems)
+                : m_num_elems(num_elems), m_next_elem_idx(0), m_is_mapped(false) {
+                    ASSERT_CONDITION_THROW(((NUM_FP_BITS != 16) && (NUM_FP_BITS != 24)),
+                            string("Unsupported number of fingerprint bits: ") + std::to_string(NUM_FP_BITS));
+                    ASSERT_CONDITION_THROW((buckets_factor <= 1.0), string("buckets_factor: ") +
+                            std::to_string(buckets_factor) + string(", must be > 1.0"));
+
+                    //Compute the number of buckets, there must be at least one empty bucket for the probing to stop
+                    const double num_buckets = ceil(buckets_factor * (num_elems + 1));
+                    ASSERT_CONDITION_THROW((num_buckets > UINT32_MAX), string("Too many buckets: ") + std::to_string(num_buckets));
+                    m_num_buckets = static_cast<uint64_t> (num_buckets);
+
+                    //Allocate the buckets, they are zeroed so all of them are empty
+                    m_slots = huge_page_allocator::allocate<TElemType>(m_num_buckets);
+
+                    LOG_DEBUG << "FSHM: num_elems: " << num_elems << ", m_num_buckets: " << m_num_buckets
+                            << ", bytes per bucket: " << sizeof (TElemType) << END_LOG;
+                }
+
+                /**
+                 * The constructor that allows to attach the map to the data previously
+                 * written by the write method. The data is not copied but is used in
+                 * place. The resulting map is read-only and shall not be used after the
+                 * reader's memory is released.
+                 * @param reader the binary reader to get the map's data from
+                 */
+                template<typename READER_TYPE>
+                explicit fingerprint_slot_hashmap(READER_TYPE & reader) : m_is_mapped(true) {
+                    reader.read(m_num_elems);
+                    reader.read(m_num_buckets);
+                    reader.read(m_next_elem_idx);
+                    m_slots = const_cast<TElemType *> (reader.template get<TElemType>(m_num_buckets));
+
+                    LOG_DEBUG << "FSHM: attached num_elems: " << m_num_elems << ", m_num_buckets: "
+                            << m_num_buckets << END_LOG;
+                }
+
+                /**
+                 * Allows to write the map's data with the given binary writer
+                 * @param writer the binary writer to write the data with
+                 */
+                template<typename WRITER_TYPE>
+                void write(WRITER_TYPE & writer) const {
+                    writer.write(m_num_elems);
+                    writer.write(m_num_buckets);
+                    writer.write(m_next_elem_idx);
+                    writer.write(m_slots, m_num_buckets);
+                }
+
+                /**
+                 * Allows to add a new element for the given key uid, the
+                 * bucket's fingerprint is set, the payload is to be set
+                 * by the caller.
+                 * @param key_uid the unique identifier of the element key
+                 * @return the reference to the new element
+                 */
+                TElemType & add_new_element(const uint_fast64_t key_uid) {
+                    //Check that the map is not attached to read-only data
+                    ASSERT_SANITY_THROW(m_is_mapped, "Adding an element to a memory mapped map!");
+
+                    //Check if the capacity is exceeded.
+                    ASSERT_SANITY_THROW((m_next_elem_idx >= m_num_elems),
+                            string("Used up all the elements, the capacity is: ") + std::to_string(m_num_elems));
+                    ++m_next_elem_idx;
+
+                    //Search for the first empty bucket
+                    const uint_fast64_t mixed_uid = get_mixed_uid(key_uid);
+                    uint_fast64_t bucket_idx = get_bucket_idx(mixed_uid);
+                    while (m_slots[bucket_idx].get_fp() != NO_FINGERPRINT) {
+                        get_next_bucket_idx(bucket_idx);
+                    }
+
+                    LOG_DEBUG3 << "The key uid: " << key_uid << " is put into bucket: " << bucket_idx << END_LOG;
+
+                    //Mark the bucket as used by the key fingerprint
+                    TElemType & slot = m_slots[bucket_idx];
+                    slot.set_fp(get_fingerprint(mixed_uid));
+                    return slot;
+                }
+
+                /**
+                 * The buckets are not word aligned, so they can not be claimed atomically
+                 * and the elements can not be added concurrently.
+                 * @param key_uid the unique identifier of the element key
+                 * @return never returns
+                 */
+                TElemType & add_new_element_concurrent(const uint_fast64_t key_uid) {
+                    THROW_EXCEPTION("The fingerprint slot hash map does not support concurrent adding!");
+                }
+
+                /**
+                 * Allows to retrieve the element for the given key uid. The key itself is
+                 * not stored, so only the fingerprint of the key uid is compared and the
+                 * result can be a false positive.
+                 * @param key_uid the unique identifier of the element key
+                 * @param key the key value of the element, is not used
+                 * @return the pointer to the found element or NULL if nothing is found
+                 */
+                template<typename KEY_TYPE>
+                TElemType * get_element(const uint_fast64_t key_uid, const KEY_TYPE & key) const {
+                    const uint_fast64_t mixed_uid = get_mixed_uid(key_uid);
+                    const uint32_t fingerprint = get_fingerprint(mixed_uid);
+                    uint_fast64_t bucket_idx = get_bucket_idx(mixed_uid);
+
+                    while (true) {
+                        const uint32_t fp = m_slots[bucket_idx].get_fp();
+                        if (fp == fingerprint) {
+                            LOG_DEBUG3 << "Found the key uid: " << key_uid << " in bucket: " << bucket_idx << END_LOG;
+                            return &m_slots[bucket_idx];
+                        }
+                        if (fp == NO_FINGERPRINT) {
+                            LOG_DEBUG3 << "Could not find the key uid: " << key_uid << END_LOG;
+                            return NULL;
+                        }
+                        get_next_bucket_idx(bucket_idx);
+                    }
+                }
+
+                /**
+                 * Allows to issue a software prefetch for the bucket that is to be
+                 * touched by the get_element method for the given key uid. The
+                 * payload is stored in the bucket so there is no second stage.
+                 * @param is_elem if false then the bucket is prefetched, otherwise nothing is done
+                 * @param key_uid the unique identifier of the element key
+                 */
+                template<bool is_elem>
+                inline void prefetch(const uint_fast64_t key_uid) const {
+                    if (!is_elem) {
+                        __builtin_prefetch(&m_slots[get_bucket_idx(get_mixed_uid(key_uid))], 0, 1);
+                    }
+                }
+
+                /**
+                 * Allows to get the false positive rate of the map, i.e. the probability that
+                 * a look-up of a key, which is not in the map, returns some element. For each
+                 * start bucket the probe run goes through the occupied buckets until the empty
+                 * one and fails to be rejected if any of the run's fingerprints matches. The
+                 * fingerprints are uniform over the 2^NUM_FP_BITS - 1 non-empty values.
+                 * @return the false positive rate averaged over all the start buckets
+                 */
+                double get_false_positive_rate() const {
+                    const double no_match_prob = 1.0 - 1.0 / static_cast<double> (FP_MASK);
+
+                    //Find an empty bucket to start from, so that no run is wrapped around
+                    uint_fast64_t start_idx = 0;
+                    while (m_slots[start_idx].get_fp() != NO_FINGERPRINT) {
+                        ++start_idx;
+                    }
+
+                    //Sum up the false positive probabilities of all the start buckets
+                    double sum_fpr = 0.0;
+                    uint_fast64_t run_length = 0;
+                    uint_fast64_t bucket_idx = start_idx;
+                    do {
+                        get_next_bucket_idx(bucket_idx);
+                        if (m_slots[bucket_idx].get_fp() != NO_FINGERPRINT) {
+                            ++run_length;
+                        } else {
+                            //Starting in the run one probes the rest of it, i.e. 1 to run_length buckets
+                            for (uint_fast64_t len = 1; len <= run_length; ++len) {
+                                sum_fpr += 1.0 - pow(no_match_prob, static_cast<double> (len));
+                            }
+                            run_length = 0;
+                        }
+                    } while (bucket_idx != start_idx);
+
+                    return sum_fpr / static_cast<double> (m_num_buckets);
+                }
+
+                /**
+                 * Allows to get the load factor of the map
+                 * @return the number of elements divided by the number of buckets
+                 */
+                inline double get_load_factor() const {
+                    return static_cast<double> (m_next_elem_idx) / static_cast<double> (m_num_buckets);
+                }
+
+                /**
+                 * The basic destructor
+                 */
+                ~fingerprint_slot_hashmap() {
+                    if (!m_is_mapped) {
+                        huge_page_allocator::deallocate(m_slots);
+                    }
+                }
+
+            private:
+                //Stores the maximum number of elements
+                uint32_t m_num_elems;
+                //Stores the number of buckets
+                uint64_t m_num_buckets;
+                //Stores the current number of stored elements
+                uint32_t m_next_elem_idx;
+                //Stores the buckets
+                TElemType * m_slots;
+                //Stores the flag indicating whether the buckets are attached to external memory
+                const bool m_is_mapped;
+
+                /**
+                 * Allows to get the mixed hash value for the given key uid
+                 * @param key_uid the key uid value to mix
+                 * @return the mixed key uid value
+                 */
+                static inline uint_fast64_t get_mixed_uid(uint_fast64_t key_uid) {
+                    return mix_hash(key_uid);
+                }
+
+                /**
+                 * Allows to get the bucket index for the given mixed hash value, the highest
+                 * 32 bits are mapped onto the buckets range without using the %.
+                 * @param mixed_uid the mixed key uid value
+                 * @return the resulting bucket index
+                 */
+                inline uint_fast64_t get_bucket_idx(const uint_fast64_t mixed_uid) const {
+                    return ((mixed_uid >> 32) * m_num_buckets) >> 32;
+                }
+
+                /**
+                 * Allows to get the non-empty fingerprint for the given mixed hash
+                 * value, the lowest bits are used as the highest are for the index.
+                 * @param mixed_uid the mixed key uid value
+                 * @return the fingerprint
+                 */
+                static inline uint32_t get_fingerprint(const uint_fast64_t mixed_uid) {
+                    const uint32_t fp = static_cast<uint32_t> (mixed_uid) & FP_MASK;
+                    return (fp == NO_FINGERPRINT) ? 1 : fp;
+                }
+
+                /**
+                 * Provides the next bucket index
+                 * @param bucket_idx [in/out] the bucket index
+                 */
+                inline void get_next_bucket_idx(uint_fast64_t & bucket_idx) const {
+                    if (++bucket_idx == m_num_buckets) {
+                        bucket_idx = 0;
+                    }
+                }
+            };
+
+            template<typename PAYLOAD_TYPE, uint8_t NUM_FP_BITS>
+            constexpr uint8_t fingerprint_slot_hashmap<PAYLOAD_TYPE, NUM_FP_BITS>::NUM_FP_BYTES;
+
+            template<typename PAYLOAD_TYPE, uint8_t NUM_FP_BITS>
+            constexpr uint32_t fingerprint_slot_hashmap<PAYLOAD_TYPE, NUM_FP_BITS>::FP_MASK;
+
+            template<typename PAYLOAD_TYPE, uint8_t NUM_FP_BITS>
+            constexpr uint32_t fingerprint_slot_hashmap<PAYLOAD_TYPE, NUM_FP_BITS>::NO_FINGERPRINT;
+        }
+    }
+}
+
+#endif /* FINGERPRINT_SLOT_HASHMAP_HPP */
+
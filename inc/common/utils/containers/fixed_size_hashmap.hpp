@@ -31,6 +31,7 @@
 #include "common/utils/math_utils.hpp"
 #include "common/utils/hashing_utils.hpp"
 #include "common/utils/containers/array_utils.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
 
 using namespace std;
 using namespace uva::utils::hashing;
@@ -74,16 +75,72 @@ namespace uva {
                  * @param buckets_factor the factor to compute the number of buckets from the number of elements
                  * @param num_elems the number of elements that will be stored in the map
                  */
-                explicit fixed_size_hashmap(const double buckets_factor, const IDX_TYPE num_elems) : MAX_ELEMENT_INDEX(num_elems) {
+                explicit fixed_size_hashmap(const double buckets_factor, const IDX_TYPE num_elems)
+                : MAX_ELEMENT_INDEX(num_elems), m_is_mapped(false) {
                     //Compute and set the number of buckets and the buckets divider
                     set_number_of_elements(buckets_factor, num_elems);
                     //Set the current number of stored elements to zero
                     m_next_elem_idx = MIN_ELEMENT_INDEX;
                     //Allocate the number of buckets, with default initialization
-                    m_buckets = new IDX_TYPE[m_num_buckets]();
+                    m_buckets = huge_page_allocator::allocate<IDX_TYPE>(m_num_buckets);
                     //Allocate the elements, add an extra one, the 0'th 
                     //element will never be used its index is reserved.
-                    m_elems = new ELEMENT_TYPE[num_elems + 1]();
+                    m_elems = huge_page_allocator::allocate<ELEMENT_TYPE>(num_elems + 1);
+                }
+
+                /**
+                 * The constructor that allows to attach the map to the data previously
+                 * written by the write method. The data is not copied but is used in
+                 * place, i.e. the buckets and elements arrays point into the memory
+                 * provided by the reader. The resulting map is read-only and shall
+                 * not be used after the reader's memory is released.
+                 * @param reader the binary reader to get the map's data from
+                 */
+                template<typename READER_TYPE>
+                explicit fixed_size_hashmap(READER_TYPE & reader)
+                : MAX_ELEMENT_INDEX(read_max_element_index(reader)), m_is_mapped(true) {
+                    //Read the map's dimensions
+                    reader.read(m_num_buckets);
+                    reader.read(m_next_elem_idx);
+                    m_buckets_capacity = m_num_buckets - 1;
+
+                    //Get the buckets and elements arrays, they are read only
+                    m_buckets = const_cast<IDX_TYPE *> (reader.template get<IDX_TYPE>(m_num_buckets));
+                    m_elems = const_cast<ELEMENT_TYPE *> (reader.template get<ELEMENT_TYPE>(MAX_ELEMENT_INDEX + 1));
+
+                    LOG_DEBUG << "FSHM: attached num_elems: " << MAX_ELEMENT_INDEX << ", m_num_buckets: "
+                            << m_num_buckets << ", m_next_elem_idx: " << m_next_elem_idx << END_LOG;
+                }
+
+                /**
+                 * Allows to write the map's data with the given binary writer.
+                 * The element type is written as is so it must be a plain type
+                 * with no dynamically allocated data.
+                 * @param writer the binary writer to write the data with
+                 */
+                template<typename WRITER_TYPE>
+                void write(WRITER_TYPE & writer) const {
+                    writer.write(MAX_ELEMENT_INDEX);
+                    writer.write(m_num_buckets);
+                    writer.write(m_next_elem_idx);
+                    writer.write(m_buckets, m_num_buckets);
+                    writer.write(m_elems, MAX_ELEMENT_INDEX + 1);
+                }
+
+                /**
+                 * Allows to get the number of added elements
+                 * @return the number of added elements
+                 */
+                inline size_t get_num_elements() const {
+                    return m_next_elem_idx - MIN_ELEMENT_INDEX;
+                }
+
+                /**
+                 * Allows to get the added elements, in the order they were added
+                 * @return the pointer to the first of the get_num_elements() elements
+                 */
+                inline const ELEMENT_TYPE * get_elements() const {
+                    return m_elems + MIN_ELEMENT_INDEX;
                 }
 
                 /**
@@ -95,6 +152,9 @@ namespace uva {
                  * @return the reference to the new element
                  */
                 ELEMENT_TYPE & add_new_element(const uint_fast64_t key_uid) {
+                    //Check that the map is not attached to read-only data
+                    ASSERT_SANITY_THROW(m_is_mapped, "Adding an element to a memory mapped map!");
+
                     //Check if the capacity is exceeded.
                     ASSERT_SANITY_THROW((m_next_elem_idx > MAX_ELEMENT_INDEX),
                             string("Used up all the elements, the last ") +
@@ -132,6 +192,44 @@ namespace uva {
                     return m_elems[elem_idx];
                 }
 
+                /**
+                 * Allows to add a new element for the given hash value, this method is
+                 * safe to be called from several threads at the same time. However it
+                 * can not be combined with the concurrent element retrievals, i.e. the
+                 * elements are only to be retrieved once all the threads adding the
+                 * elements have been joined.
+                 * @param key_uid the unique identifier representing the actual
+                 *        key value of the element. It can be e.g. a hash value
+                 *        of the key. Note that if one uses hash for a key uid
+                 *        then he or she has to accept the risk of collisions.
+                 * @return the reference to the new element
+                 */
+                ELEMENT_TYPE & add_new_element_concurrent(const uint_fast64_t key_uid) {
+                    //Check that the map is not attached to read-only data
+                    ASSERT_SANITY_THROW(m_is_mapped, "Adding an element to a memory mapped map!");
+
+                    //Atomically get the element index and increment
+                    const IDX_TYPE elem_idx = __sync_fetch_and_add(&m_next_elem_idx, 1);
+
+                    //Check if the capacity is exceeded.
+                    ASSERT_CONDITION_THROW((elem_idx > MAX_ELEMENT_INDEX),
+                            string("Used up all the elements, the last ") +
+                            string("issued id was: ") + std::to_string(elem_idx));
+
+                    //Get the bucket index from the hash
+                    uint_fast64_t bucket_idx = get_bucket_idx(key_uid);
+
+                    //Atomically claim the first empty bucket
+                    while (__sync_val_compare_and_swap(&m_buckets[bucket_idx], NO_ELEMENT_INDEX, elem_idx) != NO_ELEMENT_INDEX) {
+                        get_next_bucket_idx(bucket_idx);
+                    }
+
+                    LOG_DEBUG3 << "The element index: " << elem_idx << " is put into bucket: " << bucket_idx << END_LOG;
+
+                    //Return the element under the index
+                    return m_elems[elem_idx];
+                }
+
                 /**
                  * Allows to retrieve the element for the given hash value and key
                  * @param key_uid the unique identifier representing the actual
@@ -166,14 +264,43 @@ namespace uva {
                     return NULL;
                 }
 
+                /**
+                 * Allows to issue a software prefetch for the data that is to be
+                 * touched by the get_element method for the given key uid. The
+                 * prefetching is done in two stages, first the bucket is to be
+                 * prefetched and then, once it is expected to be in cache, the
+                 * element pointed to by the bucket. Issuing the stages for a
+                 * number of keys before retrieving them allows to overlap the
+                 * memory access latencies of the independent look-ups.
+                 * @param is_elem if false then the bucket is prefetched, if true
+                 *        then the first element of the bucket is prefetched
+                 * @param key_uid the unique identifier of the element key
+                 */
+                template<bool is_elem>
+                inline void prefetch(const uint_fast64_t key_uid) const {
+                    //Get the bucket index from the hash
+                    const uint_fast64_t bucket_idx = get_bucket_idx(key_uid);
+
+                    if (is_elem) {
+                        //The bucket is supposed to be in cache already, read it
+                        const IDX_TYPE elem_idx = m_buckets[bucket_idx];
+                        //If the bucket is not empty then prefetch the element
+                        if (elem_idx != NO_ELEMENT_INDEX) {
+                            __builtin_prefetch(&m_elems[elem_idx], 0, 1);
+                        }
+                    } else {
+                        __builtin_prefetch(&m_buckets[bucket_idx], 0, 1);
+                    }
+                }
+
                 /**
                  * The basic destructor
                  */
                 ~fixed_size_hashmap() {
-                    if (m_elems != NULL) {
+                    if ((m_elems != NULL) && !m_is_mapped) {
                         //Free the allocated arrays
-                        delete[] m_elems;
-                        delete[] m_buckets;
+                        huge_page_allocator::deallocate(m_elems);
+                        huge_page_allocator::deallocate(m_buckets);
                     }
                 }
 
@@ -192,6 +319,20 @@ namespace uva {
                 IDX_TYPE * m_buckets;
                 //Stores the array of reserved elements
                 ELEMENT_TYPE * m_elems;
+                //Stores the flag indicating whether the arrays are attached to external memory
+                const bool m_is_mapped;
+
+                /**
+                 * Allows to read the maximum element index from the binary reader
+                 * @param reader the binary reader
+                 * @return the maximum element index
+                 */
+                template<typename READER_TYPE>
+                static inline IDX_TYPE read_max_element_index(READER_TYPE & reader) {
+                    IDX_TYPE max_elem_idx = 0;
+                    reader.read(max_elem_idx);
+                    return max_elem_idx;
+                }
 
                 /**
                  * Sets the number of buckets as a power of two, based on the number of elements
@@ -226,7 +367,7 @@ namespace uva {
                     //Compute the bucket index, note that since m_capacity is the power of two,
                     //we can compute ( hash_value % m_num_buckets ) as ( hash_value & m_capacity )
                     //where m_capacity = ( m_num_buckets - 1);
-                    const uint_fast64_t bucket_idx = mix_fasthash(key_value) & m_buckets_capacity;
+                    const uint_fast64_t bucket_idx = mix_hash(key_value) & m_buckets_capacity;
 
                     LOG_DEBUG3 << "The mixed key value is: " << key_value
                             << ", bucket_idx: " << SSTR(bucket_idx) << END_LOG;
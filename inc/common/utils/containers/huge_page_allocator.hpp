@@ -0,0 +1,230 @@
+/*
+ * File:   huge_page_allocator.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 8:40 PM
+ */
+
+#ifndef HUGE_PAGE_ALLOCATOR_HPP
+#define HUGE_PAGE_ALLOCATOR_HPP
+
+#include <map>
+#include <new>
+#include <cstring>
+#include <type_traits>
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/threads/threads.hpp"
+
+using namespace std;
+
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+using namespace uva::utils::threads;
+
+namespace uva {
+    namespace utils {
+        namespace containers {
+
+            /**
+             * Defines the huge page policies for allocating the large model tables:
+             *   NO_HUGE_PAGES - the regular pages, the tables are allocated with new
+             *   THP_HUGE_PAGES - the anonymous memory advised for the transparent huge pages
+             *   TLB_HUGE_PAGES - the hugetlbfs pages, falls back to THP_HUGE_PAGES if
+             *                    there is not enough pre-reserved huge pages
+             */
+            enum huge_pages_policy {
+                NO_HUGE_PAGES = 0,
+                THP_HUGE_PAGES = 1,
+                TLB_HUGE_PAGES = 2,
+                size_huge_pages_policy = 3
+            };
+
+            /**
+             * This class allows to allocate the large, randomly accessed, model tables in huge
+             * pages, which reduces the number of TLB misses and page walks per look-up. The
+             * policy to use is set for the model being loaded, see scoped_policy. The tables
+             * smaller than one huge page as well as the tables that can not be given huge pages
+             * are allocated with new. All the tables are zero initialized, the non trivial
+             * elements are default constructed. Every allocated table is to be freed with
+             * the deallocate method. This class is thread safe.
+             */
+            class huge_page_allocator {
+            public:
+                //Stores the names of the huge page policies, as used in the configuration files
+                static const char * const POLICY_NAMES[size_huge_pages_policy];
+
+                /**
+                 * This class allows to set the huge page policy for the life time of the
+                 * object, e.g. while loading a model, and then to restore the previous one.
+                 */
+                class scoped_policy {
+                public:
+
+                    /**
+                     * The basic constructor
+                     * @param policy the policy to set
+                     */
+                    scoped_policy(const huge_pages_policy policy) {
+                        scoped_guard guard(m_lock);
+                        m_prev_policy = m_policy;
+                        m_policy = policy;
+                    }
+
+                    /**
+                     * The basic destructor, restores the previous policy
+                     */
+                    ~scoped_policy() {
+                        scoped_guard guard(m_lock);
+                        m_policy = m_prev_policy;
+                    }
+
+                private:
+                    //Stores the previous policy
+                    huge_pages_policy m_prev_policy;
+                };
+
+                /**
+                 * Allows to get the huge page policy by its name
+                 * @param name the policy name
+                 * @return the huge page policy
+                 * @throws uva_exception if the name is not known
+                 */
+                static inline huge_pages_policy get_policy(const string & name) {
+                    for (size_t idx = 0; idx < size_huge_pages_policy; ++idx) {
+                        if (name == POLICY_NAMES[idx]) {
+                            return static_cast<huge_pages_policy> (idx);
+                        }
+                    }
+                    THROW_EXCEPTION(string("Unknown huge pages policy: '") + name +
+                            string("', expected one of: ") + POLICY_NAMES[NO_HUGE_PAGES] +
+                            string(", ") + POLICY_NAMES[THP_HUGE_PAGES] + string(", ") +
+                            POLICY_NAMES[TLB_HUGE_PAGES]);
+                }
+
+                /**
+                 * Allows to allocate the zero initialized table for the given number of elements
+                 * @param ELEMENT_TYPE the table element type
+                 * @param num_elems the number of elements
+                 * @return the pointer to the allocated table
+                 */
+                template<typename ELEMENT_TYPE>
+                static inline ELEMENT_TYPE * allocate(const size_t num_elems) {
+                    ELEMENT_TYPE * elems = static_cast<ELEMENT_TYPE *> (allocate_bytes(num_elems * sizeof (ELEMENT_TYPE), num_elems));
+
+                    //The memory is zeroed, the non trivial elements are to be constructed
+                    if (!is_trivial<ELEMENT_TYPE>::value) {
+                        for (size_t idx = 0; idx < num_elems; ++idx) {
+                            new (elems + idx) ELEMENT_TYPE();
+                        }
+                    }
+
+                    return elems;
+                }
+
+                /**
+                 * Allows to deallocate the table previously allocated with allocate
+                 * @param ELEMENT_TYPE the table element type
+                 * @param elems the pointer to the table, may be NULL
+                 */
+                template<typename ELEMENT_TYPE>
+                static inline void deallocate(ELEMENT_TYPE * elems) {
+                    if (elems != NULL) {
+                        //Destroy the non trivial elements first
+                        if (!is_trivially_destructible<ELEMENT_TYPE>::value) {
+                            const size_t num_elems = get_num_elems(elems);
+                            for (size_t idx = 0; idx < num_elems; ++idx) {
+                                elems[idx].~ELEMENT_TYPE();
+                            }
+                        }
+                        deallocate_bytes(elems);
+                    }
+                }
+
+                /**
+                 * Allows to report the amount of the table memory per page type
+                 * and the number of huge pages actually used by the process.
+                 */
+                static void report_usage();
+
+            private:
+
+                /**
+                 * Defines the ways the table memory can be obtained
+                 */
+                enum alloc_kind {
+                    NEW_ALLOC_KIND = 0,
+                    THP_ALLOC_KIND = 1,
+                    TLB_ALLOC_KIND = 2,
+                    size_alloc_kind = 3
+                };
+
+                /**
+                 * This structure stores the allocated memory block information
+                 * @param m_num_bytes the number of allocated bytes
+                 * @param m_num_elems the number of elements in the block
+                 * @param m_kind the way the block memory was obtained
+                 */
+                typedef struct {
+                    size_t m_num_bytes;
+                    size_t m_num_elems;
+                    alloc_kind m_kind;
+                } s_block;
+
+                //Stores the synchronization lock
+                static mutex m_lock;
+                //Stores the current huge page policy
+                static huge_pages_policy m_policy;
+                //Stores the allocated blocks
+                static map<void *, s_block> m_blocks;
+                //Stores the number of currently allocated bytes per allocation kind
+                static size_t m_num_bytes[size_alloc_kind];
+                //Stores the flag indicating that the hugetlbfs failure was reported
+                static bool m_is_tlb_warned;
+
+                /**
+                 * Allows to allocate the zeroed memory block
+                 * @param num_bytes the number of bytes to allocate
+                 * @param num_elems the number of elements in the block
+                 * @return the pointer to the allocated memory
+                 */
+                static void * allocate_bytes(const size_t num_bytes, const size_t num_elems);
+
+                /**
+                 * Allows to get the number of elements in the allocated memory block
+                 * @param ptr the pointer to the memory block
+                 * @return the number of elements in the block
+                 */
+                static size_t get_num_elems(const void * ptr);
+
+                /**
+                 * Allows to deallocate the memory block
+                 * @param ptr the pointer to the memory block
+                 */
+                static void deallocate_bytes(void * ptr);
+            };
+        }
+    }
+}
+
+#endif /* HUGE_PAGE_ALLOCATOR_HPP */
+
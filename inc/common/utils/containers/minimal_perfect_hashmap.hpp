@@ -0,0 +1,499 @@
+/*
+ * File:   minimal_perfect_hashmap.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 12:40 AM
+ */
+
+#ifndef MINIMAL_PERFECT_HASHMAP_HPP
+#define MINIMAL_PERFECT_HASHMAP_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/hashing_utils.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
+#include "common/utils/containers/fingerprint_slot_hashmap.hpp"
+
+using namespace std;
+
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+using namespace uva::utils::hashing;
+
+namespace uva {
+    namespace utils {
+        namespace containers {
+
+            /**
+             * This class represents a static map with a BBHash style minimal perfect hash
+             * function. The elements are first added as into a plain array and once all of
+             * them are added the build method is to be called. The hash function is built
+             * in levels: each level is a bit array of gamma bits per remaining key, a key is
+             * placed into the level if its bit position is not shared with another key,
+             * the colliding keys are moved to the next level. The element index is the rank
+             * of the key's bit among all the set bits, so the elements are stored densely,
+             * without empty buckets. The few keys left after MAX_NUM_LEVELS levels are kept
+             * in a sorted array and are found by the binary search.
+             *
+             * The keys themselves are not stored, each element keeps a 16 or 24 bit
+             * fingerprint of its key uid next to the payload, this allows to reject most of
+             * the keys not in the map. The look-up of such a key returns a wrong payload
+             * with the probability of at most 1/(2^NUM_FP_BITS - 1).
+             *
+             * @param PAYLOAD_TYPE the payload type, must be a plain type
+             * @param NUM_FP_BITS the number of fingerprint bits, 16 or 24
+             */
+            template<typename PAYLOAD_TYPE, uint8_t NUM_FP_BITS>
+            class minimal_perfect_hashmap {
+            public:
+                //Stores the number of bytes in the fingerprint
+                static constexpr uint8_t NUM_FP_BYTES = NUM_FP_BITS / 8;
+                //Stores the fingerprint value mask
+                static constexpr uint32_t FP_MASK = static_cast<uint32_t> ((static_cast<uint64_t> (1) << NUM_FP_BITS) - 1);
+                //Stores the maximum number of hash function levels
+                static constexpr uint32_t MAX_NUM_LEVELS = 32;
+                //Stores the number of bit words per rank sample
+                static constexpr uint64_t RANK_SAMPLE_WORDS = 8;
+
+                typedef fingerprint_slot<PAYLOAD_TYPE, NUM_FP_BYTES> TElemType;
+
+                /**
+                 * The basic constructor that allows to instantiate the map for the given number of elements.
+                 * @param gamma the number of hash function bits per key on each level, must be >= 1.0
+                 * @param num_elems the number of elements that will be stored in the map
+                 */
+                explicit minimal_perfect_hashmap(const double gamma, const uint32_t num_elems)
+                : m_gamma(gamma), m_num_elems(num_elems), m_next_elem_idx(0), m_num_levels(0),
+                m_num_placed(0), m_num_words(0), m_bits(NULL), m_num_samples(0), m_ranks(NULL),
+                m_num_extra(0), m_extra_keys(NULL), m_slots(NULL), m_keys(NULL), m_is_mapped(false) {
+                    ASSERT_CONDITION_THROW(((NUM_FP_BITS != 16) && (NUM_FP_BITS != 24)),
+                            string("Unsupported number of fingerprint bits: ") + std::to_string(NUM_FP_BITS));
+                    ASSERT_CONDITION_THROW((gamma < 1.0), string("gamma: ") +
+                            std::to_string(gamma) + string(", must be >= 1.0"));
+                    //The level bit positions are computed from 32 bits of the hash, the level size is rounded up
+                    ASSERT_CONDITION_THROW((ceil(gamma * (num_elems + 1)) + 64 > UINT32_MAX),
+                            string("Too many elements: ") + std::to_string(num_elems));
+
+                    memset(m_level_offsets, 0, sizeof (m_level_offsets));
+                    memset(m_level_sizes, 0, sizeof (m_level_sizes));
+
+                    //Allocate the elements and their keys, the hash function is not known yet
+                    m_slots = huge_page_allocator::allocate<TElemType>(m_num_elems);
+                    m_keys = huge_page_allocator::allocate<uint64_t>(m_num_elems);
+
+                    LOG_DEBUG << "MPHM: num_elems: " << num_elems << ", gamma: " << gamma
+                            << ", bytes per element: " << sizeof (TElemType) << END_LOG;
+                }
+
+                /**
+                 * The constructor that allows to attach the map to the data previously
+                 * written by the write method. The data is not copied but is used in
+                 * place. The resulting map is read-only and shall not be used after the
+                 * reader's memory is released.
+                 * @param reader the binary reader to get the map's data from
+                 */
+                template<typename READER_TYPE>
+                explicit minimal_perfect_hashmap(READER_TYPE & reader) : m_keys(NULL), m_is_mapped(true) {
+                    reader.read(m_gamma);
+                    reader.read(m_num_elems);
+                    m_next_elem_idx = m_num_elems;
+                    reader.read(m_num_levels);
+                    memcpy(m_level_offsets, reader.template get<uint64_t>(MAX_NUM_LEVELS), sizeof (m_level_offsets));
+                    memcpy(m_level_sizes, reader.template get<uint64_t>(MAX_NUM_LEVELS), sizeof (m_level_sizes));
+                    reader.read(m_num_placed);
+                    reader.read(m_num_words);
+                    m_bits = const_cast<uint64_t *> (reader.template get<uint64_t>(m_num_words));
+                    reader.read(m_num_samples);
+                    m_ranks = const_cast<uint64_t *> (reader.template get<uint64_t>(m_num_samples));
+                    reader.read(m_num_extra);
+                    m_extra_keys = const_cast<uint64_t *> (reader.template get<uint64_t>(m_num_extra));
+                    m_slots = const_cast<TElemType *> (reader.template get<TElemType>(m_num_elems));
+
+                    LOG_DEBUG << "MPHM: attached num_elems: " << m_num_elems << ", m_num_levels: "
+                            << m_num_levels << ", m_num_extra: " << m_num_extra << END_LOG;
+                }
+
+                /**
+                 * Allows to write the map's data with the given binary writer
+                 * @param writer the binary writer to write the data with
+                 */
+                template<typename WRITER_TYPE>
+                void write(WRITER_TYPE & writer) const {
+                    ASSERT_SANITY_THROW((m_keys != NULL), "The minimal perfect hash function is not built!");
+
+                    writer.write(m_gamma);
+                    writer.write(m_num_elems);
+                    writer.write(m_num_levels);
+                    writer.write(m_level_offsets, MAX_NUM_LEVELS);
+                    writer.write(m_level_sizes, MAX_NUM_LEVELS);
+                    writer.write(m_num_placed);
+                    writer.write(m_num_words);
+                    writer.write(m_bits, m_num_words);
+                    writer.write(m_num_samples);
+                    writer.write(m_ranks, m_num_samples);
+                    writer.write(m_num_extra);
+                    writer.write(m_extra_keys, m_num_extra);
+                    writer.write(m_slots, m_num_elems);
+                }
+
+                /**
+                 * Allows to add a new element for the given key uid, the element's
+                 * fingerprint is set, the payload is to be set by the caller. The
+                 * element is not found by get_element until the map is built.
+                 * @param key_uid the unique identifier of the element key
+                 * @return the reference to the new element
+                 */
+                TElemType & add_new_element(const uint_fast64_t key_uid) {
+                    //Check that the map is still being filled in
+                    ASSERT_SANITY_THROW((m_keys == NULL), "Adding an element to a built map!");
+
+                    //Check if the capacity is exceeded.
+                    ASSERT_SANITY_THROW((m_next_elem_idx >= m_num_elems),
+                            string("Used up all the elements, the capacity is: ") + std::to_string(m_num_elems));
+
+                    m_keys[m_next_elem_idx] = key_uid;
+                    TElemType & slot = m_slots[m_next_elem_idx++];
+                    slot.set_fp(get_fingerprint(key_uid));
+                    return slot;
+                }
+
+                /**
+                 * The elements are added into one array in order, for now they are not
+                 * expected to be added concurrently.
+                 * @param key_uid the unique identifier of the element key
+                 * @return never returns
+                 */
+                TElemType & add_new_element_concurrent(const uint_fast64_t key_uid) {
+                    THROW_EXCEPTION("The minimal perfect hash map does not support concurrent adding!");
+                }
+
+                /**
+                 * Allows to build the minimal perfect hash function for the added elements
+                 * and to re-order the elements accordingly. The keys are freed afterwards.
+                 */
+                void build() {
+                    ASSERT_SANITY_THROW((m_keys == NULL), "The minimal perfect hash function is already built!");
+
+                    //Only the added elements are stored
+                    m_num_elems = m_next_elem_idx;
+
+                    //Build the hash function levels, the keys left are compacted in place
+                    vector<uint64_t> keys(m_keys, m_keys + m_num_elems);
+                    vector<uint64_t> bits;
+                    uint64_t num_left = m_num_elems;
+                    while ((num_left != 0) && (m_num_levels < MAX_NUM_LEVELS)) {
+                        num_left = build_level(keys, num_left, bits);
+                    }
+
+                    //Store the level bits and sample their ranks
+                    m_num_words = bits.size();
+                    m_bits = huge_page_allocator::allocate<uint64_t>(m_num_words);
+                    copy(bits.begin(), bits.end(), m_bits);
+                    m_num_samples = m_num_words / RANK_SAMPLE_WORDS + 1;
+                    m_ranks = huge_page_allocator::allocate<uint64_t>(m_num_samples);
+                    for (uint64_t word_idx = 0; word_idx < m_num_words; ++word_idx) {
+                        if ((word_idx % RANK_SAMPLE_WORDS) == 0) {
+                            m_ranks[word_idx / RANK_SAMPLE_WORDS] = m_num_placed;
+                        }
+                        m_num_placed += __builtin_popcountll(m_bits[word_idx]);
+                    }
+
+                    //Store the keys that could not be placed, the equal keys will get the same element
+                    m_num_extra = num_left;
+                    m_extra_keys = huge_page_allocator::allocate<uint64_t>(m_num_extra);
+                    copy(keys.begin(), keys.begin() + num_left, m_extra_keys);
+                    sort(m_extra_keys, m_extra_keys + m_num_extra);
+
+                    //Re-order the elements by the hash function
+                    TElemType * slots = huge_page_allocator::allocate<TElemType>(m_num_elems);
+                    for (uint64_t idx = 0; idx < m_num_elems; ++idx) {
+                        uint64_t elem_idx = 0;
+                        const bool is_mapped = get_index(m_keys[idx], elem_idx);
+                        ASSERT_SANITY_THROW(!is_mapped, string("The key uid: ") +
+                                to_string(m_keys[idx]) + string(" is not mapped!"));
+                        slots[elem_idx] = m_slots[idx];
+                    }
+                    huge_page_allocator::deallocate(m_slots);
+                    m_slots = slots;
+                    huge_page_allocator::deallocate(m_keys);
+                    m_keys = NULL;
+
+                    LOG_DEBUG << "MPHM: num_elems: " << m_num_elems << ", m_num_levels: " << m_num_levels
+                            << ", m_num_extra: " << m_num_extra << ", bits per key: " << get_bits_per_key() << END_LOG;
+                }
+
+                /**
+                 * Allows to retrieve the element for the given key uid. The key itself is
+                 * not stored, so only the fingerprint of the key uid is compared and the
+                 * result can be a false positive.
+                 * @param key_uid the unique identifier of the element key
+                 * @param key the key value of the element, is not used
+                 * @return the pointer to the found element or NULL if nothing is found
+                 */
+                template<typename KEY_TYPE>
+                TElemType * get_element(const uint_fast64_t key_uid, const KEY_TYPE & key) const {
+                    uint64_t elem_idx = 0;
+                    if (get_index(key_uid, elem_idx) && (m_slots[elem_idx].get_fp() == get_fingerprint(key_uid))) {
+                        LOG_DEBUG3 << "Found the key uid: " << key_uid << " at index: " << elem_idx << END_LOG;
+                        return &m_slots[elem_idx];
+                    }
+                    LOG_DEBUG3 << "Could not find the key uid: " << key_uid << END_LOG;
+                    return NULL;
+                }
+
+                /**
+                 * Allows to issue a software prefetch for the data that is to be touched by
+                 * the get_element method for the given key uid. The first stage prefetches
+                 * the first level bits and the rank sample, the second stage prefetches the
+                 * element if the key is placed on the first level.
+                 * @param is_elem if false then the first level is prefetched, otherwise the element
+                 * @param key_uid the unique identifier of the element key
+                 */
+                template<bool is_elem>
+                inline void prefetch(const uint_fast64_t key_uid) const {
+                    if (m_num_levels != 0) {
+                        const uint64_t bit_pos = get_level_pos(key_uid, 0);
+                        if (!is_elem) {
+                            __builtin_prefetch(&m_bits[bit_pos >> 6], 0, 1);
+                            __builtin_prefetch(&m_ranks[(bit_pos >> 6) / RANK_SAMPLE_WORDS], 0, 1);
+                        } else {
+                            if (is_bit_set(bit_pos)) {
+                                __builtin_prefetch(&m_slots[get_rank(bit_pos)], 0, 1);
+                            }
+                        }
+                    }
+                }
+
+                /**
+                 * Allows to get the false positive rate of the map, i.e. the probability that
+                 * a look-up of a key, which is not in the map, returns some element. Such a key
+                 * is mapped to at most one element whose fingerprint is to match.
+                 * @return the upper bound of the false positive rate
+                 */
+                inline double get_false_positive_rate() const {
+                    return 1.0 / static_cast<double> (FP_MASK);
+                }
+
+                /**
+                 * Allows to get the size of the hash function
+                 * @return the number of hash function bits per key
+                 */
+                inline double get_bits_per_key() const {
+                    const uint64_t num_bits = (m_num_words + m_num_samples + m_num_extra) * sizeof (uint64_t) * 8;
+                    return (m_num_elems == 0) ? 0.0 : static_cast<double> (num_bits) / static_cast<double> (m_num_elems);
+                }
+
+                /**
+                 * Allows to get the number of hash function levels
+                 * @return the number of levels
+                 */
+                inline uint32_t get_num_levels() const {
+                    return m_num_levels;
+                }
+
+                /**
+                 * The basic destructor
+                 */
+                ~minimal_perfect_hashmap() {
+                    if (!m_is_mapped) {
+                        huge_page_allocator::deallocate(m_bits);
+                        huge_page_allocator::deallocate(m_ranks);
+                        huge_page_allocator::deallocate(m_extra_keys);
+                        huge_page_allocator::deallocate(m_slots);
+                        huge_page_allocator::deallocate(m_keys);
+                    }
+                }
+
+            private:
+                //Stores the number of hash function bits per key on each level
+                double m_gamma;
+                //Stores the number of elements
+                uint32_t m_num_elems;
+                //Stores the number of added elements
+                uint32_t m_next_elem_idx;
+                //Stores the number of hash function levels
+                uint32_t m_num_levels;
+                //Stores the bit offsets of the levels
+                uint64_t m_level_offsets[MAX_NUM_LEVELS];
+                //Stores the bit sizes of the levels
+                uint64_t m_level_sizes[MAX_NUM_LEVELS];
+                //Stores the number of keys placed on the levels
+                uint64_t m_num_placed;
+                //Stores the number of bit words of all the levels
+                uint64_t m_num_words;
+                //Stores the bits of all the levels
+                uint64_t * m_bits;
+                //Stores the number of rank samples
+                uint64_t m_num_samples;
+                //Stores the number of set bits before every RANK_SAMPLE_WORDS'th word
+                uint64_t * m_ranks;
+                //Stores the number of keys not placed on the levels
+                uint64_t m_num_extra;
+                //Stores the sorted keys not placed on the levels
+                uint64_t * m_extra_keys;
+                //Stores the elements
+                TElemType * m_slots;
+                //Stores the keys of the added elements until the map is built
+                uint64_t * m_keys;
+                //Stores the flag indicating whether the data is attached to external memory
+                const bool m_is_mapped;
+
+                /**
+                 * Allows to build the next hash function level
+                 * @param keys [in/out] the keys left, the colliding ones are moved to the front
+                 * @param num_left the number of keys left
+                 * @param bits [in/out] the bits of the levels, the new level bits are appended
+                 * @return the number of keys colliding on the new level
+                 */
+                inline uint64_t build_level(vector<uint64_t> & keys, const uint64_t num_left, vector<uint64_t> & bits) {
+                    //The level size is rounded up to the full words
+                    const uint64_t num_words = (static_cast<uint64_t> (ceil(m_gamma * num_left)) + 63) / 64;
+                    m_level_offsets[m_num_levels] = bits.size() * 64;
+                    m_level_sizes[m_num_levels] = num_words * 64;
+
+                    //Mark the bit positions of the keys and the collisions
+                    vector<uint64_t> level_bits(num_words, 0), collisions(num_words, 0);
+                    for (uint64_t idx = 0; idx < num_left; ++idx) {
+                        const uint64_t pos = get_level_pos(keys[idx], m_num_levels) - m_level_offsets[m_num_levels];
+                        const uint64_t mask = (static_cast<uint64_t> (1) << (pos & 63));
+                        if (level_bits[pos >> 6] & mask) {
+                            collisions[pos >> 6] |= mask;
+                        } else {
+                            level_bits[pos >> 6] |= mask;
+                        }
+                    }
+
+                    //Move the colliding keys to the front, for the next level
+                    uint64_t num_next = 0;
+                    for (uint64_t idx = 0; idx < num_left; ++idx) {
+                        const uint64_t pos = get_level_pos(keys[idx], m_num_levels) - m_level_offsets[m_num_levels];
+                        if (collisions[pos >> 6] & (static_cast<uint64_t> (1) << (pos & 63))) {
+                            keys[num_next++] = keys[idx];
+                        }
+                    }
+
+                    //Only the uniquely mapped keys keep their bits
+                    for (uint64_t word_idx = 0; word_idx < num_words; ++word_idx) {
+                        bits.push_back(level_bits[word_idx] & ~collisions[word_idx]);
+                    }
+
+                    ++m_num_levels;
+                    return num_next;
+                }
+
+                /**
+                 * Allows to get the element index for the given key uid
+                 * @param key_uid the unique identifier of the element key
+                 * @param elem_idx [out] the element index
+                 * @return true if the key uid is mapped to some element, otherwise false
+                 */
+                inline bool get_index(const uint_fast64_t key_uid, uint64_t & elem_idx) const {
+                    //Search through the levels
+                    for (uint32_t level = 0; level < m_num_levels; ++level) {
+                        const uint64_t bit_pos = get_level_pos(key_uid, level);
+                        if (is_bit_set(bit_pos)) {
+                            elem_idx = get_rank(bit_pos);
+                            return true;
+                        }
+                    }
+
+                    //Search through the keys not placed on the levels
+                    const uint64_t * end_ptr = m_extra_keys + m_num_extra;
+                    const uint64_t * key_ptr = lower_bound<const uint64_t *>(m_extra_keys, end_ptr, static_cast<uint64_t> (key_uid));
+                    if ((key_ptr != end_ptr) && (*key_ptr == key_uid)) {
+                        elem_idx = m_num_placed + (key_ptr - m_extra_keys);
+                        return true;
+                    }
+                    return false;
+                }
+
+                /**
+                 * Allows to get the bit position of the key uid on the given level, the
+                 * highest 32 bits of the level hash are mapped onto the level without using the %.
+                 * @param key_uid the unique identifier of the element key
+                 * @param level the level index
+                 * @return the global bit position
+                 */
+                inline uint64_t get_level_pos(const uint_fast64_t key_uid, const uint32_t level) const {
+                    uint_fast64_t level_uid = key_uid + (level + 1) * 0x9E3779B97F4A7C15ULL;
+                    mix_hash(level_uid);
+                    return m_level_offsets[level] + (((level_uid >> 32) * m_level_sizes[level]) >> 32);
+                }
+
+                /**
+                 * Allows to check if the bit is set
+                 * @param bit_pos the global bit position
+                 * @return true if the bit is set
+                 */
+                inline bool is_bit_set(const uint64_t bit_pos) const {
+                    return (m_bits[bit_pos >> 6] & (static_cast<uint64_t> (1) << (bit_pos & 63))) != 0;
+                }
+
+                /**
+                 * Allows to get the number of set bits before the given position
+                 * @param bit_pos the global bit position
+                 * @return the rank of the bit
+                 */
+                inline uint64_t get_rank(const uint64_t bit_pos) const {
+                    const uint64_t word_idx = bit_pos >> 6;
+                    uint64_t rank = m_ranks[word_idx / RANK_SAMPLE_WORDS];
+                    for (uint64_t idx = word_idx - (word_idx % RANK_SAMPLE_WORDS); idx < word_idx; ++idx) {
+                        rank += __builtin_popcountll(m_bits[idx]);
+                    }
+                    return rank + __builtin_popcountll(m_bits[word_idx] & ((static_cast<uint64_t> (1) << (bit_pos & 63)) - 1));
+                }
+
+                /**
+                 * Allows to get the non-empty fingerprint for the given key uid
+                 * @param key_uid the unique identifier of the element key
+                 * @return the fingerprint
+                 */
+                static inline uint32_t get_fingerprint(const uint_fast64_t key_uid) {
+                    uint_fast64_t mixed_uid = key_uid;
+                    mix_hash(mixed_uid);
+                    const uint32_t fp = static_cast<uint32_t> (mixed_uid) & FP_MASK;
+                    return (fp == 0) ? 1 : fp;
+                }
+            };
+
+            template<typename PAYLOAD_TYPE, uint8_t NUM_FP_BITS>
+            constexpr uint8_t minimal_perfect_hashmap<PAYLOAD_TYPE, NUM_FP_BITS>::NUM_FP_BYTES;
+
+            template<typename PAYLOAD_TYPE, uint8_t NUM_FP_BITS>
+            constexpr uint32_t minimal_perfect_hashmap<PAYLOAD_TYPE, NUM_FP_BITS>::FP_MASK;
+
+            template<typename PAYLOAD_TYPE, uint8_t NUM_FP_BITS>
+            constexpr uint32_t minimal_perfect_hashmap<PAYLOAD_TYPE, NUM_FP_BITS>::MAX_NUM_LEVELS;
+
+            template<typename PAYLOAD_TYPE, uint8_t NUM_FP_BITS>
+            constexpr uint64_t minimal_perfect_hashmap<PAYLOAD_TYPE, NUM_FP_BITS>::RANK_SAMPLE_WORDS;
+        }
+    }
+}
+
+#endif /* MINIMAL_PERFECT_HASHMAP_HPP */
+
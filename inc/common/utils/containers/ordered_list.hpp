@@ -204,6 +204,36 @@ namespace uva {
                             << " to the ordered list" << END_LOG;
                 }
 
+                /**
+                 * Allows to move all the elements of the other list into this one, the
+                 * elements are added in their order in the other list. The elements that
+                 * do not pass into this list get deleted. The other list becomes empty.
+                 * @param other the list to move the elements from
+                 */
+                inline void move_from(ordered_list & other) {
+                    //Declare the cursor
+                    elem_container * curr = other.m_first;
+
+                    //Move the elements and destroy their containers
+                    while (curr != NULL) {
+                        //Store the next element
+                        elem_container * next = curr->m_next;
+
+                        //Add the element and release it from the container
+                        add_elemenent(curr->m_elem);
+                        curr->m_elem = NULL;
+                        delete curr;
+
+                        //Move on to the next element
+                        curr = next;
+                    }
+
+                    //The other list is now empty
+                    other.m_size = 0;
+                    other.m_first = NULL;
+                    other.m_last = NULL;
+                }
+
                 /**
                  * Allows to get the number of elements currently stored in the list
                  * @return the number of elements stored in the list
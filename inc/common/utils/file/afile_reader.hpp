@@ -65,6 +65,16 @@ namespace uva {
                  */
                 virtual void log_reader_type_info() = 0;
 
+                /**
+                 * Allows to check if the entire file content is available in memory,
+                 * i.e. the text pieces read from the file stay valid until it is closed.
+                 * The default implementation returns false.
+                 * @return true if the entire file content is in memory, otherwise false
+                 */
+                virtual bool is_in_memory() const {
+                    return false;
+                }
+
                 /**
                  * This method allows to reset the reading process and start reading
                  * the file from th first line again. The default implementation
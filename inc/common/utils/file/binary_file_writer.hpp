@@ -0,0 +1,171 @@
+/*
+ * File:   binary_file_writer.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 10:12 AM
+ */
+
+#ifndef BINARY_FILE_WRITER_HPP
+#define BINARY_FILE_WRITER_HPP
+
+#include <string>       // std::string
+#include <cstdio>       // std::fopen std::fwrite std::fclose
+#include <cstring>      // std::strerror
+#include <errno.h>
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+
+using namespace std;
+
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+
+namespace uva {
+    namespace utils {
+        namespace file {
+
+            //Stores the alignment of the binary file data blocks, in bytes
+            static constexpr size_t BINARY_FILE_DATA_ALIGNMENT = 8;
+
+            /**
+             * This is a simple binary file writer. It allows to dump raw memory
+             * blocks into a file such that they are aligned on the boundary of
+             * BINARY_FILE_DATA_ALIGNMENT bytes. The latter makes it possible to
+             * memory map the resulting file and to use its contents in place,
+             * see the binary_mmap_reader class.
+             */
+            class binary_file_writer {
+            public:
+
+                /**
+                 * The basic constructor, opens the file for writing
+                 * @param file_name the name of the file to write into
+                 */
+                binary_file_writer(const string & file_name)
+                : m_file_name(file_name), m_file_ptr(NULL), m_num_bytes(0) {
+                    errno = 0;
+                    m_file_ptr = fopen(m_file_name.c_str(), "wb");
+                    ASSERT_CONDITION_THROW((m_file_ptr == NULL), string("Could not open the file: '") +
+                            m_file_name + string("' for writing, ERROR: ") + strerror(errno));
+
+                    LOG_DEBUG << "Opened the binary file '" << m_file_name << "' for writing." << END_LOG;
+                }
+
+                /**
+                 * The basic destructor, closes the file if it is not closed yet
+                 */
+                virtual ~binary_file_writer() {
+                    close();
+                }
+
+                /**
+                 * Allows to write a single plain value into the file
+                 * @param value the value to be written
+                 */
+                template<typename VALUE_TYPE>
+                inline void write(const VALUE_TYPE & value) {
+                    write(&value, 1);
+                }
+
+                /**
+                 * Allows to write an array of plain values into the file.
+                 * The array is written starting from the aligned position.
+                 * @param data_ptr the pointer to the array to be written
+                 * @param num_elems the number of elements to write
+                 */
+                template<typename VALUE_TYPE>
+                inline void write(const VALUE_TYPE * data_ptr, const size_t num_elems) {
+                    //Make sure we always start from an aligned position
+                    align();
+
+                    //Write the data, if there is any
+                    const size_t num_bytes = num_elems * sizeof (VALUE_TYPE);
+                    if (num_bytes != 0) {
+                        write_bytes(data_ptr, num_bytes);
+                    }
+
+                    LOG_DEBUG1 << "Written " << num_bytes << " bytes into '"
+                            << m_file_name << "', total: " << m_num_bytes << END_LOG;
+                }
+
+                /**
+                 * Allows to get the number of bytes written so far
+                 * @return the number of bytes written so far
+                 */
+                inline size_t get_num_bytes() const {
+                    return m_num_bytes;
+                }
+
+                /**
+                 * Allows to close the file
+                 */
+                inline void close() {
+                    if (m_file_ptr != NULL) {
+                        LOG_DEBUG << "Closing the binary file '" << m_file_name
+                                << "', written " << m_num_bytes << " bytes." << END_LOG;
+                        const int result = fclose(m_file_ptr);
+                        m_file_ptr = NULL;
+                        ASSERT_CONDITION_THROW((result != 0), string("Could not close the file: '") + m_file_name + string("'!"));
+                    }
+                }
+
+            private:
+                //Stores the file name
+                const string m_file_name;
+                //Stores the file pointer
+                FILE * m_file_ptr;
+                //Stores the number of written bytes
+                size_t m_num_bytes;
+
+                /**
+                 * Allows to pad the file with zero bytes up to the next aligned position
+                 */
+                inline void align() {
+                    static const uint8_t ZEROS[BINARY_FILE_DATA_ALIGNMENT] = {};
+                    const size_t remainder = m_num_bytes % BINARY_FILE_DATA_ALIGNMENT;
+                    if (remainder != 0) {
+                        write_bytes(ZEROS, BINARY_FILE_DATA_ALIGNMENT - remainder);
+                    }
+                }
+
+                /**
+                 * Allows to write the given number of bytes into the file
+                 * @param data_ptr the pointer to the data
+                 * @param num_bytes the number of bytes to write
+                 */
+                inline void write_bytes(const void * data_ptr, const size_t num_bytes) {
+                    ASSERT_SANITY_THROW((m_file_ptr == NULL), string("The file: '") + m_file_name + string("' is not open!"));
+
+                    const size_t num_written = fwrite(data_ptr, 1, num_bytes, m_file_ptr);
+                    ASSERT_CONDITION_THROW((num_written != num_bytes), string("Could not write ") +
+                            to_string(num_bytes) + string(" bytes into the file: '") + m_file_name +
+                            string("', only ") + to_string(num_written) + string(" are written!"));
+
+                    m_num_bytes += num_bytes;
+                }
+            };
+        }
+    }
+}
+
+#endif /* BINARY_FILE_WRITER_HPP */
+
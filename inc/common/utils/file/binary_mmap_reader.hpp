@@ -0,0 +1,194 @@
+/*
+ * File:   binary_mmap_reader.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 10:47 AM
+ */
+
+#ifndef BINARY_MMAP_READER_HPP
+#define BINARY_MMAP_READER_HPP
+
+#include <string>       // std::string
+#include <fcntl.h>      // std::open
+#include <unistd.h>     // std::close
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <cstring>
+#include <errno.h>
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+#include "common/utils/file/binary_file_writer.hpp"
+
+using namespace std;
+
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+
+namespace uva {
+    namespace utils {
+        namespace file {
+
+            /**
+             * This is a binary file reader that memory maps the file in a read
+             * only, shared mode. The data is not copied but is used in place,
+             * the reader just issues pointers into the mapped memory. Since the
+             * mapping is shared, the page cache is shared between all processes
+             * mapping the same file. The file is expected to be written by the
+             * binary_file_writer, i.e. with the data blocks being aligned.
+             */
+            class binary_mmap_reader {
+            public:
+
+                /**
+                 * The basic constructor, maps the file into memory
+                 * @param file_name the name of the file to map
+                 */
+                binary_mmap_reader(const string & file_name)
+                : m_file_name(file_name), m_file_desc(-1), m_begin_ptr(NULL), m_length(0), m_offset(0) {
+                    errno = 0;
+                    m_file_desc = open(m_file_name.c_str(), O_RDONLY);
+                    ASSERT_CONDITION_THROW((m_file_desc == -1), string("Could not open the file: '") +
+                            m_file_name + string("' for reading, ERROR: ") + strerror(errno));
+
+                    //The statistics structure for the mapped file
+                    struct stat file_stat;
+                    if (fstat(m_file_desc, &file_stat) < 0) {
+                        close();
+                        THROW_EXCEPTION(string("Could not get the file '") + m_file_name +
+                                string("' statistics, ERROR: ") + strerror(errno));
+                    }
+                    m_length = file_stat.st_size;
+
+                    if (m_length != 0) {
+                        //Map the file into memory, do not populate the pages as the
+                        //file is to be used in place and will be loaded on demand
+                        void * begin_ptr = mmap(NULL, m_length, PROT_READ, MAP_SHARED, m_file_desc, 0);
+                        if (begin_ptr == MAP_FAILED) {
+                            close();
+                            THROW_EXCEPTION(string("Could not memory map the file '") + m_file_name +
+                                    string("', ERROR: ") + strerror(errno));
+                        }
+                        m_begin_ptr = static_cast<const uint8_t *> (begin_ptr);
+                    }
+
+                    LOG_INFO << "Memory mapped the binary file '" << m_file_name << "' size: "
+                            << m_length << " bytes." << END_LOG;
+                }
+
+                /**
+                 * The basic destructor, un-maps the memory and closes the file
+                 */
+                virtual ~binary_mmap_reader() {
+                    close();
+                }
+
+                /**
+                 * Allows to read a single plain value from the file
+                 * @param value [out] the value to read into
+                 */
+                template<typename VALUE_TYPE>
+                inline void read(VALUE_TYPE & value) {
+                    value = *get<VALUE_TYPE>(1);
+                }
+
+                /**
+                 * Allows to get the pointer to the next array of plain values in the file.
+                 * The data is not copied, the pointer is into the mapped memory.
+                 * @param num_elems the number of elements in the array
+                 * @return the pointer to the array of values
+                 */
+                template<typename VALUE_TYPE>
+                inline const VALUE_TYPE * get(const size_t num_elems) {
+                    //Skip to the next aligned position
+                    const size_t remainder = m_offset % BINARY_FILE_DATA_ALIGNMENT;
+                    if (remainder != 0) {
+                        m_offset += BINARY_FILE_DATA_ALIGNMENT - remainder;
+                    }
+
+                    //Check that there is enough data left in the file
+                    const size_t num_bytes = num_elems * sizeof (VALUE_TYPE);
+                    ASSERT_CONDITION_THROW(((m_offset + num_bytes) > m_length),
+                            string("Unexpected end of the binary file: '") + m_file_name +
+                            string("', need ") + to_string(num_bytes) + string(" bytes at position ") +
+                            to_string(m_offset) + string(", the file size is ") + to_string(m_length));
+
+                    const VALUE_TYPE * data_ptr = reinterpret_cast<const VALUE_TYPE *> (m_begin_ptr + m_offset);
+                    m_offset += num_bytes;
+
+                    return data_ptr;
+                }
+
+                /**
+                 * Allows to check if all the file data has been read
+                 * @return true if all the file data has been read
+                 */
+                inline bool is_eof() const {
+                    return (m_offset >= m_length);
+                }
+
+                /**
+                 * Allows to advise the kernel on the expected access pattern for the mapped memory
+                 * @param advice the advice value as for madvise
+                 */
+                inline void advise(const int advice) {
+                    if (m_begin_ptr != NULL) {
+                        if (madvise(const_cast<uint8_t *> (m_begin_ptr), m_length, advice) != 0) {
+                            LOG_WARNING << "The madvise(" << advice << ") for '" << m_file_name
+                                    << "' has failed, ERROR: " << strerror(errno) << END_LOG;
+                        }
+                    }
+                }
+
+                /**
+                 * Allows to un-map the memory and to close the file
+                 */
+                inline void close() {
+                    if (m_begin_ptr != NULL) {
+                        LOG_DEBUG << "Un-mapping the binary file '" << m_file_name << "' memory" << END_LOG;
+                        munmap(const_cast<uint8_t *> (m_begin_ptr), m_length);
+                        m_begin_ptr = NULL;
+                    }
+                    if (m_file_desc != -1) {
+                        ::close(m_file_desc);
+                        m_file_desc = -1;
+                    }
+                }
+
+            private:
+                //Stores the file name
+                const string m_file_name;
+                //Stores the file descriptor
+                int m_file_desc;
+                //Stores the pointer to the mapped memory
+                const uint8_t * m_begin_ptr;
+                //Stores the mapped memory length
+                size_t m_length;
+                //Stores the current read offset
+                size_t m_offset;
+            };
+        }
+    }
+}
+
+#endif /* BINARY_MMAP_READER_HPP */
+
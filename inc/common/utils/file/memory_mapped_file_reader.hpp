@@ -160,6 +160,22 @@ namespace uva {
                 inline bool get_first_line(text_piece_reader& out) {
                     return text_piece_reader::get_first_line(out);
                 }
+
+                /**
+                 * The file is entirely mapped into memory
+                 * @see afile_reader
+                 */
+                virtual bool is_in_memory() const {
+                    return true;
+                }
+
+                /**
+                 * Allows to start reading the mapped file from the first line again
+                 * @see afile_reader
+                 */
+                virtual void reset() {
+                    text_piece_reader::set(text_piece_reader::get_begin_ptr(), text_piece_reader::length());
+                }
                 
                 /**
                  * This method is used to check if the file was successfully opened.
@@ -0,0 +1,149 @@
+/*
+ * File:   shared_memory_segment.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 1:05 AM
+ */
+
+#ifndef SHARED_MEMORY_SEGMENT_HPP
+#define SHARED_MEMORY_SEGMENT_HPP
+
+#include <string>       // std::string
+#include <cstdio>       // std::rename std::remove
+#include <fcntl.h>      // std::open
+#include <unistd.h>     // std::close
+#include <sys/file.h>   // std::flock
+#include <sys/stat.h>
+#include <cstring>
+#include <errno.h>
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+
+using namespace std;
+
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+
+namespace uva {
+    namespace utils {
+        namespace file {
+
+            /**
+             * This class represents a named POSIX shared memory segment, i.e. a file
+             * in the /dev/shm tmpfs, that is created once and is then memory mapped,
+             * read-only, by any number of processes. The segment is created by writing
+             * its data into a temporary segment that is then atomically renamed, so a
+             * segment with the final name is always complete. The creation is guarded
+             * by an exclusive lock held from the construction until the destruction
+             * of this object: the first process creates the segment, the others wait
+             * and then find it created. The lock is released by the kernel if the
+             * process dies. The segment outlives the processes until it is removed
+             * from /dev/shm or the host is rebooted.
+             */
+            class shared_memory_segment {
+            public:
+                //Stores the directory of the POSIX shared memory segments
+                static constexpr const char * SHM_DIR_PATH = "/dev/shm/";
+
+                /**
+                 * The basic constructor, blocks until the segment lock is acquired
+                 * @param name the segment name, must not contain '/'
+                 */
+                shared_memory_segment(const string & name)
+                : m_path(string(SHM_DIR_PATH) + name), m_lock_desc(-1) {
+                    ASSERT_CONDITION_THROW((name.empty() || (name.find('/') != string::npos)),
+                            string("Invalid shared memory segment name: '") + name + string("'"));
+
+                    errno = 0;
+                    const string lock_path = m_path + string(".lock");
+                    m_lock_desc = open(lock_path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                    ASSERT_CONDITION_THROW((m_lock_desc == -1), string("Could not open the shared memory segment lock: '") +
+                            lock_path + string("', ERROR: ") + strerror(errno));
+
+                    LOG_DEBUG << "Waiting for the shared memory segment '" << m_path << "' lock" << END_LOG;
+                    if (flock(m_lock_desc, LOCK_EX) != 0) {
+                        const string error = strerror(errno);
+                        ::close(m_lock_desc);
+                        THROW_EXCEPTION(string("Could not lock the shared memory segment '") +
+                                m_path + string("', ERROR: ") + error);
+                    }
+                }
+
+                /**
+                 * The basic destructor, releases the segment lock. The temporary
+                 * segment, if it was not published, is removed.
+                 */
+                virtual ~shared_memory_segment() {
+                    remove(get_build_path().c_str());
+                    flock(m_lock_desc, LOCK_UN);
+                    ::close(m_lock_desc);
+                }
+
+                /**
+                 * Allows to check if the segment is already created
+                 * @return true if the segment is created
+                 */
+                inline bool is_created() const {
+                    struct stat file_stat;
+                    return (stat(m_path.c_str(), &file_stat) == 0);
+                }
+
+                /**
+                 * Allows to get the path of the segment, to be mapped for reading
+                 * @return the segment path
+                 */
+                inline const string & get_path() const {
+                    return m_path;
+                }
+
+                /**
+                 * Allows to get the path of the temporary segment, to write the data into
+                 * @return the temporary segment path
+                 */
+                inline string get_build_path() const {
+                    return m_path + string(".build");
+                }
+
+                /**
+                 * Allows to publish the temporary segment under the segment name
+                 */
+                inline void publish() {
+                    errno = 0;
+                    ASSERT_CONDITION_THROW((rename(get_build_path().c_str(), m_path.c_str()) != 0),
+                            string("Could not publish the shared memory segment '") + m_path +
+                            string("', ERROR: ") + strerror(errno));
+
+                    LOG_USAGE << "The shared memory segment '" << m_path << "' is created." << END_LOG;
+                }
+
+            private:
+                //Stores the segment path
+                const string m_path;
+                //Stores the lock file descriptor
+                int m_lock_desc;
+            };
+        }
+    }
+}
+
+#endif /* SHARED_MEMORY_SEGMENT_HPP */
+
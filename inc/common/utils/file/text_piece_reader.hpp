@@ -158,6 +158,27 @@ namespace uva {
                     return string(m_rest_ptr, m_rest_len);
                 }
 
+                /**
+                 * Allows to get the length of the remainder of the text
+                 * @return the length of the remainder of the text
+                 */
+                inline size_t get_rest_len() const {
+                    return m_rest_len;
+                }
+
+                /**
+                 * Allows to skip the given number of characters of the remainder of the text
+                 * @param num_chars the number of characters to skip
+                 */
+                inline void skip(const size_t num_chars) {
+                    ASSERT_SANITY_THROW((num_chars > m_rest_len), string("Can not skip ") +
+                            to_string(num_chars) + string(" characters, only ") +
+                            to_string(m_rest_len) + string(" are left!"));
+
+                    m_rest_ptr += num_chars;
+                    m_rest_len -= num_chars;
+                }
+
                 /**
                  * Allows to get the pointer to the beginning of the text
                  * @return the pointer to the beginning of the text
@@ -27,9 +27,14 @@
 #define	HASHINGUTILS_HPP
 
 #include <string>     // std::string
+#include <cstring>    // std::memcpy
 #include <cmath>      // std::floor, std::sqrt
 #include <stdint.h>   // srd::uint32_t
 
+#if defined(__SSE4_2__)
+#include <nmmintrin.h> // _mm_crc32_u64
+#endif
+
 #include "common/utils/logging/logger.hpp"
 
 using namespace std;
@@ -561,22 +566,188 @@ namespace uva {
             /*****************************************************************************************************/
 
             /**
-             * The function used to compute hash in the application, uses one of the specific hashing functions above.
-             * @param data the data to hash
-             * @param len the length of the data to hash
-             * @return the resulting hash.
+             * This is the 64 bit finalizer of the MurmurHash3 by Austin Appleby, see
+             * https://github.com/aappleby/smhasher, every input bit affects every output bit.
+             * @param h the 64 bit key to mix
+             * @return the mixed key
              */
-            static inline uint_fast64_t compute_hash(const char * data, uint32_t len) {
-                return MurmurHash64A(data, len);
+            static inline uint_fast64_t fmix64(uint_fast64_t h) {
+                h ^= h >> 33;
+                h *= 0xff51afd7ed558ccdULL;
+                h ^= h >> 33;
+                h *= 0xc4ceb9fe1a85ec53ULL;
+                h ^= h >> 33;
+                return h;
             }
 
+            /*****************************************************************************************************/
+
             /**
-             * The function used to compute hash in the application, uses one of the specific hashing functions above.
-             * @param token the token to compute hash for
-             * @return the resulting hash.
+             * The wyhash (final version 4) by Wang Yi, see https://github.com/wangyi-fudan/wyhash
+             * It is one of the fastest 64 bit hashes passing SMHasher, especially for the short
+             * keys such as words, as the keys up to 16 bytes are read without any loop.
              */
-            static inline uint_fast64_t compute_hash(const string & token) {
-                return compute_hash(token.c_str(), token.length());
+            namespace __wyhash {
+                //Stores the default secret of the wyhash
+                static constexpr uint64_t SECRET[4] = {
+                    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+                    0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+                };
+
+                /**
+                 * Allows to compute the 128 bit product of the two values
+                 * @param a [in/out] the first value, the lower 64 bits of the product
+                 * @param b [in/out] the second value, the higher 64 bits of the product
+                 */
+                static inline void mum(uint64_t & a, uint64_t & b) {
+                    const __uint128_t r = static_cast<__uint128_t> (a) * b;
+                    a = static_cast<uint64_t> (r);
+                    b = static_cast<uint64_t> (r >> 64);
+                }
+
+                /**
+                 * Allows to mix the two values by folding their 128 bit product
+                 * @param a the first value
+                 * @param b the second value
+                 * @return the mixed value
+                 */
+                static inline uint64_t mix(uint64_t a, uint64_t b) {
+                    mum(a, b);
+                    return a ^ b;
+                }
+
+                //The unaligned reads of 8, 4 and 1-3 bytes
+                static inline uint64_t read8(const uint8_t * p) {
+                    uint64_t v;
+                    memcpy(&v, p, sizeof (v));
+                    return v;
+                }
+
+                static inline uint64_t read4(const uint8_t * p) {
+                    uint32_t v;
+                    memcpy(&v, p, sizeof (v));
+                    return v;
+                }
+
+                static inline uint64_t read3(const uint8_t * p, const size_t k) {
+                    return (static_cast<uint64_t> (p[0]) << 16) | (static_cast<uint64_t> (p[k >> 1]) << 8) | p[k - 1];
+                }
+            }
+
+            /**
+             * The wyhash string hashing function
+             * @param key the pointer to the data
+             * @param len the data length
+             * @param seed the seed to use
+             * @return the hash value
+             */
+            static inline uint_fast64_t wyhash64(const char * key, const size_t len, uint64_t seed = 0) {
+                using namespace __wyhash;
+                const uint8_t * p = reinterpret_cast<const uint8_t *> (key);
+                seed ^= mix(seed ^ SECRET[0], SECRET[1]);
+                uint64_t a, b;
+                if (len <= 16) {
+                    if (len >= 4) {
+                        a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+                        b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+                    } else if (len > 0) {
+                        a = read3(p, len);
+                        b = 0;
+                    } else {
+                        a = b = 0;
+                    }
+                } else {
+                    size_t i = len;
+                    if (i >= 48) {
+                        uint64_t see1 = seed, see2 = seed;
+                        do {
+                            seed = mix(read8(p) ^ SECRET[1], read8(p + 8) ^ seed);
+                            see1 = mix(read8(p + 16) ^ SECRET[2], read8(p + 24) ^ see1);
+                            see2 = mix(read8(p + 32) ^ SECRET[3], read8(p + 40) ^ see2);
+                            p += 48;
+                            i -= 48;
+                        } while (i >= 48);
+                        seed ^= see1 ^ see2;
+                    }
+                    while (i > 16) {
+                        seed = mix(read8(p) ^ SECRET[1], read8(p + 8) ^ seed);
+                        i -= 16;
+                        p += 16;
+                    }
+                    a = read8(p + i - 16);
+                    b = read8(p + i - 8);
+                }
+                a ^= SECRET[1];
+                b ^= seed;
+                mum(a, b);
+                return mix(a ^ SECRET[0] ^ len, b ^ SECRET[1]);
+            }
+
+            /**
+             * The wyhash 64 bit integer hashing function, is the wyhash64 of the reference implementation
+             * @param a the first value
+             * @param b the second value
+             * @return the hash value
+             */
+            static inline uint_fast64_t wyhash64(uint64_t a, uint64_t b) {
+                a ^= 0x2d358dccaa6c78a5ULL;
+                b ^= 0x8bb84b93962eacc9ULL;
+                __wyhash::mum(a, b);
+                return __wyhash::mix(a ^ 0x2d358dccaa6c78a5ULL, b ^ 0x8bb84b93962eacc9ULL);
+            }
+
+            /*****************************************************************************************************/
+
+            /**
+             * The CRC32C (Castagnoli) checksum used as a hash. If the code is compiled with the
+             * SSE4.2 support, e.g. -msse4.2 or -march=native, then the hardware crc32 instruction
+             * is used, eight bytes per instruction, otherwise the table driven scalar version is.
+             * Both give the same values. Note that the CRC is linear, so it is only good for
+             * the keys with enough entropy and it only has 32 bits.
+             * @param data the pointer to the data
+             * @param len the data length
+             * @param crc the initial value
+             * @return the CRC32C value
+             */
+            static inline uint32_t crc32c(const char * data, size_t len, uint32_t crc = 0xFFFFFFFFU) {
+#if defined(__SSE4_2__)
+                while (len >= sizeof (uint64_t)) {
+                    uint64_t value;
+                    memcpy(&value, data, sizeof (value));
+                    crc = static_cast<uint32_t> (_mm_crc32_u64(crc, value));
+                    data += sizeof (uint64_t);
+                    len -= sizeof (uint64_t);
+                }
+                while (len != 0) {
+                    crc = _mm_crc32_u8(crc, static_cast<uint8_t> (*data++));
+                    --len;
+                }
+#else
+
+                /**
+                 * The CRC32C table for the reflected polynomial 0x82F63B78
+                 */
+                struct crc32c_table {
+                    uint32_t m_values[256];
+
+                    crc32c_table() {
+                        for (uint32_t idx = 0; idx < 256; ++idx) {
+                            uint32_t value = idx;
+                            for (uint32_t bit = 0; bit < 8; ++bit) {
+                                value = (value & 1) ? ((value >> 1) ^ 0x82F63B78U) : (value >> 1);
+                            }
+                            m_values[idx] = value;
+                        }
+                    }
+                };
+                static const crc32c_table table;
+
+                while (len != 0) {
+                    crc = table.m_values[(crc ^ static_cast<uint8_t> (*data++)) & 0xFF] ^ (crc >> 8);
+                    --len;
+                }
+#endif
+                return ~crc;
             }
 
             /*****************************************************************************************************/
@@ -652,18 +823,168 @@ namespace uva {
             /*****************************************************************************************************/
 
             /**
-             * Allows to combine two hashes into one, at the moment is implemented
-             * using the Cantor function which provides the best result so far among:
-             *  1. one ^ two
-             *  2. hash64(one, two)
-             *  3. szudzik
+             * The hashing policies below allow to choose, at compile time, the hash functions
+             * used throughout the application, see str_hash_policy and int_hash_policy. The
+             * string hashing policy computes the word ids and the phrase uids from the text:
+             *      static uint_fast64_t hash(const char * data, uint32_t len);
+             * The integer hashing policy mixes the uids into the hash table buckets and
+             * fingerprints, and combines the word and phrase uids into the phrase uids:
+             *      static uint_fast64_t mix(uint_fast64_t key);
+             *      static uint_fast64_t combine(uint_fast64_t hash_two, uint_fast64_t hash_one);
+             * Both provide the name for reporting and for the binary model compatibility:
+             *      static const char * get_name();
+             * The bundled hash-bench tool reports the speed and the quality of the policies.
+             */
+
+            /**
+             * The MurmurHash64A string hashing policy
+             */
+            struct murmur_str_hash {
+
+                static inline const char * get_name() {
+                    return "murmur64a";
+                }
+
+                static inline uint_fast64_t hash(const char * data, uint32_t len) {
+                    return MurmurHash64A(data, len);
+                }
+            };
+
+            /**
+             * The wyhash string hashing policy
+             */
+            struct wyhash_str_hash {
+
+                static inline const char * get_name() {
+                    return "wyhash";
+                }
+
+                static inline uint_fast64_t hash(const char * data, uint32_t len) {
+                    return wyhash64(data, len);
+                }
+            };
+
+            /**
+             * The CRC32C string hashing policy, the lower 32 bits are the CRC and the
+             * higher ones are the length, so the collisions are to be expected in the
+             * vocabularies of more than about 10^5 words of the same length.
+             */
+            struct crc32c_str_hash {
+
+                static inline const char * get_name() {
+                    return "crc32c";
+                }
+
+                static inline uint_fast64_t hash(const char * data, uint32_t len) {
+                    return (static_cast<uint_fast64_t> (len) << 32) | crc32c(data, len);
+                }
+            };
+
+            /**
+             * The fast-hash integer hashing policy, the mixing is the one of the fast-hash
+             * and the combining is done with the Cantor function which provides the best
+             * result so far among: 1. one ^ two; 2. hash64(one, two); 3. szudzik
+             */
+            struct fasthash_int_hash {
+
+                static inline const char * get_name() {
+                    return "fasthash";
+                }
+
+                static inline uint_fast64_t mix(uint_fast64_t key) {
+                    return mix_fasthash(key);
+                }
+
+                static inline uint_fast64_t combine(const uint_fast64_t hash_two, const uint_fast64_t hash_one) {
+                    return cantor(hash_one, hash_two);
+                }
+            };
+
+            /**
+             * The MurmurHash3 finalizer integer hashing policy
+             */
+            struct murmur_int_hash {
+
+                static inline const char * get_name() {
+                    return "fmix64";
+                }
+
+                static inline uint_fast64_t mix(uint_fast64_t key) {
+                    return fmix64(key);
+                }
+
+                static inline uint_fast64_t combine(const uint_fast64_t hash_two, const uint_fast64_t hash_one) {
+                    return fmix64(hash_one ^ (hash_two * 0x9E3779B97F4A7C15ULL));
+                }
+            };
+
+            /**
+             * The wyhash integer hashing policy
+             */
+            struct wyhash_int_hash {
+
+                static inline const char * get_name() {
+                    return "wyhash";
+                }
+
+                static inline uint_fast64_t mix(uint_fast64_t key) {
+                    return wyhash64(key, 0x9E3779B97F4A7C15ULL);
+                }
+
+                static inline uint_fast64_t combine(const uint_fast64_t hash_two, const uint_fast64_t hash_one) {
+                    return wyhash64(hash_one, hash_two);
+                }
+            };
+
+            //Here we have the string hashing policy used in the application
+            typedef murmur_str_hash str_hash_policy;
+
+            //Here we have the integer hashing policy used in the application
+            typedef fasthash_int_hash int_hash_policy;
+
+            /*****************************************************************************************************/
+
+            /**
+             * The function used to compute hash in the application, uses the string hashing policy.
+             * @param data the data to hash
+             * @param len the length of the data to hash
+             * @return the resulting hash.
+             */
+            static inline uint_fast64_t compute_hash(const char * data, uint32_t len) {
+                return str_hash_policy::hash(data, len);
+            }
+
+            /**
+             * The function used to compute hash in the application, uses the string hashing policy.
+             * @param token the token to compute hash for
+             * @return the resulting hash.
+             */
+            static inline uint_fast64_t compute_hash(const string & token) {
+                return compute_hash(token.c_str(), token.length());
+            }
+
+            /**
+             * The function used to mix the hash table keys in the application, its purpose
+             * is to spread the keys that would go into the same bucket through out the
+             * buckets. Uses the integer hashing policy.
+             * @param h the reference to the 64 bit key to mix
+             * @return the reference to the same 64 bit key that has been mixed
+             */
+            static inline uint_fast64_t & mix_hash(uint_fast64_t & h) {
+                h = int_hash_policy::mix(h);
+                return h;
+            }
+
+            /**
+             * Allows to combine two hashes into one, uses the integer hashing policy.
              * @param hash_one the first hash value
              * @param hash_two the second hash value
              * @return the resulting combines hash value
              */
             static inline uint_fast64_t combine_hash(const uint_fast64_t hash_two, const uint_fast64_t hash_one) {
-                LOG_DEBUG4 << "cantor(" << hash_one << ", " << hash_two << ") = " << cantor(hash_one, hash_two) << END_LOG;
-                return cantor(hash_one, hash_two);
+                const uint_fast64_t result = int_hash_policy::combine(hash_two, hash_one);
+                LOG_DEBUG4 << int_hash_policy::get_name() << "(" << hash_one << ", " << hash_two << ") = " << result << END_LOG;
+                return result;
             }
 
         }
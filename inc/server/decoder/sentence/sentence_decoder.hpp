@@ -41,9 +41,7 @@
 #include "server/decoder/stack/multi_stack.hpp"
 #include "server/messaging/trans_sent_data_out.hpp"
 
-#include "server/lm/lm_configurator.hpp"
-#include "server/tm/tm_configurator.hpp"
-#include "server/rm/rm_configurator.hpp"
+#include "server/server_models.hpp"
 
 using namespace std;
 
@@ -94,9 +92,10 @@ namespace uva {
                             : m_stack_info_prov(NULL), m_de_params(params), m_is_stop(is_stop),
                             m_source_sent(source_sent), m_target_sent(target_sent),
                             m_sent_data(count_words(m_source_sent)),
-                            m_lm_query(lm_configurator::allocate_fast_query_proxy()),
-                            m_tm_query(tm_configurator::allocate_query_proxy()),
-                            m_rm_query(rm_configurator::allocate_query_proxy()) {
+                            m_models(server_models::get_models()),
+                            m_lm_query(m_models.m_lm_model->allocate_fast_query_proxy()),
+                            m_tm_query(m_models.m_tm_model->allocate_query_proxy()),
+                            m_rm_query(m_models.m_rm_model->allocate_query_proxy()) {
                                 LOG_DEBUG << "Created a sentence decoder " << m_de_params << END_LOG;
 
                                 //Initialize with an empty string
@@ -107,10 +106,11 @@ namespace uva {
                              * The basic destructor
                              */
                             ~sentence_decoder() {
-                                //Dispose the query objects as they are no longer needed
-                                lm_configurator::dispose_fast_query_proxy(m_lm_query);
-                                tm_configurator::dispose_query_proxy(m_tm_query);
-                                rm_configurator::dispose_query_proxy(m_rm_query);
+                                //Dispose the query objects as they are no longer needed, the
+                                //models are freed with the last decoder if they were reloaded
+                                m_models.m_lm_model->dispose_fast_query_proxy(m_lm_query);
+                                m_models.m_tm_model->dispose_query_proxy(m_tm_query);
+                                m_models.m_rm_model->dispose_query_proxy(m_rm_query);
                                 //Dispose the translation info provider and thus the stack, if present
                                 if (m_stack_info_prov != NULL) {
                                     delete m_stack_info_prov;
@@ -487,7 +487,9 @@ namespace uva {
                             //Stores the pointer to the sentence data map
                             sentence_data_map m_sent_data;
 
-                            //The reference to the translation model query proxy
+                            //Stores the models used by this decoder, they are kept until it is finished
+                            const server_models::s_models m_models;
+                            //The reference to the language model query proxy
                             lm_fast_query_proxy & m_lm_query;
                             //The reference to the translation model query proxy
                             tm_query_proxy & m_tm_query;
@@ -94,6 +94,14 @@ namespace uva {
 #define INIT_STACK_STATE_TUNING_DATA
 #endif                        
 
+#if IS_SERVER_TUNING_MODE
+                            //In the tuning mode the LM feature scores are to be stored
+                            //per state, so the states execute their LM queries themselves
+#define PASS_LM_BATCH_QUERY(idx) NULL
+#else
+#define PASS_LM_BATCH_QUERY(idx) &lm_batch[idx]
+#endif
+
                             /**
                              * The basic constructor for the BEGIN stack state, corresponding to the <s> tag.
                              * @param data the shared data container
@@ -126,12 +134,13 @@ namespace uva {
                              * @param end_pos this state translated source phrase end position
                              * @param covered the pre-cooked covered vector, for efficiency reasons.
                              * @param target the new translation target
+                             * @param lm_query the language model query executed in a batch or NULL
                              */
                             stack_state_templ(stack_state_ptr parent, const int32_t fncs_pos,
                                     const int32_t begin_pos, const int32_t end_pos,
                                     const typename state_data::covered_info & covered,
-                                    tm_const_target_entry* target)
-                            : m_parent(parent), m_state_data(parent->m_state_data, begin_pos, end_pos, covered, target),
+                                    tm_const_target_entry* target, const lm_batch_query * lm_query)
+                            : m_parent(parent), m_state_data(parent->m_state_data, begin_pos, end_pos, covered, target, lm_query),
                             m_prev(NULL), m_next(NULL), m_fncs_pos(fncs_pos), m_recomb_from(NULL) INIT_STACK_STATE_TUNING_DATA{
                                 LOG_DEBUG1 << "New state: " << this << ", parent: " << m_parent
                                 << ", source[" << begin_pos << "," << end_pos << "], target ___"
@@ -449,7 +458,8 @@ namespace uva {
                              * the same sub-problem i.e. are eligible for recombination.
                              * The states are equal if and only if:
                              *    1. They have the same last translated word
-                             *    2. They have the same history of target words
+                             *    2. They have the same language model state, i.e. the
+                             *       same minimized history of target words
                              *    3. They cover the same source words
                              * @param other the other state to compare with
                              * @return true if this state is equal to the other one, otherwise false.
@@ -461,14 +471,15 @@ namespace uva {
                                 //Log the state data that will be compared
                                 LOG_DEBUG1 << "--- State recombination check: " << this << " =?= " << &other << END_LOG;
                                 LOG_DEBUG1 << "--- " << m_state_data.m_s_end_word_idx << " =?= " << other_data.m_s_end_word_idx << END_LOG;
-                                LOG_DEBUG1 << "--- Checking tail history of " << MAX_HISTORY_LENGTH << " elements" << END_LOG;
+                                LOG_DEBUG1 << "--- Checking tail history of " << m_state_data.m_lm_state.m_ctx_len
+                                        << " =?= " << other_data.m_lm_state.m_ctx_len << " elements" << END_LOG;
                                 LOG_DEBUG1 << "--- " << m_state_data.m_trans_frame.to_string() << " =?= " << other_data.m_trans_frame.to_string() << END_LOG;
                                 LOG_DEBUG1 << "--- " << m_state_data.covered_to_string() << " =?= " << other_data.covered_to_string() << END_LOG;
                                 LOG_DEBUG1 << "--- " << m_state_data.rm_entry_data << " =(second 1/2)?= " << other_data.rm_entry_data << END_LOG;
 
                                 //Compute the comparison result
                                 const bool is_equal = (m_state_data.m_s_end_word_idx == other_data.m_s_end_word_idx) &&
-                                        m_state_data.m_trans_frame.is_equal_last(other_data.m_trans_frame, MAX_HISTORY_LENGTH) &&
+                                        m_state_data.is_equal_lm_state(other_data) &&
                                         (m_state_data.m_covered == other_data.m_covered) &&
                                         m_state_data.rm_entry_data.is_equal_from_weights(other_data.rm_entry_data);
 
@@ -767,10 +778,30 @@ namespace uva {
                                     //Otherwise, there is a possible gap of not-covered positions starting from the given one.
                                     const int32_t fncs_pos = ((first_nc_pos == start_pos) ? (end_pos + 1) : first_nc_pos);
 
-                                    //Iterate through all the available target translations
-                                    for (size_t idx = 0; idx < entry->num_targets(); ++idx) {
-                                        //Add a new hypothesis state to the multi-stack
-                                        m_state_data.m_stack_data.m_add_state(new stack_state(this, fncs_pos, start_pos, end_pos, covered, &targets[idx]));
+#if !IS_SERVER_TUNING_MODE
+                                    //Declare the language model queries of the new states, to be executed in a batch
+                                    lm_batch_query lm_batch[LM_QUERY_BATCH_SIZE];
+                                    word_uid lm_word_ids[LM_QUERY_BATCH_SIZE][MAX_M_GRAM_QUERY_LENGTH];
+#endif
+
+                                    //Iterate through all the available target translations, in batches
+                                    for (size_t begin_idx = 0; begin_idx < entry->num_targets(); begin_idx += LM_QUERY_BATCH_SIZE) {
+                                        const size_t num_batch = min<size_t>(entry->num_targets() - begin_idx, LM_QUERY_BATCH_SIZE);
+
+#if !IS_SERVER_TUNING_MODE
+                                        //Execute the language model queries of the new states at once, the
+                                        //queries share the history so their look-ups are overlapped in time
+                                        for (size_t idx = 0; idx < num_batch; ++idx) {
+                                            m_state_data.set_lm_query(&targets[begin_idx + idx], lm_word_ids[idx], lm_batch[idx]);
+                                        }
+                                        m_state_data.m_stack_data.m_lm_query.execute(num_batch, lm_batch);
+#endif
+
+                                        for (size_t idx = 0; idx < num_batch; ++idx) {
+                                            //Add a new hypothesis state to the multi-stack
+                                            m_state_data.m_stack_data.m_add_state(new stack_state(this, fncs_pos, start_pos,
+                                                    end_pos, covered, &targets[begin_idx + idx], PASS_LM_BATCH_QUERY(idx)));
+                                        }
                                     }
                                 } else {
                                     //Do nothing we have an unknown phrase of length > 1
@@ -28,6 +28,7 @@
 
 #include <string>
 #include <bitset>
+#include <algorithm>
 
 #include "common/utils/exceptions.hpp"
 #include "common/utils/logging/logger.hpp"
@@ -48,6 +49,7 @@ using namespace uva::utils::logging;
 
 using namespace uva::smt::bpbd::server::tm::models;
 using namespace uva::smt::bpbd::server::rm::models;
+using namespace uva::smt::bpbd::server::lm::proxy;
 
 namespace uva {
     namespace smt {
@@ -104,6 +106,8 @@ namespace uva {
                             //Add the sentence begin tag uid to the target, since this is for the begin state
                             m_trans_frame(1, &m_stack_data.m_lm_query.get_begin_tag_uid()),
                             m_begin_lm_level(M_GRAM_LEVEL_1),
+                            //The language model context is just the sentence begin tag
+                            m_lm_state({M_GRAM_LEVEL_1, m_stack_data.m_lm_query.get_begin_tag_uid()}),
                             m_covered(), m_partial_score(0.0), m_total_score(0.0) INIT_STATE_DATA_TUNING_DATA{
                                 LOG_DEBUG1 << "New BEGIN state data: " << this << ", translating [" << m_s_begin_word_idx
                                 << ", " << m_s_end_word_idx << "], stack_level=" << m_stack_level
@@ -131,7 +135,7 @@ namespace uva {
                             rm_entry_data(m_stack_data.m_rm_query.get_end_tag_reordering()),
                             //Add the sentence end tag uid to the target, since this is for the end state
                             m_trans_frame(prev_state_data.m_trans_frame, 1, &m_stack_data.m_lm_query.get_end_tag_uid()),
-                            m_begin_lm_level(prev_state_data.m_begin_lm_level),
+                            m_begin_lm_level(prev_state_data.m_begin_lm_level), m_lm_state(prev_state_data.m_lm_state),
                             //The coverage vector stays the same, nothing new is added, we take over the partial score
                             m_covered(prev_state_data.m_covered), m_partial_score(prev_state_data.m_partial_score),
                             m_total_score(0.0) INIT_STATE_DATA_TUNING_DATA{
@@ -162,16 +166,20 @@ namespace uva {
                              * @param begin_pos this state translated source phrase begin position
                              * @param end_pos this state translated source phrase end position
                              * @param target the pointer to the target translation of the source phrase
+                             * @param lm_query the language model query executed in a batch, as
+                             *                 set up by set_lm_query, or NULL if the query is
+                             *                 to be executed by this constructor
                              */
                             state_data_templ(const state_data_templ & prev_state_data,
                                     const int32_t & begin_pos, const int32_t & end_pos,
-                                    const covered_info & covered, tm_const_target_entry* target)
+                                    const covered_info & covered, tm_const_target_entry* target,
+                                    const lm_batch_query * lm_query)
                             : m_stack_data(prev_state_data.m_stack_data),
                             m_s_begin_word_idx(begin_pos), m_s_end_word_idx(end_pos),
                             m_stack_level(prev_state_data.m_stack_level + (m_s_end_word_idx - m_s_begin_word_idx + 1)),
                             m_target(target), rm_entry_data(m_stack_data.m_rm_query.get_reordering(m_target->get_st_uid())),
                             m_trans_frame(prev_state_data.m_trans_frame, m_target->get_num_words(), m_target->get_word_ids()),
-                            m_begin_lm_level(prev_state_data.m_begin_lm_level),
+                            m_begin_lm_level(prev_state_data.m_begin_lm_level), m_lm_state(prev_state_data.m_lm_state),
                             m_covered(covered), m_partial_score(prev_state_data.m_partial_score),
                             m_total_score(0.0) INIT_STATE_DATA_TUNING_DATA{
                                 LOG_DEBUG1 << "New state data: " << this << ", translating [" << m_s_begin_word_idx
@@ -186,7 +194,7 @@ namespace uva {
                                 LOG_DEBUG1 << "------------------------------------------------------------------" << END_LOG;
 
                                 //Update the partial score;
-                                compute_partial_score(prev_state_data);
+                                compute_partial_score(prev_state_data, lm_query);
 
                                 //Compute the total score;
                                 compute_total_score();
@@ -214,6 +222,54 @@ namespace uva {
                                 return result + "]";
                             }
 
+                            /**
+                             * Allows to check whether the language model states of the two state
+                             * data are equal, i.e. that the language model probabilities of any
+                             * further target words will be the same for both of them.
+                             * @param other the other state data to compare with
+                             * @return true if the language model states are equal
+                             */
+                            inline bool is_equal_lm_state(const state_data_templ & other) const {
+                                //The hash comparison is cheap, the context words are compared to avoid collisions
+                                return (m_lm_state == other.m_lm_state) &&
+                                        m_trans_frame.is_equal_last(other.m_trans_frame, m_lm_state.m_ctx_len);
+                            }
+
+                            /**
+                             * Allows to set up the language model query of the new state data
+                             * that extends this one with the given target. The query is the same
+                             * as the one the get_lm_cost method of the new state data would execute.
+                             * @param target the pointer to the target translation of the source phrase
+                             * @param word_ids [out] the storage for the query word ids, must be able to
+                             *                 hold at least MAX_M_GRAM_QUERY_LENGTH elements
+                             * @param lm_query [out] the query to be set up
+                             */
+                            inline void set_lm_query(tm_const_target_entry* target, word_uid * word_ids,
+                                    lm_batch_query & lm_query) const {
+                                //The new words are the words of the target
+                                const size_t num_new_words = target->get_num_words();
+
+                                //Do the sanity check
+                                ASSERT_SANITY_THROW(((MAX_HISTORY_LENGTH + num_new_words) > MAX_M_GRAM_QUERY_LENGTH),
+                                        string("MAX_HISTORY_LENGTH (") + to_string(MAX_HISTORY_LENGTH) +
+                                        string(") + num_new_words (") + to_string(num_new_words) +
+                                        string(") > MAX_M_GRAM_QUERY_LENGTH (") + to_string(MAX_M_GRAM_QUERY_LENGTH) + string(")"));
+
+                                //The history words are the language model context words, the last words of the translation frame
+                                const size_t all_hist_words = m_trans_frame.get_size();
+                                const size_t act_hist_words = m_lm_state.m_ctx_len;
+                                const word_uid * hist_word_ids = m_trans_frame.get_elems() + (all_hist_words - act_hist_words);
+
+                                //Copy the history and the new words into the query
+                                copy(hist_word_ids, hist_word_ids + act_hist_words, word_ids);
+                                copy(target->get_word_ids(), target->get_word_ids() + num_new_words, word_ids + act_hist_words);
+
+                                lm_query.m_num_words = act_hist_words + num_new_words;
+                                lm_query.m_word_ids = word_ids;
+                                lm_query.m_min_level = m_begin_lm_level;
+                                lm_query.m_prob = 0.0;
+                            }
+
                             /**
                              * Extract the target, including the case when we are in the
                              * begin <s> or end state </s> or a phrase with no translation.
@@ -259,9 +315,9 @@ namespace uva {
                                     } else {
                                         //If this is a known translation then add the translation text
                                         if (is_lattice) {
-                                            storage = m_target->get_target_phrase();
+                                            storage.assign(m_target->get_target_phrase(), m_target->get_target_phrase_len());
                                         } else {
-                                            storage += m_target->get_target_phrase();
+                                            storage.append(m_target->get_target_phrase(), m_target->get_target_phrase_len());
                                         }
                                     }
 
@@ -309,6 +365,9 @@ namespace uva {
                             //Stores the minimum m-gram level to consider when computing the LM probability of the history
                             phrase_length m_begin_lm_level;
 
+                            //Stores the language model state, i.e. the minimized target history context
+                            lm_state m_lm_state;
+
                             //Stores the bitset of covered words indexes
                             const covered_info m_covered;
 
@@ -345,8 +404,14 @@ namespace uva {
                                 //It is only for these new words that we need to compute the lm probabilities
                                 //for. So compute the current number of elements in the words' history.
                                 const size_t all_hist_words = m_trans_frame.get_size() - num_new_words;
-                                //The number of interesting words from the history is bounded by MAX_HISTORY_LENGTH
-                                const size_t act_hist_words = min(all_hist_words, MAX_HISTORY_LENGTH);
+                                //The interesting words from the history are the context words of the previous language
+                                //model state, the probabilities of the new words do not depend on the other words
+                                const size_t act_hist_words = m_lm_state.m_ctx_len;
+
+                                //Do the sanity check
+                                ASSERT_SANITY_THROW((act_hist_words > all_hist_words),
+                                        string("The LM state context length (") + to_string(act_hist_words) +
+                                        string(") exceeds the number of history words (") + to_string(all_hist_words) + string(")"));
 
                                 //Compute the query length to consider
                                 const size_t num_query_words = act_hist_words + num_new_words;
@@ -363,11 +428,32 @@ namespace uva {
                                 //Execute the query and return the value
                                 prob_weight cost = m_stack_data.m_lm_query.execute(
                                         num_query_words, query_word_ids,
-                                        m_begin_lm_level, PASS_TUNING_FEATURES_MAP);
+                                        m_begin_lm_level, m_lm_state, PASS_TUNING_FEATURES_MAP);
+
+                                //The next query begins right after the new language model context
+                                m_begin_lm_level = m_lm_state.m_ctx_len + 1;
+
                                 LOG_DEBUG1 << "LM costs: " << cost << END_LOG;
                                 return cost;
                             }
 
+                            /**
+                             * Allows to retrieve the language model probability for the given query, if the
+                             * query has been executed in a batch then its results are just taken over
+                             * @param lm_query the language model query executed in a batch or NULL
+                             */
+                            inline prob_weight get_lm_cost(const lm_batch_query * lm_query) {
+                                if (lm_query != NULL) {
+                                    //Take over the language model state, the next query begins after the context
+                                    m_lm_state = lm_query->m_state;
+                                    m_begin_lm_level = m_lm_state.m_ctx_len + 1;
+                                    LOG_DEBUG1 << "LM costs (batched): " << lm_query->m_prob << END_LOG;
+                                    return lm_query->m_prob;
+                                } else {
+                                    return get_lm_cost();
+                                }
+                            }
+
                             /**
                              * Allows to compute the linear distortion penalty.
                              * @param prev_state_data the previous state
@@ -460,8 +546,10 @@ namespace uva {
                              * Allows to update the currently stored partial score from the
                              * parent state with the partial score of the current hypothesis
                              * @param prev_state_data the previous strate data
+                             * @param lm_query the language model query executed in a batch or NULL
                              */
-                            inline void compute_partial_score(const state_data_templ & prev_state_data) {
+                            inline void compute_partial_score(const state_data_templ & prev_state_data,
+                                    const lm_batch_query * lm_query) {
                                 //After the construction the partial score is to stay fixed,
                                 //thus it is declared as constant and here we do a const_cast
                                 prob_weight & partial_score = const_cast<prob_weight &> (m_partial_score);
@@ -474,7 +562,7 @@ namespace uva {
                                 LOG_DEBUG2 << "partial score + TM is: " << partial_score << END_LOG;
 
                                 //Add the language model probability
-                                partial_score += get_lm_cost();
+                                partial_score += get_lm_cost(lm_query);
 
                                 LOG_DEBUG2 << "partial score + LM is: " << partial_score << END_LOG;
 
@@ -27,9 +27,11 @@
 #define LM_BASIC_BUILDER_HPP
 
 #include <regex>        // std::regex, std::regex_match
+#include <exception>    // std::exception_ptr
 
 #include "server/lm/lm_consts.hpp"
 #include "server/lm/lm_parameters.hpp"
+#include "server/lm/builders/lm_vocab_filter.hpp"
 #include "common/utils/file/text_piece_reader.hpp"
 
 using namespace std;
@@ -49,6 +51,8 @@ namespace uva {
                         static const string END_OF_ARPA_FILE = "\\end\\";
                         //The N-gram Data Section Amoung delimiter
                         static const string NGRAM_COUNTS_DELIM = "=";
+                        //The ARPA log_10 probability value standing for the zero probability
+                        static constexpr prob_weight ARPA_ZERO_LOG_10_PROB = -99.0;
 
                         /**
                          * This is the Trie builder class that reads an input file stream
@@ -88,6 +92,10 @@ namespace uva {
                             const regex m_ng_amount_reg_exp;
                             //The regular expression for matching the n-grams section
                             const regex m_ng_section_reg_exp;
+                            //Stores the flag indicating whether the M-grams are read with multiple threads
+                            bool m_is_parallel;
+                            //Stores the vocabulary filter for the M-grams, NULL if all the M-grams are loaded
+                            lm_vocab_filter * m_vocab_filter;
 
                             /**
                              * The copy constructor
@@ -131,6 +139,39 @@ namespace uva {
                             template<phrase_length CURR_LEVEL, bool is_mult_weight>
                             void read_m_gram_level();
 
+                            /**
+                             * Allows to read the given Trie level M-grams from the file using several
+                             * threads. The M-gram section is split into line-aligned chunks and each
+                             * chunk is parsed and added to the trie by a separate thread. Is only to
+                             * be used when the entire file is in memory and the trie supports the
+                             * concurrent m-gram adding.
+                             * @param level the currently read M-gram level M
+                             * @param is_mult_weight true if we need to multiply the lm
+                             * probabilities and back-off weights with the language model
+                             * weight from the model properties
+                             */
+                            template<phrase_length CURR_LEVEL, bool is_mult_weight>
+                            void read_m_gram_level_parallel();
+
+                            /**
+                             * Allows to parse the M-grams of the given text chunk and to add them to the
+                             * trie. Is to be run in a separate thread, the chunk must only contain M-grams.
+                             * @param level the currently read M-gram level M
+                             * @param is_mult_weight true if we need to multiply the lm
+                             * probabilities and back-off weights with the language model
+                             * weight from the model properties
+                             * @param chunk the text chunk to parse
+                             * @param error [out] the exception thrown while parsing, if any
+                             */
+                            template<phrase_length CURR_LEVEL, bool is_mult_weight>
+                            void parse_m_gram_chunk(text_piece_reader chunk, exception_ptr & error);
+
+                            /**
+                             * Allows to check if the M-gram sections can be read in parallel
+                             * @return true if the M-gram sections can be read in parallel
+                             */
+                            bool is_parallel_reading() const;
+
                             template<phrase_length CURR_LEVEL, typename DUMMY = void>
                             struct Func {
 
@@ -222,6 +263,23 @@ namespace uva {
                              */
                             void return_to_grams();
 
+                            /**
+                             * If the M-grams are filtered by the vocabulary then this method makes
+                             * an extra pass over the M-gram sections of the ARPA file to count the
+                             * M-grams to be kept, so that the trie is pre-allocated for them only.
+                             * Afterwards it returns to the 1-gram section.
+                             * @param counts [in/out] the M-gram counts to be updated
+                             */
+                            void count_filtered_m_grams(size_t counts[LM_M_GRAM_LEVEL_MAX]);
+
+                            /**
+                             * If the trie payloads are quantized then this method makes an extra
+                             * pass over the M-gram sections of the ARPA file to collect the
+                             * probability and back-off weights and to train the per level
+                             * payload codebooks. Afterwards it returns to the 1-gram section.
+                             */
+                            void train_payload_quantizer();
+
                             /**
                              * This recursive method is used to read and process the ARPA N-Grams.
                              * @param line the in/out parameter storing the last read line
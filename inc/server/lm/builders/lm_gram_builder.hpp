@@ -118,6 +118,39 @@ namespace uva {
                                 }
                             }
 
+                            /**
+                             * Takes the m-gram line and parses it into the payload, the m-gram words are skipped.
+                             * The weights are left in the log_10 scale, the missing back-off weight is set to 0.0
+                             * @param text the piece to read the m-gram line from
+                             * @param payload [out] the payload to set the log_10 probability and back-off weights into
+                             * @return true if the m-gram line was successfully parsed
+                             */
+                            static inline bool line_to_log_10_payload(text_piece_reader &text, m_gram_payload & payload) {
+                                text_piece_reader token;
+                                //Read the probability, then skip the m-gram words, both are followed by a tab
+                                if (text.get_first_tab(token) && fast_s_to_f(payload.m_prob, token.get_rest_c_str())
+                                        && text.get_first_tab(token)) {
+                                    //Parse the back-off weight if present
+                                    if (text.has_more()) {
+                                        return fast_s_to_f(payload.m_back, text.get_rest_c_str());
+                                    } else {
+                                        payload.m_back = 0.0;
+                                        return true;
+                                    }
+                                } else {
+                                    return false;
+                                }
+                            }
+
+                            /**
+                             * Allows to convert the log_10 probability into the log_e probability value 
+                             * @param weight [in/out] the value to work with
+                             */
+                            static inline void log_10_to_log_e_scale(prob_weight & weight) {
+                                //Convert the log_10 probability into the log_e probability
+                                weight = std::log(std::pow(ARPA_PROB_WEIGHT_LOG_10_BASE, weight));
+                            }
+
                             virtual ~lm_gram_builder();
 
 
@@ -152,17 +185,6 @@ namespace uva {
                              * @param orig the other builder to copy
                              */
                             lm_gram_builder(const lm_gram_builder & orig);
-
-                        private:
-
-                            /**
-                             * Allows to convert the log_10 probability into the log_e probability value 
-                             * @param weight [in/out] the value to work with
-                             */
-                            static inline void log_10_to_log_e_scale(prob_weight & weight) {
-                                //Convert the log_10 probability into the log_e probability
-                                weight = std::log(std::pow(ARPA_PROB_WEIGHT_LOG_10_BASE, weight));
-                            }
                         };
                     }
                 }
@@ -109,6 +109,34 @@ namespace uva {
                                 LOG_DEBUG << "The " << CURR_LEVEL << "-Gram builder (" << hex << long(*ppBuilder) << ") is produced!" << END_LOG;
                             }
 
+                            /**
+                             * Is similar to get_builder but the produced builder adds the m-grams
+                             * into the trie by means of the add_m_gram_concurrent method. Several
+                             * builders produced by this method can be used from different threads
+                             * at the same time, one builder per thread, if the trie supports that.
+                             * 
+                             * Note: the returned pointer to the dynamically allocated
+                             * builder is to be freed by the caller!
+                             * 
+                             * @param CURR_LEVEL the level of the N-gram we currently need the builder for.
+                             * @param params the model parameters
+                             * @param trie the trie to be filled in with the N-grams
+                             * @param pBuilder the pointer to a dynamically allocated N-Gram builder
+                             */
+                            template<phrase_length CURR_LEVEL, bool is_mult_weight>
+                            static inline void get_concurrent_builder(const lm_parameters & params, TrieType & trie, lm_gram_builder<WordIndexType, CURR_LEVEL, is_mult_weight> **ppBuilder) {
+                                ASSERT_SANITY_THROW(!trie.is_concurrent_add_supported(),
+                                        "The trie does not support concurrent m-gram adding!");
+
+                                LOG_DEBUG1 << "Instantiating the concurrent " << CURR_LEVEL << "-Gram builder.." << END_LOG;
+                                //Create a builder with the proper lambda as an argument
+                                *ppBuilder = new lm_gram_builder<WordIndexType, CURR_LEVEL, is_mult_weight>(params, trie.get_word_index(),
+                                        [&] (const model_m_gram & gram) {
+                                            trie.template add_m_gram_concurrent<CURR_LEVEL>(gram);
+                                        });
+                                LOG_DEBUG << "The concurrent " << CURR_LEVEL << "-Gram builder (" << hex << long(*ppBuilder) << ") is produced!" << END_LOG;
+                            }
+
                             virtual ~lm_gram_builder_factory() {
                             }
                         private:
@@ -0,0 +1,264 @@
+/*
+ * File:   lm_snapshot_builder.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 11:30 AM
+ */
+
+#ifndef LM_SNAPSHOT_BUILDER_HPP
+#define LM_SNAPSHOT_BUILDER_HPP
+
+#include <string>       // std::string
+#include <cstdio>       // std::fopen
+#include <cstring>      // std::memcmp
+#include <typeinfo>     // typeid
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/hashing_utils.hpp"
+#include "common/utils/file/binary_file_writer.hpp"
+#include "common/utils/file/binary_mmap_reader.hpp"
+
+#include "server/lm/lm_consts.hpp"
+#include "server/lm/lm_parameters.hpp"
+
+using namespace std;
+
+using namespace uva::utils::file;
+using namespace uva::utils::hashing;
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+
+using namespace uva::smt::bpbd::server::lm;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace lm {
+                    namespace binary {
+
+                        namespace __lm_snapshot {
+                            //Stores the length of the magic value
+                            static constexpr size_t MAGIC_LENGTH = 8;
+                            //Stores the magic value identifying the binary snapshot file
+                            static constexpr char MAGIC[MAGIC_LENGTH] = {'B', 'P', 'B', 'D', 'L', 'M', 'S', '\0'};
+                            //Stores the snapshot file format version, is to be incremented on any layout change
+                            static constexpr uint32_t VERSION = 2;
+
+                            /**
+                             * This structure stores the snapshot file header, it is
+                             * needed to check that the snapshot is compatible with
+                             * the current build and the language model parameters.
+                             */
+                            typedef struct {
+                                //Stores the magic value
+                                char m_magic[MAGIC_LENGTH];
+                                //Stores the format version
+                                uint32_t m_version;
+                                //Stores the maximum m-gram level
+                                uint32_t m_max_level;
+                                //Stores the word uid size in bytes
+                                uint32_t m_word_uid_size;
+                                //Stores the probability weight size in bytes
+                                uint32_t m_prob_weight_size;
+                                //Stores the hash of the model type name
+                                uint64_t m_model_type_uid;
+                                //Stores the lm weight the probabilities were multiplied with
+                                float m_lm_weight;
+                                //Stores the unknown word log_e probability
+                                float m_unk_word_log_e_prob;
+                            } s_header;
+
+                            /**
+                             * Allows to get the model type unique identifier, it also accounts for
+                             * the hashing policies as the word ids and the table layouts depend on them
+                             * @param trie_type the model type
+                             * @return the model type unique identifier
+                             */
+                            template<typename trie_type>
+                            static inline uint64_t get_model_type_uid() {
+                                const string name = string(typeid (trie_type).name()) + string("/") +
+                                        str_hash_policy::get_name() + string("/") + int_hash_policy::get_name();
+                                return compute_hash(name);
+                            }
+
+                            /**
+                             * Allows to create the header for the given model parameters
+                             * @param trie_type the model type
+                             * @param params the model parameters
+                             * @param header [out] the header to fill in
+                             */
+                            template<typename trie_type>
+                            static inline void set_header(const lm_parameters & params, s_header & header) {
+                                memcpy(header.m_magic, MAGIC, MAGIC_LENGTH);
+                                header.m_version = VERSION;
+                                header.m_max_level = LM_M_GRAM_LEVEL_MAX;
+                                header.m_word_uid_size = sizeof (word_uid);
+                                header.m_prob_weight_size = sizeof (prob_weight);
+                                header.m_model_type_uid = get_model_type_uid<trie_type>();
+                                header.m_lm_weight = params.m_is_0_lm_weight ? params.get_0_lm_weight() : 1.0;
+                                header.m_unk_word_log_e_prob = params.m_unk_word_log_e_prob;
+                            }
+                        }
+
+                        /**
+                         * This is a binary snapshot builder of the language model. Instead
+                         * of parsing a text model it attaches the model to the memory mapped
+                         * binary snapshot file, as previously created by lm_snapshot_writer.
+                         * No data is copied, so loading is done in virtually no time and the
+                         * page cache is shared between all the processes using the snapshot.
+                         */
+                        template<typename trie_type>
+                        class lm_snapshot_builder {
+                        public:
+
+                            /**
+                             * The basic constructor
+                             * @params params the model parameters
+                             * @param trie the trie to attach to the snapshot data
+                             * @param file the memory mapped snapshot file
+                             */
+                            lm_snapshot_builder(const lm_parameters & params, trie_type & trie, binary_mmap_reader & file)
+                            : m_params(params), m_trie(trie), m_file(file) {
+                            }
+
+                            /**
+                             * Allows to check whether the given file is a binary snapshot file
+                             * @param file_name the name of the file to check
+                             * @return true if the file starts with the snapshot magic value
+                             */
+                            static inline bool is_snapshot_file(const string & file_name) {
+                                char magic[__lm_snapshot::MAGIC_LENGTH] = {};
+                                bool result = false;
+                                FILE * file_ptr = fopen(file_name.c_str(), "rb");
+                                if (file_ptr != NULL) {
+                                    result = (fread(magic, 1, __lm_snapshot::MAGIC_LENGTH, file_ptr) == __lm_snapshot::MAGIC_LENGTH)
+                                            && (memcmp(magic, __lm_snapshot::MAGIC, __lm_snapshot::MAGIC_LENGTH) == 0);
+                                    fclose(file_ptr);
+                                }
+                                return result;
+                            }
+
+                            /**
+                             * Allows to attach the trie to the snapshot data
+                             */
+                            void build() {
+                                //Check that the snapshot is compatible
+                                check_header();
+
+                                //Attach the trie to the snapshot data
+                                m_trie.attach_snapshot(m_file);
+
+                                ASSERT_CONDITION_THROW(!m_file.is_eof(), "The binary snapshot file contains unexpected trailing data!");
+
+                                //The data is to be accessed randomly, so there is no point in read-ahead
+                                m_file.advise(MADV_RANDOM);
+
+                                LOG_USAGE << "The binary language model snapshot is attached." << END_LOG;
+                            }
+
+                        private:
+                            //Stores the reference to the model parameters
+                            const lm_parameters & m_params;
+                            //Stores the reference to the trie
+                            trie_type & m_trie;
+                            //Stores the reference to the snapshot file
+                            binary_mmap_reader & m_file;
+
+                            /**
+                             * Allows to read and check the snapshot header
+                             */
+                            inline void check_header() {
+                                __lm_snapshot::s_header actual = {}, expected = {};
+                                m_file.read(actual);
+                                __lm_snapshot::set_header<trie_type>(m_params, expected);
+
+                                ASSERT_CONDITION_THROW((memcmp(actual.m_magic, expected.m_magic, __lm_snapshot::MAGIC_LENGTH) != 0),
+                                        "The file is not a binary language model snapshot!");
+                                ASSERT_CONDITION_THROW((actual.m_version != expected.m_version),
+                                        string("The snapshot version: ") + to_string(actual.m_version) +
+                                        string(" is not supported, expected: ") + to_string(expected.m_version));
+                                ASSERT_CONDITION_THROW((actual.m_max_level != expected.m_max_level) ||
+                                        (actual.m_word_uid_size != expected.m_word_uid_size) ||
+                                        (actual.m_prob_weight_size != expected.m_prob_weight_size) ||
+                                        (actual.m_model_type_uid != expected.m_model_type_uid),
+                                        "The snapshot was created for a different build configuration or model type, re-compile it!");
+                                ASSERT_CONDITION_THROW((actual.m_lm_weight != expected.m_lm_weight) ||
+                                        (actual.m_unk_word_log_e_prob != expected.m_unk_word_log_e_prob),
+                                        string("The snapshot was created with lm weight: ") + to_string(actual.m_lm_weight) +
+                                        string(" and unk word log_e prob: ") + to_string(actual.m_unk_word_log_e_prob) +
+                                        string(" which differ from the configured ones, re-compile it!"));
+                            }
+                        };
+
+                        /**
+                         * This is a binary snapshot writer of the language model. It allows
+                         * to dump a fully loaded model into a binary snapshot file that can
+                         * later be used by the lm_snapshot_builder.
+                         */
+                        template<typename trie_type>
+                        class lm_snapshot_writer {
+                        public:
+
+                            /**
+                             * The basic constructor
+                             * @params params the model parameters the trie was built with
+                             * @param trie the trie to write
+                             * @param file the snapshot file writer
+                             */
+                            lm_snapshot_writer(const lm_parameters & params, const trie_type & trie, binary_file_writer & file)
+                            : m_params(params), m_trie(trie), m_file(file) {
+                            }
+
+                            /**
+                             * Allows to write the snapshot
+                             */
+                            void write() {
+                                //Write the header first
+                                __lm_snapshot::s_header header = {};
+                                __lm_snapshot::set_header<trie_type>(m_params, header);
+                                m_file.write(header);
+
+                                //Write the trie data
+                                m_trie.write_snapshot(m_file);
+
+                                LOG_USAGE << "The binary language model snapshot is written, "
+                                        << m_file.get_num_bytes() << " bytes." << END_LOG;
+                            }
+
+                        private:
+                            //Stores the reference to the model parameters
+                            const lm_parameters & m_params;
+                            //Stores the reference to the trie
+                            const trie_type & m_trie;
+                            //Stores the reference to the snapshot file
+                            binary_file_writer & m_file;
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* LM_SNAPSHOT_BUILDER_HPP */
+
@@ -0,0 +1,153 @@
+/*
+ * File:   lm_vocab_filter.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 11:05 PM
+ */
+
+#ifndef LM_VOCAB_FILTER_HPP
+#define LM_VOCAB_FILTER_HPP
+
+#include <string>
+#include <unordered_set>
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/hashing_utils.hpp"
+#include "common/utils/file/text_piece_reader.hpp"
+#include "common/utils/file/cstyle_file_reader.hpp"
+
+#include "server/server_consts.hpp"
+#include "server/tm/builders/tm_builder.hpp"
+
+using namespace std;
+
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+using namespace uva::utils::hashing;
+using namespace uva::utils::file;
+
+using namespace uva::smt::bpbd::server::tm::builders;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace lm {
+                    namespace arpa {
+
+                        /**
+                         * This class stores the target vocabulary of the phrase table and allows
+                         * to filter out the ARPA m-grams containing the words not from it. The
+                         * decoder can only produce the target words of the phrase table, plus
+                         * the sentence tags and the unknown word, so the other m-grams are never
+                         * queried. The words are stored as their 64 bit hashes, a hash collision
+                         * can only make an m-gram to be kept, never to be filtered out.
+                         */
+                        class lm_vocab_filter {
+                        public:
+
+                            /**
+                             * The basic constructor, reads the target vocabulary of the phrase table
+                             * @param tm_file_name the phrase table file name
+                             */
+                            lm_vocab_filter(const string & tm_file_name) : m_words() {
+                                //Add the words that the decoder can produce on its own
+                                add_word(BEGIN_SENTENCE_TAG_STR);
+                                add_word(END_SENTENCE_TAG_STR);
+                                add_word(LM_UNKNOWN_WORD_STR);
+
+                                //Read the phrase table target phrases
+                                cstyle_file_reader tm_file(tm_file_name.c_str());
+                                ASSERT_CONDITION_THROW(!tm_file.is_open(), string("The phrase table file: '")
+                                        + tm_file_name + string("' does not exist!"));
+
+                                logger::start_progress_bar(string("Collecting the target vocabulary"));
+                                text_piece_reader line, source, target, word;
+                                while (tm_file.get_first_line(line)) {
+                                    //Skip the source phrase and read the target phrase
+                                    if (line.get_first<TM_DELIMITER, TM_DELIMITER_CDTY>(source) &&
+                                            line.get_first<TM_DELIMITER, TM_DELIMITER_CDTY>(target)) {
+                                        while (target.get_first_space(word)) {
+                                            //The target phrase is surrounded by spaces
+                                            if (word.length() != 0) {
+                                                m_words.insert(get_word_hash(word));
+                                            }
+                                        }
+                                    }
+                                    logger::update_progress_bar();
+                                }
+                                logger::stop_progress_bar();
+                                tm_file.close();
+
+                                LOG_USAGE << "The LM m-grams are filtered by the " << m_words.size()
+                                        << " target words of: " << tm_file_name << END_LOG;
+                            }
+
+                            /**
+                             * Allows to check if the ARPA m-gram line is to be kept. The lines
+                             * not being m-grams, such as the section headers, are always kept.
+                             * @param line the ARPA m-gram line: "prob\tword ... word[\tback-off]"
+                             * @return true if all the m-gram words are in the vocabulary
+                             */
+                            inline bool is_kept(text_piece_reader line) const {
+                                text_piece_reader token, words;
+                                if ((line[0] != '\\') && line.get_first_tab(token) && line.get_first_tab(words)) {
+                                    while (words.get_first_space(token)) {
+                                        if ((token.length() != 0) && (m_words.count(get_word_hash(token)) == 0)) {
+                                            LOG_DEBUG2 << "Filtering out the m-gram: " << words << END_LOG;
+                                            return false;
+                                        }
+                                    }
+                                }
+                                return true;
+                            }
+
+                        private:
+                            //Stores the hashes of the vocabulary words
+                            unordered_set<uint64_t> m_words;
+
+                            /**
+                             * Allows to compute the hash of the word
+                             * @param word the word
+                             * @return the word's hash
+                             */
+                            static inline uint64_t get_word_hash(const text_piece_reader & word) {
+                                return compute_hash(word.get_begin_c_str(), word.length());
+                            }
+
+                            /**
+                             * Allows to add the word to the vocabulary
+                             * @param word the word to add
+                             */
+                            inline void add_word(const string & word) {
+                                m_words.insert(compute_hash(word.c_str(), word.length()));
+                            }
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* LM_VOCAB_FILTER_HPP */
+
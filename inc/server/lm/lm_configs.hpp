@@ -76,6 +76,25 @@ namespace uva {
                     
                     //Define the builder type 
                     typedef lm_basic_builder<lm_model_type, lm_model_reader> lm_builder_type;
+
+                    //Here we have a model file reader type for the multi-threaded loading,
+                    //the m-gram sections are parsed in place so the file must be in memory
+                    typedef memory_mapped_file_reader lm_parallel_model_reader;
+
+                    //Define the multi-threaded loading builder type
+                    typedef lm_basic_builder<lm_model_type, lm_parallel_model_reader> lm_parallel_builder_type;
+
+                    //Here we have the trie type with the other payload quantization setting, it is
+                    //used to report on the perplexity difference caused by the payload quantization
+                    typedef h2d_map_trie<lm_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS> lm_cmp_model_type;
+
+                    //Define the comparison trie builder type
+                    typedef lm_basic_builder<lm_cmp_model_type, lm_model_reader> lm_cmp_builder_type;
+
+                    //Here we have the trie type with the other m-gram id fingerprint setting, it is used
+                    //to report on the perplexity difference caused by the lossy m-gram storage mode
+                    typedef h2d_map_trie<lm_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS,
+                    __H2DMapTrie::OTHER_IS_MPH_STORAGE> lm_fp_model_type;
                 }
             }
         }
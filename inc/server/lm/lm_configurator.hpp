@@ -26,18 +26,23 @@
 #ifndef LM_CONFIGURATOR_HPP
 #define LM_CONFIGURATOR_HPP
 
+#include <memory>       // std::shared_ptr, std::atomic_load
+
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/exceptions.hpp"
+#include "common/utils/file/shared_memory_segment.hpp"
 
 #include "server/lm/lm_parameters.hpp"
 
 #include "server/lm/proxy/lm_proxy.hpp"
 #include "server/lm/proxy/lm_proxy_local.hpp"
+#include "server/lm/proxy/lm_proxy_remote.hpp"
 #include "server/lm/proxy/lm_slow_query_proxy.hpp"
 #include "server/lm/proxy/lm_fast_query_proxy.hpp"
 
 using namespace uva::utils::exceptions;
 using namespace uva::utils::logging;
+using namespace uva::utils::file;
 using namespace uva::smt::bpbd::server::lm::proxy;
 
 namespace uva {
@@ -59,6 +64,12 @@ namespace uva {
                          * This method allows to set the configuration parameters
                          * for the word index trie etc. This method is to be called
                          * only once! The latter is not checked but is a must.
+                         * If the connection string is an lm-server address, "tcp://host:port"
+                         * or "unix://path", then the model is queried remotely.
+                         * If the shared memory segment name is given then the model is
+                         * attached, read-only, to the binary snapshot in that segment. The
+                         * first process to connect builds the model and writes the snapshot
+                         * into the segment, the other ones wait for it and then attach.
                          * @param params the language model parameters to be set,
                          * this class only stores the referent to the parameters.
                          */
@@ -66,36 +77,94 @@ namespace uva {
                             //Store the parameters for future use
                             m_params = &params;
 
-                            //At the moment we only support a local proxy
-                            m_model_proxy = new lm_proxy_local();
+                            //Create the model and make it the current one
+                            set_model_proxy(create_model_proxy());
+                        }
+
+                        /**
+                         * Allows to create and connect a new instance of the language model,
+                         * using the connected parameters, e.g. to reload the model files.
+                         * The new instance does not become current until set_model_proxy.
+                         * @return the new connected model proxy
+                         */
+                        static lm_proxy_ptr create_model_proxy() {
+                            lm_proxy_ptr proxy;
+                            const lm_parameters * params = m_params;
+
+                            if (__lm_remote::is_remote(params->m_conn_string)) {
+                                //The model is served by the lm-server
+                                proxy.reset(new lm_proxy_remote());
+                            } else {
+                                //Build or attach the shared memory segment, if requested
+                                if (!params->m_shm_name.empty()) {
+                                    params = &connect_shm_segment();
+                                }
+
+                                //The model is loaded locally
+                                proxy.reset(new lm_proxy_local());
+                            }
 
                             //Connect to the trie instance using the given parameters
-                            m_model_proxy->connect(*m_params);
+                            proxy->connect(*params);
+
+                            return proxy;
+                        }
+
+                        /**
+                         * Allows to get the current model proxy, the proxy stays valid
+                         * as long as the returned pointer is kept, even if the model
+                         * is replaced in the mean time.
+                         * @return the current model proxy
+                         */
+                        static inline lm_proxy_ptr get_model_proxy() {
+                            return atomic_load(&m_model_proxy);
+                        }
+
+                        /**
+                         * Allows to atomically replace the current model proxy, the previous
+                         * one is freed once it is no longer used.
+                         * @param proxy the new model proxy, may be empty
+                         */
+                        static inline void set_model_proxy(const lm_proxy_ptr & proxy) {
+                            atomic_store(&m_model_proxy, proxy);
                         }
 
                         /**
                          * Allows to disconnect from the language model.
                          */
                         static void disconnect() {
-                            if (m_model_proxy != NULL) {
-                                //Disconnect from the trie
-                                m_model_proxy->disconnect();
-                                //Delete the object, free the resources
-                                delete m_model_proxy;
-                                m_model_proxy = NULL;
-                            }
+                            //The model is freed once it is no longer used
+                            set_model_proxy(lm_proxy_ptr());
                         }
 
                         /**
-                         * Allows to return an instance of the query executor,
-                         * is to be returned by calling the dispose method.
+                         * Allows to write the connected language model into a binary
+                         * snapshot file. The snapshot file can then be used as the
+                         * connection string for a much faster model loading.
+                         * @param file_name the name of the snapshot file
+                         */
+                        static void write_snapshot(const string & file_name) {
+                            get_model_proxy()->write_snapshot(file_name);
+                        }
+
+                        /**
+                         * Allows to report the run time information of the language model
+                         */
+                        static void report_run_time_info() {
+                            get_model_proxy()->report_run_time_info();
+                        }
+
+                        /**
+                         * Allows to return an instance of the query executor of the current
+                         * model, is to be returned by calling the dispose method. If the model
+                         * can be replaced in the mean time then get_model_proxy is to be used.
                          * @return an instance of the query executor.
                          */
                         static inline lm_slow_query_proxy & allocate_slow_query_proxy() {
                             LOG_DEBUG2 << "Allocating a new slow LM query proxy" << END_LOG;
 
                             //Return the query executor as given by the proxy class
-                            return m_model_proxy->allocate_slow_query_proxy();
+                            return get_model_proxy()->allocate_slow_query_proxy();
                         }
 
                         /**
@@ -103,19 +172,20 @@ namespace uva {
                          * @param query the query to dispose
                          */
                         static inline void dispose_slow_query_proxy(lm_slow_query_proxy & query) {
-                            m_model_proxy->dispose_slow_query_proxy(query);
+                            get_model_proxy()->dispose_slow_query_proxy(query);
                         }
 
                         /**
-                         * Allows to return an instance of the query executor,
-                         * is to be returned by calling the dispose method.
+                         * Allows to return an instance of the query executor of the current
+                         * model, is to be returned by calling the dispose method. If the model
+                         * can be replaced in the mean time then get_model_proxy is to be used.
                          * @return an instance of the query executor.
                          */
                         static inline lm_fast_query_proxy & allocate_fast_query_proxy() {
                             LOG_DEBUG2 << "Allocating a new fast LM query proxy" << END_LOG;
 
                             //Return the query executor as given by the proxy class
-                            return m_model_proxy->allocate_fast_query_proxy();
+                            return get_model_proxy()->allocate_fast_query_proxy();
                         }
 
                         /**
@@ -123,15 +193,57 @@ namespace uva {
                          * @param query the query to dispose
                          */
                         static inline void dispose_fast_query_proxy(lm_fast_query_proxy & query) {
-                            m_model_proxy->dispose_fast_query_proxy(query);
+                            get_model_proxy()->dispose_fast_query_proxy(query);
                         }
 
                     private:
                         //Stores the pointer to the configuration parameters
                         static const lm_parameters * m_params;
 
+                        //Stores the parameters with the connection string
+                        //pointing to the model's shared memory segment
+                        static lm_parameters m_shm_params;
+
                         //Store the trie proxy object
-                        static lm_proxy * m_model_proxy;
+                        static lm_proxy_ptr m_model_proxy;
+
+                        /**
+                         * Allows to create the model's shared memory segment, unless it
+                         * is already created, and to get the connection parameters pointing
+                         * to it. The segment contains the binary snapshot of the model, so
+                         * only the trie types supporting the snapshot can be shared.
+                         * @return the parameters with the segment as the connection string
+                         */
+                        static const lm_parameters & connect_shm_segment() {
+                            //Lock the segment for the time of creation
+                            shared_memory_segment segment(m_params->m_shm_name);
+
+                            if (segment.is_created()) {
+                                LOG_USAGE << "Attaching to the existing LM shared memory segment: "
+                                        << segment.get_path() << END_LOG;
+                            } else {
+                                LOG_USAGE << "Building the LM shared memory segment: "
+                                        << segment.get_path() << END_LOG;
+
+                                //Load the model into the private memory, write its
+                                //snapshot and free the memory before attaching to it
+                                lm_proxy_local builder;
+                                builder.connect(*m_params);
+                                builder.write_snapshot(segment.get_build_path());
+                                builder.disconnect();
+
+                                //Make the complete segment visible to the other processes
+                                segment.publish();
+                            }
+
+                            //The model is to be attached to the segment, the parameters are
+                            //only set once as they may be in use by the current model
+                            if (m_shm_params.m_conn_string != segment.get_path()) {
+                                m_shm_params = *m_params;
+                                m_shm_params.m_conn_string = segment.get_path();
+                            }
+                            return m_shm_params;
+                        }
                     };
                 }
             }
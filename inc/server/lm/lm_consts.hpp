@@ -53,6 +53,14 @@ namespace uva {
                     //The base of the logarithm of the probability weights in the ARPA file
                     static constexpr prob_weight ARPA_PROB_WEIGHT_LOG_10_BASE = 10;
 
+                    //The maximum number of queries executed at once by the batched LM query
+                    //execution, the payload data of these queries is prefetched together
+                    static constexpr size_t LM_QUERY_BATCH_SIZE = 16;
+
+                    //The maximum number of bits of the per translation thread LM query cache
+                    //size, the cache has 2^bits entries, each entry takes 16 bytes of memory
+                    static constexpr size_t LM_QUERY_CACHE_BITS_MAX = 24;
+
                     namespace dictionary {
 
                         namespace __AWordIndex {
@@ -78,6 +86,15 @@ namespace uva {
                         typedef uint64_t TLongId;
                     }
 
+                    namespace __HashCache {
+                        //The type of the m-gram presence cache used by the tries with the bitmap hash cache
+                        //buckets factor > 1: false - the bitmap with one bit per m-gram and the number of
+                        //bits being the buckets factor * the number of m-grams rounded up to the power of
+                        //two; true - the cache-line-blocked Bloom filter with the buckets factor bits per
+                        //m-gram, one cache miss per check and a much lower false positive rate
+                        static constexpr bool IS_BLOOM_FILTER = true;
+                    }
+
                     namespace __C2DHybridTrie {
                         //The unordered map memory factor for the M-Grams in C2DMapArrayTrie
                         static constexpr float UM_M_GRAM_MEMORY_FACTOR = 2.1;
@@ -89,6 +106,8 @@ namespace uva {
                         //static constexpr word_index_types WORD_INDEX_TYPE = OPTIMIZING_BASIC_WORD_INDEX;
                         //With the bitmap hashing we get some 5% performance improvement
                         static constexpr uint8_t BITMAP_HASH_CACHE_BUCKETS_FACTOR = 10;
+                        //The number of bits per quantized m-gram (1 < m) payload value: 0 - no quantization, 8 or 16
+                        static constexpr uint8_t PAYLOAD_QUANT_BITS = 0;
                     }
 
                     namespace __C2DMapTrie {
@@ -102,6 +121,8 @@ namespace uva {
                         //static constexpr word_index_types WORD_INDEX_TYPE = OPTIMIZING_BASIC_WORD_INDEX;
                         //With the bitmap hash caching on we are not faster with this trie
                         static constexpr uint8_t BITMAP_HASH_CACHE_BUCKETS_FACTOR = 0;
+                        //The number of bits per quantized m-gram (1 < m) payload value: 0 - no quantization, 8 or 16
+                        static constexpr uint8_t PAYLOAD_QUANT_BITS = 0;
                     }
 
                     namespace __G2DMapTrie {
@@ -128,6 +149,40 @@ namespace uva {
                         //static constexpr word_index_types WORD_INDEX_TYPE = HASHING_WORD_INDEX;
                         //With the bitmap hash caching on we are not faster with this trie
                         static constexpr uint8_t BITMAP_HASH_CACHE_BUCKETS_FACTOR = 0;
+                        //The number of bits per quantized m-gram (1 < m) payload value: 0 - no quantization, 8 or 16.
+                        //The quantized payloads take 2 or 4 bytes instead of 8, at the price of precision,
+                        //use lm-query with the --quant-report option to see the perplexity difference.
+                        static constexpr uint8_t PAYLOAD_QUANT_BITS = 0;
+                        //Stores the number of quantization bits for the model to compare with, see lm-query
+                        static constexpr uint8_t OTHER_PAYLOAD_QUANT_BITS = ((PAYLOAD_QUANT_BITS == 0) ? 8 : 0);
+                        //If true then the m-grams are stored in the fingerprint_hashmap, matching 16 buckets at a time
+                        //by their 7 bit key fingerprints, otherwise in the plain linear probing fixed_size_hashmap.
+                        //Changing this value changes the binary snapshot layout, the snapshots are to be re-compiled.
+                        static constexpr bool IS_FINGERPRINT_HASHMAP = true;
+                        //The number of key fingerprint bits for the lossy storage mode: 0 - the full 64 bit m-gram
+                        //ids are stored, 16 or 24 - only the fingerprint is stored in the bucket next to the payload.
+                        //The lossy mode takes about half the memory but an absent m-gram can get the payload of another
+                        //one, the false positive rate is reported at build time. Use lm-query with the --fp-report
+                        //option to see the perplexity difference.
+                        static constexpr uint8_t FINGERPRINT_BITS = 0;
+                        //Stores the number of fingerprint bits for the model to compare with, see lm-query
+                        static constexpr uint8_t OTHER_FINGERPRINT_BITS = ((FINGERPRINT_BITS == 0) ? 16 : 0);
+                        //The buckets factor for the lossy storage mode, the buckets are small so the load is to be
+                        //kept higher than with BUCKETS_FACTOR, the false positive rate grows with the probe runs.
+                        static constexpr double FINGERPRINT_BUCKETS_FACTOR = 1.5;
+                        //If true then, once loaded, each m-gram level is stored in a dense array addressed by a minimal
+                        //perfect hash function, next to the payloads only the m-gram id fingerprints are kept, so the
+                        //non-zero FINGERPRINT_BITS are required. There are no empty buckets and every look-up touches
+                        //one payload. Changing this value changes the binary snapshot layout.
+                        static constexpr bool IS_MPH_STORAGE = false;
+                        //Stores the number of fingerprint bits of the minimal perfect hash storage trie selectable in
+                        //lm-query, it differs from the default trie setting so that the two are different tries
+                        static constexpr uint8_t MPH_FINGERPRINT_BITS = ((IS_MPH_STORAGE && (FINGERPRINT_BITS == 16)) ? 24 : 16);
+                        //The number of minimal perfect hash function bits per m-gram per level, the larger it
+                        //is the fewer levels are there and the faster the look-ups, at the price of memory.
+                        static constexpr double MPH_GAMMA = 2.0;
+                        //Stores the minimal perfect hash storage setting for the model with the other fingerprint setting
+                        static constexpr bool OTHER_IS_MPH_STORAGE = (IS_MPH_STORAGE && (OTHER_FINGERPRINT_BITS != 0));
                     }
 
                     namespace __W2CArrayTrie {
@@ -153,6 +208,8 @@ namespace uva {
                         //static constexpr word_index_types WORD_INDEX_TYPE = OPTIMIZING_COUNTING_WORD_INDEX;
                         //With the bitmap hashing we get some 5% performance improvement
                         static constexpr uint8_t BITMAP_HASH_CACHE_BUCKETS_FACTOR = 5;
+                        //The number of bits per quantized m-gram (1 < m) payload value: 0 - no quantization, 8 or 16
+                        static constexpr uint8_t PAYLOAD_QUANT_BITS = 0;
                     }
 
                     namespace __C2WArrayTrie {
@@ -28,15 +28,23 @@
 
 #include <string>
 #include <vector>
+#include <thread>       // std::thread
+#include <chrono>       // std::chrono::steady_clock
+#include <algorithm>    // std::sort
+#include <exception>    // std::exception_ptr
+#include <cmath>        // std::exp
+#include <malloc.h>     // malloc_trim
 
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/exceptions.hpp"
 
 #include "server/lm/lm_consts.hpp"
 #include "server/lm/lm_parameters.hpp"
+#include "server/lm/lm_configs.hpp"
 #include "server/lm/lm_configurator.hpp"
 
 #include "server/lm/proxy/lm_fast_query_proxy.hpp"
+#include "server/lm/proxy/lm_slow_query_proxy_local.hpp"
 
 #include "server/lm/dictionaries/basic_word_index.hpp"
 #include "server/lm/dictionaries/counting_word_index.hpp"
@@ -75,27 +83,59 @@ namespace uva {
 
                             //The test file name
                             string m_query_file_name;
+
+                            //The binary snapshot file name to compile the model into
+                            string m_snapshot_file_name;
+
+                            //The flag indicating whether the payload quantization report is needed
+                            bool m_is_quant_report;
+
+                            //The flag indicating whether the m-gram id fingerprints report is needed
+                            bool m_is_fp_report;
+
+                            //The number of query threads for the throughput mode, zero for the regular mode
+                            size_t m_num_query_threads;
+
+                            //The trie type name, see TRIE_TYPE_NAMES
+                            string m_trie_type;
+
+                            //The word index type name, see WORD_INDEX_TYPE_NAMES
+                            string m_word_index_type;
+
+                            //The flag indicating whether all the trie types are to be compared
+                            bool m_is_compare;
                         } lm_exec_params;
 
                         /**
-                         * Allows to read and execute test queries from the given file on the given trie.
+                         * This structure stores the throughput mode results of one query thread
+                         * @param m_log_prob the joint log_e probability of the thread's queries
+                         * @param m_num_probs the number of probabilities in the joint probability
+                         * @param m_wall_secs the wall-clock seconds the thread spent on its queries
+                         * @param m_latencies the per-query latencies in nanoseconds
+                         * @param m_error the exception thrown by the thread, if any
+                         */
+                        typedef struct {
+                            double m_log_prob;
+                            size_t m_num_probs;
+                            double m_wall_secs;
+                            vector<uint64_t> m_latencies;
+                            exception_ptr m_error;
+                        } thread_results;
+
+                        /**
+                         * Allows to read and execute test queries from the given file with the given query proxy.
                          * @param test_file the file containing the N-Gram (5-Gram queries)
+                         * @param query the query proxy to execute the queries with
+                         * @return the perplexity of the query set
                          */
                         template<typename TFileReaderQuery>
-                        static void execute_queries(TFileReaderQuery &test_file) {
-                            //Declare time variables for CPU times in seconds
-                            double start_time = 0.0, end_time = 0.0;
-
+                        static double run_queries(TFileReaderQuery &test_file, lm_slow_query_proxy & query) {
                             //Will store the read line (word1 word2 word3 word4 word5)
                             text_piece_reader line;
 
-                            //Get the query executor proxy object
-                            lm_slow_query_proxy & query = lm_configurator::allocate_slow_query_proxy();
-
-                            LOG_USAGE << "Start reading and executing the test queries ..." << END_LOG;
-
-                            //Start the timer
-                            start_time = stat_monitor::get_cpu_time();
+                            //Stores the total joint log_e probability and the number of probabilities
+                            double total_log_prob = 0.0;
+                            size_t total_num_probs = 0;
 
                             //Read the test file line by line
                             while (test_file.get_first_line(line)) {
@@ -104,12 +144,41 @@ namespace uva {
                                 try {
                                     //Query the Trie for the results and log them
                                     query.execute(line);
+
+                                    //Account for the query result
+                                    total_log_prob += query.get_joint_prob();
+                                    total_num_probs += query.get_num_probs();
                                 } catch (exception & ex) {
                                     //The query has failed! print an exception and proceed!
                                     LOG_ERROR << ex.what() << END_LOG;
                                 }
                             }
 
+                            //Compute the perplexity, the probabilities are in the log_e space
+                            return (total_num_probs == 0) ? 0.0 : exp(-total_log_prob / total_num_probs);
+                        }
+
+                        /**
+                         * Allows to read and execute test queries from the given file on the given trie.
+                         * @param test_file the file containing the N-Gram (5-Gram queries)
+                         * @return the perplexity of the query set
+                         */
+                        template<typename TFileReaderQuery>
+                        static double execute_queries(TFileReaderQuery &test_file) {
+                            //Declare time variables for CPU times in seconds
+                            double start_time = 0.0, end_time = 0.0;
+
+                            //Get the query executor proxy object
+                            lm_slow_query_proxy & query = lm_configurator::allocate_slow_query_proxy();
+
+                            LOG_USAGE << "Start reading and executing the test queries ..." << END_LOG;
+
+                            //Start the timer
+                            start_time = stat_monitor::get_cpu_time();
+
+                            //Execute the queries
+                            const double perplexity = run_queries(test_file, query);
+
                             //Stop the timer
                             end_time = stat_monitor::get_cpu_time();
 
@@ -117,6 +186,474 @@ namespace uva {
                             lm_configurator::dispose_slow_query_proxy(query);
 
                             LOG_USAGE << "Total query execution time is " << (end_time - start_time) << " CPU seconds." << END_LOG;
+                            LOG_USAGE << "The query set perplexity is " << perplexity << END_LOG;
+
+                            return perplexity;
+                        }
+
+                        /**
+                         * Allows to execute the queries of the given line aligned chunk of the query file
+                         * and to measure the per-query latencies. Is to be run in a separate thread.
+                         * @param chunk the query file chunk to execute
+                         * @param query the query proxy to execute the queries with
+                         * @param results [out] the thread results
+                         */
+                        static void run_queries_chunk(text_piece_reader chunk, lm_slow_query_proxy & query, thread_results & results) {
+                            try {
+                                text_piece_reader line;
+                                const auto start = chrono::steady_clock::now();
+                                while (chunk.get_first_line(line)) {
+                                    const auto begin = chrono::steady_clock::now();
+                                    try {
+                                        //Query the Trie and account for the query result
+                                        query.execute(line);
+                                        results.m_log_prob += query.get_joint_prob();
+                                        results.m_num_probs += query.get_num_probs();
+                                    } catch (exception & ex) {
+                                        //The query has failed! print an exception and proceed!
+                                        LOG_ERROR << ex.what() << END_LOG;
+                                    }
+                                    const auto end = chrono::steady_clock::now();
+                                    results.m_latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(end - begin).count());
+                                }
+                                results.m_wall_secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                            } catch (...) {
+                                results.m_error = current_exception();
+                            }
+                        }
+
+                        /**
+                         * Allows to get the latency percentile from the sorted latencies
+                         * @param latencies the sorted per-query latencies in nanoseconds, not empty
+                         * @param percent the percentile to get
+                         * @return the percentile latency in microseconds
+                         */
+                        static inline double get_percentile(const vector<uint64_t> & latencies, const double percent) {
+                            const size_t idx = static_cast<size_t> (percent * (latencies.size() - 1) / 100.0 + 0.5);
+                            return latencies[idx] / 1000.0;
+                        }
+
+                        /**
+                         * Allows to execute the test queries in the throughput mode. The memory mapped query
+                         * file is split into line aligned chunks, one per thread, and each thread executes
+                         * its chunk with its own query proxy. The per query results are not reported, the
+                         * wall-clock queries per second, the per thread throughput and the per-query latency
+                         * percentiles are reported instead.
+                         * @param test_file the file containing the queries
+                         * @param queries the query proxies, one per thread
+                         * @param qps [out] the wall-clock queries per second
+                         * @return the perplexity of the query set
+                         */
+                        static double execute_queries_parallel(memory_mapped_file_reader & test_file,
+                                const vector<lm_slow_query_proxy *> & queries, double & qps) {
+                            const char * const data = test_file.get_rest_c_str();
+                            const size_t data_len = test_file.get_rest_len();
+
+                            //Split the file into the line aligned chunks, one chunk per thread
+                            const size_t chunk_len = (data_len / queries.size()) + 1;
+                            vector<text_piece_reader> chunks;
+                            size_t begin_idx = 0;
+                            while (begin_idx < data_len) {
+                                size_t end_idx = min(begin_idx + chunk_len, data_len);
+                                if (end_idx < data_len) {
+                                    const char * const nl_ptr = static_cast<const char *> (
+                                            memchr(data + end_idx, '\n', data_len - end_idx));
+                                    end_idx = (nl_ptr == NULL) ? data_len : (nl_ptr - data) + 1;
+                                }
+                                chunks.push_back(text_piece_reader(data + begin_idx, end_idx - begin_idx));
+                                begin_idx = end_idx;
+                            }
+
+                            //Allocate the results, one per chunk
+                            vector<thread_results> results(chunks.size(), thread_results{});
+
+                            LOG_USAGE << "Start executing the test queries with " << chunks.size()
+                                    << " threads in the throughput mode ..." << END_LOG;
+
+                            //The per query results are not reported, they would just measure the logging
+                            const debug_levels_enum level = logger::get_reporting_level();
+                            logger::get_reporting_level() = min(level, debug_levels_enum::USAGE);
+
+                            //Run the query threads and wait until they are done
+                            const auto start = chrono::steady_clock::now();
+                            vector<thread> workers;
+                            for (size_t idx = 0; idx < chunks.size(); ++idx) {
+                                workers.push_back(thread(run_queries_chunk, chunks[idx], ref(*queries[idx]), ref(results[idx])));
+                            }
+                            for (thread & worker : workers) {
+                                worker.join();
+                            }
+                            const double wall_secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+                            logger::get_reporting_level() = level;
+
+                            //Re-throw the first of the worker exceptions, if any
+                            for (thread_results & result : results) {
+                                if (result.m_error) {
+                                    rethrow_exception(result.m_error);
+                                }
+                            }
+
+                            //Collect the totals and report the per thread throughput
+                            double total_log_prob = 0.0;
+                            size_t total_num_probs = 0;
+                            vector<uint64_t> latencies;
+                            for (size_t idx = 0; idx < results.size(); ++idx) {
+                                const thread_results & result = results[idx];
+                                total_log_prob += result.m_log_prob;
+                                total_num_probs += result.m_num_probs;
+                                latencies.insert(latencies.end(), result.m_latencies.begin(), result.m_latencies.end());
+                                LOG_USAGE << "Thread " << idx << ": " << result.m_latencies.size() << " queries in "
+                                        << result.m_wall_secs << " seconds, "
+                                        << ((result.m_wall_secs == 0.0) ? 0.0 : result.m_latencies.size() / result.m_wall_secs)
+                                        << " queries/sec" << END_LOG;
+                            }
+
+                            //Report the total throughput and the latency percentiles
+                            qps = (wall_secs == 0.0) ? 0.0 : latencies.size() / wall_secs;
+                            LOG_USAGE << "Total: " << latencies.size() << " queries in " << wall_secs << " wall-clock seconds, "
+                                    << qps << " queries/sec" << END_LOG;
+                            if (!latencies.empty()) {
+                                sort(latencies.begin(), latencies.end());
+                                LOG_USAGE << "Query latency: p50 " << get_percentile(latencies, 50.0) << " us, p99 "
+                                        << get_percentile(latencies, 99.0) << " us, max " << latencies.back() / 1000.0
+                                        << " us" << END_LOG;
+                            }
+
+                            //Compute the perplexity, the probabilities are in the log_e space
+                            const double perplexity = (total_num_probs == 0) ? 0.0 : exp(-total_log_prob / total_num_probs);
+                            LOG_USAGE << "The query set perplexity is " << perplexity << END_LOG;
+
+                            return perplexity;
+                        }
+
+                        /**
+                         * Allows to execute the test queries in the throughput mode with the connected model
+                         * @param test_file the file containing the queries
+                         * @param num_threads the number of query threads
+                         * @return the perplexity of the query set
+                         */
+                        static double execute_queries_parallel(memory_mapped_file_reader & test_file, const size_t num_threads) {
+                            //Allocate the query proxies, one per thread
+                            vector<lm_slow_query_proxy *> queries;
+                            for (size_t idx = 0; idx < num_threads; ++idx) {
+                                queries.push_back(&lm_configurator::allocate_slow_query_proxy());
+                            }
+
+                            //Execute the queries
+                            double qps = 0.0;
+                            const double perplexity = execute_queries_parallel(test_file, queries, qps);
+
+                            //Dispose the query proxies
+                            for (lm_slow_query_proxy * query : queries) {
+                                lm_configurator::dispose_slow_query_proxy(*query);
+                            }
+
+                            return perplexity;
+                        }
+
+                        /**
+                         * This structure stores the results of loading and querying one model type
+                         * @param m_load_secs the wall-clock seconds of loading the model
+                         * @param m_rss_mb the resident memory increase after loading the model, in Mb
+                         * @param m_qps the wall-clock queries per second
+                         * @param m_perplexity the perplexity of the query set
+                         * @param m_error the error message, empty if the model type was run
+                         */
+                        typedef struct {
+                            double m_load_secs;
+                            double m_rss_mb;
+                            double m_qps;
+                            double m_perplexity;
+                            string m_error;
+                        } model_results;
+
+                        /**
+                         * Allows to load the ARPA model into the given model type and to execute
+                         * the test queries with it, in the throughput mode if requested.
+                         * @param model_type the trie type, with its word index type
+                         * @param params the runtime program parameters
+                         * @param results [out] the load and query results
+                         */
+                        template<typename model_type>
+                        static void run_model_type(const __executor::lm_exec_params & params, model_results & results) {
+                            typedef typename model_type::WordIndexType word_index_type;
+
+                            //The model is to be loaded from an ARPA file
+                            ASSERT_CONDITION_THROW(lm_snapshot_builder<lm_model_type>::is_snapshot_file(params.m_lm_params.m_conn_string),
+                                    "The selected trie and word index types require the model in the ARPA format, not a binary snapshot!");
+
+                            //Declare the statistics monitor data
+                            TMemotyUsage mem_stat_start = {}, mem_stat_end = {};
+                            stat_monitor::get_mem_stat(mem_stat_start);
+                            const auto load_start = chrono::steady_clock::now();
+
+                            //Create and load the model, with several threads if requested and supported
+                            word_index_type word_index(__AWordIndex::MEMORY_FACTOR);
+                            model_type model(word_index);
+                            model.log_model_type_info();
+                            {
+                                huge_page_allocator::scoped_policy huge_pages(params.m_lm_params.m_huge_pages);
+                                if (params.m_lm_params.m_num_load_threads > 1) {
+                                    lm_parallel_model_reader model_file(params.m_lm_params.m_conn_string.c_str());
+                                    ASSERT_CONDITION_THROW(!model_file.is_open(), string("The model file: '")
+                                            + params.m_lm_params.m_conn_string + string("' does not exist!"));
+                                    lm_basic_builder<model_type, lm_parallel_model_reader> builder(params.m_lm_params, model, model_file);
+                                    builder.build();
+                                    model_file.close();
+                                } else {
+                                    lm_model_reader model_file(params.m_lm_params.m_conn_string.c_str());
+                                    ASSERT_CONDITION_THROW(!model_file.is_open(), string("The model file: '")
+                                            + params.m_lm_params.m_conn_string + string("' does not exist!"));
+                                    lm_basic_builder<model_type, lm_model_reader> builder(params.m_lm_params, model, model_file);
+                                    builder.build();
+                                    model_file.close();
+                                }
+                            }
+
+                            results.m_load_secs = chrono::duration<double>(chrono::steady_clock::now() - load_start).count();
+                            stat_monitor::get_mem_stat(mem_stat_end);
+                            report_memory_usage("Loading the model", mem_stat_start, mem_stat_end, true);
+                            results.m_rss_mb = (mem_stat_end.vmrss < mem_stat_start.vmrss) ? 0.0 :
+                                    (mem_stat_end.vmrss - mem_stat_start.vmrss) / 1024.0;
+
+                            //Execute the queries
+                            memory_mapped_file_reader test_file(params.m_query_file_name.c_str());
+                            ASSERT_CONDITION_THROW(!test_file.is_open(), string("The Test Queries file: '")
+                                    + params.m_query_file_name + string("' does not exist!"));
+                            if (params.m_num_query_threads == 0) {
+                                lm_slow_query_proxy_local<model_type> query(model);
+                                const auto start = chrono::steady_clock::now();
+                                results.m_perplexity = run_queries(test_file, query);
+                                const double wall_secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                                results.m_qps = (wall_secs == 0.0) ? 0.0 : count(test_file.get_begin_c_str(),
+                                        test_file.get_begin_c_str() + test_file.length(), '\n') / wall_secs;
+                                LOG_USAGE << "The query set perplexity is " << results.m_perplexity << END_LOG;
+                            } else {
+                                vector<lm_slow_query_proxy *> queries;
+                                for (size_t idx = 0; idx < params.m_num_query_threads; ++idx) {
+                                    queries.push_back(new lm_slow_query_proxy_local<model_type>(model));
+                                }
+                                results.m_perplexity = execute_queries_parallel(test_file, queries, results.m_qps);
+                                for (lm_slow_query_proxy * query : queries) {
+                                    delete query;
+                                }
+                            }
+                            test_file.close();
+
+                            LOG_USAGE << "Cleaning up memory ..." << END_LOG;
+                        }
+
+                        //Define the function type for loading and querying one model type
+                        typedef void (*model_type_runner)(const __executor::lm_exec_params &, model_results &);
+
+                        //Stores the number of trie types selectable at runtime
+                        static constexpr size_t NUM_TRIE_TYPES = 9;
+                        //Stores the number of word index types selectable at runtime
+                        static constexpr size_t NUM_WORD_INDEX_TYPES = 5;
+
+                        //Stores the names of the trie types selectable at runtime
+                        static const char * const TRIE_TYPE_NAMES[NUM_TRIE_TYPES] = {
+                            "h2d", "h2d-mph", "c2d-hybrid", "c2d-map", "c2w-array", "c2w-packed", "w2c-array", "w2c-hybrid", "g2d"
+                        };
+
+                        //Stores the names of the word index types selectable at runtime
+                        static const char * const WORD_INDEX_TYPE_NAMES[NUM_WORD_INDEX_TYPES] = {
+                            "hashing", "basic", "count", "opt-basic", "opt-count"
+                        };
+
+                        //Stores the word index type name meaning the recommended word index of the trie type
+                        static const char * const AUTO_WORD_INDEX_TYPE_NAME = "auto";
+
+                        //Stores the recommended word index types of the trie types, see lm_consts.hpp
+                        static constexpr size_t TRIE_WORD_INDEX_TYPES[NUM_TRIE_TYPES] = {0, 0, 3, 3, 4, 4, 4, 4, 4};
+
+                        //Defines the model type runners of the trie, for all the word index types
+#define MODEL_TYPE_RUNNERS(TRIE_TYPE) \
+                        { \
+                            &run_model_type<TRIE_TYPE<hashing_word_index>>, \
+                            &run_model_type<TRIE_TYPE<basic_word_index>>, \
+                            &run_model_type<TRIE_TYPE<counting_word_index>>, \
+                            &run_model_type<TRIE_TYPE<basic_optimizing_word_index>>, \
+                            &run_model_type<TRIE_TYPE<counting_optimizing_word_index>> \
+                        }
+
+                        //Stores the model type runners, indexed as the trie and word index type names
+                        static const model_type_runner MODEL_TYPE_RUNNERS[NUM_TRIE_TYPES][NUM_WORD_INDEX_TYPES] = {
+                            MODEL_TYPE_RUNNERS(h2d_map_trie),
+                            MODEL_TYPE_RUNNERS(h2d_mph_trie),
+                            MODEL_TYPE_RUNNERS(c2d_hybrid_trie),
+                            MODEL_TYPE_RUNNERS(c2d_map_trie),
+                            MODEL_TYPE_RUNNERS(c2w_array_trie),
+                            MODEL_TYPE_RUNNERS(c2w_packed_trie),
+                            MODEL_TYPE_RUNNERS(w2c_array_trie),
+                            MODEL_TYPE_RUNNERS(w2c_hybrid_trie),
+                            MODEL_TYPE_RUNNERS(g2d_map_trie)
+                        };
+
+                        /**
+                         * Allows to get the index of the given name in the array of names
+                         * @param names the array of names
+                         * @param num_names the number of names
+                         * @param name the name to look for
+                         * @return the index of the name
+                         * @throws uva_exception if the name is not found
+                         */
+                        static inline size_t get_name_idx(const char * const * names, const size_t num_names, const string & name) {
+                            for (size_t idx = 0; idx < num_names; ++idx) {
+                                if (name == names[idx]) {
+                                    return idx;
+                                }
+                            }
+                            THROW_EXCEPTION(string("Unknown type name: ") + name);
+                        }
+
+                        /**
+                         * Allows to load and query the model with the selected trie type and word index
+                         * type, or with all the trie types if the comparison is requested. In the latter
+                         * case the load time, the resident memory and the query throughput of the trie
+                         * types are reported side by side. Unless a word index type is selected, each
+                         * trie type uses its recommended word index type.
+                         * @param params the runtime program parameters
+                         */
+                        static void run_model_types(const __executor::lm_exec_params & params) {
+                            const bool is_auto_word_idx = (params.m_word_index_type == AUTO_WORD_INDEX_TYPE_NAME);
+                            const size_t trie_type = get_name_idx(TRIE_TYPE_NAMES, NUM_TRIE_TYPES, params.m_trie_type);
+
+                            //Get the trie types to run
+                            const size_t begin_idx = params.m_is_compare ? 0 : trie_type;
+                            const size_t end_idx = params.m_is_compare ? NUM_TRIE_TYPES : trie_type + 1;
+                            vector<model_results> results(NUM_TRIE_TYPES, model_results{});
+
+                            for (size_t idx = begin_idx; idx < end_idx; ++idx) {
+                                const size_t word_idx_type = is_auto_word_idx ? TRIE_WORD_INDEX_TYPES[idx] :
+                                        get_name_idx(WORD_INDEX_TYPE_NAMES, NUM_WORD_INDEX_TYPES, params.m_word_index_type);
+                                LOG_USAGE << "--------------------------------------------------------" << END_LOG;
+                                LOG_USAGE << "Loading and querying the " << TRIE_TYPE_NAMES[idx] << " trie with the "
+                                        << WORD_INDEX_TYPE_NAMES[word_idx_type] << " word index ..." << END_LOG;
+                                try {
+                                    MODEL_TYPE_RUNNERS[idx][word_idx_type](params, results[idx]);
+                                } catch (exception & ex) {
+                                    //Some layered tries only support the 32 bit word_uid, keep comparing the others
+                                    if (!params.m_is_compare) {
+                                        throw;
+                                    }
+                                    LOG_ERROR << ex.what() << END_LOG;
+                                    results[idx].m_error = ex.what();
+                                }
+#ifdef __GLIBC__
+                                //Give the freed model memory back to the system for the next resident memory measurement
+                                malloc_trim(0);
+#endif
+                            }
+
+                            //Report the trie types side by side
+                            if (params.m_is_compare) {
+                                LOG_USAGE << "--------------------------------------------------------" << END_LOG;
+                                LOG_USAGE << "The trie types compared:" << END_LOG;
+                                LOG_USAGE << "trie type\tword index\tload, sec\tvmrss, Mb\tqueries/sec\tperplexity" << END_LOG;
+                                for (size_t idx = begin_idx; idx < end_idx; ++idx) {
+                                    const model_results & result = results[idx];
+                                    const char * const word_idx_name = is_auto_word_idx ?
+                                            WORD_INDEX_TYPE_NAMES[TRIE_WORD_INDEX_TYPES[idx]] : params.m_word_index_type.c_str();
+                                    if (result.m_error.empty()) {
+                                        LOG_USAGE << TRIE_TYPE_NAMES[idx] << "\t" << word_idx_name << "\t"
+                                                << result.m_load_secs << "\t" << result.m_rss_mb << "\t"
+                                                << result.m_qps << "\t" << result.m_perplexity << END_LOG;
+                                    } else {
+                                        LOG_USAGE << TRIE_TYPE_NAMES[idx] << "\t" << word_idx_name
+                                                << "\tfailed: " << result.m_error << END_LOG;
+                                    }
+                                }
+                            }
+                        }
+
+                        /**
+                         * Allows to load the comparison model from the ARPA file and to report on its
+                         * perplexity for the given queries compared to the perplexity of the main model.
+                         * @param cmp_model_type the comparison model type
+                         * @param params the runtime program parameters
+                         * @param perplexity the perplexity of the main model
+                         * @param main_setting the description of the main model setting
+                         * @param cmp_setting the description of the comparison model setting
+                         */
+                        template<typename cmp_model_type>
+                        static void report_model_delta(const __executor::lm_exec_params & params, const double perplexity,
+                                const string & main_setting, const string & cmp_setting) {
+                            //The model is to be loaded from an ARPA file
+                            ASSERT_CONDITION_THROW(lm_snapshot_builder<cmp_model_type>::is_snapshot_file(params.m_lm_params.m_conn_string),
+                                    "The comparison report requires the model in the ARPA format, not a binary snapshot!");
+
+                            LOG_USAGE << "--------------------------------------------------------" << END_LOG;
+                            LOG_USAGE << "Loading the model with " << cmp_setting << " for comparison ..." << END_LOG;
+
+                            //Declare the statistics monitor data
+                            TMemotyUsage mem_stat_start = {}, mem_stat_end = {};
+                            stat_monitor::get_mem_stat(mem_stat_start);
+
+                            //Create and load the comparison model
+                            lm_word_index word_index(__AWordIndex::MEMORY_FACTOR);
+                            cmp_model_type model(word_index);
+                            lm_model_reader model_file(params.m_lm_params.m_conn_string.c_str());
+                            ASSERT_CONDITION_THROW(!model_file.is_open(), string("The model file: '")
+                                    + params.m_lm_params.m_conn_string + string("' does not exist!"));
+                            lm_basic_builder<cmp_model_type, lm_model_reader> builder(params.m_lm_params, model, model_file);
+                            builder.build();
+                            model_file.close();
+
+                            stat_monitor::get_mem_stat(mem_stat_end);
+                            report_memory_usage("Loading the comparison model", mem_stat_start, mem_stat_end, true);
+
+                            //Execute the queries quietly, the per-query results are not needed
+                            lm_slow_query_proxy_local<cmp_model_type> query(model);
+                            const debug_levels_enum level = logger::get_reporting_level();
+                            logger::get_reporting_level() = min(level, debug_levels_enum::USAGE);
+                            memory_mapped_file_reader test_file(params.m_query_file_name.c_str());
+                            const double cmp_perplexity = run_queries(test_file, query);
+                            test_file.close();
+                            logger::get_reporting_level() = level;
+
+                            LOG_USAGE << "The query set perplexity with " << main_setting << " is " << perplexity << END_LOG;
+                            LOG_USAGE << "The query set perplexity with " << cmp_setting << " is " << cmp_perplexity << END_LOG;
+                            LOG_USAGE << "The perplexity delta is " << (cmp_perplexity - perplexity) << " ("
+                                    << ((perplexity == 0.0) ? 0.0 : (100.0 * (cmp_perplexity - perplexity) / perplexity))
+                                    << "%)" << END_LOG;
+                        }
+
+                        /**
+                         * Allows to get the description of the m-gram id fingerprint setting
+                         * @param num_bits the number of fingerprint bits
+                         * @return the setting description
+                         */
+                        static inline string get_fingerprint_setting(const uint8_t num_bits) {
+                            return (num_bits == 0) ? string("the full m-gram ids") :
+                                    to_string(num_bits) + string(" bit m-gram id fingerprints");
+                        }
+
+                        /**
+                         * Allows to load the model with the other payload quantization setting from the
+                         * ARPA file and to report on its perplexity for the given queries compared to the
+                         * perplexity of the main model. Both models have the same type otherwise.
+                         * @param params the runtime program parameters
+                         * @param perplexity the perplexity of the main model
+                         */
+                        static void report_quantization(const __executor::lm_exec_params & params, const double perplexity) {
+                            report_model_delta<lm_cmp_model_type>(params, perplexity,
+                                    to_string(__H2DMapTrie::PAYLOAD_QUANT_BITS) + string(" payload quantization bits"),
+                                    to_string(__H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS) + string(" payload quantization bits"));
+                        }
+
+                        /**
+                         * Allows to load the model with the other m-gram id fingerprint setting from the
+                         * ARPA file and to report on its perplexity for the given queries compared to the
+                         * perplexity of the main model. Both models have the same type otherwise.
+                         * @param params the runtime program parameters
+                         * @param perplexity the perplexity of the main model
+                         */
+                        static void report_fingerprints(const __executor::lm_exec_params & params, const double perplexity) {
+                            report_model_delta<lm_fp_model_type>(params, perplexity,
+                                    get_fingerprint_setting(__H2DMapTrie::FINGERPRINT_BITS),
+                                    get_fingerprint_setting(__H2DMapTrie::OTHER_FINGERPRINT_BITS));
                         }
 
                         /**
@@ -126,28 +663,56 @@ namespace uva {
                          * @param params the runtime program parameters
                          */
                         static void perform_tasks(const __executor::lm_exec_params & params) {
-                            //Attempt to open the test file
-                            memory_mapped_file_reader test_file(params.m_query_file_name.c_str());
-
-                            //Assert that the query file is opened
-                            ASSERT_CONDITION_THROW(!test_file.is_open(), string("The Test Queries file: '")
-                                    + params.m_query_file_name + string("' does not exist!"));
+                            //The non default model types are loaded and queried without the configurator
+                            if (params.m_is_compare || (params.m_trie_type != TRIE_TYPE_NAMES[0]) ||
+                                    ((params.m_word_index_type != AUTO_WORD_INDEX_TYPE_NAME) &&
+                                    (params.m_word_index_type != WORD_INDEX_TYPE_NAMES[TRIE_WORD_INDEX_TYPES[0]]))) {
+                                run_model_types(params);
+                                return;
+                            }
 
                             //Connect to the language model
                             lm_configurator::connect(params.m_lm_params);
 
-                            //Override the reporting level for testing purposes
-                            //Logger::get_reporting_level() = DebugLevelsEnum::DEBUG2;
+                            //Compile the model into a binary snapshot if requested
+                            if (!params.m_snapshot_file_name.empty()) {
+                                lm_configurator::write_snapshot(params.m_snapshot_file_name);
+                            }
 
-                            //Execute the queries
-                            execute_queries(test_file);
+                            //Execute the queries if requested
+                            if (!params.m_query_file_name.empty()) {
+                                //Attempt to open the test file
+                                memory_mapped_file_reader test_file(params.m_query_file_name.c_str());
+
+                                //Assert that the query file is opened
+                                ASSERT_CONDITION_THROW(!test_file.is_open(), string("The Test Queries file: '")
+                                        + params.m_query_file_name + string("' does not exist!"));
+
+                                //Override the reporting level for testing purposes
+                                //Logger::get_reporting_level() = DebugLevelsEnum::DEBUG2;
+
+                                //Execute the queries, in the throughput mode if requested
+                                const double perplexity = (params.m_num_query_threads == 0) ?
+                                        execute_queries(test_file) :
+                                        execute_queries_parallel(test_file, params.m_num_query_threads);
+
+                                //Close the test file
+                                test_file.close();
+
+                                //Report on the payload quantization effect if requested
+                                if (params.m_is_quant_report) {
+                                    report_quantization(params, perplexity);
+                                }
+
+                                //Report on the m-gram id fingerprints effect if requested
+                                if (params.m_is_fp_report) {
+                                    report_fingerprints(params, perplexity);
+                                }
+                            }
 
                             //Deallocate the trie
                             LOG_USAGE << "Cleaning up memory ..." << END_LOG;
 
-                            //Close the test file
-                            test_file.close();
-
                             //Disconnect from the trie
                             lm_configurator::disconnect();
                         }
@@ -33,8 +33,10 @@
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/exceptions.hpp"
 #include "common/utils/text/string_utils.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
 
 #include "server/server_configs.hpp"
+#include "server/lm/lm_consts.hpp"
 #include "server/common/feature_id_registry.hpp"
 
 using namespace std;
@@ -42,6 +44,7 @@ using namespace std;
 using namespace uva::utils::exceptions;
 using namespace uva::utils::logging;
 using namespace uva::utils::text;
+using namespace uva::utils::containers;
 
 using namespace uva::smt::bpbd::server::common;
 
@@ -67,6 +70,16 @@ namespace uva {
                         static size_t LM_WEIGHT_GLOBAL_IDS[MAX_NUM_LM_FEATURES];
                         //The unknown word log_e probability parameter name
                         static const string LM_UNK_WORD_LOG_E_PROB_PARAM_NAME;
+                        //The number of model loading threads parameter name
+                        static const string LM_LOAD_THREADS_PARAM_NAME;
+                        //The query cache size bits parameter name
+                        static const string LM_QUERY_CACHE_BITS_PARAM_NAME;
+                        //The huge pages policy parameter name
+                        static const string LM_HUGE_PAGES_PARAM_NAME;
+                        //The phrase table vocabulary filter flag parameter name
+                        static const string LM_TM_VOCAB_FILTER_PARAM_NAME;
+                        //The shared memory segment name parameter name
+                        static const string LM_SHM_NAME_PARAM_NAME;
 
                         //The the connection string needed to connect to the model
                         string m_conn_string;
@@ -79,6 +92,19 @@ namespace uva {
                         bool m_is_0_lm_weight;
                         //Stores the unknown word probability in the log_e space
                         float m_unk_word_log_e_prob;
+                        //Stores the number of threads to be used for loading the model
+                        size_t m_num_load_threads;
+                        //Stores the number of bits of the per translation thread
+                        //query cache size, zero if the cache is disabled
+                        size_t m_query_cache_bits;
+                        //Stores the huge pages policy for the model tables
+                        huge_pages_policy m_huge_pages;
+                        //Stores the phrase table file name, only the m-grams consisting of its
+                        //target words are loaded, empty if all the m-grams are to be loaded
+                        string m_vocab_file_name;
+                        //Stores the name of the shared memory segment the model is
+                        //to be built in or attached from, empty if it is not shared
+                        string m_shm_name;
 
                         /**
                          * Allows to get the features weights used in the corresponding model.
@@ -118,6 +144,15 @@ namespace uva {
 
                             //Set the flag value, indicating whether the lambda is to be used
                             m_is_0_lm_weight = ((m_num_lambdas != 0) && (m_lambdas[0] != 1.0));
+
+                            //There must be at least one loading thread
+                            ASSERT_CONDITION_THROW((m_num_load_threads == 0),
+                                    string("The value of ") + LM_LOAD_THREADS_PARAM_NAME + string(" must be > 0!"));
+
+                            //The query cache must not be too large
+                            ASSERT_CONDITION_THROW((m_query_cache_bits > LM_QUERY_CACHE_BITS_MAX),
+                                    string("The value of ") + LM_QUERY_CACHE_BITS_PARAM_NAME +
+                                    string(" must be <= ") + to_string(LM_QUERY_CACHE_BITS_MAX));
                         }
                     };
 
@@ -137,6 +172,15 @@ namespace uva {
                                 params.m_lambdas, LM_FEATURE_WEIGHTS_DELIMITER_STR)
                                 << ", " << lm_parameters::LM_UNK_WORD_LOG_E_PROB_PARAM_NAME
                                 << " = " << params.m_unk_word_log_e_prob
+                                << ", " << lm_parameters::LM_LOAD_THREADS_PARAM_NAME
+                                << " = " << params.m_num_load_threads
+                                << ", " << lm_parameters::LM_QUERY_CACHE_BITS_PARAM_NAME
+                                << " = " << params.m_query_cache_bits
+                                << ", " << lm_parameters::LM_HUGE_PAGES_PARAM_NAME
+                                << " = " << huge_page_allocator::POLICY_NAMES[params.m_huge_pages]
+                                << ", vocab_file_name = " << params.m_vocab_file_name
+                                << ", " << lm_parameters::LM_SHM_NAME_PARAM_NAME
+                                << " = " << params.m_shm_name
                                 << " ]";
                     }
                 }
@@ -0,0 +1,207 @@
+/*
+ * File:   lm_remote_server.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 2:10 AM
+ */
+
+#ifndef LM_REMOTE_SERVER_HPP
+#define LM_REMOTE_SERVER_HPP
+
+#include <string>       // std::string
+#include <vector>       // std::vector
+#include <cstring>      // std::memcpy
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+#include "common/utils/threads/threads.hpp"
+
+#include "server/lm/lm_configs.hpp"
+#include "server/lm/lm_parameters.hpp"
+#include "server/lm/lm_configurator.hpp"
+#include "server/lm/proxy/lm_remote_protocol.hpp"
+
+using namespace std;
+
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+using namespace uva::utils::threads;
+
+using namespace uva::smt::bpbd::server::lm::proxy;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace lm {
+
+                    /**
+                     * This class represents the language model server, it serves the language
+                     * model connected by the lm_configurator to the remote language model proxies
+                     * of the translation servers. Each accepted connection is served by its own
+                     * thread with its own fast query proxy, so the per thread query cache works
+                     * the same as in the translation server.
+                     */
+                    class lm_remote_server {
+                    public:
+
+                        /**
+                         * The basic constructor
+                         * @param params the connected language model parameters
+                         * @param address the address to listen on, "tcp://host:port" or "unix://path"
+                         */
+                        lm_remote_server(const lm_parameters & params, const string & address)
+                        : m_params(params), m_address(address), m_handshake() {
+                            //Clear the handshake, including the padding, as it is compared by the clients
+                            memset(&m_handshake, 0, sizeof (m_handshake));
+
+                            //Get the handshake data from the model
+                            lm_fast_query_proxy & query = lm_configurator::allocate_fast_query_proxy();
+                            __lm_remote::set_handshake<lm_model_type>(m_params, query.get_unk_word_prob(),
+                                    query.get_begin_tag_uid(), query.get_end_tag_uid(), m_handshake);
+                            lm_configurator::dispose_fast_query_proxy(query);
+                        }
+
+                        /**
+                         * Allows to run the server, accepts the connections until the process is terminated
+                         */
+                        void run() {
+                            const int listen_desc = __lm_remote::open_socket(m_address, true);
+
+                            LOG_USAGE << "The LM server is listening on: " << m_address << END_LOG;
+
+                            while (true) {
+                                errno = 0;
+                                const int sock_desc = accept(listen_desc, NULL, NULL);
+                                if (sock_desc == -1) {
+                                    if (errno != EINTR) {
+                                        LOG_ERROR << "Could not accept an LM server connection, ERROR: "
+                                                << strerror(errno) << END_LOG;
+                                    }
+                                } else {
+                                    LOG_INFO << "Accepted the LM server connection: " << sock_desc << END_LOG;
+
+                                    //Serve the connection in a separate thread
+                                    __lm_remote::set_no_delay(sock_desc);
+                                    thread(&lm_remote_server::serve, this, sock_desc).detach();
+                                }
+                            }
+                        }
+
+                    private:
+                        //Stores the reference to the model parameters
+                        const lm_parameters & m_params;
+                        //Stores the address to listen on
+                        const string m_address;
+                        //Stores the handshake to be sent to the clients
+                        __lm_remote::s_handshake m_handshake;
+
+                        /**
+                         * Allows to serve the connection, until it is closed by the client
+                         * @param sock_desc the accepted socket descriptor
+                         */
+                        void serve(const int sock_desc) {
+                            lm_fast_query_proxy & query = lm_configurator::allocate_fast_query_proxy();
+                            try {
+                                //Declare the request and response data
+                                vector<uint8_t> request(__lm_remote::MAX_BATCH_BYTES);
+                                vector<word_uid> word_ids(__lm_remote::MAX_BATCH_SIZE * LM_MAX_QUERY_LEN);
+                                vector<lm_batch_query> batch(__lm_remote::MAX_BATCH_SIZE);
+                                vector<__lm_remote::s_query_result> results(__lm_remote::MAX_BATCH_SIZE);
+                                __lm_remote::s_batch_header header = {};
+
+                                //Send the handshake first
+                                __lm_remote::send_all(sock_desc, &m_handshake, sizeof (m_handshake));
+
+                                //Serve the batches until the connection is closed
+                                while (__lm_remote::recv_all(sock_desc, &header, sizeof (header))) {
+                                    ASSERT_CONDITION_THROW((header.m_num_queries > __lm_remote::MAX_BATCH_SIZE) ||
+                                            (header.m_num_bytes > __lm_remote::MAX_BATCH_BYTES),
+                                            string("Invalid LM batch size: ") + to_string(header.m_num_queries) +
+                                            string(" queries, ") + to_string(header.m_num_bytes) + string(" bytes"));
+                                    ASSERT_CONDITION_THROW(!__lm_remote::recv_all(sock_desc, request.data(), header.m_num_bytes),
+                                            "The LM server connection is closed in the middle of a batch!");
+
+                                    //Parse and execute the queries
+                                    parse_batch(request.data(), header, word_ids.data(), batch.data());
+                                    query.execute(header.m_num_queries, batch.data());
+
+                                    //Send the results back
+                                    for (uint32_t idx = 0; idx < header.m_num_queries; ++idx) {
+                                        memset(&results[idx], 0, sizeof (__lm_remote::s_query_result));
+                                        results[idx].m_prob = batch[idx].m_prob;
+                                        results[idx].m_min_level = batch[idx].m_min_level;
+                                        results[idx].m_state = batch[idx].m_state;
+                                    }
+                                    __lm_remote::send_all(sock_desc, results.data(),
+                                            header.m_num_queries * sizeof (__lm_remote::s_query_result));
+                                }
+
+                                LOG_INFO << "The LM server connection: " << sock_desc << " is closed by the client." << END_LOG;
+                            } catch (std::exception & ex) {
+                                LOG_ERROR << "Dropping the LM server connection: " << sock_desc << ", " << ex.what() << END_LOG;
+                            }
+                            lm_configurator::dispose_fast_query_proxy(query);
+                            ::close(sock_desc);
+                        }
+
+                        /**
+                         * Allows to parse and check the batch request
+                         * @param data the request data
+                         * @param header the request header
+                         * @param word_ids the buffer to store the query word ids in
+                         * @param batch [out] the queries to be set
+                         */
+                        static inline void parse_batch(const uint8_t * data, const __lm_remote::s_batch_header & header,
+                                word_uid * word_ids, lm_batch_query * batch) {
+                            const uint8_t * const end = data + header.m_num_bytes;
+                            for (uint32_t idx = 0; idx < header.m_num_queries; ++idx) {
+                                lm_batch_query & query = batch[idx];
+
+                                //Read the query lengths
+                                ASSERT_CONDITION_THROW((data + 2 * sizeof (phrase_length) > end), "Truncated LM batch request!");
+                                memcpy(&query.m_num_words, data, sizeof (phrase_length));
+                                memcpy(&query.m_min_level, data + sizeof (phrase_length), sizeof (phrase_length));
+                                data += 2 * sizeof (phrase_length);
+                                ASSERT_CONDITION_THROW((query.m_num_words == 0) || (query.m_num_words > LM_MAX_QUERY_LEN) ||
+                                        (query.m_min_level == 0) || (query.m_min_level > min<phrase_length>(query.m_num_words, LM_M_GRAM_LEVEL_MAX)),
+                                        string("Invalid LM query: ") + to_string(query.m_num_words) + string(" words, min level ") +
+                                        to_string(query.m_min_level));
+
+                                //Read the query word ids, they are copied to be aligned
+                                const size_t num_bytes = query.m_num_words * sizeof (word_uid);
+                                ASSERT_CONDITION_THROW((data + num_bytes > end), "Truncated LM batch request!");
+                                memcpy(word_ids, data, num_bytes);
+                                query.m_word_ids = word_ids;
+                                word_ids += LM_MAX_QUERY_LEN;
+                                data += num_bytes;
+                            }
+                            ASSERT_CONDITION_THROW((data != end), "Unexpected LM batch request data!");
+                        }
+                    };
+                }
+            }
+        }
+    }
+}
+
+#endif /* LM_REMOTE_SERVER_HPP */
+
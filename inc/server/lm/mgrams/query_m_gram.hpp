@@ -69,83 +69,54 @@ namespace uva {
                             }
 
                             /**
-                             * Allows to retrieve the hash value for the sub-m-gram 
-                             * defined by the parameters
+                             * Allows to retrieve the hash value for the sub-m-gram defined by the
+                             * parameters. The hash values of all the sub-m-grams, up to the maximum
+                             * m-gram level, are pre-computed when the m-gram is set, see set_m_gram.
                              * @param begin_word_idx the begin word index of the sub-m-gram
                              * @param end_word_idx the end word index of the sub-m-gram
                              * @return the hash value for the given sub-m-gram
                              */
-                            inline uint64_t get_hash(phrase_length begin_word_idx, const phrase_length end_word_idx) const {
-                                //Define the reference to the previous level
-                                phrase_length & prev_level_ref = const_cast<phrase_length &> (m_hash_level_row[begin_word_idx]);
-
-                                LOG_DEBUG1 << "Getting hash values for begin/end index: " << SSTR(begin_word_idx)
-                                        << "/" << SSTR(end_word_idx) << ", the previous computed begin level "
-                                        << "is: " << SSTR(prev_level_ref) << END_LOG;
-
-                                //Define the reference to the hash row
-                                uint64_t(& hash_row_ref)[QUERY_M_GRAM_MAX_LEN] = const_cast<uint64_t(&)[QUERY_M_GRAM_MAX_LEN]> (m_hash_matrix[begin_word_idx]);
-
-                                //Compute the current level
-                                const phrase_length curr_level = CURR_LEVEL_MAP[begin_word_idx][end_word_idx];
-                                //Check if the given hash is already available.
-                                if (curr_level > prev_level_ref) {
-                                    //Check if there has its been computed before for this row
-                                    if (prev_level_ref == M_GRAM_LEVEL_UNDEF) {
-                                        //If there has not been anything computed yet,
-                                        //then first initialize the starting word
-                                        hash_row_ref[begin_word_idx] = BASE::operator [](begin_word_idx);
-
-                                        LOG_DEBUG1 << "word[" << SSTR(begin_word_idx) << "] = "
-                                                << BASE::operator [](begin_word_idx)
-                                                << ", hash[" << SSTR(begin_word_idx) << "] = "
-                                                << hash_row_ref[begin_word_idx] << END_LOG;
-
-                                        ++begin_word_idx;
-                                    } else {
-                                        //This is the case of at least a bi-gram, but the actual
-                                        //begin word index is the one stored from before
-                                        begin_word_idx += prev_level_ref;
-                                    }
-
-                                    //Iterate on and compute the subsequent hashes, if any
-                                    for (; begin_word_idx <= end_word_idx; ++begin_word_idx) {
-                                        //Incrementally build up hash, using the previous hash value and the next word id
-                                        hash_row_ref[begin_word_idx] = combine_phrase_uids(hash_row_ref[begin_word_idx - 1], BASE::operator [](begin_word_idx));
-
-                                        LOG_DEBUG1 << "hash[" << SSTR(begin_word_idx) << "] = combine( word["
-                                                << SSTR(begin_word_idx) << "] = " << BASE::operator [](begin_word_idx)
-                                                << ", hash[" << SSTR(begin_word_idx - 1) << "] = "
-                                                << hash_row_ref[begin_word_idx - 1] << " ) = "
-                                                << hash_row_ref[begin_word_idx] << END_LOG;
-                                    }
-                                    //Set the processed level 
-                                    prev_level_ref = curr_level;
-                                }
+                            inline uint64_t get_hash(const phrase_length begin_word_idx, const phrase_length end_word_idx) const {
+                                ASSERT_SANITY_THROW(((begin_word_idx > end_word_idx) || (end_word_idx >= BASE::get_num_words()) ||
+                                        (end_word_idx - begin_word_idx >= LM_M_GRAM_LEVEL_MAX)), string("The sub-m-gram [")
+                                        + to_string(begin_word_idx) + string(", ") + to_string(end_word_idx) +
+                                        string("] hash is not pre-computed!"));
 
-                                LOG_DEBUG1 << "Resulting hash value: " << hash_row_ref[end_word_idx] << END_LOG;
+                                LOG_DEBUG1 << "The hash[" << SSTR(begin_word_idx) << ", " << SSTR(end_word_idx)
+                                        << "] = " << m_hash_matrix[begin_word_idx][end_word_idx] << END_LOG;
 
-                                //Return the hash value that must have been pre-computed
-                                return hash_row_ref[end_word_idx];
+                                return m_hash_matrix[begin_word_idx][end_word_idx];
                             }
 
                             /**
-                             * Tokenise a given piece of text into a space separated list of text pieces.
-                             * @param text the piece of text to tokenise
-                             * @param gram the gram container to put data into
+                             * Allows to set the m-gram word ids and to pre-compute the hash values of all
+                             * its sub-m-grams up to the maximum m-gram level. The hashes of each row, i.e.
+                             * of the sub-m-grams with the same begin word, are computed incrementally.
+                             * @param num_words the number of words in the m-gram
+                             * @param word_ids the m-gram word ids
                              */
                             inline void set_m_gram(const phrase_length num_words, const word_uid * word_ids) {
-                                //Set all the "computed hash level" flags to "undefined"
-                                memset(m_hash_level_row, M_GRAM_LEVEL_UNDEF, QUERY_M_GRAM_MAX_LEN * sizeof (phrase_length));
-
                                 //Set the word ids into the parent
                                 BASE::set_word_ids(num_words, word_ids);
+
+                                //Fill in the triangular table of the sub-m-gram hashes
+                                for (phrase_length begin_word_idx = 0; begin_word_idx < num_words; ++begin_word_idx) {
+                                    uint64_t(& hash_row_ref)[QUERY_M_GRAM_MAX_LEN] = m_hash_matrix[begin_word_idx];
+                                    const phrase_length last_word_idx = min<phrase_length>(
+                                            begin_word_idx + LM_M_GRAM_LEVEL_MAX, num_words) - 1;
+
+                                    //The uni-gram hash is the word id
+                                    hash_row_ref[begin_word_idx] = BASE::operator [](begin_word_idx);
+
+                                    //Incrementally build up hash, using the previous hash value and the next word id
+                                    for (phrase_length end_word_idx = begin_word_idx + 1; end_word_idx <= last_word_idx; ++end_word_idx) {
+                                        hash_row_ref[end_word_idx] = combine_phrase_uids(hash_row_ref[end_word_idx - 1], BASE::operator [](end_word_idx));
+                                    }
+                                }
                             }
 
                         private:
-                            //Stores the hash computed flags
-                            phrase_length m_hash_level_row[QUERY_M_GRAM_MAX_LEN];
-                            //Stores the computed hash values
+                            //Stores the pre-computed sub-m-gram hash values, indexed by the begin and end word indexes
                             uint64_t m_hash_matrix[QUERY_M_GRAM_MAX_LEN][QUERY_M_GRAM_MAX_LEN];
 
                             /**
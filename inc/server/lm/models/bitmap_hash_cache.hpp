@@ -35,12 +35,14 @@
 #include "server/lm/mgrams/model_m_gram.hpp"
 #include "common/utils/hashing_utils.hpp"
 #include "common/utils/math_utils.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
 
 using namespace std;
 
 using namespace uva::utils::math;
 using namespace uva::utils::logging;
 using namespace uva::utils::exceptions;
+using namespace uva::utils::containers;
 using namespace uva::smt::bpbd::server::lm::m_grams;
 using namespace uva::smt::bpbd::server::lm::identifiers;
 
@@ -64,18 +66,47 @@ namespace uva {
                             /**
                              * The basic constructor, does not do much - only default initialization
                              */
-                            BitmapHashCache() : m_num_buckets(0), m_data_ptr(NULL) {
+                            BitmapHashCache() : m_num_buckets(0), m_buckets_capacity(0), m_data_ptr(NULL), m_is_mapped(false) {
                             }
 
                             /**
                              * The basic destructor
                              */
                             virtual ~BitmapHashCache() {
-                                if (m_data_ptr != NULL) {
-                                    delete[] m_data_ptr;
+                                if ((m_data_ptr != NULL) && !m_is_mapped) {
+                                    huge_page_allocator::deallocate(m_data_ptr);
                                 }
                             }
 
+                            /**
+                             * Allows to write the cache data with the given binary writer
+                             * @param writer the binary writer to write the data with
+                             */
+                            template<typename WRITER_TYPE>
+                            inline void write(WRITER_TYPE & writer) const {
+                                writer.write(m_num_buckets);
+                                writer.write(m_data_ptr, NUM_BYTES_4_BITS(m_num_buckets));
+                            }
+
+                            /**
+                             * Allows to attach the cache to the data previously written by the
+                             * write method. The bitset is not copied but is used in place.
+                             * @param reader the binary reader to get the cache data from
+                             */
+                            template<typename READER_TYPE>
+                            inline void attach(READER_TYPE & reader) {
+                                if (DO_SANITY_CHECKS && (m_data_ptr != NULL)) {
+                                    THROW_EXCEPTION("The bitset is already pre-allocated!");
+                                }
+
+                                reader.read(m_num_buckets);
+                                m_buckets_capacity = m_num_buckets - 1;
+                                m_data_ptr = const_cast<uint8_t *> (reader.template get<uint8_t>(NUM_BYTES_4_BITS(m_num_buckets)));
+                                m_is_mapped = true;
+
+                                LOG_DEBUG << "Attached m_num_buckets: " << m_num_buckets << END_LOG;
+                            }
+
                             /**
                              * Allowo to pre-allocate memory for the bitset
                              * @param num_elems
@@ -96,8 +127,7 @@ namespace uva {
                                             << " m_num_buckets: " << m_num_buckets
                                             << " bytes: " << num_bytes << END_LOG;
 
-                                    m_data_ptr = new uint8_t[num_bytes];
-                                    fill_n(m_data_ptr, num_bytes, 0u);
+                                    m_data_ptr = huge_page_allocator::allocate<uint8_t>(num_bytes);
                                 } else {
                                     THROW_EXCEPTION("Trying to pre-allocate 0 elements for a BitmaphashCache!");
                                 }
@@ -149,6 +179,8 @@ namespace uva {
                             size_t m_buckets_capacity;
                             //Stores the data allocated for the bitset
                             uint8_t * m_data_ptr;
+                            //Stores the flag indicating whether the bitset is attached to external memory
+                            bool m_is_mapped;
 
                             /**
                              * Allows to get the bit position for the M-gram
@@ -0,0 +1,235 @@
+/*
+ * File:   bloom_hash_cache.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 4:20 PM
+ */
+
+#ifndef BLOOM_HASH_CACHE_HPP
+#define BLOOM_HASH_CACHE_HPP
+
+#include <cstdint>      //  std::uint8_t std::uint64_t
+#include <cmath>        //  std::log
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
+
+#include "server/lm/lm_consts.hpp"
+#include "server/lm/mgrams/model_m_gram.hpp"
+
+using namespace std;
+
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+using namespace uva::utils::containers;
+using namespace uva::smt::bpbd::server::lm::m_grams;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace lm {
+                    namespace caching {
+
+                        /**
+                         * This class is a cache-line-blocked Bloom filter to be used for caching the
+                         * presence of M-grams in the trie, it is an alternative to BitmapHashCache
+                         * with the same interface. Each M-gram hash selects one 64 byte block of the
+                         * filter and sets several bits inside that block only, so checking for an
+                         * M-gram, present or not, costs just one cache miss. Compared to one bit per
+                         * M-gram this gives a much lower false positive rate for the same memory.
+                         */
+                        class BloomHashCache {
+                        public:
+                            //Stores the number of 64 bit words in one filter block
+                            static constexpr uint32_t NUM_WORDS_IN_BLOCK = 8;
+                            //Stores the number of bits in one filter block
+                            static constexpr uint32_t NUM_BITS_IN_BLOCK = NUM_WORDS_IN_BLOCK * 64;
+                            //Stores the number of hash bits needed for one bit position inside a block
+                            static constexpr uint32_t NUM_POS_BITS = 9;
+                            //Stores the maximum number of bits set per M-gram, all positions come from one 64 bit value
+                            static constexpr uint32_t MAX_NUM_HASH_BITS = 64 / NUM_POS_BITS;
+
+                            /**
+                             * The basic constructor, does not do much - only default initialization
+                             */
+                            BloomHashCache() : m_num_blocks(0), m_num_hash_bits(0), m_alloc_ptr(NULL), m_data_ptr(NULL) {
+                            }
+
+                            /**
+                             * The basic destructor
+                             */
+                            virtual ~BloomHashCache() {
+                                if (m_alloc_ptr != NULL) {
+                                    huge_page_allocator::deallocate(m_alloc_ptr);
+                                }
+                            }
+
+                            /**
+                             * Allows to write the cache data with the given binary writer
+                             * @param writer the binary writer to write the data with
+                             */
+                            template<typename WRITER_TYPE>
+                            inline void write(WRITER_TYPE & writer) const {
+                                writer.write(m_num_blocks);
+                                writer.write(m_num_hash_bits);
+                                writer.write(m_data_ptr, m_num_blocks * NUM_WORDS_IN_BLOCK);
+                            }
+
+                            /**
+                             * Allows to attach the cache to the data previously written by the
+                             * write method. The filter is not copied but is used in place.
+                             * @param reader the binary reader to get the cache data from
+                             */
+                            template<typename READER_TYPE>
+                            inline void attach(READER_TYPE & reader) {
+                                if (DO_SANITY_CHECKS && (m_data_ptr != NULL)) {
+                                    THROW_EXCEPTION("The Bloom filter is already pre-allocated!");
+                                }
+
+                                reader.read(m_num_blocks);
+                                reader.read(m_num_hash_bits);
+                                m_data_ptr = const_cast<uint64_t *> (reader.template get<uint64_t>(m_num_blocks * NUM_WORDS_IN_BLOCK));
+
+                                LOG_DEBUG << "Attached m_num_blocks: " << m_num_blocks
+                                        << ", m_num_hash_bits: " << m_num_hash_bits << END_LOG;
+                            }
+
+                            /**
+                             * Allows to pre-allocate memory for the filter
+                             * @param num_elems the number of M-grams to be cached
+                             * @param bits_per_elem the number of filter bits per M-gram
+                             */
+                            inline void pre_allocate(const size_t num_elems, const uint8_t bits_per_elem) {
+                                if (DO_SANITY_CHECKS && (m_data_ptr != NULL)) {
+                                    THROW_EXCEPTION("The Bloom filter is already pre-allocated!");
+                                }
+
+                                if (num_elems != 0) {
+                                    //Compute the number of blocks, the block index is computed from 32 bits of the hash
+                                    m_num_blocks = (num_elems * bits_per_elem + NUM_BITS_IN_BLOCK - 1) / NUM_BITS_IN_BLOCK;
+                                    ASSERT_CONDITION_THROW((m_num_blocks > UINT32_MAX),
+                                            string("Too many Bloom filter blocks: ") + to_string(m_num_blocks));
+
+                                    //The optimal number of bits per M-gram is bits_per_elem * ln(2)
+                                    m_num_hash_bits = static_cast<uint32_t> (bits_per_elem * std::log(2.0) + 0.5);
+                                    if (m_num_hash_bits == 0) {
+                                        m_num_hash_bits = 1;
+                                    }
+                                    if (m_num_hash_bits > MAX_NUM_HASH_BITS) {
+                                        m_num_hash_bits = MAX_NUM_HASH_BITS;
+                                    }
+
+                                    LOG_DEBUG << "num_elems: " << num_elems << " m_num_blocks: " << m_num_blocks
+                                            << " m_num_hash_bits: " << m_num_hash_bits << " bytes: "
+                                            << m_num_blocks * NUM_WORDS_IN_BLOCK * sizeof (uint64_t) << END_LOG;
+
+                                    //Allocate one more block to align the data to the cache line
+                                    const size_t num_words = (m_num_blocks + 1) * NUM_WORDS_IN_BLOCK;
+                                    m_alloc_ptr = huge_page_allocator::allocate<uint64_t>(num_words);
+                                    const size_t offset = (NUM_BITS_IN_BLOCK / 8 - (reinterpret_cast<uintptr_t> (m_alloc_ptr) % (NUM_BITS_IN_BLOCK / 8))) % (NUM_BITS_IN_BLOCK / 8);
+                                    m_data_ptr = m_alloc_ptr + offset / sizeof (uint64_t);
+                                } else {
+                                    THROW_EXCEPTION("Trying to pre-allocate 0 elements for a BloomHashCache!");
+                                }
+                            }
+
+                            /**
+                             * Allows to add the M-gram to the cache
+                             * @param gram the M-gram to cache
+                             */
+                            inline void cache_m_gram_hash(const model_m_gram gram) {
+                                const uint_fast64_t key = gram.get_hash();
+
+                                LOG_DEBUG2 << "Adding M-gram: " << gram << ", hash: " << key << END_LOG;
+
+                                //Set the bits of the M-gram inside its block
+                                uint64_t * block = get_block(key);
+                                uint64_t bits = get_bits(key);
+                                for (uint32_t idx = 0; idx < m_num_hash_bits; ++idx) {
+                                    block[(bits >> 6) & (NUM_WORDS_IN_BLOCK - 1)] |= (static_cast<uint64_t> (1) << (bits & 63));
+                                    bits >>= NUM_POS_BITS;
+                                }
+                            }
+
+                            /**
+                             * Allows to check if the given sub-m-gram, defined by the begin_word_idx
+                             * and end_word_idx parameters, is potentially present in the trie.
+                             * @param key the m-gram key
+                             * @return true if the sub-m-gram is potentially present, otherwise false
+                             */
+                            inline bool is_hash_cached(uint_fast64_t key) const {
+                                //Check that all the bits of the M-gram are set inside its block
+                                const uint64_t * block = get_block(key);
+                                uint64_t bits = get_bits(key);
+                                for (uint32_t idx = 0; idx < m_num_hash_bits; ++idx) {
+                                    if (!(block[(bits >> 6) & (NUM_WORDS_IN_BLOCK - 1)] & (static_cast<uint64_t> (1) << (bits & 63)))) {
+                                        LOG_DEBUG2 << "The hash: " << key << " is not cached" << END_LOG;
+                                        return false;
+                                    }
+                                    bits >>= NUM_POS_BITS;
+                                }
+
+                                LOG_DEBUG2 << "The hash: " << key << " is potentially cached" << END_LOG;
+                                return true;
+                            }
+
+                        private:
+                            //Stores the number of filter blocks
+                            size_t m_num_blocks;
+                            //Stores the number of bits set per M-gram
+                            uint32_t m_num_hash_bits;
+                            //Stores the allocated data, NULL if the filter is attached to external memory
+                            uint64_t * m_alloc_ptr;
+                            //Stores the cache line aligned filter data
+                            uint64_t * m_data_ptr;
+
+                            /**
+                             * Allows to get the filter block for the given key, the block index is
+                             * computed from the lower 32 bits of the key without using the %.
+                             * @param key the M-gram key
+                             * @return the pointer to the first word of the block
+                             */
+                            inline uint64_t * get_block(const uint_fast64_t key) const {
+                                const uint64_t block_idx = ((key & UINT32_MAX) * m_num_blocks) >> 32;
+                                return m_data_ptr + block_idx * NUM_WORDS_IN_BLOCK;
+                            }
+
+                            /**
+                             * Allows to get the in-block bit positions for the given key, the
+                             * key is re-mixed so that these do not depend on the block index.
+                             * @param key the M-gram key
+                             * @return the value storing NUM_POS_BITS bits per position
+                             */
+                            static inline uint64_t get_bits(const uint_fast64_t key) {
+                                return (key * 0x9E3779B97F4A7C15ULL) >> (64 - NUM_POS_BITS * MAX_NUM_HASH_BITS);
+                            }
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* BLOOM_HASH_CACHE_HPP */
+
@@ -65,9 +65,12 @@ namespace uva {
                      * the lookup is O(log(n)), as we need to use binary searches there.
                      */
                     template<typename WordIndexType>
-                    class c2d_hybrid_trie : public layered_trie_base<c2d_hybrid_trie<WordIndexType>, WordIndexType, __C2DHybridTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> {
+                    class c2d_hybrid_trie : public layered_trie_base<c2d_hybrid_trie<WordIndexType>, WordIndexType, __C2DHybridTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, __C2DHybridTrie::PAYLOAD_QUANT_BITS> {
                     public:
-                        typedef layered_trie_base<c2d_hybrid_trie<WordIndexType>, WordIndexType, __C2DHybridTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> BASE;
+                        typedef layered_trie_base<c2d_hybrid_trie<WordIndexType>, WordIndexType, __C2DHybridTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, __C2DHybridTrie::PAYLOAD_QUANT_BITS> BASE;
+                        //Typedef the stored m-gram, 1 < m < n, and n-gram payload types
+                        typedef typename BASE::quantizer_type::m_gram_payload_type TMGramPayload;
+                        typedef typename BASE::quantizer_type::n_gram_payload_type TNGramPayload;
 
                         /**
                          * The basic class constructor, accepts memory factors that are the
@@ -168,7 +171,7 @@ namespace uva {
 
                                 //Store the payload
                                 if (CURR_LEVEL == LM_M_GRAM_LEVEL_MAX) {
-                                    m_n_gram_map_ptr->operator[](key) = gram.m_payload.m_prob;
+                                    this->m_quantizer.encode_n_gram(gram.m_payload, m_n_gram_map_ptr->operator[](key));
                                 } else {
                                     //Get the next context id
                                     const phrase_length level_idx = (CURR_LEVEL - BASE::MGRAM_IDX_OFFSET);
@@ -178,7 +181,7 @@ namespace uva {
                                     m_m_gram_map_ptrs[level_idx]->operator[](key) = next_ctx_id;
 
                                     //Return the reference to the piece of memory
-                                    m_m_gram_data[level_idx][next_ctx_id] = gram.m_payload;
+                                    this->m_quantizer.encode_m_gram(CURR_LEVEL, gram.m_payload, m_m_gram_data[level_idx][next_ctx_id]);
                                 }
                             }
                         }
@@ -225,8 +228,8 @@ namespace uva {
                                 if (get_ctx_id(level_idx, word_id, ctx_id)) {
                                     LOG_DEBUG << "level_idx: " << SSTR(level_idx) << ", ctx_id: " << ctx_id << END_LOG;
                                     //There is data found under this context
-                                    query.set_curr_payload(&m_m_gram_data[level_idx][ctx_id]);
-                                    LOG_DEBUG << "The payload is retrieved: " << m_m_gram_data[level_idx][ctx_id] << END_LOG;
+                                    this->m_quantizer.set_m_gram_payload(query, curr_level, m_m_gram_data[level_idx][ctx_id]);
+                                    LOG_DEBUG << "The payload is retrieved!" << END_LOG;
                                 } else {
                                     //The payload could not be found
                                     LOG_DEBUG1 << "Unable to find m-gram data for ctx_id: " << SSTR(ctx_id)
@@ -254,7 +257,7 @@ namespace uva {
                                 const TLongId key = put_32_32_in_64(ctx_id, word_id);
 
                                 //Search for the map for that context id
-                                TNGramsMap::const_iterator result = m_n_gram_map_ptr->find(key);
+                                typename TNGramsMap::const_iterator result = m_n_gram_map_ptr->find(key);
                                 if (result == m_n_gram_map_ptr->end()) {
                                     //The payload could not be found
                                     LOG_DEBUG1 << "Unable to find " << SSTR(LM_M_GRAM_LEVEL_MAX) << "-gram data for ctx_id: "
@@ -262,8 +265,8 @@ namespace uva {
                                     status = MGramStatusEnum::BAD_NO_PAYLOAD_MGS;
                                 } else {
                                     //There is data found under this context
-                                    query.set_curr_payload(&result->second);
-                                    LOG_DEBUG << "The payload is retrieved: " << result->second << END_LOG;
+                                    this->m_quantizer.set_n_gram_payload(query, result->second);
+                                    LOG_DEBUG << "The payload is retrieved!" << END_LOG;
                                 }
                             }
                         }
@@ -307,14 +310,14 @@ namespace uva {
                         TMGramsMap * m_m_gram_map_ptrs[BASE::NUM_M_GRAM_LEVELS];
                         //Stores the M-gram data for the M levels: 1 < M < N
                         //This is a two dimensional array
-                        m_gram_payload * m_m_gram_data[BASE::NUM_M_GRAM_LEVELS];
+                        TMGramPayload * m_m_gram_data[BASE::NUM_M_GRAM_LEVELS];
 
                         //The type of key,value pairs to be stored in the N Grams map
-                        typedef pair< const TLongId, prob_weight> TNGramEntry;
+                        typedef pair< const TLongId, TNGramPayload> TNGramEntry;
                         //The typedef for the N Grams map allocator
                         typedef greedy_memory_allocator< TNGramEntry > TNGramAllocator;
                         //The N Grams map type
-                        typedef unordered_map<TLongId, prob_weight, std::hash<TLongId>, std::equal_to<TLongId>, TNGramAllocator > TNGramsMap;
+                        typedef unordered_map<TLongId, TNGramPayload, std::hash<TLongId>, std::equal_to<TLongId>, TNGramAllocator > TNGramsMap;
                         //The actual data storage for the N Grams
                         TNGramAllocator * m_n_gram_alloc_ptr;
                         //The map storing the N-Grams, they do not have back-off values
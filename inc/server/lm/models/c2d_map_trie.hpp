@@ -82,9 +82,12 @@ namespace uva {
                      * 
                      */
                     template<typename WordIndexType>
-                    class c2d_map_trie : public layered_trie_base<c2d_map_trie<WordIndexType>, WordIndexType, __C2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> {
+                    class c2d_map_trie : public layered_trie_base<c2d_map_trie<WordIndexType>, WordIndexType, __C2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, __C2DMapTrie::PAYLOAD_QUANT_BITS> {
                     public:
-                        typedef layered_trie_base<c2d_map_trie<WordIndexType>, WordIndexType, __C2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> BASE;
+                        typedef layered_trie_base<c2d_map_trie<WordIndexType>, WordIndexType, __C2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, __C2DMapTrie::PAYLOAD_QUANT_BITS> BASE;
+                        //Typedef the stored m-gram, 1 < m < n, and n-gram payload types
+                        typedef typename BASE::quantizer_type::m_gram_payload_type TMGramPayload;
+                        typedef typename BASE::quantizer_type::n_gram_payload_type TNGramPayload;
 
                         /**
                          * The basic class constructor, accepts memory factors that are the
@@ -174,9 +177,10 @@ namespace uva {
 
                                 //Store the payload
                                 if (CURR_LEVEL == LM_M_GRAM_LEVEL_MAX) {
-                                    m_n_gram_map_ptr->operator[](ctx_id) = gram.m_payload.m_prob;
+                                    this->m_quantizer.encode_n_gram(gram.m_payload, m_n_gram_map_ptr->operator[](ctx_id));
                                 } else {
-                                    m_m_gram_map_ptrs[CURR_LEVEL - BASE::MGRAM_IDX_OFFSET]->operator[](ctx_id) = gram.m_payload;
+                                    this->m_quantizer.encode_m_gram(CURR_LEVEL, gram.m_payload,
+                                            m_m_gram_map_ptrs[CURR_LEVEL - BASE::MGRAM_IDX_OFFSET]->operator[](ctx_id));
                                 }
                             }
                         }
@@ -222,7 +226,7 @@ namespace uva {
                                 const phrase_length & level_idx = query.get_curr_level_m2();
                                 if (get_ctx_id(level_idx, word_id, ctx_id)) {
                                     LOG_DEBUG << "level_idx: " << SSTR(level_idx) << ", ctx_id: " << ctx_id << END_LOG;
-                                    TMGramsMap::const_iterator result = m_m_gram_map_ptrs[level_idx]->find(ctx_id);
+                                    typename TMGramsMap::const_iterator result = m_m_gram_map_ptrs[level_idx]->find(ctx_id);
                                     if (result == m_m_gram_map_ptrs[level_idx]->end()) {
                                         //The payload could not be found
                                         LOG_DEBUG1 << "Unable to find m-gram data for ctx_id: " << SSTR(ctx_id)
@@ -230,8 +234,8 @@ namespace uva {
                                         status = MGramStatusEnum::BAD_NO_PAYLOAD_MGS;
                                     } else {
                                         //There is data found under this context
-                                        query.set_curr_payload(&result->second);
-                                        LOG_DEBUG << "The payload is retrieved: " << result->second << END_LOG;
+                                        this->m_quantizer.set_m_gram_payload(query, curr_level, result->second);
+                                        LOG_DEBUG << "The payload is retrieved!" << END_LOG;
                                     }
                                 } else {
                                     //The payload could not be found
@@ -263,7 +267,7 @@ namespace uva {
                                 const phrase_length & level_idx = query.get_curr_level_m2();
                                 if (get_ctx_id(level_idx, word_id, ctx_id)) {
                                     LOG_DEBUG << "ctx_id: " << ctx_id << END_LOG;
-                                    TNGramsMap::const_iterator result = m_n_gram_map_ptr->find(ctx_id);
+                                    typename TNGramsMap::const_iterator result = m_n_gram_map_ptr->find(ctx_id);
                                     if (result == m_n_gram_map_ptr->end()) {
                                         //The payload could not be found
                                         LOG_DEBUG1 << "Unable to find " << SSTR(LM_M_GRAM_LEVEL_MAX) << "-gram data for ctx_id: "
@@ -271,8 +275,8 @@ namespace uva {
                                         status = MGramStatusEnum::BAD_NO_PAYLOAD_MGS;
                                     } else {
                                         //There is data found under this context
-                                        query.set_curr_payload(&result->second);
-                                        LOG_DEBUG << "The payload is retrieved: " << result->second << END_LOG;
+                                        this->m_quantizer.set_n_gram_payload(query, result->second);
+                                        LOG_DEBUG << "The payload is retrieved!" << END_LOG;
                                     }
                                 } else {
                                     //The payload could not be found
@@ -306,22 +310,22 @@ namespace uva {
                         m_gram_payload * m_1_gram_data;
 
                         //The type of key,value pairs to be stored in the M Grams map
-                        typedef pair< const TLongId, m_gram_payload> TMGramEntry;
+                        typedef pair< const TLongId, TMGramPayload> TMGramEntry;
                         //The typedef for the M Grams map allocator
                         typedef greedy_memory_allocator< TMGramEntry > TMGramAllocator;
                         //The N Grams map type
-                        typedef unordered_map<TLongId, m_gram_payload, std::hash<TLongId>, std::equal_to<TLongId>, TMGramAllocator > TMGramsMap;
+                        typedef unordered_map<TLongId, TMGramPayload, std::hash<TLongId>, std::equal_to<TLongId>, TMGramAllocator > TMGramsMap;
                         //The actual data storage for the M Grams for 1 < M < N
                         TMGramAllocator * m_m_gram_alloc_ptrs[LM_M_GRAM_LEVEL_MAX - BASE::MGRAM_IDX_OFFSET];
                         //The array of maps map storing M-grams for 1 < M < N
                         TMGramsMap * m_m_gram_map_ptrs[LM_M_GRAM_LEVEL_MAX - BASE::MGRAM_IDX_OFFSET];
 
                         //The type of key,value pairs to be stored in the N Grams map
-                        typedef pair< const TLongId, prob_weight> TNGramEntry;
+                        typedef pair< const TLongId, TNGramPayload> TNGramEntry;
                         //The typedef for the N Grams map allocator
                         typedef greedy_memory_allocator< TNGramEntry > TNGramAllocator;
                         //The N Grams map type
-                        typedef unordered_map<TLongId, prob_weight, std::hash<TLongId>, std::equal_to<TLongId>, TNGramAllocator > TNGramsMap;
+                        typedef unordered_map<TLongId, TNGramPayload, std::hash<TLongId>, std::equal_to<TLongId>, TNGramAllocator > TNGramsMap;
                         //The actual data storage for the N Grams
                         TNGramAllocator * m_n_gram_alloc_ptr;
                         //The map storing the N-Grams, they do not have back-off values
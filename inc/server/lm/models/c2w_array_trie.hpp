@@ -27,6 +27,7 @@
 #define C2WORDEREDARRAYTRIE_HPP
 
 #include <string>       // std::string
+#include <vector>       // std::vector
 
 #include "server/lm/lm_consts.hpp"
 #include "common/utils/logging/logger.hpp"
@@ -36,9 +37,13 @@
 #include "server/lm/dictionaries/aword_index.hpp"
 #include "server/lm/dictionaries/hashing_word_index.hpp"
 #include "common/utils/containers/array_utils.hpp"
+#include "common/utils/containers/bit_packed_array.hpp"
+#include "common/utils/containers/elias_fano_sequence.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
 
 using namespace std;
 using namespace uva::smt::bpbd::server::lm::dictionary;
+using namespace uva::utils::containers;
 using namespace uva::utils::containers::utils;
 
 namespace uva {
@@ -128,6 +133,123 @@ namespace uva {
                         inline bool operator==(const TCtxIdProbData & one, const TCtxIdProbData & two) {
                             return (compare(one, two) == 0);
                         };
+
+                        /**
+                         * This is the ordering of the N-gram data for the bit packing,
+                         * the N-grams are grouped by the context id then the word id.
+                         * @param one the first object to compare
+                         * @param two the second object to compare
+                         * @return true if (ctx_id,word_id) < (ctx_id,word_id)
+                         */
+                        inline bool is_less_ctx_word(const TCtxIdProbData & one, const TCtxIdProbData & two) {
+                            return (one.ctx_id < two.ctx_id) || ((one.ctx_id == two.ctx_id) && (one.word_id < two.word_id));
+                        }
+
+                        /**
+                         * This class stores one trie level in the bit packed form. The level's
+                         * entries are grouped by their context ids and sorted by the word ids
+                         * within the group. The group begin indexes, one per context id, are
+                         * Elias-Fano encoded, the word ids are bit packed with just as many bits
+                         * as needed for the largest word id, and the payloads are kept in a
+                         * separate plain array. The entry index is the next context id, as in
+                         * the plain array. An entry is found by getting its group range from
+                         * the Elias-Fano sequence and binary searching the packed word ids.
+                         * @param PAYLOAD_TYPE the entry payload type
+                         */
+                        template<typename PAYLOAD_TYPE>
+                        class bit_packed_level {
+                        public:
+
+                            /**
+                             * The basic constructor
+                             */
+                            bit_packed_level() : m_ctx_begins(), m_word_ids(), m_payloads(NULL) {
+                            }
+
+                            /**
+                             * The basic destructor
+                             */
+                            ~bit_packed_level() {
+                                huge_page_allocator::deallocate(m_payloads);
+                            }
+
+                            /**
+                             * Allows to allocate the level
+                             * @param ctx_begins the entry group begin indexes, one per context id plus the end index
+                             * @param num_entries the number of entries, including the reserved ones
+                             * @param max_word_id the maximum word id
+                             */
+                            inline void allocate(const vector<uint64_t> & ctx_begins, const uint64_t num_entries, const uint64_t max_word_id) {
+                                m_ctx_begins.build(ctx_begins.data(), ctx_begins.size());
+                                m_word_ids.allocate(num_entries, bit_packed_array::get_num_bits(max_word_id));
+                                m_payloads = huge_page_allocator::allocate<PAYLOAD_TYPE>(num_entries);
+                            }
+
+                            /**
+                             * Allows to set the entry
+                             * @param idx the entry index
+                             * @param word_id the entry word id
+                             * @param payload the entry payload
+                             */
+                            inline void set(const uint64_t idx, const TShortId word_id, const PAYLOAD_TYPE & payload) {
+                                m_word_ids.set(idx, word_id);
+                                m_payloads[idx] = payload;
+                            }
+
+                            /**
+                             * Allows to find the entry index for the given context and word ids
+                             * @param ctx_id the context id
+                             * @param word_id the word id
+                             * @param idx [out] the found entry index
+                             * @return true if the entry is found, otherwise false
+                             */
+                            inline bool find(const TLongId ctx_id, const TShortId word_id, TLongId & idx) const {
+                                uint64_t l_idx = 0, u_idx = 0;
+                                m_ctx_begins.get_pair(ctx_id, l_idx, u_idx);
+
+                                //Binary search for the word id in [l_idx, u_idx)
+                                while (l_idx < u_idx) {
+                                    const uint64_t mid_idx = (l_idx + u_idx) >> 1;
+                                    const uint64_t mid_word_id = m_word_ids.get(mid_idx);
+                                    if (mid_word_id < word_id) {
+                                        l_idx = mid_idx + 1;
+                                    } else {
+                                        if (mid_word_id == word_id) {
+                                            idx = mid_idx;
+                                            return true;
+                                        }
+                                        u_idx = mid_idx;
+                                    }
+                                }
+                                return false;
+                            }
+
+                            /**
+                             * Allows to get the entry payload
+                             * @param idx the entry index
+                             * @return the reference to the payload
+                             */
+                            inline const PAYLOAD_TYPE & get_payload(const TLongId idx) const {
+                                return m_payloads[idx];
+                            }
+
+                            /**
+                             * Allows to get the number of bytes taken by the level
+                             * @return the number of bytes
+                             */
+                            inline uint64_t get_num_bytes() const {
+                                return m_ctx_begins.get_num_bytes() + m_word_ids.get_num_bytes()
+                                        + m_word_ids.size() * sizeof (PAYLOAD_TYPE);
+                            }
+
+                        private:
+                            //Stores the entry group begin indexes per context id
+                            elias_fano_sequence m_ctx_begins;
+                            //Stores the entry word ids
+                            bit_packed_array m_word_ids;
+                            //Stores the entry payloads
+                            PAYLOAD_TYPE * m_payloads;
+                        };
                     }
 
                     /**
@@ -138,12 +260,18 @@ namespace uva {
                      * 1-Grams. The order is assumed to be lexicographical as in the ARPA
                      * files! This is also checked if the sanity checks are on see Globals.hpp!
                      * 
+                     * In the bit packed variant, once all the M-grams of a level are read
+                     * and sorted, the level is converted into a __C2WArrayTrie::bit_packed_level
+                     * and the plain arrays are freed. This takes less memory at the price
+                     * of slower look-ups.
+                     * 
                      * @param N the maximum number of levels in the trie.
+                     * @param IS_BIT_PACKED true for the bit packed variant of the trie
                      */
-                    template<typename WordIndexType>
-                    class c2w_array_trie : public layered_trie_base<c2w_array_trie<WordIndexType>, WordIndexType, __C2WArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> {
+                    template<typename WordIndexType, bool IS_BIT_PACKED = false>
+                    class c2w_array_trie : public layered_trie_base<c2w_array_trie<WordIndexType, IS_BIT_PACKED>, WordIndexType, __C2WArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> {
                     public:
-                        typedef layered_trie_base<c2w_array_trie<WordIndexType>, WordIndexType, __C2WArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> BASE;
+                        typedef layered_trie_base<c2w_array_trie<WordIndexType, IS_BIT_PACKED>, WordIndexType, __C2WArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> BASE;
 
                         /**
                          * The basic constructor
@@ -174,6 +302,15 @@ namespace uva {
                                     << "-gram with word_id: " << SSTR(word_id) << ", ctx_id: "
                                     << SSTR(ctx_id) << END_LOG;
 
+                            //The bit packed level is searched for the entry index directly
+                            if (IS_BIT_PACKED) {
+                                if (m_packed_m_gram_data[level_idx].find(ctx_id, word_id, ctx_id)) {
+                                    LOG_DEBUG2 << "The next ctx_id for word_id: " << SSTR(word_id) << ", is: " << SSTR(ctx_id) << END_LOG;
+                                    return true;
+                                }
+                                return false;
+                            }
+
                             //First get the sub-array reference. Note that, even if it is the 2-Gram
                             //case and the previous word is unknown (ctx_id == 0) we still can use
                             //the ctx_id to get the data entry. The reason is that we allocated memory
@@ -200,7 +337,8 @@ namespace uva {
                          * Allows to log the information about the instantiated trie type
                          */
                         inline void log_model_type_info() const {
-                            LOG_USAGE << "Using the <" << __FILENAME__ << "> model." << END_LOG;
+                            LOG_USAGE << "Using the <" << __FILENAME__ << "> model"
+                                    << (IS_BIT_PACKED ? ", bit packed." : ".") << END_LOG;
                         }
 
                         /**
@@ -268,7 +406,7 @@ namespace uva {
                                 //Define the context id variable
                                 TLongId ctx_id = UNKNOWN_WORD_ID;
                                 //Obtain the m-gram context id
-                                __LayeredTrieBase::get_context_id<c2w_array_trie<WordIndexType>, CURR_LEVEL, debug_levels_enum::DEBUG2>(*this, gram, ctx_id);
+                                __LayeredTrieBase::get_context_id<c2w_array_trie<WordIndexType, IS_BIT_PACKED>, CURR_LEVEL, debug_levels_enum::DEBUG2>(*this, gram, ctx_id);
 
                                 if (CURR_LEVEL == LM_M_GRAM_LEVEL_MAX) {
                                     //Get the new n-gram index
@@ -347,8 +485,11 @@ namespace uva {
                                 if (get_ctx_id(level_idx, word_id, ctx_id)) {
                                     LOG_DEBUG << "level_idx: " << SSTR(level_idx) << ", ctx_id: " << ctx_id << END_LOG;
                                     //There is data found under this context
-                                    query.set_curr_payload(&m_m_gram_data[level_idx][ctx_id].payload);
-                                    LOG_DEBUG << "The payload is retrieved: " << m_m_gram_data[level_idx][ctx_id].payload << END_LOG;
+                                    const m_gram_payload & payload = IS_BIT_PACKED ?
+                                            m_packed_m_gram_data[level_idx].get_payload(ctx_id) :
+                                            m_m_gram_data[level_idx][ctx_id].payload;
+                                    query.set_curr_payload(&payload);
+                                    LOG_DEBUG << "The payload is retrieved: " << payload << END_LOG;
                                 } else {
                                     //The payload could not be found
                                     LOG_DEBUG1 << "Unable to find m-gram data for ctx_id: " << SSTR(ctx_id)
@@ -383,7 +524,12 @@ namespace uva {
 
                                 //Search for the index using binary search
                                 TShortId idx = BASE::UNDEFINED_ARR_IDX;
-                                if (my_bsearch_wordId_ctxId<TCtxIdProbEntry>(m_n_gram_data, BASE::FIRST_VALID_CTX_ID,
+                                TLongId packed_idx = BASE::UNDEFINED_ARR_IDX;
+                                if (IS_BIT_PACKED && m_packed_n_gram_data.find(ctx_id, word_id, packed_idx)) {
+                                    //Return the data
+                                    query.set_curr_payload(&m_packed_n_gram_data.get_payload(packed_idx));
+                                    LOG_DEBUG << "The payload is retrieved: " << m_packed_n_gram_data.get_payload(packed_idx) << END_LOG;
+                                } else if (!IS_BIT_PACKED && my_bsearch_wordId_ctxId<TCtxIdProbEntry>(m_n_gram_data, BASE::FIRST_VALID_CTX_ID,
                                         m_m_n_gram_num_ctx_ids[BASE::N_GRAM_IDX_IN_M_N_ARR] - 1, word_id, ctx_id, idx)) {
                                     //Return the data
                                     query.set_curr_payload(&m_n_gram_data[idx].prob);
@@ -442,6 +588,11 @@ namespace uva {
                                     my_sort<TWordIdPBEntry>(&m_m_gram_data[mgram_idx][info.begin_idx], (info.end_idx - info.begin_idx) + 1);
                                 }
                             }
+
+                            //Convert the level into the bit packed form if needed
+                            if (IS_BIT_PACKED) {
+                                pack_m_grams(mgram_idx, num_prev_ctx);
+                            }
                         }
 
                         inline void post_n_grams() {
@@ -453,9 +604,100 @@ namespace uva {
                             //Also, I did not yet see any performance advantages compared to sort!
                             //Actually the qsort provided here was 50% slower on a 20 Gb language
                             //model when compared to the str::sort!
-                            my_sort<TCtxIdProbEntry>(m_n_gram_data, m_m_n_gram_num_ctx_ids[BASE::N_GRAM_IDX_IN_M_N_ARR]);
+                            if (IS_BIT_PACKED) {
+                                //The bit packed level groups the N-grams by the context ids
+                                my_sort<TCtxIdProbEntry>(m_n_gram_data, m_m_n_gram_num_ctx_ids[BASE::N_GRAM_IDX_IN_M_N_ARR],
+                                        __C2WArrayTrie::is_less_ctx_word);
+                                pack_n_grams();
+                            } else {
+                                my_sort<TCtxIdProbEntry>(m_n_gram_data, m_m_n_gram_num_ctx_ids[BASE::N_GRAM_IDX_IN_M_N_ARR]);
+                            }
                         };
 
+                        /**
+                         * Allows to convert the M-gram level, 1 < M < N, into the bit packed form.
+                         * The sorted context groups are copied in the order of their context ids.
+                         * @param mgram_idx the m-gram level index
+                         * @param num_prev_ctx the number of the previous level context ids
+                         */
+                        inline void pack_m_grams(const phrase_length mgram_idx, const size_t num_prev_ctx) {
+                            //Compute the group begin indexes, the first index is reserved
+                            vector<uint64_t> ctx_begins(num_prev_ctx + 1);
+                            uint64_t next_idx = BASE::FIRST_VALID_CTX_ID;
+                            for (size_t ctx_id = 0; ctx_id < num_prev_ctx; ++ctx_id) {
+                                ctx_begins[ctx_id] = next_idx;
+                                const TSubArrReference & info = m_m_gram_ctx_2_data[mgram_idx][ctx_id];
+                                if (info.begin_idx != BASE::UNDEFINED_ARR_IDX) {
+                                    next_idx += (info.end_idx - info.begin_idx) + 1;
+                                }
+                            }
+                            ctx_begins[num_prev_ctx] = next_idx;
+
+                            //Copy the entries into the bit packed level
+                            __C2WArrayTrie::bit_packed_level<m_gram_payload> & level = m_packed_m_gram_data[mgram_idx];
+                            level.allocate(ctx_begins, m_m_n_gram_num_ctx_ids[mgram_idx], m_one_gram_arr_size);
+                            for (size_t ctx_id = 0; ctx_id < num_prev_ctx; ++ctx_id) {
+                                const TSubArrReference & info = m_m_gram_ctx_2_data[mgram_idx][ctx_id];
+                                if (info.begin_idx != BASE::UNDEFINED_ARR_IDX) {
+                                    uint64_t idx = ctx_begins[ctx_id];
+                                    for (TShortId arr_idx = info.begin_idx; arr_idx <= info.end_idx; ++arr_idx) {
+                                        const TWordIdPBEntry & entry = m_m_gram_data[mgram_idx][arr_idx];
+                                        level.set(idx++, entry.id, entry.payload);
+                                    }
+                                }
+                            }
+
+                            //Report on the memory and free the plain arrays
+                            report_packing(mgram_idx + BASE::MGRAM_IDX_OFFSET, num_prev_ctx * sizeof (TSubArrReference)
+                                    + m_m_n_gram_num_ctx_ids[mgram_idx] * sizeof (TWordIdPBEntry), level.get_num_bytes());
+                            huge_page_allocator::deallocate(m_m_gram_ctx_2_data[mgram_idx]);
+                            m_m_gram_ctx_2_data[mgram_idx] = NULL;
+                            huge_page_allocator::deallocate(m_m_gram_data[mgram_idx]);
+                            m_m_gram_data[mgram_idx] = NULL;
+                        }
+
+                        /**
+                         * Allows to convert the N-gram level into the bit packed form,
+                         * the N-grams are expected to be sorted by context then word id.
+                         */
+                        inline void pack_n_grams() {
+                            const TShortId num_entries = m_m_n_gram_num_ctx_ids[BASE::N_GRAM_IDX_IN_M_N_ARR];
+                            const size_t num_prev_ctx = (LM_M_GRAM_LEVEL_MAX == M_GRAM_LEVEL_2) ?
+                                    m_one_gram_arr_size : m_m_n_gram_num_ctx_ids[BASE::N_GRAM_IDX_IN_M_N_ARR - 1];
+
+                            //Compute the group begin indexes from the context id counts, the first index is reserved
+                            vector<uint64_t> ctx_begins(num_prev_ctx + 1, 0);
+                            for (TShortId idx = BASE::FIRST_VALID_CTX_ID; idx < num_entries; ++idx) {
+                                ++ctx_begins[m_n_gram_data[idx].ctx_id + 1];
+                            }
+                            ctx_begins[0] = BASE::FIRST_VALID_CTX_ID;
+                            for (size_t ctx_id = 1; ctx_id <= num_prev_ctx; ++ctx_id) {
+                                ctx_begins[ctx_id] += ctx_begins[ctx_id - 1];
+                            }
+
+                            //Copy the entries into the bit packed level, they are in order
+                            m_packed_n_gram_data.allocate(ctx_begins, num_entries, m_one_gram_arr_size);
+                            for (TShortId idx = BASE::FIRST_VALID_CTX_ID; idx < num_entries; ++idx) {
+                                m_packed_n_gram_data.set(idx, m_n_gram_data[idx].word_id, m_n_gram_data[idx].prob);
+                            }
+
+                            //Report on the memory and free the plain array
+                            report_packing(LM_M_GRAM_LEVEL_MAX, num_entries * sizeof (TCtxIdProbEntry), m_packed_n_gram_data.get_num_bytes());
+                            huge_page_allocator::deallocate(m_n_gram_data);
+                            m_n_gram_data = NULL;
+                        }
+
+                        /**
+                         * Allows to report on the memory saved by the bit packing of the level
+                         * @param level the M-gram level
+                         * @param plain_bytes the number of bytes taken by the plain arrays
+                         * @param packed_bytes the number of bytes taken by the bit packed level
+                         */
+                        static inline void report_packing(const phrase_length level, const uint64_t plain_bytes, const uint64_t packed_bytes) {
+                            LOG_USAGE << "The " << SSTR(level) << "-grams are bit packed into " << packed_bytes
+                                    << " bytes instead of " << plain_bytes << " bytes" << END_LOG;
+                        }
+
                     private:
                         //Stores the pointer to the UNK word payload
                         m_gram_payload * m_unk_data;
@@ -473,6 +715,11 @@ namespace uva {
                         //Stores the N-gram data
                         TCtxIdProbEntry * m_n_gram_data;
 
+                        //Stores the bit packed M-gram data for the M levels: 1 < M < N
+                        __C2WArrayTrie::bit_packed_level<m_gram_payload> m_packed_m_gram_data[BASE::NUM_M_GRAM_LEVELS];
+                        //Stores the bit packed N-gram data
+                        __C2WArrayTrie::bit_packed_level<prob_weight> m_packed_n_gram_data;
+
                         //Stores the size of the One-gram
                         TShortId m_one_gram_arr_size;
                         //Stores the maximum number of context id  per M-gram level: 1 < M <= N
@@ -486,6 +733,16 @@ namespace uva {
                     typedef c2w_array_trie<basic_optimizing_word_index > TC2WArrayTrieOptBasic;
                     typedef c2w_array_trie<counting_optimizing_word_index > TC2WArrayTrieOptCount;
                     typedef c2w_array_trie<hashing_word_index > TC2WArrayTrieHashing;
+
+                    typedef c2w_array_trie<basic_word_index, true > TC2WPackedTrieBasic;
+                    typedef c2w_array_trie<counting_word_index, true > TC2WPackedTrieCount;
+                    typedef c2w_array_trie<basic_optimizing_word_index, true > TC2WPackedTrieOptBasic;
+                    typedef c2w_array_trie<counting_optimizing_word_index, true > TC2WPackedTrieOptCount;
+                    typedef c2w_array_trie<hashing_word_index, true > TC2WPackedTrieHashing;
+
+                    //Define the bit packed trie template, with the word index type as the only parameter
+                    template<typename WordIndexType>
+                    using c2w_packed_trie = c2w_array_trie<WordIndexType, true>;
                 }
             }
         }
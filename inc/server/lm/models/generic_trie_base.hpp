@@ -27,6 +27,7 @@
 #define GENERICTRIEBASE_HPP
 
 #include <string>       // std::string
+#include <type_traits>  // std::conditional
 
 #include "server/lm/lm_consts.hpp"
 #include "common/utils/exceptions.hpp"
@@ -36,6 +37,8 @@
 #include "server/lm/mgrams/query_m_gram.hpp"
 
 #include "common/utils/file/text_piece_reader.hpp"
+#include "common/utils/file/binary_file_writer.hpp"
+#include "common/utils/file/binary_mmap_reader.hpp"
 
 #include "server/lm/dictionaries/basic_word_index.hpp"
 #include "server/lm/dictionaries/counting_word_index.hpp"
@@ -45,6 +48,8 @@
 #include "server/lm/models/m_gram_query.hpp"
 #include "server/lm/models/word_index_trie_base.hpp"
 #include "server/lm/models/bitmap_hash_cache.hpp"
+#include "server/lm/models/bloom_hash_cache.hpp"
+#include "server/lm/models/payload_quantizer.hpp"
 
 using namespace std;
 using namespace uva::utils::logging;
@@ -53,6 +58,7 @@ using namespace uva::smt::bpbd::server::lm::dictionary;
 using namespace uva::smt::bpbd::server::lm::m_grams;
 using namespace uva::utils::math::bits;
 using namespace uva::smt::bpbd::server::lm::caching;
+using namespace uva::smt::bpbd::server::lm::quantization;
 
 namespace uva {
     namespace smt {
@@ -94,16 +100,23 @@ namespace uva {
 
                     /**
                      * This class defined the trie interface and functionality that is expected by the TrieDriver class
+                     * @param PAYLOAD_QUANT_BITS the number of bits for the quantized m-gram payloads, 0 for no quantization
                      */
-                    template<typename TrieType, typename WordIndexType, uint8_t BITMAP_HASH_CACHE_BUCKETS_FACTOR>
+                    template<typename TrieType, typename WordIndexType, uint8_t BITMAP_HASH_CACHE_BUCKETS_FACTOR, uint8_t PAYLOAD_QUANT_BITS = 0 >
                     class generic_trie_base : public word_index_trie_base<WordIndexType> {
                     public:
                         //Typedef the base class
                         typedef word_index_trie_base<WordIndexType> BASE;
 
+                        //Typedef the payload quantizer
+                        typedef payload_quantizer<PAYLOAD_QUANT_BITS> quantizer_type;
+
                         //The flag indicating if the bitmap hash caching is needed
                         const static bool NEEDS_BITMAP_HASH_CACHE = (BITMAP_HASH_CACHE_BUCKETS_FACTOR > 1);
 
+                        //Typedef the m-gram presence cache, the bitmap or the Bloom filter
+                        typedef typename conditional<__HashCache::IS_BLOOM_FILTER, BloomHashCache, BitmapHashCache>::type hash_cache_type;
+
                         //The offset, relative to the M-gram level M for the m-gram mapping array index
                         const static phrase_length MGRAM_IDX_OFFSET = 2;
 
@@ -151,6 +164,27 @@ namespace uva {
                             return false;
                         }
 
+                        /**
+                         * Allows to indicate whether the trie can prefetch the sub-m-gram payload data before the query execution
+                         * @return returns false, by default the payload location depends on the previous look-ups, e.g. context ids
+                         */
+                        static constexpr bool is_payload_prefetch_supported() {
+                            return false;
+                        }
+
+                        /**
+                         * Allows to issue a software prefetch for the payload of the current sub-m-gram of the
+                         * query, defined by the current begin and end word indexes. Is to be called in two stages,
+                         * first with is_elem == false and then with is_elem == true, the last stage expects
+                         * the data prefetched by the first stage to be in cache already.
+                         * @param is_elem the prefetching stage flag
+                         * @param query the query containing the actual query data
+                         */
+                        template<bool is_elem>
+                        inline void prefetch_payload(m_gram_query & query) const {
+                            THROW_MUST_NOT_CALL();
+                        }
+
                         /**
                          * @see WordIndexTrieBase
                          */
@@ -166,6 +200,67 @@ namespace uva {
                             }
                         }
 
+                        /**
+                         * Allows to write the trie data into a binary snapshot file
+                         * @param writer the binary writer to write the data with
+                         */
+                        inline void write_snapshot(binary_file_writer & writer) const {
+                            THROW_EXCEPTION("The binary snapshot is not supported by this trie type!");
+                        }
+
+                        /**
+                         * Allows to attach the trie to the data of a binary snapshot file
+                         * @param reader the binary reader to get the data from
+                         */
+                        inline void attach_snapshot(binary_mmap_reader & reader) {
+                            THROW_EXCEPTION("The binary snapshot is not supported by this trie type!");
+                        }
+
+                        /**
+                         * Allows to check whether the m-gram payloads are quantized. If so then
+                         * the payload quantizer is to be trained before any m-gram is added.
+                         * @return true if the payloads are quantized, otherwise false
+                         */
+                        static constexpr bool is_payload_quantized() {
+                            return quantizer_type::IS_QUANTIZED;
+                        }
+
+                        /**
+                         * Allows to train the payload quantizer for the given m-gram level
+                         * @param level the m-gram level
+                         * @param probs the probability weights of all the level m-grams
+                         * @param backs the back-off weights of all the level m-grams
+                         */
+                        inline void train_payload_quantizer(const phrase_length level, vector<prob_weight> & probs, vector<prob_weight> & backs) {
+                            m_quantizer.train(level, probs, backs);
+                        }
+
+                        /**
+                         * Allows to write the bitmap hash caches, if present, with the given binary writer
+                         * @param writer the binary writer to write the data with
+                         */
+                        template<typename WRITER_TYPE>
+                        inline void write_bitmap_hash_caches(WRITER_TYPE & writer) const {
+                            if (NEEDS_BITMAP_HASH_CACHE) {
+                                for (size_t idx = 0; idx < NUM_M_N_GRAM_LEVELS; ++idx) {
+                                    m_bitmap_hash_cach[idx].write(writer);
+                                }
+                            }
+                        }
+
+                        /**
+                         * Allows to attach the bitmap hash caches, if needed, to the binary data
+                         * @param reader the binary reader to get the data from
+                         */
+                        template<typename READER_TYPE>
+                        inline void attach_bitmap_hash_caches(READER_TYPE & reader) {
+                            if (NEEDS_BITMAP_HASH_CACHE) {
+                                for (size_t idx = 0; idx < NUM_M_N_GRAM_LEVELS; ++idx) {
+                                    m_bitmap_hash_cach[idx].attach(reader);
+                                }
+                            }
+                        }
+
                         /**
                          * This method adds a M-Gram (word) to the trie where 1 < M < N
                          * @param gram the M-Gram data
@@ -176,6 +271,25 @@ namespace uva {
                             THROW_MUST_OVERRIDE();
                         };
 
+                        /**
+                         * Allows to check if the m-grams can be added to the trie from several
+                         * threads at the same time, by means of the add_m_gram_concurrent method.
+                         * @return false, by default the tries do not support concurrent m-gram adding
+                         */
+                        inline bool is_concurrent_add_supported() const {
+                            return false;
+                        }
+
+                        /**
+                         * This method adds a M-Gram (word) to the trie, it can be called from several
+                         * threads at the same time, if is_concurrent_add_supported returns true.
+                         * @param gram the M-Gram data
+                         */
+                        template<phrase_length CURR_LEVEL>
+                        inline void add_m_gram_concurrent(const model_m_gram & gram) {
+                            THROW_MUST_NOT_CALL();
+                        };
+
                         /**
                          * Allows to log the information about the instantiated trie type
                          */
@@ -206,7 +320,7 @@ namespace uva {
                                         const phrase_length level_idx = query.get_curr_level_m2();
 
                                         //If the caching is enabled, the higher sub-m-gram levels always require checking
-                                        const BitmapHashCache & ref = m_bitmap_hash_cach[level_idx];
+                                        const hash_cache_type & ref = m_bitmap_hash_cach[level_idx];
 
                                         //Get the m-gram's hash
                                         const uint64_t hash = query.get_curr_m_gram_hash();
@@ -346,10 +460,14 @@ namespace uva {
                         virtual ~generic_trie_base() {
                         }
 
+                    protected:
+                        //Stores the payload quantizer
+                        quantizer_type m_quantizer;
+
                     private:
 
-                        //Stores the bitmap hash caches per M-gram level for 1 < M <= N
-                        BitmapHashCache m_bitmap_hash_cach[NUM_M_N_GRAM_LEVELS];
+                        //Stores the bitmap hash caches or Bloom filters per M-gram level for 1 < M <= N
+                        hash_cache_type m_bitmap_hash_cach[NUM_M_N_GRAM_LEVELS];
 
                         /**
                          * This method allows to process the uni-gram case, retrieve payload and account for probabilities.
@@ -39,6 +39,9 @@
 
 #include "common/utils/containers/array_utils.hpp"
 #include "common/utils/containers/fixed_size_hashmap.hpp"
+#include "common/utils/containers/fingerprint_hashmap.hpp"
+#include "common/utils/containers/fingerprint_slot_hashmap.hpp"
+#include "common/utils/containers/minimal_perfect_hashmap.hpp"
 
 #include "generic_trie_base.hpp"
 
@@ -103,18 +106,40 @@ namespace uva {
                             }
                         };
 #pragma pack(pop) //back to whatever the previous packing mode was 
+
+                        /**
+                         * Allows to set the m-gram id into the newly added map element
+                         * @param data the map element
+                         * @param id the m-gram id
+                         */
+                        template<typename TPayloadType>
+                        inline void set_m_gram_id(S_M_GramData<TPayloadType> & data, const uint64_t id) {
+                            data.m_id = id;
+                        }
+
+                        /**
+                         * The lossy storage mode elements do not store the m-gram id,
+                         * the id fingerprint is set by the map when adding the element.
+                         * @param data the map element
+                         * @param id the m-gram id
+                         */
+                        template<typename TPayloadType, uint8_t NUM_FP_BYTES>
+                        inline void set_m_gram_id(fingerprint_slot<TPayloadType, NUM_FP_BYTES> & data, const uint64_t id) {
+                        }
                     }
 
                     /**
                      * This is a Gram to Data trie that is implemented as a HashMap.
                      * @param M_GRAM_LEVEL_MAX - the maximum level of the considered N-gram, i.e. the N value
+                     * @param PAYLOAD_QUANT_BITS - the number of bits per quantized payload value, 0 for no quantization
+                     * @param FINGERPRINT_BITS - the number of m-gram id fingerprint bits, 0 for storing the full ids
+                     * @param IS_MPH_STORAGE - true if the levels are stored with the minimal perfect hashing, requires fingerprints
                      */
-                    template<typename WordIndexType>
-                    class h2d_map_trie : public generic_trie_base<h2d_map_trie<WordIndexType>, WordIndexType, __H2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> {
+                    template<typename WordIndexType, uint8_t PAYLOAD_QUANT_BITS = __H2DMapTrie::PAYLOAD_QUANT_BITS,
+                    uint8_t FINGERPRINT_BITS = __H2DMapTrie::FINGERPRINT_BITS, bool IS_MPH_STORAGE = __H2DMapTrie::IS_MPH_STORAGE>
+                    class h2d_map_trie : public generic_trie_base<h2d_map_trie<WordIndexType, PAYLOAD_QUANT_BITS, FINGERPRINT_BITS, IS_MPH_STORAGE>, WordIndexType, __H2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, PAYLOAD_QUANT_BITS> {
                     public:
-                        typedef generic_trie_base<h2d_map_trie<WordIndexType>, WordIndexType, __H2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> BASE;
-                        typedef __H2DMapTrie::S_M_GramData<m_gram_payload> T_M_Gram_PB_Entry;
-                        typedef __H2DMapTrie::S_M_GramData<prob_weight> T_M_Gram_Prob_Entry;
+                        typedef generic_trie_base<h2d_map_trie<WordIndexType, PAYLOAD_QUANT_BITS, FINGERPRINT_BITS, IS_MPH_STORAGE>, WordIndexType, __H2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, PAYLOAD_QUANT_BITS> BASE;
 
                         /**
                          * The basic constructor
@@ -136,7 +161,10 @@ namespace uva {
                         inline void log_model_type_info() const {
                             LOG_USAGE << "Using the <" << __FILENAME__ << "> model." << END_LOG;
                             LOG_INFO << "The <" << __FILENAME__ << "> model's buckets factor: "
-                                    << __H2DMapTrie::BUCKETS_FACTOR << END_LOG;
+                                    << get_buckets_factor() << ", payload quantization bits: "
+                                    << to_string(PAYLOAD_QUANT_BITS) << ", m-gram id fingerprint bits: "
+                                    << to_string(FINGERPRINT_BITS) << ", minimal perfect hashing: "
+                                    << (IS_MPH_STORAGE ? "on" : "off") << END_LOG;
                         }
 
                         /**
@@ -152,47 +180,80 @@ namespace uva {
                         virtual void pre_allocate(const size_t counts[LM_M_GRAM_LEVEL_MAX]);
 
                         /**
-                         * This method adds a M-Gram (word) to the trie where 1 < M < N
+                         * Allows to write the trie data into a binary snapshot file.
+                         * The snapshot is only possible with a word index that does
+                         * not store any words, i.e. the hashing word index.
                          * @see GenericTrieBase
                          */
-                        template<phrase_length CURR_LEVEL>
-                        inline void add_m_gram(const model_m_gram & gram) {
-                            //If not a uni-gram then register in the cache
-                            if (CURR_LEVEL != M_GRAM_LEVEL_1) {
-                                //Register the m-gram in the hash cache
-                                this->register_m_gram_cache(gram);
-                            }
+                        void write_snapshot(binary_file_writer & writer) const;
 
-                            //Compute the M-gram level index, here we store m-grams for 1 <=m < n in one structure
-                            constexpr phrase_length LEVEL_IDX = (CURR_LEVEL - LEVEL_IDX_OFFSET);
+                        /**
+                         * Allows to attach the trie to the data of a binary snapshot
+                         * file. The data is not copied but is used in place.
+                         * @see GenericTrieBase
+                         */
+                        void attach_snapshot(binary_mmap_reader & reader);
 
-                            //Get the bucket index
-                            const uint64_t hash_value = gram.get_hash();
-                            LOG_DEBUG << "Getting the bucket id for the m-gram: " << gram << " hash value: " << hash_value << END_LOG;
+                        /**
+                         * In the lossy storage mode the false positive rates are to be reported,
+                         * with the minimal perfect hashing the hash functions are to be built.
+                         * @see WordIndexTrieBase
+                         */
+                        template<phrase_length level>
+                        inline bool is_post_grams() const {
+                            return (FINGERPRINT_BITS != 0) || IS_MPH_STORAGE || BASE::template is_post_grams<level>();
+                        }
 
+                        /**
+                         * Allows to build the level's map, if needed, and to report on its false positive rate
+                         * @see WordIndexTrieBase
+                         */
+                        template<phrase_length CURR_LEVEL>
+                        inline void post_grams() {
+                            //Call the base class method first
+                            if (BASE::template is_post_grams<CURR_LEVEL>()) {
+                                BASE::template post_grams<CURR_LEVEL>();
+                            }
+
+                            //Build the level's map and report on its false positive rate
                             if (CURR_LEVEL == LM_M_GRAM_LEVEL_MAX) {
-                                //Create a new M-Gram data entry
-                                T_M_Gram_Prob_Entry & data = m_n_gram_data->add_new_element(hash_value);
-                                //The n-gram id is equal to its hash value
-                                data.m_id = hash_value;
-                                //Set the probability data
-                                data.m_payload = gram.m_payload.m_prob;
+                                build_map(*m_n_gram_data);
+                                report_false_positive_rate(CURR_LEVEL, *m_n_gram_data);
                             } else {
-                                //Check if this is an <unk> unigram, in this case we store the payload elsewhere
-                                if ((CURR_LEVEL == M_GRAM_LEVEL_1) && gram.is_unk_unigram()) {
-                                    //Store the uni-gram payload - overwrite the default values.
-                                    m_unk_data = gram.m_payload;
-                                } else {
-                                    //Create a new M-Gram data entry
-                                    T_M_Gram_PB_Entry & data = m_m_gram_data[LEVEL_IDX]->add_new_element(hash_value);
-                                    //The m-gram id is equal to its hash value
-                                    data.m_id = hash_value;
-                                    //Set the probability and back-off data
-                                    data.m_payload = gram.m_payload;
-                                }
+                                build_map(*m_m_gram_data[CURR_LEVEL - LEVEL_IDX_OFFSET]);
+                                report_false_positive_rate(CURR_LEVEL, *m_m_gram_data[CURR_LEVEL - LEVEL_IDX_OFFSET]);
                             }
                         }
 
+                        /**
+                         * This method adds a M-Gram (word) to the trie where 1 < M < N
+                         * @see GenericTrieBase
+                         */
+                        template<phrase_length CURR_LEVEL>
+                        inline void add_m_gram(const model_m_gram & gram) {
+                            add_m_gram_data<CURR_LEVEL, false>(gram);
+                        }
+
+                        /**
+                         * The m-grams can be added concurrently if the word index
+                         * does not register words and there are no bitmap hash caches.
+                         * The lossy storage mode buckets can not be claimed atomically.
+                         * @see GenericTrieBase
+                         */
+                        inline bool is_concurrent_add_supported() const {
+                            return !BASE::NEEDS_BITMAP_HASH_CACHE && !this->get_word_index().is_word_registering_needed()
+                                    && (FINGERPRINT_BITS == 0);
+                        }
+
+                        /**
+                         * This method adds a M-Gram (word) to the trie, is thread safe
+                         * @see GenericTrieBase
+                         */
+                        template<phrase_length CURR_LEVEL>
+                        inline void add_m_gram_concurrent(const model_m_gram & gram) {
+                            add_m_gram_data<CURR_LEVEL, true>(gram);
+                        }
+
                         /**
                          * Allows to attempt the sub-m-gram payload retrieval for m==1.
                          * The retrieval of a uni-gram data is always a success.
@@ -239,6 +300,30 @@ namespace uva {
                             status = get_payload<TProbMap>(m_n_gram_data, query);
                         }
 
+                        /**
+                         * The payloads are found by the sub-m-gram hash only, so they can be prefetched
+                         * @see GenericTrieBase
+                         */
+                        static constexpr bool is_payload_prefetch_supported() {
+                            return true;
+                        }
+
+                        /**
+                         * Allows to prefetch the sub-m-gram payload bucket or element
+                         * @see GenericTrieBase
+                         */
+                        template<bool is_elem>
+                        inline void prefetch_payload(m_gram_query & query) const {
+                            const uint64_t hash_value = query.get_curr_m_gram_hash();
+                            const phrase_length curr_level = query.get_curr_level();
+
+                            if (curr_level == LM_M_GRAM_LEVEL_MAX) {
+                                m_n_gram_data->template prefetch<is_elem>(hash_value);
+                            } else {
+                                m_m_gram_data[curr_level - LEVEL_IDX_OFFSET]->template prefetch<is_elem>(hash_value);
+                            }
+                        }
+
                         /**
                          * The basic class destructor
                          */
@@ -257,17 +342,84 @@ namespace uva {
                         //typedef the bucket capacity type, for convenience.
                         typedef uint16_t TBucketCapacityType;
 
+                        //Typedef the full m-gram id storage elements
+                        typedef __H2DMapTrie::S_M_GramData<typename BASE::quantizer_type::m_gram_payload_type> T_M_Gram_PB_Entry;
+                        typedef __H2DMapTrie::S_M_GramData<typename BASE::quantizer_type::n_gram_payload_type> T_M_Gram_Prob_Entry;
+
+                        //Typedef the full m-gram id storage maps
+                        typedef typename conditional<__H2DMapTrie::IS_FINGERPRINT_HASHMAP,
+                        fingerprint_hashmap<T_M_Gram_PB_Entry, typename T_M_Gram_PB_Entry::TM_Gram_Id >,
+                        fixed_size_hashmap<T_M_Gram_PB_Entry, typename T_M_Gram_PB_Entry::TM_Gram_Id > >::type TIdProbBackMap;
+                        typedef typename conditional<__H2DMapTrie::IS_FINGERPRINT_HASHMAP,
+                        fingerprint_hashmap<T_M_Gram_Prob_Entry, typename T_M_Gram_Prob_Entry::TM_Gram_Id >,
+                        fixed_size_hashmap<T_M_Gram_Prob_Entry, typename T_M_Gram_Prob_Entry::TM_Gram_Id > >::type TIdProbMap;
+
+                        //Typedef the lossy storage mode maps
+                        typedef typename conditional<IS_MPH_STORAGE,
+                        minimal_perfect_hashmap<typename BASE::quantizer_type::m_gram_payload_type, FINGERPRINT_BITS>,
+                        fingerprint_slot_hashmap<typename BASE::quantizer_type::m_gram_payload_type, FINGERPRINT_BITS> >::type TFpProbBackMap;
+                        typedef typename conditional<IS_MPH_STORAGE,
+                        minimal_perfect_hashmap<typename BASE::quantizer_type::n_gram_payload_type, FINGERPRINT_BITS>,
+                        fingerprint_slot_hashmap<typename BASE::quantizer_type::n_gram_payload_type, FINGERPRINT_BITS> >::type TFpProbMap;
+
                         //This is an array of hash maps for M-Gram levels with 1 < M < N
-                        typedef fixed_size_hashmap<T_M_Gram_PB_Entry, T_M_Gram_PB_Entry::TM_Gram_Id > TProbBackMap;
+                        typedef typename conditional<(FINGERPRINT_BITS == 0), TIdProbBackMap, TFpProbBackMap>::type TProbBackMap;
                         TProbBackMap * m_m_gram_data[NUM_M_GRAM_LEVELS];
 
                         //This is hash map pointer for the N-Gram level
-                        typedef fixed_size_hashmap<T_M_Gram_Prob_Entry, T_M_Gram_Prob_Entry::TM_Gram_Id > TProbMap;
+                        typedef typename conditional<(FINGERPRINT_BITS == 0), TIdProbMap, TFpProbMap>::type TProbMap;
                         TProbMap * m_n_gram_data;
 
                         //Stores the number of m-gram ids/buckets per level
                         TShortId m_num_buckets[LM_M_GRAM_LEVEL_MAX];
 
+                        /**
+                         * This method adds a M-Gram (word) to the trie
+                         * @param is_concurrent true if the m-gram is being added concurrently with other m-grams
+                         * @param gram the m-gram to be added
+                         */
+                        template<phrase_length CURR_LEVEL, bool is_concurrent>
+                        inline void add_m_gram_data(const model_m_gram & gram) {
+                            //If not a uni-gram then register in the cache
+                            if (CURR_LEVEL != M_GRAM_LEVEL_1) {
+                                //Register the m-gram in the hash cache
+                                this->register_m_gram_cache(gram);
+                            }
+
+                            //Compute the M-gram level index, here we store m-grams for 1 <=m < n in one structure
+                            constexpr phrase_length LEVEL_IDX = (CURR_LEVEL - LEVEL_IDX_OFFSET);
+
+                            //Get the bucket index
+                            const uint64_t hash_value = gram.get_hash();
+                            LOG_DEBUG << "Getting the bucket id for the m-gram: " << gram << " hash value: " << hash_value << END_LOG;
+
+                            if (CURR_LEVEL == LM_M_GRAM_LEVEL_MAX) {
+                                //Create a new M-Gram data entry
+                                typename TProbMap::TElemType & data = (is_concurrent ?
+                                        m_n_gram_data->add_new_element_concurrent(hash_value) :
+                                        m_n_gram_data->add_new_element(hash_value));
+                                //The n-gram id is equal to its hash value
+                                __H2DMapTrie::set_m_gram_id(data, hash_value);
+                                //Set the probability data
+                                this->m_quantizer.encode_n_gram(gram.m_payload, data.m_payload);
+                            } else {
+                                //Check if this is an <unk> unigram, in this case we store the payload elsewhere
+                                if ((CURR_LEVEL == M_GRAM_LEVEL_1) && gram.is_unk_unigram()) {
+                                    //Store the uni-gram payload - overwrite the default values.
+                                    m_unk_data = gram.m_payload;
+                                } else {
+                                    //Create a new M-Gram data entry
+                                    typename TProbBackMap::TElemType & data = (is_concurrent ?
+                                            m_m_gram_data[LEVEL_IDX]->add_new_element_concurrent(hash_value) :
+                                            m_m_gram_data[LEVEL_IDX]->add_new_element(hash_value));
+                                    //The m-gram id is equal to its hash value
+                                    __H2DMapTrie::set_m_gram_id(data, hash_value);
+                                    //Set the probability and back-off data
+                                    this->m_quantizer.encode_m_gram(CURR_LEVEL, gram.m_payload, data.m_payload);
+                                }
+                            }
+                        }
+
                         /**
                          * Gets the probability for the given level M-gram, searches on specific level
                          * @param STORAGE_MAP the level map type
@@ -275,8 +427,8 @@ namespace uva {
                          * @return the resulting status of the operation
                          */
                         template<typename STORAGE_MAP>
-                        static inline MGramStatusEnum get_payload(const STORAGE_MAP * map,
-                                m_gram_query & query) {
+                        inline MGramStatusEnum get_payload(const STORAGE_MAP * map,
+                                m_gram_query & query) const {
                             LOG_DEBUG << "Getting the bucket id for the sub-m-gram " << query << END_LOG;
 
                             const uint64_t hash_value = query.get_curr_m_gram_hash();
@@ -287,7 +439,7 @@ namespace uva {
                             const typename STORAGE_MAP::TElemType * elem = map->get_element(hash_value, hash_value);
                             if (elem != NULL) {
                                 //We are now done, the payload is found, can return!
-                                query.set_curr_payload(&elem->m_payload);
+                                set_payload(query, elem->m_payload);
                                 return MGramStatusEnum::GOOD_PRESENT_MGS;
                             } else {
                                 //Could not retrieve the payload for the given sub-m-gram
@@ -295,6 +447,87 @@ namespace uva {
                                 return MGramStatusEnum::BAD_NO_PAYLOAD_MGS;
                             }
                         }
+
+                        /**
+                         * Allows to get the buckets factor of the maps
+                         * @return the buckets factor
+                         */
+                        static constexpr double get_buckets_factor() {
+                            return IS_MPH_STORAGE ? __H2DMapTrie::MPH_GAMMA : ((FINGERPRINT_BITS == 0) ?
+                                    __H2DMapTrie::BUCKETS_FACTOR : __H2DMapTrie::FINGERPRINT_BUCKETS_FACTOR);
+                        }
+
+                        /**
+                         * The hash maps are ready to be used once filled in
+                         * @param map the level's map
+                         */
+                        template<typename STORAGE_MAP>
+                        static inline void build_map(STORAGE_MAP & map) {
+                        }
+
+                        /**
+                         * Allows to build the minimal perfect hash function of the level's map
+                         * @param map the level's map
+                         */
+                        template<typename TPayloadType>
+                        static inline void build_map(minimal_perfect_hashmap<TPayloadType, FINGERPRINT_BITS> & map) {
+                            map.build();
+                        }
+
+                        /**
+                         * The full m-gram id storage maps have no false positives
+                         * @param level the m-gram level
+                         * @param map the level's map
+                         */
+                        template<typename STORAGE_MAP>
+                        static inline void report_false_positive_rate(const phrase_length level, const STORAGE_MAP & map) {
+                        }
+
+                        /**
+                         * Allows to report on the false positive rate of the lossy storage mode map
+                         * @param level the m-gram level
+                         * @param map the level's map
+                         */
+                        template<typename TPayloadType>
+                        static inline void report_false_positive_rate(const phrase_length level,
+                                const fingerprint_slot_hashmap<TPayloadType, FINGERPRINT_BITS> & map) {
+                            LOG_USAGE << "The " << SSTR(level) << "-grams load factor: " << map.get_load_factor()
+                                    << ", " << to_string(FINGERPRINT_BITS) << " bit fingerprint false positive rate: "
+                                    << map.get_false_positive_rate() << END_LOG;
+                        }
+
+                        /**
+                         * Allows to report on the minimal perfect hash function and the false positive rate
+                         * @param level the m-gram level
+                         * @param map the level's map
+                         */
+                        template<typename TPayloadType>
+                        static inline void report_false_positive_rate(const phrase_length level,
+                                const minimal_perfect_hashmap<TPayloadType, FINGERPRINT_BITS> & map) {
+                            LOG_USAGE << "The " << SSTR(level) << "-grams minimal perfect hash levels: " << map.get_num_levels()
+                                    << ", bits per m-gram: " << map.get_bits_per_key() << ", " << to_string(FINGERPRINT_BITS)
+                                    << " bit fingerprint false positive rate: <= " << map.get_false_positive_rate() << END_LOG;
+                        }
+
+                        /**
+                         * Allows to set the found m-gram payload, 1 <= m < n, into the query
+                         * @param query the query M-gram state
+                         * @param payload the stored payload
+                         */
+                        inline void set_payload(m_gram_query & query,
+                                const typename BASE::quantizer_type::m_gram_payload_type & payload) const {
+                            this->m_quantizer.set_m_gram_payload(query, query.get_curr_level(), payload);
+                        }
+
+                        /**
+                         * Allows to set the found n-gram payload into the query
+                         * @param query the query M-gram state
+                         * @param payload the stored payload
+                         */
+                        inline void set_payload(m_gram_query & query,
+                                const typename BASE::quantizer_type::n_gram_payload_type & payload) const {
+                            this->m_quantizer.set_n_gram_payload(query, payload);
+                        }
                     };
 
                     typedef h2d_map_trie<basic_word_index > TH2DMapTrieBasic;
@@ -302,6 +535,11 @@ namespace uva {
                     typedef h2d_map_trie<basic_optimizing_word_index > TH2DMapTrieOptBasic;
                     typedef h2d_map_trie<counting_optimizing_word_index > TH2DMapTrieOptCount;
                     typedef h2d_map_trie<hashing_word_index > TH2DMapTrieHashing;
+
+                    //Define the minimal perfect hashing trie template, with the word index type as the only parameter
+                    template<typename WordIndexType>
+                    using h2d_mph_trie = h2d_map_trie<WordIndexType, __H2DMapTrie::PAYLOAD_QUANT_BITS,
+                    __H2DMapTrie::MPH_FINGERPRINT_BITS, true>;
                 }
             }
         }
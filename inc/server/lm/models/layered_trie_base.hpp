@@ -149,18 +149,18 @@ namespace uva {
                     /**
                      * This class defined the trie interface and functionality that is expected by the TrieDriver class
                      */
-                    template<typename TrieType, typename WordIndexType, uint8_t BITMAP_HASH_CACHE_BUCKETS_FACTOR>
-                    class layered_trie_base : public generic_trie_base<TrieType, WordIndexType, BITMAP_HASH_CACHE_BUCKETS_FACTOR> {
+                    template<typename TrieType, typename WordIndexType, uint8_t BITMAP_HASH_CACHE_BUCKETS_FACTOR, uint8_t PAYLOAD_QUANT_BITS = 0 >
+                    class layered_trie_base : public generic_trie_base<TrieType, WordIndexType, BITMAP_HASH_CACHE_BUCKETS_FACTOR, PAYLOAD_QUANT_BITS> {
                     public:
                         //Typedef the base class
-                        typedef generic_trie_base<TrieType, WordIndexType, BITMAP_HASH_CACHE_BUCKETS_FACTOR> BASE;
+                        typedef generic_trie_base<TrieType, WordIndexType, BITMAP_HASH_CACHE_BUCKETS_FACTOR, PAYLOAD_QUANT_BITS> BASE;
 
                         /**
                          * The basic constructor
                          * @param word_index the word index to be used
                          */
                         explicit layered_trie_base(WordIndexType & word_index)
-                        : generic_trie_base<TrieType, WordIndexType, BITMAP_HASH_CACHE_BUCKETS_FACTOR> (word_index),
+                        : generic_trie_base<TrieType, WordIndexType, BITMAP_HASH_CACHE_BUCKETS_FACTOR, PAYLOAD_QUANT_BITS> (word_index),
                         m_nothing_payload(0.0, 0.0) {
                             //Clean the cache memory
                             memset(m_cached_ctx, 0, LM_M_GRAM_LEVEL_MAX * sizeof (TContextCacheEntry));
@@ -312,8 +312,8 @@ namespace uva {
                     };
 
                     //Define the template for instantiating the layered trie class children templates
-#define INSTANTIATE_LAYERED_TRIE_TEMPLATES_NAME_TYPE(CLASS_NAME, WORD_IDX_TYPE) \
-            template class CLASS_NAME<WORD_IDX_TYPE >;
+#define INSTANTIATE_LAYERED_TRIE_TEMPLATES_NAME_TYPE(CLASS_NAME, ...) \
+            template class CLASS_NAME<__VA_ARGS__ >;
                 }
             }
         }
@@ -37,6 +37,7 @@
 
 #include "server/lm/lm_consts.hpp"
 #include "server/lm/mgrams/query_m_gram.hpp"
+#include "server/lm/mgrams/m_gram_payload.hpp"
 
 using namespace std;
 
@@ -72,6 +73,9 @@ namespace uva {
                         //query but is limited by the maximum Language model level.
                         prob_weight m_probs[QUERY_M_GRAM_MAX_LEN];
 
+                        //Stores the minimized context length of the executed query, see get_ctx_len
+                        phrase_length m_ctx_len;
+
                         //The currently considered m-gram's begin word index
                         phrase_length m_curr_begin_word_idx;
                         //The currently considered m-gram's end word index
@@ -111,6 +115,14 @@ namespace uva {
                             m_gram.set_m_gram(num_words, word_ids);
                         }
                         
+                        /**
+                         * Allows to get the number of words in the query
+                         * @return the number of words in the query
+                         */
+                        inline phrase_length get_query_num_words() const {
+                            return m_gram.get_num_words();
+                        }
+                        
                         /**
                          * Allows to get the begin word index of the query
                          * @return the begin word index of the query
@@ -188,6 +200,44 @@ namespace uva {
                             return m_gram.get_hash(m_curr_begin_word_idx, m_curr_end_word_idx);
                         }
 
+                        /**
+                         * Allows to compute the hash value of the sub-m-gram
+                         * defined by the given begin and end word indexes
+                         * @param begin_word_idx the begin word index
+                         * @param end_word_idx the end word index
+                         * @return the hash of the sub-m-gram
+                         */
+                        inline uint64_t get_m_gram_hash(const phrase_length begin_word_idx, const phrase_length end_word_idx) {
+                            return m_gram.get_hash(begin_word_idx, end_word_idx);
+                        }
+
+                        /**
+                         * Allows to get the length of the minimized context of the sub-m-gram
+                         * defined by the given begin and end word indexes. This is the length
+                         * of the longest suffix of the sub-m-gram that was found in the model
+                         * as an m-gram with m < N. As a model contains all the prefixes and
+                         * suffixes of its m-grams, the longer suffixes are not in the model
+                         * and have no back-off weights. So the probabilities of any words
+                         * following the sub-m-gram only depend on this suffix.
+                         * Is to be called after the end word probability is computed.
+                         * @param begin_word_idx the begin word index
+                         * @param end_word_idx the end word index
+                         * @return the number of the last sub-m-gram words forming the context
+                         */
+                        inline phrase_length get_ctx_len(const phrase_length begin_word_idx, const phrase_length end_word_idx) const {
+                            //An unknown word can not be continued, there is no context
+                            if (m_gram[end_word_idx] != UNKNOWN_WORD_ID) {
+                                //The first found sub-m-gram ending in the end word is the longest one
+                                for (phrase_length idx = begin_word_idx; idx <= end_word_idx; ++idx) {
+                                    if (m_payloads[idx][end_word_idx] != NULL) {
+                                        return min<phrase_length>(end_word_idx - idx + 1, LM_HISTORY_LEN_MAX);
+                                    }
+                                }
+                            }
+
+                            return 0;
+                        }
+
                         /**
                          * Allows to get the current begin word id
                          * @return the current begin word id
@@ -229,6 +279,33 @@ namespace uva {
                             m_payloads[m_curr_begin_word_idx][m_curr_end_word_idx] = payload;
                         }
 
+                        /**
+                         * Allows to set the payload value of the current m-gram defined by the
+                         * current begin and end word indexes. The payload is copied into the
+                         * query, this is needed if the trie does not store the payload as is,
+                         * e.g. when the payload is quantized.
+                         * @param prob the probability weight to be set
+                         * @param back the back-off weight to be set
+                         */
+                        inline void set_curr_payload_value(const prob_weight prob, const prob_weight back) {
+                            m_gram_payload & payload = m_decoded[m_curr_begin_word_idx][m_curr_end_word_idx];
+                            payload.m_prob = prob;
+                            payload.m_back = back;
+                            m_payloads[m_curr_begin_word_idx][m_curr_end_word_idx] = &payload;
+                        }
+
+                        /**
+                         * Allows to set the probability value of the current m-gram defined by the
+                         * current begin and end word indexes, to be used for the n-grams only.
+                         * @see set_curr_payload_value
+                         * @param prob the probability weight to be set
+                         */
+                        inline void set_curr_prob_value(const prob_weight prob) {
+                            m_gram_payload & payload = m_decoded[m_curr_begin_word_idx][m_curr_end_word_idx];
+                            payload.m_prob = prob;
+                            m_payloads[m_curr_begin_word_idx][m_curr_end_word_idx] = &payload.m_prob;
+                        }
+
                         /**
                          * Allows to set the payload of the current m-gram defined
                          * by the current begin and end word indexes
@@ -301,6 +378,9 @@ namespace uva {
                         //Stores the retrieved payloads
                         payload_ptr m_payloads[QUERY_M_GRAM_MAX_LEN][QUERY_M_GRAM_MAX_LEN];
 
+                        //Stores the payload values copied into the query, e.g. the de-quantized ones
+                        m_gram_payload m_decoded[QUERY_M_GRAM_MAX_LEN][QUERY_M_GRAM_MAX_LEN];
+
                         //Stores the currently computed context for the last pair
                         //of begin and end word ids, only for layered tries.
                         TLongId m_last_ctx_ids[QUERY_M_GRAM_MAX_LEN];
@@ -0,0 +1,438 @@
+/*
+ * File:   payload_quantizer.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 3:05 PM
+ */
+
+#ifndef PAYLOAD_QUANTIZER_HPP
+#define PAYLOAD_QUANTIZER_HPP
+
+#include <cstdint>      // std::uint8_t std::uint16_t
+#include <cmath>        // std::fabs
+#include <vector>       // std::vector
+#include <algorithm>    // std::sort std::lower_bound std::unique
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+
+#include "server/lm/lm_consts.hpp"
+#include "server/lm/mgrams/m_gram_payload.hpp"
+#include "server/lm/models/m_gram_query.hpp"
+
+using namespace std;
+
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+using namespace uva::smt::bpbd::server::lm::m_grams;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace lm {
+                    namespace quantization {
+
+                        /**
+                         * Allows to get the code type for the given number of quantization bits
+                         * @param NUM_BITS the number of bits, 8 or 16
+                         */
+                        template<uint8_t NUM_BITS>
+                        struct quant_code_type;
+
+                        template<>
+                        struct quant_code_type<8> {
+                            typedef uint8_t type;
+                        };
+
+                        template<>
+                        struct quant_code_type<16> {
+                            typedef uint16_t type;
+                        };
+
+#pragma pack(push, 1) // exact fit - no padding
+
+                        /**
+                         * This structure stores the quantized probability and back-off weight payload for an m-gram
+                         * @param CODE_TYPE the type of the code of a quantized value
+                         */
+                        template<typename CODE_TYPE>
+                        struct quant_m_gram_payload {
+                            CODE_TYPE m_prob; // 1 or 2 bytes
+                            CODE_TYPE m_back; // 1 or 2 bytes
+                        };
+#pragma pack(pop) //back to whatever the previous packing mode was
+
+                        /**
+                         * This class represents a codebook for the payload values of one kind, e.g.
+                         * the probabilities of one m-gram level. The code book is built by binning,
+                         * the sorted training values are split into the bins of equal frequency and
+                         * the bin means become the codebook values. Value 0.0 is always present in
+                         * the codebook exactly, as it is e.g. the default back-off weight.
+                         * @param NUM_BITS the number of bits per code, 8 or 16
+                         */
+                        template<uint8_t NUM_BITS>
+                        class payload_codebook {
+                        public:
+                            //Typedef the code type
+                            typedef typename quant_code_type<NUM_BITS>::type code_type;
+
+                            //Stores the maximum number of the codebook values
+                            static constexpr uint32_t MAX_NUM_VALUES = (1u << NUM_BITS);
+
+                            /**
+                             * The basic constructor
+                             */
+                            payload_codebook() : m_values(NULL), m_num_values(0), m_is_mapped(false) {
+                            }
+
+                            /**
+                             * The basic destructor
+                             */
+                            ~payload_codebook() {
+                                if (!m_is_mapped) {
+                                    delete[] m_values;
+                                }
+                            }
+
+                            /**
+                             * Allows to build the codebook from the given training values
+                             * @param values the training values, will be sorted
+                             */
+                            void train(vector<prob_weight> & values) {
+                                ASSERT_SANITY_THROW((m_values != NULL), "The codebook is already trained!");
+
+                                vector<prob_weight> result;
+                                result.reserve(MAX_NUM_VALUES);
+
+                                //Sort the values and get the number of distinct ones
+                                sort(values.begin(), values.end());
+                                vector<prob_weight> distinct(values.begin(), values.end());
+                                distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+
+                                if (distinct.size() < MAX_NUM_VALUES) {
+                                    //All the distinct values fit, there will be no loss
+                                    result.assign(distinct.begin(), distinct.end());
+                                } else {
+                                    //Split the values into bins of equal frequency, one code is reserved for 0.0
+                                    const size_t num_bins = MAX_NUM_VALUES - 1;
+                                    for (size_t bin_idx = 0; bin_idx < num_bins; ++bin_idx) {
+                                        const size_t begin_idx = (bin_idx * values.size()) / num_bins;
+                                        const size_t end_idx = ((bin_idx + 1) * values.size()) / num_bins;
+                                        if (begin_idx < end_idx) {
+                                            double sum = 0.0;
+                                            for (size_t idx = begin_idx; idx < end_idx; ++idx) {
+                                                sum += values[idx];
+                                            }
+                                            result.push_back(sum / (end_idx - begin_idx));
+                                        }
+                                    }
+                                }
+
+                                //Make sure that zero is represented exactly
+                                result.push_back(0.0);
+                                sort(result.begin(), result.end());
+                                result.erase(unique(result.begin(), result.end()), result.end());
+
+                                //Store the codebook values
+                                m_num_values = result.size();
+                                m_values = new prob_weight[m_num_values];
+                                copy(result.begin(), result.end(), m_values);
+                            }
+
+                            /**
+                             * Allows to get the code of the codebook value closest to the given one
+                             * @param value the value to encode
+                             * @return the code of the value
+                             */
+                            inline code_type encode(const prob_weight value) const {
+                                const prob_weight * const begin_ptr = m_values;
+                                const prob_weight * const end_ptr = begin_ptr + m_num_values;
+                                const prob_weight * ptr = lower_bound(begin_ptr, end_ptr, value);
+                                if (ptr == end_ptr) {
+                                    --ptr;
+                                } else {
+                                    if ((ptr != begin_ptr) && ((value - *(ptr - 1)) < (*ptr - value))) {
+                                        --ptr;
+                                    }
+                                }
+                                return static_cast<code_type> (ptr - begin_ptr);
+                            }
+
+                            /**
+                             * Allows to get the value for the given code
+                             * @param code the code to decode
+                             * @return the codebook value
+                             */
+                            inline prob_weight decode(const code_type code) const {
+                                return m_values[code];
+                            }
+
+                            /**
+                             * Allows to get the number of codebook values
+                             * @return the number of codebook values
+                             */
+                            inline uint32_t get_num_values() const {
+                                return m_num_values;
+                            }
+
+                            /**
+                             * Allows to write the codebook with the given binary writer
+                             * @param writer the binary writer to write the data with
+                             */
+                            template<typename WRITER_TYPE>
+                            inline void write(WRITER_TYPE & writer) const {
+                                writer.write(m_num_values);
+                                writer.write(m_values, m_num_values);
+                            }
+
+                            /**
+                             * Allows to attach the codebook to the data previously written
+                             * by the write method. The values are not copied but used in place.
+                             * @param reader the binary reader to get the codebook data from
+                             */
+                            template<typename READER_TYPE>
+                            inline void attach(READER_TYPE & reader) {
+                                ASSERT_SANITY_THROW((m_values != NULL), "The codebook is already trained!");
+
+                                reader.read(m_num_values);
+                                ASSERT_CONDITION_THROW((m_num_values == 0) || (m_num_values > MAX_NUM_VALUES),
+                                        string("Improper number of codebook values: ") + to_string(m_num_values));
+                                m_values = const_cast<prob_weight *> (reader.template get<prob_weight>(m_num_values));
+                                m_is_mapped = true;
+                            }
+
+                        private:
+                            //Stores the sorted codebook values
+                            prob_weight * m_values;
+                            //Stores the number of codebook values
+                            uint32_t m_num_values;
+                            //Stores the flag indicating whether the values are memory mapped
+                            bool m_is_mapped;
+                        };
+
+                        /**
+                         * This is the payload quantizer, it stores the per-level probability and
+                         * back-off weight codebooks and allows to encode the payloads to be stored
+                         * in the trie and to decode the stored payloads into the query.
+                         * @param NUM_BITS the number of bits per quantized value, 8 or 16
+                         */
+                        template<uint8_t NUM_BITS>
+                        class payload_quantizer {
+                        public:
+                            //Typedef the codebook type
+                            typedef payload_codebook<NUM_BITS> codebook_type;
+                            //Typedef the payload type for the m-grams with back-off weights
+                            typedef quant_m_gram_payload<typename codebook_type::code_type> m_gram_payload_type;
+                            //Typedef the payload type for the n-grams, just the probability
+                            typedef typename codebook_type::code_type n_gram_payload_type;
+
+                            //Stores the flag indicating whether the payloads are quantized
+                            static constexpr bool IS_QUANTIZED = true;
+
+                            /**
+                             * Allows to build the codebooks for the given m-gram level
+                             * @param level the m-gram level
+                             * @param probs the probability weights of the level m-grams
+                             * @param backs the back-off weights of the level m-grams, ignored for the n-grams
+                             */
+                            inline void train(const phrase_length level, vector<prob_weight> & probs, vector<prob_weight> & backs) {
+                                ASSERT_SANITY_THROW((level < M_GRAM_LEVEL_1) || (level > LM_M_GRAM_LEVEL_MAX),
+                                        string("Improper m-gram level: ") + to_string(level));
+
+                                train_codebook(level, "probabilities", m_probs[level - 1], probs);
+                                if (level != LM_M_GRAM_LEVEL_MAX) {
+                                    train_codebook(level, "back-off weights", m_backs[level - 1], backs);
+                                }
+                            }
+
+                            /**
+                             * Allows to encode the m-gram payload to be stored, 1 <= level < N
+                             * @param level the m-gram level
+                             * @param payload the payload to encode
+                             * @param result [out] the encoded payload
+                             */
+                            inline void encode_m_gram(const phrase_length level, const m_gram_payload & payload, m_gram_payload_type & result) const {
+                                result.m_prob = m_probs[level - 1].encode(payload.m_prob);
+                                result.m_back = m_backs[level - 1].encode(payload.m_back);
+                            }
+
+                            /**
+                             * Allows to encode the n-gram payload to be stored
+                             * @param payload the payload to encode
+                             * @param result [out] the encoded payload
+                             */
+                            inline void encode_n_gram(const m_gram_payload & payload, n_gram_payload_type & result) const {
+                                result = m_probs[LM_M_GRAM_LEVEL_MAX - 1].encode(payload.m_prob);
+                            }
+
+                            /**
+                             * Allows to set the stored m-gram payload into the query, 1 <= level < N
+                             * @param query the query to set the payload into
+                             * @param level the m-gram level
+                             * @param payload the stored payload
+                             */
+                            inline void set_m_gram_payload(m_gram_query & query, const phrase_length level, const m_gram_payload_type & payload) const {
+                                query.set_curr_payload_value(m_probs[level - 1].decode(payload.m_prob),
+                                        m_backs[level - 1].decode(payload.m_back));
+                            }
+
+                            /**
+                             * Allows to set the stored n-gram payload into the query
+                             * @param query the query to set the payload into
+                             * @param payload the stored payload
+                             */
+                            inline void set_n_gram_payload(m_gram_query & query, const n_gram_payload_type & payload) const {
+                                query.set_curr_prob_value(m_probs[LM_M_GRAM_LEVEL_MAX - 1].decode(payload));
+                            }
+
+                            /**
+                             * Allows to write the codebooks with the given binary writer
+                             * @param writer the binary writer to write the data with
+                             */
+                            template<typename WRITER_TYPE>
+                            inline void write(WRITER_TYPE & writer) const {
+                                for (phrase_length idx = 0; idx < LM_M_GRAM_LEVEL_MAX; ++idx) {
+                                    m_probs[idx].write(writer);
+                                }
+                                for (phrase_length idx = 0; idx < (LM_M_GRAM_LEVEL_MAX - 1); ++idx) {
+                                    m_backs[idx].write(writer);
+                                }
+                            }
+
+                            /**
+                             * Allows to attach the codebooks to the binary data
+                             * @param reader the binary reader to get the data from
+                             */
+                            template<typename READER_TYPE>
+                            inline void attach(READER_TYPE & reader) {
+                                for (phrase_length idx = 0; idx < LM_M_GRAM_LEVEL_MAX; ++idx) {
+                                    m_probs[idx].attach(reader);
+                                }
+                                for (phrase_length idx = 0; idx < (LM_M_GRAM_LEVEL_MAX - 1); ++idx) {
+                                    m_backs[idx].attach(reader);
+                                }
+                            }
+
+                        private:
+                            //Stores the probability codebooks for the levels 1 <= m <= N
+                            codebook_type m_probs[LM_M_GRAM_LEVEL_MAX];
+                            //Stores the back-off weight codebooks for the levels 1 <= m < N
+                            codebook_type m_backs[LM_M_GRAM_LEVEL_MAX - 1];
+
+                            /**
+                             * Allows to train the given codebook and to report on the quantization error
+                             * @param level the m-gram level
+                             * @param name the name of the values
+                             * @param codebook the codebook to train
+                             * @param values the training values
+                             */
+                            static inline void train_codebook(const phrase_length level, const char * name,
+                                    codebook_type & codebook, vector<prob_weight> & values) {
+                                codebook.train(values);
+
+                                //Compute the quantization error
+                                double sum_error = 0.0, max_error = 0.0;
+                                for (const prob_weight & value : values) {
+                                    const double error = fabs(codebook.decode(codebook.encode(value)) - value);
+                                    sum_error += error;
+                                    max_error = max(max_error, error);
+                                }
+
+                                LOG_INFO << "Quantized " << values.size() << " " << SSTR(level) << "-gram " << name
+                                        << " into " << codebook.get_num_values() << " codes, the mean/max log_e error: "
+                                        << (values.empty() ? 0.0 : (sum_error / values.size())) << "/" << max_error << END_LOG;
+                            }
+                        };
+
+                        /**
+                         * This is the payload quantizer specialization for no quantization,
+                         * the payloads are stored as they are and are not copied into the query.
+                         */
+                        template<>
+                        class payload_quantizer<0> {
+                        public:
+                            //Typedef the payload type for the m-grams with back-off weights
+                            typedef m_gram_payload m_gram_payload_type;
+                            //Typedef the payload type for the n-grams, just the probability
+                            typedef prob_weight n_gram_payload_type;
+
+                            //Stores the flag indicating whether the payloads are quantized
+                            static constexpr bool IS_QUANTIZED = false;
+
+                            /**
+                             * There is nothing to train
+                             */
+                            inline void train(const phrase_length level, vector<prob_weight> & probs, vector<prob_weight> & backs) {
+                                THROW_MUST_NOT_CALL();
+                            }
+
+                            /**
+                             * @see payload_quantizer
+                             */
+                            inline void encode_m_gram(const phrase_length level, const m_gram_payload & payload, m_gram_payload_type & result) const {
+                                result = payload;
+                            }
+
+                            /**
+                             * @see payload_quantizer
+                             */
+                            inline void encode_n_gram(const m_gram_payload & payload, n_gram_payload_type & result) const {
+                                result = payload.m_prob;
+                            }
+
+                            /**
+                             * @see payload_quantizer
+                             */
+                            inline void set_m_gram_payload(m_gram_query & query, const phrase_length level, const m_gram_payload_type & payload) const {
+                                query.set_curr_payload(&payload);
+                            }
+
+                            /**
+                             * @see payload_quantizer
+                             */
+                            inline void set_n_gram_payload(m_gram_query & query, const n_gram_payload_type & payload) const {
+                                query.set_curr_payload(&payload);
+                            }
+
+                            /**
+                             * There are no codebooks to write
+                             */
+                            template<typename WRITER_TYPE>
+                            inline void write(WRITER_TYPE & writer) const {
+                            }
+
+                            /**
+                             * There are no codebooks to attach
+                             */
+                            template<typename READER_TYPE>
+                            inline void attach(READER_TYPE & reader) {
+                            }
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* PAYLOAD_QUANTIZER_HPP */
+
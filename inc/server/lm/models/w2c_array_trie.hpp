@@ -73,8 +73,9 @@ namespace uva {
                         get_mem_incr_strat(__W2CArrayTrie::MEM_INC_TYPE,
                                 __W2CArrayTrie::MIN_MEM_INC_NUM, __W2CArrayTrie::MEM_INC_FACTOR);
 
-                        typedef S_M_GramData<m_gram_payload> T_M_GramData;
-                        typedef S_M_GramData<prob_weight> T_N_GramData;
+                        //The payload types depend on whether the payloads are quantized
+                        typedef S_M_GramData<payload_quantizer<PAYLOAD_QUANT_BITS>::m_gram_payload_type> T_M_GramData;
+                        typedef S_M_GramData<payload_quantizer<PAYLOAD_QUANT_BITS>::n_gram_payload_type> T_N_GramData;
 
                         /**
                          * This is the less operator implementation
@@ -103,9 +104,9 @@ namespace uva {
                      * @param M_GRAM_LEVEL_MAX the maximum number of levels in the trie.
                      */
                     template<typename WordIndexType>
-                    class w2c_array_trie : public layered_trie_base<w2c_array_trie<WordIndexType>, WordIndexType, __W2CArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> {
+                    class w2c_array_trie : public layered_trie_base<w2c_array_trie<WordIndexType>, WordIndexType, __W2CArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, __W2CArrayTrie::PAYLOAD_QUANT_BITS> {
                     public:
-                        typedef layered_trie_base<w2c_array_trie<WordIndexType>, WordIndexType, __W2CArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR> BASE;
+                        typedef layered_trie_base<w2c_array_trie<WordIndexType>, WordIndexType, __W2CArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, __W2CArrayTrie::PAYLOAD_QUANT_BITS> BASE;
 
                         /**
                          * The basic constructor
@@ -258,14 +259,14 @@ namespace uva {
                                     //Store the context and word ids
                                     ref.id = ctx_id;
                                     //Return the reference to the probability
-                                    ref.payload = gram.m_payload.m_prob;
+                                    this->m_quantizer.encode_n_gram(gram.m_payload, ref.payload);
                                 } else {
                                     //Get the sub-array reference. 
                                     typename T_M_GramWordEntry::TElemType & ref = make_m_n_gram_entry<T_M_GramWordEntry>(m_m_gram_word_2_data[CURR_LEVEL - BASE::MGRAM_IDX_OFFSET], word_id);
                                     //Store the context and word ids
                                     ref.id = ctx_id;
                                     //Return the reference to the newly allocated element
-                                    ref.payload = gram.m_payload;
+                                    this->m_quantizer.encode_m_gram(CURR_LEVEL, gram.m_payload, ref.payload);
                                 }
                             }
                         }
@@ -311,8 +312,8 @@ namespace uva {
                                 const T_M_GramWordEntry * ptr = m_m_gram_word_2_data[level_idx];
                                 if (get_m_n_gram_entry<T_M_GramWordEntry>(ptr, word_id, ctx_id, &entry_ptr)) {
                                     //Return the data
-                                    query.set_curr_payload(&entry_ptr->payload);
-                                    LOG_DEBUG << "The payload is retrieved: " << entry_ptr->payload << END_LOG;
+                                    this->m_quantizer.set_m_gram_payload(query, level_idx + BASE::MGRAM_IDX_OFFSET, entry_ptr->payload);
+                                    LOG_DEBUG << "The payload is retrieved!" << END_LOG;
                                 } else {
                                     //The payload could not be found
                                     LOG_DEBUG1 << "Unable to find m-gram data for ctx_id: " << SSTR(ctx_id)
@@ -343,8 +344,8 @@ namespace uva {
                                 const typename T_N_GramWordEntry::TElemType * entry_ptr;
                                 if (get_m_n_gram_entry<T_N_GramWordEntry>(m_n_gram_word_2_data, word_id, ctx_id, &entry_ptr)) {
                                     //Return the data
-                                    query.set_curr_payload(&entry_ptr->payload);
-                                    LOG_DEBUG << "The payload is retrieved: " << entry_ptr->payload << END_LOG;
+                                    this->m_quantizer.set_n_gram_payload(query, entry_ptr->payload);
+                                    LOG_DEBUG << "The payload is retrieved!" << END_LOG;
                                 } else {
                                     //The payload could not be found
                                     LOG_DEBUG1 << "Unable to find " << SSTR(LM_M_GRAM_LEVEL_MAX) << "-gram data for ctx_id: "
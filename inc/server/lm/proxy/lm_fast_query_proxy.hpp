@@ -44,6 +44,46 @@ namespace uva {
                 namespace lm {
                     namespace proxy {
 
+                        /**
+                         * This structure stores the language model state after a query execution,
+                         * being the minimized context of the query, see m_gram_query::get_ctx_len.
+                         * The probabilities of the words following the query only depend on the
+                         * context words, so the other history words need neither be sent with
+                         * the next query nor be compared when recombining hypotheses.
+                         * @param m_ctx_len the number of the last query words forming the context
+                         * @param m_ctx_hash the hash of the context words, zero if there is none
+                         */
+                        struct lm_state {
+                            phrase_length m_ctx_len;
+                            uint64_t m_ctx_hash;
+
+                            /**
+                             * The comparison operator
+                             * @param other the state to compare with
+                             * @return true if the states have the same context length and hash
+                             */
+                            inline bool operator==(const lm_state & other) const {
+                                return (m_ctx_len == other.m_ctx_len) && (m_ctx_hash == other.m_ctx_hash);
+                            }
+                        };
+
+                        /**
+                         * This structure stores one query of the batched query execution
+                         * @param m_num_words [in] the number of word ids, at most LM_MAX_QUERY_LEN
+                         * @param m_word_ids [in] the word identifiers of the query words
+                         * @param m_min_level [in/out] the first m-gram level to consider, the next
+                         * minimum m-gram level to consider, is limited by LM_M_GRAM_LEVEL_MAX
+                         * @param m_prob [out] the resulting probability weight
+                         * @param m_state [out] the resulting language model state
+                         */
+                        struct lm_batch_query {
+                            phrase_length m_num_words;
+                            const word_uid * m_word_ids;
+                            phrase_length m_min_level;
+                            prob_weight m_prob;
+                            lm_state m_state;
+                        };
+
                         /**
                          * This class represents a trie query proxy interface class.
                          * It allows to interact with templated trie queries in a uniform way.
@@ -139,13 +179,25 @@ namespace uva {
                              * to compute the probability for
                              * @param [in/out] min_level the first m-gram level to consider, the next
                              * minimum m-gram level to consider, is limited by LM_M_GRAM_LEVEL_MAX
+                             * @param [out] state the language model state after the query execution
                              * @param scores the pointer to the array of feature scores that is to 
                              *               be filled in, unless the provided pointer is NULL.
                              * @return the resulting probability weight
                              */
                             virtual prob_weight execute(const phrase_length num_words,
                                     const word_uid * word_ids, phrase_length & min_level, 
-                                    prob_weight * scores) = 0;
+                                    lm_state & state, prob_weight * scores) = 0;
+
+                            /**
+                             * Allows to execute a batch of m-gram queries, each query is executed
+                             * as by the execute method with the min_level argument. The queries are
+                             * independent, e.g. they are the expansions of the same hypothesis, so
+                             * the look-ups of their payloads can be overlapped in time. Note that
+                             * the feature scores are not reported by this method.
+                             * @param num_queries the number of queries in the batch
+                             * @param queries [in/out] the array of queries to be executed
+                             */
+                            virtual void execute(const size_t num_queries, lm_batch_query * queries) = 0;
                         };
                     }
                 }
@@ -30,6 +30,7 @@
 
 #include "server/lm/lm_parameters.hpp"
 #include "server/lm/proxy/lm_fast_query_proxy.hpp"
+#include "server/lm/proxy/lm_query_cache.hpp"
 #include "server/lm/models/m_gram_query.hpp"
 
 using namespace std;
@@ -62,13 +63,14 @@ namespace uva {
                              * @param unk_word_prob the unknown word LM probability
                              * @param begin_tag_uid the begin sentence tag word uid
                              * @param end_tag_uid the begin sentence tag word uid
+                             * @param model_uid the uid of the model instance, for the query cache
                              */
                             lm_fast_query_proxy_local(const lm_parameters & params, const trie_type & trie,
                                     const prob_weight& unk_word_prob, const word_uid & begin_tag_uid,
-                                    const word_uid & end_tag_uid)
-                            : m_params(params), m_trie(trie), m_unk_word_prob(unk_word_prob),
+                                    const word_uid & end_tag_uid, const uint64_t model_uid)
+                            : m_params(params), m_trie(trie), m_model_uid(model_uid), m_unk_word_prob(unk_word_prob),
                             m_begin_tag_uid(begin_tag_uid), m_end_tag_uid(end_tag_uid),
-                            m_word_idx(m_trie.get_word_index()), m_query(), m_joint_prob(0.0) {
+                            m_word_idx(m_trie.get_word_index()), m_query(), m_batch(), m_joint_prob(0.0) {
                             }
 
                             /**
@@ -137,8 +139,11 @@ namespace uva {
                                 //Declare a dummy variable for the min level
                                 phrase_length min_level = M_GRAM_LEVEL_1;
 
+                                //Set the words data into the query object
+                                m_query.set_data<m_is_ctx>(num_words, word_ids);
+
                                 //Compute the probability value
-                                prob_weight prob = execute_query<false>(num_words, word_ids, min_level);
+                                prob_weight prob = execute_query<false>(m_query, min_level);
 
                                 LOG_DEBUG1 << "The resulting LM query probability is: " << prob << END_LOG;
 
@@ -151,7 +156,10 @@ namespace uva {
                              */
                             virtual prob_weight execute(const phrase_length num_words,
                                     const word_uid * word_ids, phrase_length & min_level) {
-                                return execute_query<false>(num_words, word_ids, min_level);
+                                //Set the words data into the query object
+                                m_query.set_data<m_is_ctx>(num_words, word_ids);
+
+                                return execute_query<false>(m_query, min_level);
                             }
 
                             /**
@@ -159,24 +167,167 @@ namespace uva {
                              */
                             virtual prob_weight execute(const phrase_length num_words,
                                     const word_uid * word_ids, phrase_length & min_level,
-                                    prob_weight * scores) {
-                                return execute_query(num_words, word_ids, min_level, scores);
+                                    lm_state & state, prob_weight * scores) {
+                                //Set the words data into the query object
+                                m_query.set_data<m_is_ctx>(num_words, word_ids);
+
+                                //Execute the query and get the resulting state
+                                const prob_weight prob = execute_query(m_query, min_level, scores);
+                                get_state(m_query, state);
+
+                                return prob;
+                            }
+
+                            /**
+                             * @see lm_query_proxy
+                             */
+                            virtual void execute(const size_t num_queries, lm_batch_query * queries) {
+                                //Process the queries in chunks of the maximum batch size
+                                for (size_t begin_idx = 0; begin_idx < num_queries; begin_idx += LM_QUERY_BATCH_SIZE) {
+                                    const size_t num_batch = std::min<size_t>(num_queries - begin_idx, LM_QUERY_BATCH_SIZE);
+                                    lm_batch_query * batch = queries + begin_idx;
+
+                                    LOG_DEBUG1 << "Executing a batch of " << num_batch << " LM queries" << END_LOG;
+
+                                    //Set the queries data, the sub-m-gram hashes are computed and
+                                    //stored inside the queries on the first prefetching stage
+                                    for (size_t idx = 0; idx < num_batch; ++idx) {
+                                        m_batch[idx].set_data<m_is_ctx>(batch[idx].m_num_words, batch[idx].m_word_ids);
+                                    }
+
+                                    //Prefetch the payload data, first the buckets then the
+                                    //elements, so that the memory accesses of the queries
+                                    //overlap instead of being done one after another
+                                    if (m_is_prefetch) {
+                                        for (size_t idx = 0; idx < num_batch; ++idx) {
+                                            prefetch_query<false>(m_batch[idx], batch[idx].m_min_level);
+                                        }
+                                        for (size_t idx = 0; idx < num_batch; ++idx) {
+                                            prefetch_query<true>(m_batch[idx], batch[idx].m_min_level);
+                                        }
+                                    }
+
+                                    //Execute the queries, the payload data is expected to be in cache
+                                    for (size_t idx = 0; idx < num_batch; ++idx) {
+                                        batch[idx].m_prob = execute_query<false>(m_batch[idx], batch[idx].m_min_level);
+                                        get_state(m_batch[idx], batch[idx].m_state);
+                                    }
+                                }
                             }
 
                         protected:
 
+                            /**
+                             * Allows to get the language model state of the executed query
+                             * @param query the executed query
+                             * @param state [out] the state to be set
+                             */
+                            inline void get_state(m_gram_query & query, lm_state & state) const {
+                                state.m_ctx_len = query.m_ctx_len;
+                                if (state.m_ctx_len != 0) {
+                                    const phrase_length end_word_idx = query.get_query_end_word_idx();
+                                    state.m_ctx_hash = query.get_m_gram_hash(end_word_idx - state.m_ctx_len + 1, end_word_idx);
+                                } else {
+                                    state.m_ctx_hash = 0;
+                                }
+
+                                LOG_DEBUG1 << "The LM state context length: " << state.m_ctx_len
+                                        << ", hash: " << state.m_ctx_hash << END_LOG;
+                            }
+
+                            /**
+                             * Allows to prefetch the payloads of the sub-m-grams the query execution will
+                             * start with, i.e. the longest ones, as defined by the execute_query method.
+                             * The back-off sub-m-grams depend on the retrieved data and are not prefetched.
+                             * @param is_elem the prefetching stage flag, see generic_trie_base::prefetch_payload
+                             * @param query the query with the data set
+                             * @param min_level the first m-gram level to consider
+                             */
+                            template<bool is_elem>
+                            inline void prefetch_query(m_gram_query & query, const phrase_length min_level) const {
+                                //Compute the maximum to consider m-gram level
+                                const phrase_length max_m_gram_level = std::min<phrase_length>(
+                                        query.get_query_num_words(), LM_M_GRAM_LEVEL_MAX);
+
+                                //Prefetch the m-grams growing from the first word
+                                for (phrase_length end_word_idx = min_level - 1; end_word_idx < max_m_gram_level; ++end_word_idx) {
+                                    query.set_word_indxes(0, end_word_idx);
+                                    m_trie.template prefetch_payload<is_elem>(query);
+                                }
+
+                                //Prefetch the m-grams of the sliding window
+                                for (phrase_length end_word_idx = max_m_gram_level;
+                                        end_word_idx <= query.get_query_end_word_idx(); ++end_word_idx) {
+                                    query.set_word_indxes(end_word_idx - LM_M_GRAM_LEVEL_MAX + 1, end_word_idx);
+                                    m_trie.template prefetch_payload<is_elem>(query);
+                                }
+                            }
+
+                            /**
+                             * Allows to execute the sub-query, i.e. to compute the probabilities of the
+                             * sub-m-grams starting in the given begin word and ending in the given range
+                             * of end words. If the cache is enabled, the probabilities of the leading
+                             * cached sub-m-grams are taken from the cache and the others are computed
+                             * with the trie and cached. Also sets the query context length, being the
+                             * one of the last sub-m-gram.
+                             * @param cache the query cache of this thread
+                             * @param query the query with the data set
+                             * @param begin_word_idx the sub-query begin word index
+                             * @param first_end_word_idx the first sub-m-gram end word index
+                             * @param last_end_word_idx the last sub-m-gram end word index
+                             */
+                            inline void execute_sub_query(lm_query_cache & cache, m_gram_query & query,
+                                    const phrase_length begin_word_idx, phrase_length first_end_word_idx,
+                                    const phrase_length last_end_word_idx) {
+                                if (cache.is_enabled()) {
+                                    //Take the results of the leading sub-m-grams from the cache while they are there
+                                    const lm_cache_entry * entry = NULL;
+                                    while ((first_end_word_idx <= last_end_word_idx) && ((entry = cache.get(
+                                            query.get_m_gram_hash(begin_word_idx, first_end_word_idx),
+                                            first_end_word_idx - begin_word_idx + 1)) != NULL)) {
+                                        query.m_probs[first_end_word_idx] = entry->m_prob;
+                                        query.m_ctx_len = entry->m_ctx_len;
+                                        ++first_end_word_idx;
+                                    }
+
+                                    //Compute the rest of the sub-m-grams with the trie, if any, and cache them
+                                    if (first_end_word_idx <= last_end_word_idx) {
+                                        query.set_word_indxes(begin_word_idx, first_end_word_idx, last_end_word_idx);
+                                        m_trie.execute(query);
+
+                                        for (phrase_length end_word_idx = first_end_word_idx; end_word_idx <= last_end_word_idx; ++end_word_idx) {
+                                            query.m_ctx_len = query.get_ctx_len(begin_word_idx, end_word_idx);
+                                            cache.put(query.get_m_gram_hash(begin_word_idx, end_word_idx),
+                                                    end_word_idx - begin_word_idx + 1,
+                                                    query.m_probs[end_word_idx], query.m_ctx_len);
+                                        }
+                                    }
+                                } else {
+                                    //Compute all the sub-m-grams with the trie
+                                    query.set_word_indxes(begin_word_idx, first_end_word_idx, last_end_word_idx);
+                                    m_trie.execute(query);
+                                    query.m_ctx_len = query.get_ctx_len(begin_word_idx, last_end_word_idx);
+                                }
+                            }
+
+                            /**
+                             * Allows to execute the query with the data set
+                             * @param is_consider_scores true if the feature scores are to be reported
+                             * @param query the query with the data set
+                             * @param min_level [in/out] the first m-gram level to consider, the next
+                             * minimum m-gram level to consider
+                             * @param scores the pointer to the array of feature scores
+                             * @return the resulting probability weight
+                             */
                             template<bool is_consider_scores = true >
-                            inline prob_weight execute_query(const phrase_length num_words,
-                                    const word_uid * word_ids, phrase_length & min_level,
+                            inline prob_weight execute_query(m_gram_query & query, phrase_length & min_level,
                                     prob_weight * scores = NULL) {
                                 //Re-initialize the joint prob result with zero
                                 m_joint_prob = 0.0;
 
-                                //Set the words data into the query object
-                                m_query.set_data<m_is_ctx>(num_words, word_ids);
-
                                 //Compute the maximum to consider m-gram level
-                                const phrase_length max_m_gram_level = std::min<phrase_length>(num_words, LM_M_GRAM_LEVEL_MAX);
+                                const phrase_length max_m_gram_level = std::min<phrase_length>(
+                                        query.get_query_num_words(), LM_M_GRAM_LEVEL_MAX);
 
                                 //Initialize the begin and end word indexes
                                 phrase_length begin_word_idx = 0;
@@ -188,42 +339,41 @@ namespace uva {
                                         string("Impossible min_level: ") + to_string(min_level) +
                                         string(" the maximum possible level is: ") + to_string(max_m_gram_level));
 
-                                //Set the m-gram values for the first query execution
-                                m_query.set_word_indxes(begin_word_idx, sub_end_word_idx, end_word_idx);
+                                //Get the query cache of this thread, with the configured size and model
+                                lm_query_cache & cache = lm_query_cache::get_thread_cache();
+                                cache.set_num_bits(m_params.m_query_cache_bits);
+                                cache.set_model_uid(m_model_uid);
 
                                 //Execute the first part of the query
-                                m_trie.execute(m_query);
+                                execute_sub_query(cache, query, begin_word_idx, sub_end_word_idx, end_word_idx);
 
                                 //Report the partial results, and update the total
-                                get_report_interm_results(begin_word_idx, sub_end_word_idx, end_word_idx);
+                                get_report_interm_results(query, begin_word_idx, sub_end_word_idx, end_word_idx);
 
                                 //Now do the sliding window and compute more probabilities,
                                 //Note that if the end_word_idx is smaller than the query
                                 //last word idx then it means that:
                                 //      (max_m_gram_level == LM_M_GRAM_LEVEL_MAX)
                                 //and there is still m-grams to compute
-                                while (end_word_idx < m_query.get_query_end_word_idx()) {
+                                while (end_word_idx < query.get_query_end_word_idx()) {
                                     //Slide the window one step forward
                                     begin_word_idx++;
                                     end_word_idx++;
 
-                                    //Set the window value inside, this time we need a single probability and not the joint
-                                    m_query.set_word_indxes(begin_word_idx, end_word_idx);
-
-                                    //Execute the query
-                                    m_trie.execute(m_query);
+                                    //Execute the query, this time we need a single probability and not the joint
+                                    execute_sub_query(cache, query, begin_word_idx, end_word_idx, end_word_idx);
 
                                     //Report the partial result, and update the total
-                                    get_report_interm_results(begin_word_idx, end_word_idx, end_word_idx);
+                                    get_report_interm_results(query, begin_word_idx, end_word_idx, end_word_idx);
                                 }
 
                                 //Report the total result
-                                report_final_result();
+                                report_final_result(query);
 
                                 //Compute the next minimum level to consider, it is either one level higher or we are at the maximum
                                 min_level = std::min<phrase_length>(max_m_gram_level + 1, LM_M_GRAM_LEVEL_MAX);
 
-                                LOG_DEBUG << "Computed log_e(Prob(" << m_query << ")) = " << m_joint_prob << ", next min_level:  " << min_level << END_LOG;
+                                LOG_DEBUG << "Computed log_e(Prob(" << query << ")) = " << m_joint_prob << ", next min_level:  " << min_level << END_LOG;
 
 #if IS_SERVER_TUNING_MODE
                                 //Report the feature scores, here we do it outside the model - for
@@ -248,20 +398,22 @@ namespace uva {
                              * N-gram = "word1" -> result = "word1"
                              * N-gram = "word1 word2 word3" -> result = "word3 | word1  word2"
                              * for the first M tokens of the N-gram
+                             * @param query the query
                              * @param begin_word_idx the m-gram's begin word index
                              * @param end_word_idx the m-gram's begin word index
                              * @return the resulting string
                              */
-                            inline string get_m_gram_str(const phrase_length begin_word_idx, const phrase_length end_word_idx) const {
+                            inline string get_m_gram_str(const m_gram_query & query, const phrase_length begin_word_idx,
+                                    const phrase_length end_word_idx) const {
                                 if (begin_word_idx > end_word_idx) {
                                     return "<none>";
                                 } else {
                                     if (begin_word_idx == end_word_idx) {
-                                        return to_string(m_query[begin_word_idx]);
+                                        return to_string(query[begin_word_idx]);
                                     } else {
-                                        string result = to_string(m_query[end_word_idx]) + " |";
+                                        string result = to_string(query[end_word_idx]) + " |";
                                         for (phrase_length idx = begin_word_idx; idx != end_word_idx; ++idx) {
-                                            result += string(" ") + to_string(m_query[idx]);
+                                            result += string(" ") + to_string(query[idx]);
                                         }
                                         return result;
                                     }
@@ -273,17 +425,18 @@ namespace uva {
                              * of the object for which the probability is computed, e.g.:
                              * N-gram = "word1" -> result = "word1"
                              * N-gram = "word1 word2 word3" -> result = "word1 word2 word3"
+                             * @param query the query
                              * @return the resulting string
                              */
-                            inline string get_query_str() const {
-                                const phrase_length begin_idx = m_query.get_query_begin_word_idx();
-                                const phrase_length end_idx = m_query.get_query_end_word_idx();
+                            inline string get_query_str(const m_gram_query & query) const {
+                                const phrase_length begin_idx = query.get_query_begin_word_idx();
+                                const phrase_length end_idx = query.get_query_end_word_idx();
                                 if (begin_idx == end_idx) {
-                                    return to_string(m_query[begin_idx]);
+                                    return to_string(query[begin_idx]);
                                 } else {
                                     string result;
                                     for (phrase_length idx = begin_idx; idx <= end_idx; ++idx) {
-                                        result += to_string(m_query[idx]) + string(" ");
+                                        result += to_string(query[idx]) + string(" ");
                                     }
                                     return result.substr(0, result.length() - 1);
                                 }
@@ -291,40 +444,43 @@ namespace uva {
 
                             /**
                              * Allows add up the intermediate results of the loose sub-sub queries defined by the arguments
+                             * @param query the query
                              * @param begin_word_idx the sub query begin word index
                              * @param first_end_word_idx the first sub-sub query end word index
                              * @param last_end_word_idx the last sub-sub query end word index
                              */
                             inline void get_report_interm_results(
+                                    const m_gram_query & query,
                                     const phrase_length begin_word_idx,
                                     const phrase_length first_end_word_idx,
                                     const phrase_length last_end_word_idx) {
                                 //Print the intermediate results
                                 for (phrase_length end_word_idx = first_end_word_idx; end_word_idx <= last_end_word_idx; ++end_word_idx) {
                                     if (MAXIMUM_LOGGING_LEVEL >= debug_levels_enum::DEBUG) {
-                                        const string gram_str = get_m_gram_str(begin_word_idx, end_word_idx);
+                                        const string gram_str = get_m_gram_str(query, begin_word_idx, end_word_idx);
 
                                         LOG_DEBUG << "  log_e( Prob( " << gram_str
-                                                << " ) ) = " << SSTR(m_query.m_probs[end_word_idx]) << END_LOG;
+                                                << " ) ) = " << SSTR(query.m_probs[end_word_idx]) << END_LOG;
                                         LOG_DEBUG1 << "  Prob( " << gram_str << " ) = "
-                                                << SSTR(pow(LOG_PROB_WEIGHT_BASE, m_query.m_probs[end_word_idx])) << END_LOG;
+                                                << SSTR(pow(LOG_PROB_WEIGHT_BASE, query.m_probs[end_word_idx])) << END_LOG;
                                     }
 
                                     //Do not add anything below the zero weight.
-                                    if (m_query.m_probs[end_word_idx] >= ZERO_LOG_PROB_WEIGHT) {
-                                        m_joint_prob += m_query.m_probs[end_word_idx];
+                                    if (query.m_probs[end_word_idx] >= ZERO_LOG_PROB_WEIGHT) {
+                                        m_joint_prob += query.m_probs[end_word_idx];
                                     }
                                 }
                             }
 
                             /**
                              * Allows to report the total joint probability of the query
+                             * @param query the query
                              */
-                            inline void report_final_result() {
+                            inline void report_final_result(const m_gram_query & query) {
                                 if (MAXIMUM_LOGGING_LEVEL >= debug_levels_enum::DEBUG) {
                                     LOG_DEBUG << "---" << END_LOG;
                                     //Print the total cumulative probability if needed
-                                    const string gram_str = get_query_str();
+                                    const string gram_str = get_query_str(query);
                                     LOG_DEBUG << "  log_e( Prob( " << gram_str
                                             << " ) ) = " << SSTR(m_joint_prob) << END_LOG;
                                     LOG_DEBUG1 << "  Prob( " << gram_str << " ) = "
@@ -338,12 +494,18 @@ namespace uva {
                             //Store the flag indicating whether the trie needs context ids
                             static constexpr bool m_is_ctx = trie_type::is_context_needed();
 
+                            //Store the flag indicating whether the trie can prefetch the payloads
+                            static constexpr bool m_is_prefetch = trie_type::is_payload_prefetch_supported();
+
                             //Stores the pointer to the configuration parameters
                             const lm_parameters & m_params;
 
                             //Stores the reference to the trie
                             const trie_type & m_trie;
 
+                            //Stores the uid of the model instance
+                            const uint64_t m_model_uid;
+
                             //Stores the cached unknown word probability from LM
                             const prob_weight m_unk_word_prob;
 
@@ -357,12 +519,18 @@ namespace uva {
                             //Stores the reference to the sliding query
                             m_gram_query m_query;
 
+                            //Stores the queries of the batched query execution
+                            m_gram_query m_batch[LM_QUERY_BATCH_SIZE];
+
                             //Stores the joint probability result for the query
                             prob_weight m_joint_prob;
                         };
 
                         template<typename trie_type>
                         constexpr bool lm_fast_query_proxy_local<trie_type>::m_is_ctx;
+
+                        template<typename trie_type>
+                        constexpr bool lm_fast_query_proxy_local<trie_type>::m_is_prefetch;
                     }
                 }
             }
@@ -0,0 +1,259 @@
+/*
+ * File:   lm_fast_query_proxy_remote.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 1:45 AM
+ */
+
+#ifndef LM_FAST_QUERY_PROXY_REMOTE_HPP
+#define LM_FAST_QUERY_PROXY_REMOTE_HPP
+
+#include <vector>
+#include <algorithm>
+
+#include "server/lm/lm_configs.hpp"
+#include "server/lm/lm_parameters.hpp"
+#include "server/lm/proxy/lm_fast_query_proxy.hpp"
+#include "server/lm/proxy/lm_remote_protocol.hpp"
+
+using namespace std;
+
+using namespace uva::smt::bpbd::server::lm;
+using namespace uva::smt::bpbd::server::lm::proxy;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace lm {
+                    namespace proxy {
+
+                        /**
+                         * This is a remote implementation of the language model query, it sends
+                         * the queries to the lm-server over the given socket connection. Each
+                         * batch of queries is sent in a single round trip. The word ids are
+                         * computed locally, as the stateless hashing word index gives the same
+                         * ids as the one of the server.
+                         */
+                        class lm_fast_query_proxy_remote : public lm_fast_query_proxy {
+                        public:
+
+                            /**
+                             * The basic constructor
+                             * @param params the lm model parameters
+                             * @param word_idx the word index to get the word ids from
+                             * @param handshake the handshake received from the server
+                             * @param sock_desc the connected socket, is not closed by this class
+                             */
+                            lm_fast_query_proxy_remote(const lm_parameters & params, const lm_word_index & word_idx,
+                                    const __lm_remote::s_handshake & handshake, const int sock_desc)
+                            : m_params(params), m_word_idx(word_idx), m_handshake(handshake),
+                            m_sock_desc(sock_desc), m_is_in_trip(false), m_request(), m_results() {
+                            }
+
+                            /**
+                             * @see lm_fast_query_proxy
+                             */
+                            virtual ~lm_fast_query_proxy_remote() {
+                                //Nothing to free, the socket is owned by the model proxy.
+                            }
+
+                            /**
+                             * Allows to get the connected socket descriptor
+                             * @return the socket descriptor
+                             */
+                            inline int get_sock_desc() const {
+                                return m_sock_desc;
+                            }
+
+                            /**
+                             * Allows to check if the connection can be re-used, it can not if
+                             * a round trip has failed as then the stream is out of sync
+                             * @return true if the connection can be re-used
+                             */
+                            inline bool is_reusable() const {
+                                return !m_is_in_trip;
+                            }
+
+                            /**
+                             * @see lm_fast_query_proxy
+                             */
+                            virtual prob_weight get_unk_word_prob() const {
+                                return m_handshake.m_unk_word_prob;
+                            }
+
+                            /**
+                             * @see lm_fast_query_proxy
+                             */
+                            virtual const word_uid & get_begin_tag_uid() const {
+                                return m_handshake.m_begin_tag_uid;
+                            }
+
+                            /**
+                             * @see lm_fast_query_proxy
+                             */
+                            virtual const word_uid & get_end_tag_uid() const {
+                                return m_handshake.m_end_tag_uid;
+                            }
+
+                            /**
+                             * @see lm_fast_query_proxy
+                             */
+                            virtual void get_word_ids(text_piece_reader phrase, phrase_length & num_words,
+                                    word_uid word_ids[tm::TM_MAX_TARGET_PHRASE_LEN]) const {
+                                //Initialize with zero words
+                                num_words = 0;
+
+                                //Declare the text piece reader for storing words
+                                text_piece_reader word;
+
+                                //Read the tokens one by one
+                                while (phrase.get_first_space(word)) {
+                                    //Check that we do not get too many words!
+                                    ASSERT_SANITY_THROW((num_words >= tm::TM_MAX_TARGET_PHRASE_LEN),
+                                            string("The target phrase: ___") + phrase.str() +
+                                            string("___ has too many words, the allowed maximum is: ") +
+                                            to_string(tm::TM_MAX_TARGET_PHRASE_LEN));
+
+                                    //Obtain the word id from the word index
+                                    word_ids[num_words++] = m_word_idx.get_word_id(word);
+                                }
+                            };
+
+                            /**
+                             * @see lm_fast_query_proxy
+                             */
+                            virtual prob_weight execute(const phrase_length num_words, const word_uid * word_ids) {
+                                phrase_length min_level = M_GRAM_LEVEL_1;
+                                return execute(num_words, word_ids, min_level);
+                            }
+
+                            /**
+                             * @see lm_fast_query_proxy
+                             */
+                            virtual prob_weight execute(const phrase_length num_words,
+                                    const word_uid * word_ids, phrase_length & min_level) {
+                                lm_batch_query query = {num_words, word_ids, min_level, 0.0, {0, 0}};
+                                execute(1, &query);
+                                min_level = query.m_min_level;
+                                return query.m_prob;
+                            }
+
+                            /**
+                             * @see lm_fast_query_proxy
+                             */
+                            virtual prob_weight execute(const phrase_length num_words,
+                                    const word_uid * word_ids, phrase_length & min_level,
+                                    lm_state & state, prob_weight * scores) {
+                                lm_batch_query query = {num_words, word_ids, min_level, 0.0, {0, 0}};
+                                execute(1, &query);
+                                min_level = query.m_min_level;
+                                state = query.m_state;
+
+#if IS_SERVER_TUNING_MODE
+                                //Store the score and divide it by the lambda weight to restore the original!
+                                ASSERT_SANITY_THROW((scores == NULL), string("The scores pointer is NULL!"));
+                                scores[lm_parameters::LM_WEIGHT_GLOBAL_IDS[0]] = query.m_prob / m_params.get_0_lm_weight();
+#endif
+
+                                return query.m_prob;
+                            }
+
+                            /**
+                             * @see lm_fast_query_proxy
+                             */
+                            virtual void execute(const size_t num_queries, lm_batch_query * queries) {
+                                //Process the queries in chunks of the maximum remote batch size
+                                for (size_t begin_idx = 0; begin_idx < num_queries; begin_idx += __lm_remote::MAX_BATCH_SIZE) {
+                                    const size_t num_batch = std::min<size_t>(num_queries - begin_idx, __lm_remote::MAX_BATCH_SIZE);
+                                    lm_batch_query * batch = queries + begin_idx;
+
+                                    LOG_DEBUG1 << "Sending a batch of " << num_batch << " LM queries" << END_LOG;
+
+                                    //Serialize the request, leaving space for the header
+                                    m_request.resize(sizeof (__lm_remote::s_batch_header));
+                                    for (size_t idx = 0; idx < num_batch; ++idx) {
+                                        ASSERT_SANITY_THROW((batch[idx].m_num_words == 0) || (batch[idx].m_num_words > LM_MAX_QUERY_LEN),
+                                                string("Invalid number of LM query words: ") + to_string(batch[idx].m_num_words));
+                                        append(&batch[idx].m_num_words, 1);
+                                        append(&batch[idx].m_min_level, 1);
+                                        append(batch[idx].m_word_ids, batch[idx].m_num_words);
+                                    }
+                                    __lm_remote::s_batch_header header = {
+                                        static_cast<uint32_t> (m_request.size() - sizeof (__lm_remote::s_batch_header)),
+                                        static_cast<uint32_t> (num_batch)
+                                    };
+                                    memcpy(m_request.data(), &header, sizeof (header));
+
+                                    //Do the round trip
+                                    m_is_in_trip = true;
+                                    __lm_remote::send_all(m_sock_desc, m_request.data(), m_request.size());
+                                    m_results.resize(num_batch);
+                                    ASSERT_CONDITION_THROW(!__lm_remote::recv_all(m_sock_desc, m_results.data(),
+                                            num_batch * sizeof (__lm_remote::s_query_result)),
+                                            "The LM server has closed the connection!");
+                                    m_is_in_trip = false;
+
+                                    //Store the results
+                                    for (size_t idx = 0; idx < num_batch; ++idx) {
+                                        batch[idx].m_prob = m_results[idx].m_prob;
+                                        batch[idx].m_min_level = m_results[idx].m_min_level;
+                                        batch[idx].m_state = m_results[idx].m_state;
+                                    }
+                                }
+                            }
+
+                        private:
+                            //Stores the reference to the configuration parameters
+                            const lm_parameters & m_params;
+                            //Stores the reference to the word index
+                            const lm_word_index & m_word_idx;
+                            //Stores the reference to the server handshake
+                            const __lm_remote::s_handshake & m_handshake;
+                            //Stores the connected socket descriptor
+                            const int m_sock_desc;
+                            //Stores the flag indicating that a round trip is not finished
+                            bool m_is_in_trip;
+                            //Stores the serialized batch request
+                            vector<uint8_t> m_request;
+                            //Stores the batch results
+                            vector<__lm_remote::s_query_result> m_results;
+
+                            /**
+                             * Allows to append the values to the serialized request
+                             * @param values the pointer to the values
+                             * @param num_values the number of values
+                             */
+                            template<typename VALUE_TYPE>
+                            inline void append(const VALUE_TYPE * values, const size_t num_values) {
+                                const uint8_t * begin = reinterpret_cast<const uint8_t *> (values);
+                                m_request.insert(m_request.end(), begin, begin + num_values * sizeof (VALUE_TYPE));
+                            }
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* LM_FAST_QUERY_PROXY_REMOTE_HPP */
+
@@ -26,6 +26,8 @@
 #ifndef TRIE_PROXY_HPP
 #define TRIE_PROXY_HPP
 
+#include <memory>       // std::shared_ptr
+
 #include "server/lm/proxy/lm_slow_query_proxy.hpp"
 #include "server/lm/proxy/lm_fast_query_proxy.hpp"
 
@@ -55,6 +57,18 @@ namespace uva {
                              */
                             virtual void disconnect() = 0;
 
+                            /**
+                             * Allows to write the connected model into a binary snapshot file,
+                             * the latter can be later used as a connection string.
+                             * @param file_name the name of the snapshot file to write
+                             */
+                            virtual void write_snapshot(const string & file_name) = 0;
+
+                            /**
+                             * Allows to report the run time information of the model queries
+                             */
+                            virtual void report_run_time_info() const = 0;
+
                             /**
                              * The basic virtual destructor
                              */
@@ -86,6 +100,10 @@ namespace uva {
                             virtual void dispose_fast_query_proxy(lm_fast_query_proxy & query) = 0;
 
                         };
+
+                        //Define the shared pointer to the trie proxy, the proxy is freed
+                        //once it is neither configured nor used by any of the decoders
+                        typedef shared_ptr<lm_proxy> lm_proxy_ptr;
                     }
                 }
             }
@@ -37,11 +37,13 @@
 
 #include "server/lm/proxy/lm_fast_query_proxy.hpp"
 #include "server/lm/proxy/lm_fast_query_proxy_local.hpp"
+#include "server/lm/proxy/lm_query_cache.hpp"
 
 #include "server/lm/proxy/lm_slow_query_proxy.hpp"
 #include "server/lm/proxy/lm_slow_query_proxy_local.hpp"
 
 #include "server/lm/builders/lm_basic_builder.hpp"
+#include "server/lm/builders/lm_snapshot_builder.hpp"
 
 using namespace uva::utils::monitor;
 using namespace uva::utils::exceptions;
@@ -51,6 +53,7 @@ using namespace uva::utils::file;
 using namespace uva::smt::bpbd::server::lm;
 using namespace uva::smt::bpbd::server::lm::proxy;
 using namespace uva::smt::bpbd::server::lm::arpa;
+using namespace uva::smt::bpbd::server::lm::binary;
 
 namespace uva {
     namespace smt {
@@ -71,7 +74,8 @@ namespace uva {
                              * The basic constructor of the trie proxy implementation class
                              * @param params the language model parameters
                              */
-                            lm_proxy_local() : m_word_index(__AWordIndex::MEMORY_FACTOR), m_model(m_word_index), m_params(NULL) {
+                            lm_proxy_local() : m_word_index(__AWordIndex::MEMORY_FACTOR), m_model(m_word_index), m_params(NULL),
+                            m_snapshot_file(NULL), m_model_uid(lm_query_cache::get_new_model_uid()) {
                             }
 
                             /**
@@ -91,7 +95,14 @@ namespace uva {
 
                                 //The whole purpose of this method connect here is
                                 //just to load the language model into the memory.
-                                load_model_data<lm_builder_type, lm_model_reader>("Language Model", params);
+                                //The binary snapshot is attached, the rest is parsed.
+                                if (lm_snapshot_builder<lm_model_type>::is_snapshot_file(params.m_conn_string)) {
+                                    attach_model_data("Language Model", params);
+                                } else if (params.m_num_load_threads > 1) {
+                                    load_model_data<lm_parallel_builder_type, lm_parallel_model_reader>("Language Model", params);
+                                } else {
+                                    load_model_data<lm_builder_type, lm_model_reader>("Language Model", params);
+                                }
 
                                 //Retrieve the unknown word probability
                                 get_unk_word_prob();
@@ -109,8 +120,35 @@ namespace uva {
                              * @see lm_proxy
                              */
                             virtual void disconnect() {
-                                //Nothing to be done at the moment, the word index
-                                //and trie are stack allocated class data members 
+                                //The word index and trie are stack allocated class data
+                                //members, only the snapshot file, if any, is to be closed
+                                if (m_snapshot_file != NULL) {
+                                    delete m_snapshot_file;
+                                    m_snapshot_file = NULL;
+                                }
+                            }
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual void write_snapshot(const string & file_name) {
+                                LOG_USAGE << "Writing the binary language model snapshot into: " << file_name << END_LOG;
+
+                                //Open the file, write the snapshot and close the file
+                                binary_file_writer file(file_name);
+                                lm_snapshot_writer<lm_model_type> writer(*m_params, m_model, file);
+                                writer.write();
+                                file.close();
+                            }
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual void report_run_time_info() const {
+                                //Report the query cache statistics, if the cache is used
+                                if (m_params->m_query_cache_bits != 0) {
+                                    lm_query_cache::report_run_time_info();
+                                }
                             }
 
                             /**
@@ -119,7 +157,8 @@ namespace uva {
                              * @see lm_proxy
                              */
                             virtual lm_fast_query_proxy & allocate_fast_query_proxy() {
-                                return *(new lm_fast_query_proxy_local<lm_model_type>(*m_params, m_model, m_unk_word_prob, m_begin_tag_uid, m_end_tag_uid));
+                                return *(new lm_fast_query_proxy_local<lm_model_type>(*m_params, m_model, m_unk_word_prob,
+                                        m_begin_tag_uid, m_end_tag_uid, m_model_uid));
                             }
 
                             /**
@@ -174,6 +213,42 @@ namespace uva {
                                         string("' word uid is not found!"));
                             }
 
+                            /**
+                             * Allows to attach the model to the binary snapshot file, the file
+                             * stays memory mapped until the proxy is disconnected.
+                             * @param the name of the model being loaded
+                             * @params params the model parameters
+                             */
+                            void attach_model_data(char const *model_name, const lm_parameters & params) {
+                                //Declare time variables for CPU times in seconds
+                                double start_time, end_time;
+                                //Declare the statistics monitor and its data
+                                TMemotyUsage mem_stat_start = {}, mem_stat_end = {};
+
+                                LOG_USAGE << "--------------------------------------------------------" << END_LOG;
+                                LOG_USAGE << "Start attaching the " << model_name << " binary snapshot ..." << END_LOG;
+                                LOG_USAGE << model_name << " is located in: " << params.m_conn_string << END_LOG;
+
+                                //Log the usage information
+                                m_model.log_model_type_info();
+
+                                LOG_DEBUG << "Getting the memory statistics before attaching the " << model_name << " ..." << END_LOG;
+                                stat_monitor::get_mem_stat(mem_stat_start);
+                                start_time = stat_monitor::get_cpu_time();
+
+                                //Map the snapshot file and attach the trie to it
+                                m_snapshot_file = new binary_mmap_reader(params.m_conn_string);
+                                lm_snapshot_builder<lm_model_type> builder(params, m_model, *m_snapshot_file);
+                                builder.build();
+
+                                end_time = stat_monitor::get_cpu_time();
+                                LOG_USAGE << "Attaching the " << model_name << " took " << (end_time - start_time) << " CPU seconds." << END_LOG;
+                                LOG_DEBUG << "Getting the memory statistics after attaching the " << model_name << " ..." << END_LOG;
+                                stat_monitor::get_mem_stat(mem_stat_end);
+                                const string action_name = string("Attaching the ") + string(model_name);
+                                report_memory_usage(action_name.c_str(), mem_stat_start, mem_stat_end, true);
+                            }
+
                             /**
                              * Allows to load the model into the instance of the selected container class
                              * \todo Add the possibility to choose between the file readers from the command line!
@@ -214,6 +289,9 @@ namespace uva {
                                 ASSERT_CONDITION_THROW(!model_file.is_open(), string("The ") + string(model_name) + string(" file: '")
                                         + model_file_name + string("' does not exist!"));
 
+                                //Allocate the model tables with the configured huge pages policy
+                                huge_page_allocator::scoped_policy huge_pages(params.m_huge_pages);
+
                                 //Create the trie builder and give it the trie
                                 lm_builder_type builder(params, m_model, model_file);
                                 //Load the model from the file
@@ -227,6 +305,9 @@ namespace uva {
                                 LOG_DEBUG << "Reporting on the memory consumption" << END_LOG;
                                 const string action_name = string("Loading the ") + string(model_name);
                                 report_memory_usage(action_name.c_str(), mem_stat_start, mem_stat_end, true);
+                                if (params.m_huge_pages != NO_HUGE_PAGES) {
+                                    huge_page_allocator::report_usage();
+                                }
 
                                 LOG_DEBUG << "Getting the memory statistics before closing the " << model_name << " file ..." << END_LOG;
                                 stat_monitor::get_mem_stat(mem_stat_start);
@@ -252,6 +333,12 @@ namespace uva {
 
                             //Stores the pointer to the configuration parameters
                             const lm_parameters * m_params;
+
+                            //Stores the memory mapped binary snapshot file, if the model is attached to one
+                            binary_mmap_reader * m_snapshot_file;
+
+                            //Stores the uid of this model instance, for the query cache
+                            const uint64_t m_model_uid;
                         };
                     }
                 }
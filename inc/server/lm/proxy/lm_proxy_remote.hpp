@@ -0,0 +1,242 @@
+/*
+ * File:   lm_proxy_remote.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 1:55 AM
+ */
+
+#ifndef LM_PROXY_REMOTE_HPP
+#define LM_PROXY_REMOTE_HPP
+
+#include <vector>
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+#include "common/utils/threads/threads.hpp"
+
+#include "server/lm/lm_configs.hpp"
+#include "server/lm/lm_consts.hpp"
+
+#include "server/lm/proxy/lm_proxy.hpp"
+#include "server/lm/proxy/lm_remote_protocol.hpp"
+#include "server/lm/proxy/lm_fast_query_proxy_remote.hpp"
+
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+using namespace uva::utils::threads;
+
+using namespace uva::smt::bpbd::server::lm;
+using namespace uva::smt::bpbd::server::lm::proxy;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace lm {
+                    namespace proxy {
+
+                        /**
+                         * This is a remote trie proxy implementation of the trie proxy interface.
+                         * The model is served by the lm-server process, the connection string is
+                         * its address: "tcp://host:port" or "unix://path". Each allocated query
+                         * proxy gets its own connection, the connections of the disposed query
+                         * proxies are kept open and are re-used by the next ones.
+                         */
+                        class lm_proxy_remote : public lm_proxy {
+                        public:
+
+                            /**
+                             * The basic constructor
+                             */
+                            lm_proxy_remote() : m_word_index(__AWordIndex::MEMORY_FACTOR), m_params(NULL),
+                            m_handshake(), m_free_socks(), m_num_socks(0), m_socks_lock() {
+                            }
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual ~lm_proxy_remote() {
+                                //Call the disconnect, just in case.
+                                disconnect();
+                            };
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual void connect(const lm_parameters & params) {
+                                //Store the parameters
+                                m_params = &params;
+
+                                LOG_USAGE << "--------------------------------------------------------" << END_LOG;
+                                LOG_USAGE << "Connecting to the Language Model server: " << params.m_conn_string << END_LOG;
+
+                                //The word ids are computed locally so the word index must be stateless
+                                ASSERT_CONDITION_THROW(m_word_index.is_word_registering_needed(),
+                                        "The remote language model requires the hashing word index!");
+
+                                //Open the first connection, it gets and checks the handshake
+                                m_free_socks.push_back(open_connection());
+
+                                LOG_USAGE << "Connected to the Language Model server." << END_LOG;
+                            }
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual void disconnect() {
+                                scoped_guard guard(m_socks_lock);
+
+                                //Close the connections of the disposed query proxies
+                                for (vector<int>::const_iterator iter = m_free_socks.begin(); iter != m_free_socks.end(); ++iter) {
+                                    ::close(*iter);
+                                }
+                                m_free_socks.clear();
+                            }
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual void write_snapshot(const string & file_name) {
+                                THROW_EXCEPTION("The remote language model can not be written into a snapshot!");
+                            }
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual void report_run_time_info() const {
+                                LOG_USAGE << "The number of the Language Model server connections: " << m_num_socks << END_LOG;
+                            }
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual lm_fast_query_proxy & allocate_fast_query_proxy() {
+                                int sock_desc = -1;
+                                {
+                                    scoped_guard guard(m_socks_lock);
+                                    if (!m_free_socks.empty()) {
+                                        sock_desc = m_free_socks.back();
+                                        m_free_socks.pop_back();
+                                    }
+                                }
+
+                                //Open a new connection if there is no free one
+                                if (sock_desc == -1) {
+                                    sock_desc = open_connection();
+                                }
+
+                                return *(new lm_fast_query_proxy_remote(*m_params, m_word_index, m_handshake, sock_desc));
+                            }
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual void dispose_fast_query_proxy(lm_fast_query_proxy & query) {
+                                lm_fast_query_proxy_remote & remote_query = dynamic_cast<lm_fast_query_proxy_remote &> (query);
+
+                                //Keep the connection for the next query proxy, unless it is broken
+                                if (remote_query.is_reusable()) {
+                                    scoped_guard guard(m_socks_lock);
+                                    m_free_socks.push_back(remote_query.get_sock_desc());
+                                } else {
+                                    ::close(remote_query.get_sock_desc());
+                                }
+
+                                delete &remote_query;
+                            }
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual lm_slow_query_proxy & allocate_slow_query_proxy() {
+                                THROW_EXCEPTION("The remote language model does not support the slow query proxy!");
+                            }
+
+                            /**
+                             * @see lm_proxy
+                             */
+                            virtual void dispose_slow_query_proxy(lm_slow_query_proxy & query) {
+                                THROW_MUST_NOT_CALL();
+                            }
+
+                        private:
+                            //Stores the word index, the hashing one does not need the model
+                            lm_word_index m_word_index;
+                            //Stores the pointer to the configuration parameters
+                            const lm_parameters * m_params;
+                            //Stores the handshake received from the server
+                            __lm_remote::s_handshake m_handshake;
+                            //Stores the connections of the disposed query proxies
+                            vector<int> m_free_socks;
+                            //Stores the number of the opened connections
+                            atomic<uint32_t> m_num_socks;
+                            //Stores the lock for the connections
+                            mutex m_socks_lock;
+
+                            /**
+                             * Allows to open a new connection to the server and to check its handshake,
+                             * the model must be the same as the one the decoder is configured with.
+                             * @return the connected socket descriptor
+                             */
+                            inline int open_connection() {
+                                const int sock_desc = __lm_remote::open_socket(m_params->m_conn_string, false);
+
+                                //Receive the handshake
+                                __lm_remote::s_handshake handshake = {};
+                                if (!__lm_remote::recv_all(sock_desc, &handshake, sizeof (handshake))) {
+                                    ::close(sock_desc);
+                                    THROW_EXCEPTION("The LM server has closed the connection!");
+                                }
+
+                                if (m_num_socks == 0) {
+                                    //Check that the model header is the expected one
+                                    __lm_snapshot::s_header expected = {};
+                                    __lm_snapshot::set_header<lm_model_type>(*m_params, expected);
+                                    if (memcmp(&handshake.m_header, &expected, sizeof (expected)) != 0) {
+                                        ::close(sock_desc);
+                                        THROW_EXCEPTION(string("The LM server model has a different build configuration, ") +
+                                                string("model type, lm weight or unk word log_e prob than the configured one!"));
+                                    }
+                                    //Store the handshake data, is done once from the connect method
+                                    m_handshake = handshake;
+                                } else {
+                                    //The other connections must be to the same model
+                                    if (memcmp(&handshake, &m_handshake, sizeof (handshake)) != 0) {
+                                        ::close(sock_desc);
+                                        THROW_EXCEPTION("The LM server model has changed since the first connection!");
+                                    }
+                                }
+                                ++m_num_socks;
+
+                                LOG_DEBUG << "Opened the LM server connection: " << sock_desc << END_LOG;
+
+                                return sock_desc;
+                            }
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* LM_PROXY_REMOTE_HPP */
+
@@ -0,0 +1,291 @@
+/*
+ * File:   lm_query_cache.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 10:12 AM
+ */
+
+#ifndef LM_QUERY_CACHE_HPP
+#define LM_QUERY_CACHE_HPP
+
+#include <set>
+#include <atomic>
+#include <algorithm>
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/threads/threads.hpp"
+
+#include "server/server_configs.hpp"
+#include "server/lm/lm_consts.hpp"
+
+using namespace std;
+
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+using namespace uva::utils::threads;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace lm {
+                    namespace proxy {
+
+                        /**
+                         * This structure stores one cached sub-m-gram result, the entry takes
+                         * 16 bytes so that four of them fit into one cache line.
+                         * @param m_hash the sub-m-gram hash value
+                         * @param m_prob the conditional log_e probability of the sub-m-gram
+                         *               end word, including the back-off weights sum
+                         * @param m_level the sub-m-gram level, zero for an empty entry
+                         * @param m_ctx_len the sub-m-gram minimized context length, see
+                         *                  m_gram_query::get_ctx_len
+                         */
+                        struct lm_cache_entry {
+                            uint64_t m_hash;
+                            prob_weight m_prob;
+                            phrase_length m_level;
+                            phrase_length m_ctx_len;
+                        };
+
+                        /**
+                         * This is the bounded direct-mapped cache of the computed sub-m-gram
+                         * probabilities. The cache is keyed by the sub-m-gram hash and level,
+                         * a new entry just overwrites the old one with the same index. The
+                         * cache is thread-local, see get_thread_cache, so it does not need
+                         * any synchronization and survives the sentences translated by the
+                         * same thread. The cached entries are only valid for the model they
+                         * were computed with, so the cache remembers the model's uid, see
+                         * set_model_uid, and is cleared once the thread queries another model,
+                         * e.g. after the model is reloaded. The hit/miss counters of all the
+                         * thread caches are reported together by report_run_time_info.
+                         */
+                        class lm_query_cache {
+                        public:
+
+                            /**
+                             * The basic constructor, creates a disabled cache
+                             */
+                            lm_query_cache() : m_entries(NULL), m_num_bits(0), m_mask(0), m_model_uid(0), m_num_hits(0), m_num_misses(0) {
+                                scoped_guard guard(m_caches_lock);
+
+                                //Register the cache for the run time statistics
+                                m_caches.insert(this);
+                            }
+
+                            /**
+                             * The basic destructor
+                             */
+                            ~lm_query_cache() {
+                                {
+                                    scoped_guard guard(m_caches_lock);
+
+                                    //Keep the counts of the cache in the totals
+                                    m_gone_num_hits += m_num_hits;
+                                    m_gone_num_misses += m_num_misses;
+
+                                    //Un-register the cache
+                                    m_caches.erase(this);
+                                }
+
+                                if (m_entries != NULL) {
+                                    delete[] m_entries;
+                                    m_entries = NULL;
+                                }
+                            }
+
+                            /**
+                             * Allows to get the cache of the current thread, the cache is
+                             * created on the first call and is disabled until its size is set.
+                             * @return the reference to the thread-local cache
+                             */
+                            static inline lm_query_cache & get_thread_cache() {
+                                static thread_local lm_query_cache cache;
+                                return cache;
+                            }
+
+                            /**
+                             * Allows to set the cache size, if the size changes then the
+                             * cache is re-allocated and all the cached entries are lost.
+                             * @param num_bits the number of bits of the cache size, the cache
+                             *                 has 2^num_bits entries, zero disables the cache
+                             */
+                            inline void set_num_bits(const size_t num_bits) {
+                                if (num_bits != m_num_bits) {
+                                    ASSERT_SANITY_THROW((num_bits > LM_QUERY_CACHE_BITS_MAX),
+                                            string("The LM query cache bits: ") + to_string(num_bits) +
+                                            string(" exceed the maximum: ") + to_string(LM_QUERY_CACHE_BITS_MAX));
+
+                                    //Free the old entries if any
+                                    if (m_entries != NULL) {
+                                        delete[] m_entries;
+                                        m_entries = NULL;
+                                    }
+
+                                    //Allocate the new zero initialized entries if needed
+                                    m_num_bits = num_bits;
+                                    if (m_num_bits != 0) {
+                                        const size_t num_entries = (static_cast<size_t> (1) << m_num_bits);
+                                        m_entries = new lm_cache_entry[num_entries]();
+                                        m_mask = num_entries - 1;
+                                    } else {
+                                        m_mask = 0;
+                                    }
+
+                                    LOG_DEBUG << "The LM query cache of thread " << this_thread::get_id()
+                                            << " has 2^" << m_num_bits << " entries" << END_LOG;
+                                }
+                            }
+
+                            /**
+                             * Allows to set the uid of the model the cache is used with, if the
+                             * uid changes then all the cached entries are cleared.
+                             * @param model_uid the model uid, see get_new_model_uid
+                             */
+                            inline void set_model_uid(const uint64_t model_uid) {
+                                if (model_uid != m_model_uid) {
+                                    //Clear the entries of the previous model, the zero level means empty
+                                    if (m_entries != NULL) {
+                                        fill(m_entries, m_entries + m_mask + 1, lm_cache_entry());
+                                    }
+                                    m_model_uid = model_uid;
+
+                                    LOG_DEBUG << "The LM query cache of thread " << this_thread::get_id()
+                                            << " is set to model " << m_model_uid << END_LOG;
+                                }
+                            }
+
+                            /**
+                             * Allows to get a new unique model uid, is to be called once per model
+                             * instance. The uids are never re-used so they are never confused.
+                             * @return the new model uid, never zero
+                             */
+                            static inline uint64_t get_new_model_uid() {
+                                return ++m_last_model_uid;
+                            }
+
+                            /**
+                             * Allows to check if the cache is enabled
+                             * @return true if the cache is enabled
+                             */
+                            inline bool is_enabled() const {
+                                return (m_entries != NULL);
+                            }
+
+                            /**
+                             * Allows to get the cached sub-m-gram entry, must only be called if enabled.
+                             * @param hash the sub-m-gram hash
+                             * @param level the sub-m-gram level
+                             * @return the pointer to the cached entry or NULL if it is not cached
+                             */
+                            inline const lm_cache_entry * get(const uint64_t hash, const phrase_length level) {
+                                const lm_cache_entry & entry = m_entries[hash & m_mask];
+                                if ((entry.m_hash == hash) && (entry.m_level == level)) {
+                                    increment(m_num_hits);
+                                    return &entry;
+                                } else {
+                                    increment(m_num_misses);
+                                    return NULL;
+                                }
+                            }
+
+                            /**
+                             * Allows to put the sub-m-gram result into the cache, must only be called if enabled.
+                             * @param hash the sub-m-gram hash
+                             * @param level the sub-m-gram level
+                             * @param prob the conditional log_e probability of the sub-m-gram end word
+                             * @param ctx_len the sub-m-gram minimized context length
+                             */
+                            inline void put(const uint64_t hash, const phrase_length level,
+                                    const prob_weight prob, const phrase_length ctx_len) {
+                                lm_cache_entry & entry = m_entries[hash & m_mask];
+                                entry.m_hash = hash;
+                                entry.m_prob = prob;
+                                entry.m_level = level;
+                                entry.m_ctx_len = ctx_len;
+                            }
+
+                            /**
+                             * Allows to report the hit/miss counters summed over all the thread caches
+                             */
+                            static inline void report_run_time_info() {
+                                scoped_guard guard(m_caches_lock);
+
+                                //Sum up the counters of the gone and the present caches
+                                uint64_t num_hits = m_gone_num_hits;
+                                uint64_t num_misses = m_gone_num_misses;
+                                for (auto iter = m_caches.begin(); iter != m_caches.end(); ++iter) {
+                                    num_hits += (*iter)->m_num_hits.load(memory_order_relaxed);
+                                    num_misses += (*iter)->m_num_misses.load(memory_order_relaxed);
+                                }
+
+                                const uint64_t num_total = num_hits + num_misses;
+                                LOG_USAGE << "LM query cache: #hits: " << num_hits << ", #misses: " << num_misses
+                                        << ", hit rate: " << ((num_total == 0) ? 0.0 : (100.0 * num_hits) / num_total)
+                                        << "%" << END_LOG;
+                            }
+
+                        private:
+                            //Stores the cache entries
+                            lm_cache_entry * m_entries;
+                            //Stores the number of bits of the cache size
+                            size_t m_num_bits;
+                            //Stores the entry index mask
+                            uint64_t m_mask;
+                            //Stores the uid of the model the cached entries belong to
+                            uint64_t m_model_uid;
+
+                            //Stores the number of cache hits, only the owner thread writes
+                            atomic<uint64_t> m_num_hits;
+                            //Stores the number of cache misses, only the owner thread writes
+                            atomic<uint64_t> m_num_misses;
+
+                            //Stores the lock for the registered caches
+                            static mutex m_caches_lock;
+                            //Stores the registered caches
+                            static set<lm_query_cache *> m_caches;
+                            //Stores the number of cache hits of the destroyed caches
+                            static uint64_t m_gone_num_hits;
+                            //Stores the number of cache misses of the destroyed caches
+                            static uint64_t m_gone_num_misses;
+                            //Stores the last issued model uid
+                            static atomic<uint64_t> m_last_model_uid;
+
+                            /**
+                             * Allows to increment the counter, there is only one writer so no
+                             * atomic read-modify-write is needed, the atomic store just
+                             * makes the value visible to the reporting thread.
+                             * @param counter the counter to increment
+                             */
+                            static inline void increment(atomic<uint64_t> & counter) {
+                                counter.store(counter.load(memory_order_relaxed) + 1, memory_order_relaxed);
+                            }
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* LM_QUERY_CACHE_HPP */
+
@@ -0,0 +1,296 @@
+/*
+ * File:   lm_remote_protocol.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 1:30 AM
+ */
+
+#ifndef LM_REMOTE_PROTOCOL_HPP
+#define LM_REMOTE_PROTOCOL_HPP
+
+#include <string>       // std::string
+#include <cstring>      // std::memcpy
+#include <unistd.h>     // std::close
+#include <netdb.h>      // std::getaddrinfo
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <errno.h>
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+
+#include "server/lm/lm_consts.hpp"
+#include "server/lm/lm_parameters.hpp"
+#include "server/lm/proxy/lm_fast_query_proxy.hpp"
+#include "server/lm/builders/lm_snapshot_builder.hpp"
+
+using namespace std;
+
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+
+using namespace uva::smt::bpbd::server::lm::binary;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace lm {
+                    namespace proxy {
+
+                        /**
+                         * This namespace contains the wire protocol between the remote language
+                         * model proxy and the lm-server. The connection is a stream socket, TCP
+                         * or Unix. Once the connection is accepted the server sends the handshake,
+                         * then the client sends batches of queries and gets the batch results:
+                         *
+                         * request:  s_batch_header, then per query: phrase_length num_words,
+                         *           phrase_length min_level, word_uid word_ids[num_words]
+                         * response: s_query_result[num_queries]
+                         *
+                         * The values are sent in the native byte order, the handshake allows
+                         * to check that both ends are built with the same configuration.
+                         */
+                        namespace __lm_remote {
+                            //Stores the connection string prefix of the TCP socket, "tcp://host:port"
+                            static constexpr const char * TCP_PREFIX = "tcp://";
+                            //Stores the connection string prefix of the Unix socket, "unix://path"
+                            static constexpr const char * UNIX_PREFIX = "unix://";
+                            //Stores the maximum number of queries in one batch
+                            static constexpr uint32_t MAX_BATCH_SIZE = 1024;
+                            //Stores the maximum number of bytes in one batch request
+                            static constexpr uint32_t MAX_BATCH_BYTES = MAX_BATCH_SIZE *
+                                    (2 * sizeof (phrase_length) + LM_MAX_QUERY_LEN * sizeof (word_uid));
+                            //Stores the number of pending connections of the listening socket
+                            static constexpr int LISTEN_BACKLOG = 128;
+
+                            /**
+                             * This structure stores the handshake sent by the server
+                             * @param m_header the model header, the same as the one of the binary snapshot
+                             * @param m_unk_word_prob the unknown word probability of the model
+                             * @param m_begin_tag_uid the begin sentence tag uid
+                             * @param m_end_tag_uid the end sentence tag uid
+                             */
+                            typedef struct {
+                                __lm_snapshot::s_header m_header;
+                                prob_weight m_unk_word_prob;
+                                word_uid m_begin_tag_uid;
+                                word_uid m_end_tag_uid;
+                            } s_handshake;
+
+                            /**
+                             * This structure stores the batch request header
+                             * @param m_num_bytes the number of bytes of the queries following the header
+                             * @param m_num_queries the number of queries in the batch
+                             */
+                            typedef struct {
+                                uint32_t m_num_bytes;
+                                uint32_t m_num_queries;
+                            } s_batch_header;
+
+                            /**
+                             * This structure stores the result of one query of the batch
+                             * @param m_prob the resulting probability weight
+                             * @param m_min_level the next minimum m-gram level to consider
+                             * @param m_state the resulting language model state
+                             */
+                            typedef struct {
+                                prob_weight m_prob;
+                                phrase_length m_min_level;
+                                lm_state m_state;
+                            } s_query_result;
+
+                            /**
+                             * Allows to check if the connection string is the one of a remote model
+                             * @param conn_string the connection string
+                             * @return true if the connection string is a TCP or a Unix socket address
+                             */
+                            static inline bool is_remote(const string & conn_string) {
+                                return (conn_string.compare(0, strlen(TCP_PREFIX), TCP_PREFIX) == 0) ||
+                                        (conn_string.compare(0, strlen(UNIX_PREFIX), UNIX_PREFIX) == 0);
+                            }
+
+                            /**
+                             * Allows to create a connected or a listening socket for the address
+                             * @param address the socket address, "tcp://host:port" or "unix://path"
+                             * @param is_server true for a listening socket, false for a connected one
+                             * @return the socket descriptor
+                             */
+                            static inline int open_socket(const string & address, const bool is_server) {
+                                int sock_desc = -1, result = -1;
+                                errno = 0;
+                                if (address.compare(0, strlen(UNIX_PREFIX), UNIX_PREFIX) == 0) {
+                                    //Create the Unix domain socket address
+                                    const string path = address.substr(strlen(UNIX_PREFIX));
+                                    sockaddr_un addr = {};
+                                    addr.sun_family = AF_UNIX;
+                                    ASSERT_CONDITION_THROW((path.empty() || (path.length() >= sizeof (addr.sun_path))),
+                                            string("Invalid Unix socket path: '") + path + string("'"));
+                                    strncpy(addr.sun_path, path.c_str(), sizeof (addr.sun_path) - 1);
+
+                                    sock_desc = socket(AF_UNIX, SOCK_STREAM, 0);
+                                    if (sock_desc != -1) {
+                                        if (is_server) {
+                                            //Remove the socket file left by a previous server
+                                            unlink(path.c_str());
+                                            result = bind(sock_desc, reinterpret_cast<sockaddr *> (&addr), sizeof (addr));
+                                        } else {
+                                            result = connect(sock_desc, reinterpret_cast<sockaddr *> (&addr), sizeof (addr));
+                                        }
+                                    }
+                                } else {
+                                    ASSERT_CONDITION_THROW((address.compare(0, strlen(TCP_PREFIX), TCP_PREFIX) != 0),
+                                            string("Invalid LM server address: '") + address + string("'"));
+
+                                    //Split the host and the port, an empty host means any for the server
+                                    const string host_port = address.substr(strlen(TCP_PREFIX));
+                                    const size_t colon_pos = host_port.rfind(':');
+                                    ASSERT_CONDITION_THROW((colon_pos == string::npos) || (colon_pos + 1 == host_port.length()),
+                                            string("The LM server address: '") + address + string("' has no port"));
+                                    const string host = host_port.substr(0, colon_pos);
+                                    const string port = host_port.substr(colon_pos + 1);
+
+                                    //Resolve the address
+                                    addrinfo hints = {}, * info = NULL;
+                                    hints.ai_family = AF_UNSPEC;
+                                    hints.ai_socktype = SOCK_STREAM;
+                                    hints.ai_flags = (is_server ? AI_PASSIVE : 0);
+                                    const int error = getaddrinfo(host.empty() ? NULL : host.c_str(), port.c_str(), &hints, &info);
+                                    ASSERT_CONDITION_THROW((error != 0), string("Could not resolve the LM server address: '") +
+                                            address + string("', ERROR: ") + gai_strerror(error));
+
+                                    sock_desc = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+                                    if (sock_desc != -1) {
+                                        const int flag = 1;
+                                        if (is_server) {
+                                            setsockopt(sock_desc, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof (flag));
+                                            result = bind(sock_desc, info->ai_addr, info->ai_addrlen);
+                                        } else {
+                                            //The batches are small and latency bound, do not delay them
+                                            setsockopt(sock_desc, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof (flag));
+                                            result = connect(sock_desc, info->ai_addr, info->ai_addrlen);
+                                        }
+                                    }
+                                    freeaddrinfo(info);
+                                }
+
+                                if ((result == 0) && is_server) {
+                                    result = listen(sock_desc, LISTEN_BACKLOG);
+                                }
+
+                                if (result != 0) {
+                                    const string error = strerror(errno);
+                                    if (sock_desc != -1) {
+                                        ::close(sock_desc);
+                                    }
+                                    THROW_EXCEPTION(string("Could not ") + (is_server ? string("listen on") : string("connect to")) +
+                                            string(" the LM server address: '") + address + string("', ERROR: ") + error);
+                                }
+
+                                return sock_desc;
+                            }
+
+                            /**
+                             * Allows to set the TCP no delay option on the accepted socket, is
+                             * ignored for the Unix sockets
+                             * @param sock_desc the socket descriptor
+                             */
+                            static inline void set_no_delay(const int sock_desc) {
+                                const int flag = 1;
+                                setsockopt(sock_desc, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof (flag));
+                            }
+
+                            /**
+                             * Allows to send all the data into the socket
+                             * @param sock_desc the socket descriptor
+                             * @param data the pointer to the data
+                             * @param num_bytes the number of bytes to send
+                             */
+                            static inline void send_all(const int sock_desc, const void * data, size_t num_bytes) {
+                                const uint8_t * ptr = static_cast<const uint8_t *> (data);
+                                while (num_bytes != 0) {
+                                    const ssize_t num_sent = send(sock_desc, ptr, num_bytes, MSG_NOSIGNAL);
+                                    if (num_sent < 0) {
+                                        ASSERT_CONDITION_THROW((errno != EINTR), string("Could not send to the LM ") +
+                                                string("server connection, ERROR: ") + strerror(errno));
+                                    } else {
+                                        ptr += num_sent;
+                                        num_bytes -= num_sent;
+                                    }
+                                }
+                            }
+
+                            /**
+                             * Allows to receive the given amount of data from the socket
+                             * @param sock_desc the socket descriptor
+                             * @param data the pointer to the data buffer
+                             * @param num_bytes the number of bytes to receive
+                             * @return false if the connection was closed before any data was received
+                             */
+                            static inline bool recv_all(const int sock_desc, void * data, size_t num_bytes) {
+                                uint8_t * ptr = static_cast<uint8_t *> (data);
+                                const size_t total_bytes = num_bytes;
+                                while (num_bytes != 0) {
+                                    const ssize_t num_recv = recv(sock_desc, ptr, num_bytes, 0);
+                                    if (num_recv < 0) {
+                                        ASSERT_CONDITION_THROW((errno != EINTR), string("Could not receive from the LM ") +
+                                                string("server connection, ERROR: ") + strerror(errno));
+                                    } else if (num_recv == 0) {
+                                        ASSERT_CONDITION_THROW((num_bytes != total_bytes),
+                                                "The LM server connection is closed in the middle of a message!");
+                                        return false;
+                                    } else {
+                                        ptr += num_recv;
+                                        num_bytes -= num_recv;
+                                    }
+                                }
+                                return true;
+                            }
+
+                            /**
+                             * Allows to set the handshake for the given model parameters
+                             * @param trie_type the model type
+                             * @param params the model parameters
+                             * @param unk_word_prob the unknown word probability
+                             * @param begin_tag_uid the begin sentence tag uid
+                             * @param end_tag_uid the end sentence tag uid
+                             * @param handshake [out] the handshake to be set
+                             */
+                            template<typename trie_type>
+                            static inline void set_handshake(const lm_parameters & params, const prob_weight unk_word_prob,
+                                    const word_uid begin_tag_uid, const word_uid end_tag_uid, s_handshake & handshake) {
+                                __lm_snapshot::set_header<trie_type>(params, handshake.m_header);
+                                handshake.m_unk_word_prob = unk_word_prob;
+                                handshake.m_begin_tag_uid = begin_tag_uid;
+                                handshake.m_end_tag_uid = end_tag_uid;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* LM_REMOTE_PROTOCOL_HPP */
+
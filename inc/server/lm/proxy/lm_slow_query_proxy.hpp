@@ -66,6 +66,20 @@ namespace uva {
                              * @param line the text piece reader storing the m-gram query line
                              */
                             virtual void execute(text_piece_reader & line) = 0;
+
+                            /**
+                             * Allows to get the joint log_e probability computed by the last executed query.
+                             * The zero probabilities, if any, are not accounted for.
+                             * @return the joint log_e probability of the last query
+                             */
+                            virtual prob_weight get_joint_prob() const = 0;
+
+                            /**
+                             * Allows to get the number of m-gram probabilities accounted
+                             * for in the joint probability of the last executed query.
+                             * @return the number of probabilities in the joint probability of the last query
+                             */
+                            virtual phrase_length get_num_probs() const = 0;
                         };
                     }
                 }
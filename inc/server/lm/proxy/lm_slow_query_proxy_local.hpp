@@ -59,7 +59,7 @@ namespace uva {
                              */
                             lm_slow_query_proxy_local(const trie_type & trie)
                             : m_trie(trie), m_word_idx(m_trie.get_word_index()),
-                            m_query(), m_num_words(0), m_joint_prob(0.0) {
+                            m_query(), m_num_words(0), m_joint_prob(0.0), m_num_probs(0) {
                             }
 
                             /**
@@ -83,6 +83,7 @@ namespace uva {
                             virtual void execute(text_piece_reader & line) {
                                 //Re-initialize the joint prob reault with zero
                                 m_joint_prob = 0.0;
+                                m_num_probs = 0;
 
                                 //Parse the query line into tokens and get the word ids thereof
                                 set_tokens_and_word_ids(line);
@@ -137,6 +138,20 @@ namespace uva {
                                 LOG_RESULT << "-------------------------------------------" << END_LOG;
                             }
 
+                            /**
+                             * @see lm_slow_query_proxy
+                             */
+                            virtual prob_weight get_joint_prob() const {
+                                return m_joint_prob;
+                            }
+
+                            /**
+                             * @see lm_slow_query_proxy
+                             */
+                            virtual phrase_length get_num_probs() const {
+                                return m_num_probs;
+                            }
+
                         protected:
 
                             /**
@@ -162,6 +177,7 @@ namespace uva {
 
                                     if (m_query.m_probs[end_word_idx] > ZERO_LOG_PROB_WEIGHT) {
                                         m_joint_prob += m_query.m_probs[end_word_idx];
+                                        ++m_num_probs;
                                     }
                                 }
                             }
@@ -286,6 +302,9 @@ namespace uva {
 
                             //Stores the joint probability result for the query
                             prob_weight m_joint_prob;
+
+                            //Stores the number of probabilities in the joint probability
+                            phrase_length m_num_probs;
                         };
 
                         template<typename trie_type>
@@ -33,7 +33,7 @@
 #include "common/utils/file/text_piece_reader.hpp"
 #include "common/utils/text/string_utils.hpp"
 
-#include "server/tm/tm_configurator.hpp"
+#include "server/tm/proxy/tm_proxy.hpp"
 #include "server/tm/proxy/tm_query_proxy.hpp"
 
 #include "server/common/models/phrase_uid.hpp"
@@ -80,9 +80,10 @@ namespace uva {
                              * @params params the model parameters
                              * @param model the model to put the data into
                              * @param reader the reader to read the data from
+                             * @param tm_model the translation model to check the source/target phrases with
                              */
-                            rm_basic_builder(const rm_parameters & params, model_type & model, reader_type & reader)
-                            : m_params(params), m_model(model), m_reader(reader), m_num_entries(0) {
+                            rm_basic_builder(const rm_parameters & params, model_type & model, reader_type & reader, tm_proxy & tm_model)
+                            : m_params(params), m_model(model), m_reader(reader), m_tm_model(tm_model), m_num_entries(0) {
                                 LOG_DEBUG << "Creating the basic RM builder" << END_LOG;
                             }
 
@@ -98,7 +99,7 @@ namespace uva {
                                 rm_entry::set_num_features(m_params.m_num_lambdas);
 
                                 //Obtains the query proxy
-                                tm_query_proxy & query = tm_configurator::allocate_query_proxy();
+                                tm_query_proxy & query = m_tm_model.allocate_query_proxy();
 
                                 //Count and set the number of source phrases if needed
                                 if (m_model.is_num_entries_needed()) {
@@ -109,7 +110,7 @@ namespace uva {
                                 process_source_entries(query);
 
                                 //Dispose the query proxy
-                                tm_configurator::dispose_query_proxy(query);
+                                m_tm_model.dispose_query_proxy(query);
 
                                 LOG_DEBUG << "The RM model is built!" << END_LOG;
                             }
@@ -296,6 +297,8 @@ namespace uva {
                             model_type & m_model;
                             //Stores the reference to the builder;
                             reader_type & m_reader;
+                            //Stores the reference to the translation model
+                            tm_proxy & m_tm_model;
                             //Stores the number of valid RM model entries
                             size_t m_num_entries;
                         };
@@ -26,6 +26,8 @@
 #ifndef RM_BASIC_MODEL_HPP
 #define RM_BASIC_MODEL_HPP
 
+#include <type_traits>  // std::conditional
+
 #include "common/utils/exceptions.hpp"
 #include "common/utils/logging/logger.hpp"
 
@@ -34,6 +36,7 @@
 #include "server/rm/models/rm_query.hpp"
 
 #include "common/utils/containers/fixed_size_hashmap.hpp"
+#include "common/utils/containers/fingerprint_hashmap.hpp"
 
 using namespace std;
 
@@ -71,7 +74,9 @@ namespace uva {
                             const phrase_uid END_SENT_TAG_UID;
 
                             //Define the translations data map. It represents possible translations for some source phrase.
-                            typedef fixed_size_hashmap<rm_entry, const phrase_uid &> rm_entry_map;
+                            typedef conditional<__rm_basic_model::IS_FINGERPRINT_HASHMAP,
+                            fingerprint_hashmap<rm_entry, const phrase_uid &>,
+                            fixed_size_hashmap<rm_entry, const phrase_uid &> >::type rm_entry_map;
 
                             /**
                              * The basic class constructor
@@ -26,8 +26,13 @@
 #ifndef RM_PROXY_HPP
 #define RM_PROXY_HPP
 
+#include <memory>       // std::shared_ptr
+
+#include "server/tm/proxy/tm_proxy.hpp"
 #include "server/rm/proxy/rm_query_proxy.hpp"
 
+using namespace uva::smt::bpbd::server::tm::proxy;
+
 namespace uva {
     namespace smt {
         namespace bpbd {
@@ -45,8 +50,9 @@ namespace uva {
                             /**
                              * Allows to connect to the model object based on the given parameters
                              * @param params the model parameters
+                             * @param tm_model the translation model to get the source/target phrase ids from
                              */
-                            virtual void connect(const rm_parameters & params) = 0;
+                            virtual void connect(const rm_parameters & params, tm_proxy & tm_model) = 0;
 
                             /**
                              * Allows to disconnect from the trie
@@ -70,6 +76,9 @@ namespace uva {
                              */
                             virtual void dispose_query_proxy(rm_query_proxy & query) = 0;
                         };
+
+                        //Define the shared pointer to the reordering model proxy
+                        typedef shared_ptr<rm_proxy> rm_proxy_ptr;
                     }
                 }
             }
@@ -76,10 +76,10 @@ namespace uva {
                             /**
                              * @see rm_proxy
                              */
-                            virtual void connect(const rm_parameters & params) {
+                            virtual void connect(const rm_parameters & params, tm_proxy & tm_model) {
                                 //The whole purpose of this method connect here is
                                 //just to load the reordering model into the memory.
-                                load_model_data<rm_builder_type, rm_model_reader>("Reordering Model", params);
+                                load_model_data<rm_builder_type, rm_model_reader>("Reordering Model", params, tm_model);
 
                                 //Get the pointers to the begin and end tag reordering entries
                                 m_begin_tag_entry = m_model.get_begin_tag_entry();
@@ -119,9 +119,10 @@ namespace uva {
                              * \todo Add the possibility to choose between the file readers from the command line!
                              * @param the name of the model being loaded
                              * @params params the model parameters
+                             * @param tm_model the translation model to check the source/target phrases with
                              */
                             template<typename rm_builder_type, typename file_reader_type>
-                            void load_model_data(char const *model_name, const rm_parameters & params) {
+                            void load_model_data(char const *model_name, const rm_parameters & params, tm_proxy & tm_model) {
                                 const string & model_file_name = params.m_conn_string;
 
                                 //Declare time variables for CPU times in seconds
@@ -157,9 +158,12 @@ namespace uva {
                                 ASSERT_CONDITION_THROW(!model_file.is_open(), string("The ") + string(model_name) + string(" file: '")
                                         + model_file_name + string("' does not exist!"));
 
+                                //Allocate the model tables with the configured huge pages policy
+                                huge_page_allocator::scoped_policy huge_pages(params.m_huge_pages);
+
                                 //Create the trie builder and give it the trie
                                 LOG_DEBUG << "Creating the RM model builder!" << END_LOG;
-                                rm_builder_type builder(params, m_model, model_file);
+                                rm_builder_type builder(params, m_model, model_file, tm_model);
 
                                 //Load the model from the file
                                 LOG_DEBUG << "Start reading the RM model with the builder!" << END_LOG;
@@ -173,6 +177,9 @@ namespace uva {
                                 LOG_DEBUG << "Reporting on the memory consumption" << END_LOG;
                                 const string action_name = string("Loading the ") + string(model_name);
                                 report_memory_usage(action_name.c_str(), mem_stat_start, mem_stat_end, true);
+                                if (params.m_huge_pages != NO_HUGE_PAGES) {
+                                    huge_page_allocator::report_usage();
+                                }
 
                                 LOG_DEBUG << "Getting the memory statistics before closing the " << model_name << " file ..." << END_LOG;
                                 stat_monitor::get_mem_stat(mem_stat_start);
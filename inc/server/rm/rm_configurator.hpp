@@ -26,9 +26,12 @@
 #ifndef RM_CONFIGURATOR_HPP
 #define RM_CONFIGURATOR_HPP
 
+#include <memory>       // std::shared_ptr, std::atomic_load
+
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/exceptions.hpp"
 
+#include "server/tm/tm_configurator.hpp"
 #include "server/rm/rm_parameters.hpp"
 #include "server/rm/proxy/rm_proxy.hpp"
 #include "server/rm/proxy/rm_proxy_local.hpp"
@@ -63,44 +66,53 @@ namespace uva {
                             //Store the parameters for future use
                             m_params = &params;
 
+                            //Create the model and make it the current one, the model
+                            //is built against the current translation model
+                            set_model_proxy(create_model_proxy(*tm_configurator::get_model_proxy()));
+                        }
+
+                        /**
+                         * Allows to create and connect a new instance of the reordering model,
+                         * using the connected parameters, e.g. to reload the model files.
+                         * The new instance does not become current until set_model_proxy.
+                         * @param tm_model the translation model to check the source/target phrases with
+                         * @return the new connected model proxy
+                         */
+                        static rm_proxy_ptr create_model_proxy(tm_proxy & tm_model) {
                             //At the moment we only support a local proxy
-                            m_model_proxy = new rm_proxy_local();
+                            rm_proxy_ptr proxy(new rm_proxy_local());
 
                             //Connect to the model instance using the given parameters
-                            m_model_proxy->connect(*m_params);
+                            proxy->connect(*m_params, tm_model);
+
+                            return proxy;
                         }
 
                         /**
-                         * Allows to disconnect from the reordering model.
+                         * Allows to get the current model proxy, the proxy stays valid
+                         * as long as the returned pointer is kept, even if the model
+                         * is replaced in the mean time.
+                         * @return the current model proxy
                          */
-                        static void disconnect() {
-                            if (m_model_proxy != NULL) {
-                                //Disconnect from the model
-                                m_model_proxy->disconnect();
-                                //Delete the object, free the resources
-                                delete m_model_proxy;
-                                m_model_proxy = NULL;
-                            }
+                        static inline rm_proxy_ptr get_model_proxy() {
+                            return atomic_load(&m_model_proxy);
                         }
 
                         /**
-                         * Allows to return an instance of the query proxy,
-                         * is to be returned by calling the dispose method.
-                         * @return an instance of the query executor.
+                         * Allows to atomically replace the current model proxy, the previous
+                         * one is freed once it is no longer used.
+                         * @param proxy the new model proxy, may be empty
                          */
-                        static inline rm_query_proxy & allocate_query_proxy() {
-                            LOG_DEBUG2 << "Allocating a new RM query proxy" << END_LOG;
-
-                            //Return the query executor as given by the proxy class
-                            return m_model_proxy->allocate_query_proxy();
+                        static inline void set_model_proxy(const rm_proxy_ptr & proxy) {
+                            atomic_store(&m_model_proxy, proxy);
                         }
 
                         /**
-                         * Dispose the previously allocated query object
-                         * @param query the query to dispose
+                         * Allows to disconnect from the reordering model.
                          */
-                        static inline void dispose_query_proxy(rm_query_proxy & query) {
-                            m_model_proxy->dispose_query_proxy(query);
+                        static void disconnect() {
+                            //The model is freed once it is no longer used
+                            set_model_proxy(rm_proxy_ptr());
                         }
 
                     private:
@@ -108,7 +120,7 @@ namespace uva {
                         static const rm_parameters * m_params;
 
                         //Store the trie proxy object
-                        static rm_proxy * m_model_proxy;
+                        static rm_proxy_ptr m_model_proxy;
                     };
                 }
             }
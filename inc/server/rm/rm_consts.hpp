@@ -38,6 +38,8 @@ namespace uva {
                         namespace __rm_basic_model {
                             //Influences the number of buckets that will be created for the basic model implementations
                             static constexpr double SOURCES_BUCKETS_FACTOR = 3.0;
+                            //If true then the entries are stored in the fingerprint_hashmap, otherwise in the fixed_size_hashmap
+                            static constexpr bool IS_FINGERPRINT_HASHMAP = true;
                         }
                     }
                 }
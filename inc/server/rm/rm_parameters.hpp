@@ -33,6 +33,7 @@
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/exceptions.hpp"
 #include "common/utils/text/string_utils.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
 
 #include "server/server_configs.hpp"
 #include "server/common/feature_id_registry.hpp"
@@ -42,6 +43,7 @@ using namespace std;
 using namespace uva::utils::exceptions;
 using namespace uva::utils::logging;
 using namespace uva::utils::text;
+using namespace uva::utils::containers;
 
 using namespace uva::smt::bpbd::server::common;
 
@@ -65,6 +67,8 @@ namespace uva {
                         static const string RM_WEIGHT_NAMES[MAX_NUM_RM_FEATURES];
                         //The feature weight names
                         static size_t RM_WEIGHT_GLOBAL_IDS[MAX_NUM_RM_FEATURES];
+                        //The huge pages policy parameter name
+                        static const string RM_HUGE_PAGES_PARAM_NAME;
 
                         //The the connection string needed to connect to the model
                         string m_conn_string;
@@ -75,6 +79,9 @@ namespace uva {
                         //Stores the reordering model weights
                         float m_lambdas[MAX_NUM_RM_FEATURES];
 
+                        //Stores the huge pages policy for the model tables
+                        huge_pages_policy m_huge_pages;
+
                         /**
                          * Allows to get the features weights used in the corresponding model.
                          * @param registry the feature registry entity
@@ -127,6 +134,8 @@ namespace uva {
                                 << ", " << rm_parameters::RM_WEIGHTS_PARAM_NAME << "[" << params.m_num_lambdas
                                 << "] = " << array_to_string<float>(params.m_num_lambdas,
                                 params.m_lambdas, RM_FEATURE_WEIGHTS_DELIMITER_STR)
+                                << ", " << rm_parameters::RM_HUGE_PAGES_PARAM_NAME << " = "
+                                << huge_page_allocator::POLICY_NAMES[params.m_huge_pages]
                                 << " ]";
                     }
                 }
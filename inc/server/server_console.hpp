@@ -13,6 +13,7 @@
 
 #include "server/server_parameters.hpp"
 #include "server/translation_server.hpp"
+#include "server/server_models.hpp"
 
 using namespace uva::utils::logging;
 using namespace uva::utils::cmd;
@@ -32,6 +33,8 @@ namespace uva {
                 static const string PROGRAM_SET_SC_CMD = "set sc ";
                 static const string PROGRAM_SET_LDP_CMD = "set ldp ";
                 static const string PROGRAM_SET_GL_CMD = "set gl ";
+                //Declare the program "reload" command
+                static const string PROGRAM_RELOAD_CMD = "reload";
 
                 /**
                  * The command line handler class for the translation server.
@@ -74,6 +77,7 @@ namespace uva {
 #if IS_SERVER_TUNING_MODE
                         print_command_help(PROGRAM_SET_GL_CMD, "<bool>", "enable/disable search lattice generation");
 #endif
+                        print_command_help(PROGRAM_RELOAD_CMD, "", "reload the models in the background");
                     }
 
                     /**
@@ -98,6 +102,12 @@ namespace uva {
                         if (begins_with(cmd, PROGRAM_SET_NT_CMD)) {
                             set_num_threads(cmd, PROGRAM_SET_NT_CMD);
                             return false;
+                        } else if (cmd == PROGRAM_RELOAD_CMD) {
+                            //Reload the models, the server keeps translating
+                            if (!server_models::start_reload()) {
+                                LOG_WARNING << "The models are already being reloaded!" << END_LOG;
+                            }
+                            return false;
                         } else {
                             //Set other decoder parameters
                             return set_decoder_params(cmd, m_params.m_de_params);
@@ -0,0 +1,182 @@
+/*
+ * File:   server_models.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 2:40 AM
+ */
+
+#ifndef SERVER_MODELS_HPP
+#define SERVER_MODELS_HPP
+
+#include <thread>       // std::thread
+#include <atomic>       // std::atomic
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+#include "common/utils/threads/threads.hpp"
+
+#include "server/lm/lm_configurator.hpp"
+#include "server/tm/tm_configurator.hpp"
+#include "server/rm/rm_configurator.hpp"
+
+using namespace std;
+
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+using namespace uva::utils::threads;
+
+using namespace uva::smt::bpbd::server::lm;
+using namespace uva::smt::bpbd::server::tm;
+using namespace uva::smt::bpbd::server::rm;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+
+                /**
+                 * This class represents a singleton that allows to get the consistent set of
+                 * the current language, translation and reordering models, and to reload them
+                 * without stopping the server. The new models are built in a background thread,
+                 * from the same connection parameters, while the current ones keep serving. Then
+                 * all three are replaced at once. The sentence decoders keep the models they
+                 * have got until they are finished, the old models are freed after the last of
+                 * them is. Note that, for the time of the reload, both the old and the new
+                 * models are kept in memory.
+                 */
+                class server_models {
+                public:
+
+                    /**
+                     * This structure stores the set of models consistent with each other,
+                     * i.e. the translation model is built against the language model
+                     * and the reordering model against the translation model.
+                     * @param m_lm_model the language model
+                     * @param m_tm_model the translation model
+                     * @param m_rm_model the reordering model
+                     */
+                    typedef struct {
+                        lm_proxy_ptr m_lm_model;
+                        tm_proxy_ptr m_tm_model;
+                        rm_proxy_ptr m_rm_model;
+                    } s_models;
+
+                    /**
+                     * Allows to get the current models
+                     * @return the consistent set of the current models
+                     */
+                    static inline s_models get_models() {
+                        scoped_guard guard(m_models_lock);
+
+                        return {
+                            lm_configurator::get_model_proxy(),
+                            tm_configurator::get_model_proxy(),
+                            rm_configurator::get_model_proxy()
+                        };
+                    }
+
+                    /**
+                     * Allows to start reloading the models in a background thread,
+                     * the models are replaced once all of them are loaded.
+                     * @return false if the models are already being reloaded, otherwise true
+                     */
+                    static bool start_reload() {
+                        scoped_guard guard(m_reload_lock);
+
+                        if (m_is_reloading) {
+                            return false;
+                        }
+
+                        //Wait for the previous reload thread, it is finished
+                        if (m_reload_thread.joinable()) {
+                            m_reload_thread.join();
+                        }
+
+                        m_is_reloading = true;
+                        m_reload_thread = thread(&server_models::reload);
+
+                        return true;
+                    }
+
+                    /**
+                     * Allows to wait until the models reload, if started, is finished.
+                     * Is to be called before disconnecting from the models.
+                     */
+                    static void finish_reload() {
+                        scoped_guard guard(m_reload_lock);
+
+                        if (m_reload_thread.joinable()) {
+                            if (m_is_reloading) {
+                                LOG_USAGE << "Waiting for the models reload to finish ..." << END_LOG;
+                            }
+                            m_reload_thread.join();
+                        }
+                    }
+
+                private:
+                    //Stores the lock for getting and replacing the models
+                    static mutex m_models_lock;
+                    //Stores the lock for starting and finishing the reload
+                    static mutex m_reload_lock;
+                    //Stores the reload thread
+                    static thread m_reload_thread;
+                    //Stores the flag indicating that the models are being reloaded
+                    static atomic<bool> m_is_reloading;
+
+                    /**
+                     * Allows to load the new models and to replace the current ones, is run
+                     * in the reload thread. If loading fails the current models are kept.
+                     */
+                    static void reload() {
+                        LOG_USAGE << "Start reloading the models in the background ..." << END_LOG;
+
+                        try {
+                            //Load the new models, each against the new model it depends on
+                            lm_proxy_ptr lm_model = lm_configurator::create_model_proxy();
+                            tm_proxy_ptr tm_model = tm_configurator::create_model_proxy(*lm_model);
+                            rm_proxy_ptr rm_model = rm_configurator::create_model_proxy(*tm_model);
+
+                            //Replace the current models at once
+                            {
+                                scoped_guard guard(m_models_lock);
+
+                                lm_configurator::set_model_proxy(lm_model);
+                                tm_configurator::set_model_proxy(tm_model);
+                                rm_configurator::set_model_proxy(rm_model);
+                            }
+
+                            LOG_USAGE << "The models are reloaded, the previous ones are freed "
+                                    << "once the running translations are finished." << END_LOG;
+                        } catch (std::exception & ex) {
+                            LOG_ERROR << "Could not reload the models, keeping the current ones: "
+                                    << ex.what() << END_LOG;
+                        }
+
+                        m_is_reloading = false;
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif /* SERVER_MODELS_HPP */
+
@@ -27,6 +27,9 @@
 #define TM_LIMITING_BUILDER_HPP
 
 #include <cmath>
+#include <vector>
+#include <thread>       // std::thread
+#include <exception>    // std::exception_ptr
 #include <unordered_map>
 
 #include "tm_builder.hpp"
@@ -41,8 +44,8 @@
 
 #include "server/common/models/phrase_uid.hpp"
 
+#include "server/lm/proxy/lm_proxy.hpp"
 #include "server/lm/proxy/lm_fast_query_proxy.hpp"
-#include "server/lm/lm_configurator.hpp"
 
 #include "server/tm/tm_parameters.hpp"
 #include "server/tm/models/tm_target_entry.hpp"
@@ -81,7 +84,9 @@ namespace uva {
                          * See http://www.statmt.org/moses/?n=Moses.Tutorial for some info.
                          * The translation model is also commonly known as a phrase table.
                          * This implementation is slow on loading the models when the 
-                         * translation limit is too large or is not set.
+                         * translation limit is too large or is not set. If the file is
+                         * in memory then the lines can be parsed with several threads,
+                         * see the tm_load_threads parameter.
                          */
                         template< typename model_type, typename reader_type>
                         class tm_basic_builder {
@@ -96,10 +101,11 @@ namespace uva {
                              * @params params the model parameters
                              * @param model the model to put the data into
                              * @param reader the reader to read the data from
+                             * @param lm_model the language model to get the target word ids from
                              */
-                            tm_basic_builder(const tm_parameters & params, model_type & model, reader_type & reader)
-                            : m_params(params), m_data(NULL), m_model(model), m_reader(reader),
-                            m_lm_query(lm_configurator::allocate_fast_query_proxy()), m_tmp_num_words(0) {
+                            tm_basic_builder(const tm_parameters & params, model_type & model, reader_type & reader, lm_proxy & lm_model)
+                            : m_params(params), m_data(NULL), m_model(model), m_reader(reader), m_lm_model(lm_model),
+                            m_lm_query(m_lm_model.allocate_fast_query_proxy()) {
                                 if (m_params.m_trans_limit <= BEST_TRANS_THRESHOLD) {
                                     LOG_WARNING << "The translation limit: " << m_params.m_trans_limit
                                             << " is too small, will be ignored!" << END_LOG;
@@ -113,7 +119,7 @@ namespace uva {
                              */
                             ~tm_basic_builder() {
                                 //Dispose the query proxy
-                                lm_configurator::dispose_fast_query_proxy(m_lm_query);
+                                m_lm_model.dispose_fast_query_proxy(m_lm_query);
                                 //Destroy the data container if it is not destroyed yet
                                 if (m_data != NULL) {
                                     delete m_data;
@@ -129,12 +135,17 @@ namespace uva {
                                 //Set the number of TM features
                                 tm_target_entry::set_num_features(m_params.m_num_lambdas);
 
-                                //Load the model data into memory and filter
-                                load_tm_data();
-                                
-                                //Convert the loaded data into the
-                                //model and delete the temporary data
-                                convert_tm_data();
+                                if (m_params.m_is_streaming_load) {
+                                    //Stream the sorted model data straight into the model
+                                    stream_tm_data();
+                                } else {
+                                    //Load the model data into memory and filter
+                                    load_tm_data();
+
+                                    //Convert the loaded data into the
+                                    //model and delete the temporary data
+                                    convert_tm_data();
+                                }
 
                                 //Add the unk (unknown translation) entry
                                 add_unk_translation();
@@ -254,10 +265,12 @@ namespace uva {
                              * Allows to create a new target entry in case the 
                              * @param rest the text piece reader to parse the target entry from
                              * @param source_uid the if of the source phrase
+                             * @param lm_query the LM query proxy to get the target word ids and weight from
                              * @param entry [out] the reference to the entry pointer
                              * @return true if the entry was created, otherwise false
                              */
-                            inline bool get_target_entry(text_piece_reader &rest, phrase_uid source_uid, tm_tmp_target_entry *&entry) {
+                            inline bool get_target_entry(text_piece_reader &rest, phrase_uid source_uid,
+                                    lm_fast_query_proxy & lm_query, tm_tmp_target_entry *&entry) {
                                 LOG_DEBUG2 << "Got translation line to parse: ___" << rest << "___" << END_LOG;
 
                                 //Declare an array of weights for temporary use
@@ -266,6 +279,10 @@ namespace uva {
                                 //Declare the target and weights entry reader
                                 text_piece_reader target, weights;
 
+                                //Declare the target translation phrase number of words and LM word ids
+                                phrase_length num_words = 0;
+                                word_uid word_ids[TM_MAX_TARGET_PHRASE_LEN];
+
                                 //Skip the first space symbol that follows the delimiter with the source
                                 rest.get_first_space(target);
 
@@ -285,22 +302,22 @@ namespace uva {
                                     const phrase_uid target_uid = get_phrase_uid<true>(target_str);
 
                                     //Use the language model to get the target translation word ids
-                                    m_lm_query.get_word_ids(target, m_tmp_num_words, m_tmp_word_ids);
+                                    lm_query.get_word_ids(target, num_words, word_ids);
 
                                     LOG_DEBUG << "The phrase: ___" << target << "__ got "
-                                            << m_tmp_num_words << " word ids: " <<
-                                            array_to_string<word_uid>(m_tmp_num_words, m_tmp_word_ids) << END_LOG;
+                                            << num_words << " word ids: " <<
+                                            array_to_string<word_uid>(num_words, word_ids) << END_LOG;
                                     
                                     //Initiate a new temporary target entry
                                     entry = new tm_tmp_target_entry();
                                     
                                     //Set the target entry data first, to make it distinguishable
                                     entry->set_data(source_uid, target_str, target_uid,
-                                            tmp_features, m_tmp_num_words, m_tmp_word_ids,
+                                            tmp_features, num_words, word_ids,
                                             m_params.m_wp_lambda, tmp_pure_features);
 
                                     //Get the Language Model weight for the target translation
-                                    const prob_weight lm_weight = m_lm_query.execute(m_tmp_num_words, m_tmp_word_ids);
+                                    const prob_weight lm_weight = lm_query.execute(num_words, word_ids);
                                     LOG_DEBUG << "The phrase: ___" << target_str << "__ lm-weight: " << lm_weight << END_LOG;
                                     
                                     //Set the LM target weight, is needed to compute the temporary total
@@ -320,9 +337,16 @@ namespace uva {
                             }
 
                             /**
-                             * Parses the tm file and loads the data
+                             * Parses the tm file lines and loads the data
+                             * @param chunk_reader_type the type of the lines reader
+                             * @param chunk the reader of the lines to parse
+                             * @param lm_query the LM query proxy to get the target word ids and weight from
+                             * @param data the map to load the data into
+                             * @param is_progress true if the progress bar is to be updated
                              */
-                            inline void parse_tm_file() {
+                            template<typename chunk_reader_type>
+                            inline void parse_tm_chunk(chunk_reader_type & chunk, lm_fast_query_proxy & lm_query,
+                                    tm_data_map & data, const bool is_progress) {
                                 //Declare the text piece reader for storing the read line and source phrase
                                 text_piece_reader line, source;
 
@@ -337,11 +361,8 @@ namespace uva {
 
                                 LOG_DEBUG << "Start parsing the TM file" << END_LOG;
 
-                                //Instantiate the data map container
-                                m_data = new tm_data_map();
-
                                 //Start reading the translation model file line by line
-                                while (m_reader.get_first_line(line)) {
+                                while (chunk.get_first_line(line)) {
                                     //Read the source phrase
                                     line.get_first<TM_DELIMITER, TM_DELIMITER_CDTY>(source);
 
@@ -359,7 +380,7 @@ namespace uva {
                                             LOG_DEBUG << "Deleting the previous source entry "
                                                     << source_uid << ", as it has no targets!" << END_LOG;
                                             delete targets;
-                                            m_data->erase(source_uid);
+                                            data.erase(source_uid);
                                         }
 
                                         //Store the new source string
@@ -370,17 +391,17 @@ namespace uva {
                                         LOG_DEBUG1 << "The NEW source ___" << source_str << "___ id is: " << source_uid << END_LOG;
 
                                         //Create a new list of targets, or retrieve an existing one
-                                        tm_data_map::iterator iter = m_data->find(source_uid);
-                                        if (iter == m_data->end()) {
+                                        tm_data_map::iterator iter = data.find(source_uid);
+                                        if (iter == data.end()) {
                                             targets = new targets_list(m_params.m_trans_limit);
-                                            m_data->operator[](source_uid) = targets;
+                                            data[source_uid] = targets;
                                         } else {
                                             targets = iter->second;
                                         }
                                     }
 
                                     //Get the target entry if it is passes
-                                    if (get_target_entry(line, source_uid, entry)) {
+                                    if (get_target_entry(line, source_uid, lm_query, entry)) {
                                         LOG_DEBUG1 << "Adding the new target entry to the source " << source_uid << END_LOG;
                                         //Add the translation entry to the list
                                         targets->add_elemenent(entry);
@@ -388,8 +409,158 @@ namespace uva {
                                     LOG_DEBUG1 << "The source " << source_uid << " targets count is " << targets->get_size() << END_LOG;
 
                                     //Update the progress bar status
-                                    logger::update_progress_bar();
+                                    if (is_progress) {
+                                        logger::update_progress_bar();
+                                    }
+                                }
+                            }
+
+                            /**
+                             * Parses the chunk of the tm file lines in a worker thread
+                             * @param chunk the chunk of the tm file lines
+                             * @param lm_query the LM query proxy owned by the worker
+                             * @param data the map to load the chunk data into, owned by the worker
+                             * @param error [out] the exception thrown by the worker, if any
+                             */
+                            void parse_tm_chunk_worker(text_piece_reader chunk, lm_fast_query_proxy * lm_query,
+                                    tm_data_map * data, exception_ptr & error) {
+                                try {
+                                    parse_tm_chunk(chunk, *lm_query, *data, false);
+                                } catch (...) {
+                                    //Store the exception to be re-thrown from the main thread
+                                    error = current_exception();
+                                }
+                            }
+
+                            /**
+                             * Allows to get the end of the chunk of the tm file lines, the chunk
+                             * is extended to the end of the line and then further on until the
+                             * next line has a different source phrase. So all the translations
+                             * of a source phrase, if consecutive, are parsed by one worker.
+                             * @param data the pointer to the tm file lines
+                             * @param len the length of the tm file lines
+                             * @param end_idx the desired chunk end index, must not exceed len
+                             * @return the actual chunk end index
+                             */
+                            static inline size_t get_chunk_end(const char * const data, const size_t len, size_t end_idx) {
+                                //Move the chunk end right after the end of line
+                                if (end_idx < len) {
+                                    const char * nl_ptr = static_cast<const char *> (memchr(data + end_idx, '\n', len - end_idx));
+                                    end_idx = (nl_ptr == NULL) ? len : (nl_ptr - data) + 1;
+                                }
+
+                                if (end_idx < len) {
+                                    //Search for the beginning of the last chunk line
+                                    size_t line_idx = end_idx - 1;
+                                    while ((line_idx > 0) && (data[line_idx - 1] != '\n')) {
+                                        --line_idx;
+                                    }
+
+                                    //Get the source phrase prefix of the line, including the first delimiter
+                                    const char * dlm_ptr = static_cast<const char *> (memchr(data + line_idx, TM_DELIMITER, end_idx - line_idx));
+                                    if (dlm_ptr != NULL) {
+                                        const size_t prefix_len = (dlm_ptr - (data + line_idx)) + 1;
+
+                                        //Extend the chunk while the next line has the same source phrase
+                                        while ((end_idx + prefix_len <= len) &&
+                                                (memcmp(data + end_idx, data + line_idx, prefix_len) == 0)) {
+                                            const char * nl_ptr = static_cast<const char *> (memchr(data + end_idx, '\n', len - end_idx));
+                                            end_idx = (nl_ptr == NULL) ? len : (nl_ptr - data) + 1;
+                                        }
+                                    }
+                                }
+
+                                return end_idx;
+                            }
+
+                            /**
+                             * Parses the in memory tm file with several threads and loads the data. Each
+                             * worker has its own LM query proxy and its own map of the top translations,
+                             * the maps are merged in the order of the chunks, so the same source entry
+                             * met in different chunks gets its translations as if read sequentially.
+                             */
+                            inline void parse_tm_file_parallel() {
+                                //Get the rest of the file, it is in memory
+                                const char * const file_begin = m_reader.get_rest_c_str();
+                                const size_t file_len = m_reader.get_rest_len();
+
+                                LOG_DEBUG << "The TM file length is " << file_len << " bytes, splitting it between "
+                                        << m_params.m_num_load_threads << " threads" << END_LOG;
+
+                                //Split the file into the source phrase aligned chunks, one chunk per thread
+                                const size_t chunk_len = (file_len / m_params.m_num_load_threads) + 1;
+                                vector<thread> workers;
+                                vector<exception_ptr> errors(m_params.m_num_load_threads);
+                                vector<tm_data_map> chunk_data(m_params.m_num_load_threads);
+                                vector<lm_fast_query_proxy *> lm_queries;
+                                size_t begin_idx = 0;
+                                while (begin_idx < file_len) {
+                                    //Compute the chunk end, it is at the source phrase boundary
+                                    const size_t end_idx = get_chunk_end(file_begin, file_len, min(begin_idx + chunk_len, file_len));
+
+                                    //Each worker gets its own LM query proxy
+                                    lm_queries.push_back(&m_lm_model.allocate_fast_query_proxy());
+
+                                    //Start the worker thread for the chunk
+                                    const size_t chunk_idx = workers.size();
+                                    workers.push_back(thread(&tm_basic_builder<model_type, reader_type>::parse_tm_chunk_worker,
+                                            this, text_piece_reader(file_begin + begin_idx, end_idx - begin_idx),
+                                            lm_queries[chunk_idx], &chunk_data[chunk_idx], ref(errors[chunk_idx])));
+
+                                    begin_idx = end_idx;
+                                }
+
+                                //Wait until all the chunks are parsed
+                                for (thread & worker : workers) {
+                                    worker.join();
+                                }
+
+                                //Dispose the worker query proxies
+                                for (lm_fast_query_proxy * lm_query : lm_queries) {
+                                    m_lm_model.dispose_fast_query_proxy(*lm_query);
+                                }
+
+                                //Merge the chunk data in the order of chunks
+                                for (tm_data_map & data : chunk_data) {
+                                    for (tm_data_map::iterator it = data.begin(); it != data.end(); ++it) {
+                                        tm_data_map::iterator iter = m_data->find(it->first);
+                                        if (iter == m_data->end()) {
+                                            m_data->operator[](it->first) = it->second;
+                                        } else {
+                                            iter->second->move_from(*it->second);
+                                            delete it->second;
+                                        }
+                                    }
+                                    data.clear();
+                                }
+
+                                //Re-throw the first of the worker exceptions, if any
+                                for (exception_ptr & error : errors) {
+                                    if (error) {
+                                        rethrow_exception(error);
+                                    }
                                 }
+
+                                //Skip the parsed file content
+                                m_reader.skip(file_len);
+
+                                LOG_DEBUG << "Finished parsing the TM file with " << workers.size() << " threads." << END_LOG;
+                            }
+
+                            /**
+                             * Allows to check if the tm file can be parsed with several threads
+                             * @return true if the multi-threaded parsing is requested and possible
+                             */
+                            inline bool is_parallel_reading() const {
+                                if (m_params.m_num_load_threads > 1) {
+                                    if (m_reader.is_in_memory()) {
+                                        return true;
+                                    } else {
+                                        LOG_WARNING << "The multi-threaded loading is requested but is not supported by the "
+                                                << "file reader, loading with a single thread!" << END_LOG;
+                                    }
+                                }
+                                return false;
                             }
 
                             /**
@@ -398,8 +569,15 @@ namespace uva {
                             inline void load_tm_data() {
                                 logger::start_progress_bar(string("Pre-loading phrase translations"));
 
+                                //Instantiate the data map container
+                                m_data = new tm_data_map();
+
                                 //Count the good entries
-                                parse_tm_file();
+                                if (is_parallel_reading()) {
+                                    parse_tm_file_parallel();
+                                } else {
+                                    parse_tm_chunk(m_reader, m_lm_query, *m_data, true);
+                                }
 
                                 //Stop the progress bar in case of no exception
                                 logger::stop_progress_bar();
@@ -407,6 +585,177 @@ namespace uva {
                                 LOG_INFO << "The number of loaded TM source entries is: " << m_data->size() << END_LOG;
                             }
 
+                            /**
+                             * Allows to add the source entry with the given translations to the model
+                             * @param source_uid the source phrase uid
+                             * @param targets the list of translations, the entries are moved into the model
+                             * @return true if the source entry was added, false if there are no translations
+                             */
+                            inline bool add_source_entry(const phrase_uid source_uid, targets_list & targets) {
+                                if (targets.get_size() != 0) {
+                                    //Open the new source entry
+                                    tm_source_entry * source_entry = m_model.begin_entry(source_uid, targets.get_size());
+
+                                    ASSERT_SANITY_THROW((m_params.m_trans_limit > 0) &&
+                                            (targets.get_size() > m_params.m_trans_limit),
+                                            string("The COUNTED targets size ") + to_string(targets.get_size()) +
+                                            string(" is exceeding the trans limit ") + to_string(m_params.m_trans_limit));
+
+                                    LOG_DEBUG << "TM source: " << source_uid << ", #targets: " << targets.get_size() << END_LOG;
+
+                                    //The pointer variable for the target entry container
+                                    targets_list::elem_container * entry = targets.get_first();
+
+                                    //Add the translation entries
+                                    while (entry != NULL) {
+                                        //Get the reference to the target entry
+                                        tm_tmp_target_entry & target = **entry;
+
+                                        source_entry->emplace_target(target);
+
+                                        //Move on to the next entry
+                                        entry = entry->m_next;
+                                    }
+
+                                    ASSERT_SANITY_THROW((m_params.m_trans_limit > 0) &&
+                                            (source_entry->num_targets() > m_params.m_trans_limit),
+                                            string("The ACTUAL targets size ") + to_string(source_entry->num_targets()) +
+                                            string(" is exceeding the trans limit ") + to_string(m_params.m_trans_limit));
+
+                                    //Finalize the source entry
+                                    m_model.finalize_entry(source_uid);
+
+                                    return true;
+                                } else {
+                                    return false;
+                                }
+                            }
+
+                            /**
+                             * Allows to count the source phrases of the tm file, a cheap pass as
+                             * only the consecutive source phrase strings are compared. For the file
+                             * sorted by the source phrases this is the number of distinct sources.
+                             * @return the number of source phrases
+                             */
+                            inline size_t count_tm_sources() {
+                                //Declare the text piece reader for storing the read line and source phrase
+                                text_piece_reader line, source;
+                                //Store the previous source string, the line data is not kept by the reader
+                                string source_str = "";
+                                //Stores the number of source phrases
+                                size_t num_sources = 0;
+
+                                while (m_reader.get_first_line(line)) {
+                                    //Read the source phrase
+                                    line.get_first<TM_DELIMITER, TM_DELIMITER_CDTY>(source);
+
+                                    //Count the source phrase if it is new
+                                    if (source != source_str) {
+                                        source_str = source.str();
+                                        ++num_sources;
+                                    }
+
+                                    //Update the progress bar status
+                                    logger::update_progress_bar();
+                                }
+
+                                return num_sources;
+                            }
+
+                            /**
+                             * Allows to load the translation model file sorted by the source phrases
+                             * in a single pass. The number of sources is counted first, to pre-size
+                             * the model, then only the top translations of the current source are
+                             * kept in memory and they are added to the model once the next source
+                             * phrase is met. So the peak memory is not much more than the model size.
+                             */
+                            inline void stream_tm_data() {
+                                if (m_params.m_num_load_threads > 1) {
+                                    LOG_WARNING << "The multi-threaded loading is requested but is not supported by the "
+                                            << "streaming loading, loading with a single thread!" << END_LOG;
+                                }
+
+                                //Count the sources and pre-size the model
+                                logger::start_progress_bar(string("Counting the source phrases"));
+                                const size_t num_sources = count_tm_sources();
+                                logger::stop_progress_bar();
+
+                                LOG_INFO << "The number of TM source phrases is: " << num_sources << END_LOG;
+
+                                m_model.set_num_entries(num_sources);
+
+                                //Re-start reading the file
+                                m_reader.reset();
+
+                                logger::start_progress_bar(string("Streaming phrase translations"));
+
+                                //Declare the text piece reader for storing the read line and source phrase
+                                text_piece_reader line, source;
+
+                                //Store the cached source string and its uid values
+                                string source_str = "";
+                                phrase_uid source_uid = UNDEFINED_PHRASE_ID;
+
+                                //The pointers to the current targets list
+                                targets_list_ptr targets = NULL;
+                                //Declare the pointer variable for the target entry
+                                tm_tmp_target_entry * entry = NULL;
+                                //Stores the number of added source entries
+                                size_t num_entries = 0;
+
+                                //Start reading the translation model file line by line
+                                while (m_reader.get_first_line(line)) {
+                                    //Read the source phrase
+                                    line.get_first<TM_DELIMITER, TM_DELIMITER_CDTY>(source);
+
+                                    //Get the current source phrase
+                                    string next_source_str = source.str();
+                                    trim(next_source_str);
+
+                                    //If we are now reading the new source entry
+                                    if (source_str != next_source_str) {
+                                        //Add the previous source entry to the model
+                                        if (targets != NULL) {
+                                            num_entries += add_source_entry(source_uid, *targets);
+                                            delete targets;
+                                        }
+
+                                        //Store the new source string and compute its uid
+                                        source_str = next_source_str;
+                                        source_uid = get_phrase_uid(source_str);
+
+                                        //The source phrase must not have been added already
+                                        ASSERT_CONDITION_THROW((m_model.template get_source_entry<false>(source_uid) != NULL),
+                                                string("The translation model is not sorted by the source phrases, the source: ___") +
+                                                source_str + string("___ is met again, disable ") +
+                                                tm_parameters::TM_STREAMING_LOAD_PARAM_NAME);
+
+                                        //Create a new list of targets
+                                        targets = new targets_list(m_params.m_trans_limit);
+                                    }
+
+                                    //Get the target entry if it is passes
+                                    if (get_target_entry(line, source_uid, m_lm_query, entry)) {
+                                        //Add the translation entry to the list
+                                        targets->add_elemenent(entry);
+                                    }
+
+                                    //Update the progress bar status
+                                    logger::update_progress_bar();
+                                }
+
+                                //Add the last source entry to the model
+                                if (targets != NULL) {
+                                    num_entries += add_source_entry(source_uid, *targets);
+                                    delete targets;
+                                }
+
+                                //Stop the progress bar in case of no exception
+                                logger::stop_progress_bar();
+
+                                LOG_INFO << "The number of loaded TM source entries is: " << num_entries << END_LOG;
+                            }
+
                             /**
                              * Loads the translation model data into memory and filters is
                              */
@@ -424,39 +773,7 @@ namespace uva {
                                     targets_list_ptr targets = it->second;
 
                                     //Add the source entry and the translation entries
-                                    if (targets->get_size() != 0) {
-                                        //Open the new source entry
-                                        tm_source_entry * source_entry = m_model.begin_entry(source_uid, targets->get_size());
-
-                                        ASSERT_SANITY_THROW((m_params.m_trans_limit > 0) &&
-                                                (targets->get_size() > m_params.m_trans_limit),
-                                                string("The COUNTED targets size ") + to_string(targets->get_size()) +
-                                                string(" is exceeding the trans limit ") + to_string(m_params.m_trans_limit));
-
-                                        LOG_DEBUG << "TM source: " << source_uid << ", #targets: " << targets->get_size() << END_LOG;
-
-                                        //The pointer variable for the target entry container
-                                        targets_list::elem_container * entry = targets->get_first();
-
-                                        //Add the translation entries
-                                        while (entry != NULL) {
-                                            //Get the reference to the target entry
-                                            tm_tmp_target_entry & target = **entry;
-
-                                            source_entry->emplace_target(target);
-
-                                            //Move on to the next entry
-                                            entry = entry->m_next;
-                                        }
-
-                                        ASSERT_SANITY_THROW((m_params.m_trans_limit > 0) &&
-                                                (source_entry->num_targets() > m_params.m_trans_limit),
-                                                string("The ACTUAL targets size ") + to_string(source_entry->num_targets()) +
-                                                string(" is exceeding the trans limit ") + to_string(m_params.m_trans_limit));
-
-                                        //Finalize the source entry
-                                        m_model.finalize_entry(source_uid);
-                                    }
+                                    add_source_entry(source_uid, *targets);
 
                                     //Delete the entry
                                     delete targets;
@@ -489,13 +806,11 @@ namespace uva {
                             //Stores the reference to the builder;
                             reader_type & m_reader;
 
+                            //Stores the reference to the language model
+                            lm_proxy & m_lm_model;
+
                             //Stores the reference to the LM query proxy
                             lm_fast_query_proxy & m_lm_query;
-
-                            //The temporary variable to store the number of words in the target translation phrase
-                            phrase_length m_tmp_num_words;
-                            //The temporary variable to store word ids for the target translation phrase LM word ids
-                            word_uid m_tmp_word_ids[TM_MAX_TARGET_PHRASE_LEN];
                         };
                     };
                 }
@@ -0,0 +1,563 @@
+/*
+ * File:   tm_snapshot_builder.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 2:50 AM
+ */
+
+#ifndef TM_SNAPSHOT_BUILDER_HPP
+#define TM_SNAPSHOT_BUILDER_HPP
+
+#include <string>       // std::string
+#include <vector>       // std::vector
+#include <cstdio>       // std::fopen
+#include <cstring>      // std::memcmp
+#include <typeinfo>     // typeid
+#include <algorithm>    // std::sort, std::lower_bound
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/hashing_utils.hpp"
+#include "common/utils/file/binary_file_writer.hpp"
+#include "common/utils/file/binary_mmap_reader.hpp"
+
+#include "server/server_consts.hpp"
+
+#include "server/lm/proxy/lm_proxy.hpp"
+#include "server/lm/proxy/lm_fast_query_proxy.hpp"
+
+#include "server/tm/tm_parameters.hpp"
+#include "server/tm/models/tm_target_entry.hpp"
+#include "server/tm/models/tm_source_entry.hpp"
+
+using namespace std;
+
+using namespace uva::utils::file;
+using namespace uva::utils::hashing;
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+
+using namespace uva::smt::bpbd::server::lm::proxy;
+using namespace uva::smt::bpbd::server::tm;
+using namespace uva::smt::bpbd::server::tm::models;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace tm {
+                    namespace builders {
+
+                        /**
+                         * This namespace contains the layout of the binary snapshot file of the
+                         * translation model. The file stores the finalized model data, i.e. the
+                         * weighted features total, the target word ids, the LM weight of the
+                         * targets and the minimum source cost, so loading it requires neither
+                         * parsing nor the language model queries. The file consists of:
+                         *
+                         * s_header, s_source[m_num_sources], s_target[m_num_targets],
+                         * word_uid[m_num_word_ids], char[m_num_chars], and in the tuning
+                         * mode also prob_weight[m_num_targets * m_num_lambdas]
+                         *
+                         * the last source is the one of the unk entry, the other sources are
+                         * sorted by their uids so that a source can be found without reading
+                         * the entire file, as done by the lazily loaded translation model.
+                         */
+                        namespace __tm_snapshot {
+                            //Stores the length of the magic value
+                            static constexpr size_t MAGIC_LENGTH = 8;
+                            //Stores the magic value identifying the binary snapshot file
+                            static constexpr char MAGIC[MAGIC_LENGTH] = {'B', 'P', 'B', 'D', 'T', 'M', 'S', '\0'};
+                            //Stores the snapshot file format version, is to be incremented on any layout change
+                            static constexpr uint32_t VERSION = 2;
+                            //Stores the number of targets the LM weights of which are checked when loading
+                            static constexpr size_t NUM_LM_CHECK_TARGETS = 16;
+
+                            /**
+                             * This structure stores the snapshot file header, it is
+                             * needed to check that the snapshot is compatible with
+                             * the current build and the translation model parameters.
+                             */
+                            typedef struct {
+                                //Stores the magic value
+                                char m_magic[MAGIC_LENGTH];
+                                //Stores the format version
+                                uint32_t m_version;
+                                //Stores the word uid size in bytes
+                                uint32_t m_word_uid_size;
+                                //Stores the probability weight size in bytes
+                                uint32_t m_prob_weight_size;
+                                //Stores the tuning mode flag, the pure features are only stored in the tuning mode
+                                uint32_t m_is_tuning_mode;
+                                //Stores the hash of the model type name
+                                uint64_t m_model_type_uid;
+                                //Stores the translation limit
+                                uint64_t m_trans_limit;
+                                //Stores the minimum translation probability
+                                float m_min_tran_prob;
+                                //Stores the word penalty lambda
+                                float m_wp_lambda;
+                                //Stores the number of lambdas
+                                uint64_t m_num_lambdas;
+                                //Stores the lambdas
+                                float m_lambdas[MAX_NUM_TM_FEATURES];
+                                //Stores the unk entry features
+                                float m_unk_features[MAX_NUM_TM_FEATURES];
+                                //Stores the number of source entries, including the unk entry
+                                uint64_t m_num_sources;
+                                //Stores the number of target entries
+                                uint64_t m_num_targets;
+                                //Stores the number of target word ids
+                                uint64_t m_num_word_ids;
+                                //Stores the number of target phrase characters
+                                uint64_t m_num_chars;
+                            } s_header;
+
+                            /**
+                             * This structure stores the source entry
+                             * @param m_source_uid the source phrase uid
+                             * @param m_begin_target the index of the first target
+                             * @param m_num_targets the number of targets
+                             * @param m_min_cost the minimum translation cost
+                             */
+                            typedef struct {
+                                phrase_uid m_source_uid;
+                                uint64_t m_begin_target;
+                                uint32_t m_num_targets;
+                                prob_weight m_min_cost;
+                            } s_source;
+
+                            /**
+                             * Allows to compare two source entries by their uids
+                             * @param first the first source entry
+                             * @param second the second source entry
+                             * @return true if the first source uid is smaller than the second one
+                             */
+                            static inline bool is_less_source(const s_source & first, const s_source & second) {
+                                return (first.m_source_uid < second.m_source_uid);
+                            }
+
+                            /**
+                             * Allows to compare the source entry uid with the given one
+                             * @param source the source entry
+                             * @param source_uid the source uid
+                             * @return true if the source entry uid is smaller than the given one
+                             */
+                            static inline bool is_less_source_uid(const s_source & source, const phrase_uid source_uid) {
+                                return (source.m_source_uid < source_uid);
+                            }
+
+                            /**
+                             * This structure stores the target entry
+                             * @param m_st_uid the source/target phrase uid
+                             * @param m_begin_char the index of the first target phrase character
+                             * @param m_begin_word the index of the first target word id
+                             * @param m_num_chars the number of target phrase characters
+                             * @param m_total_weight the total features weight, including the word penalty
+                             * @param m_lm_weight the language model weight of the target phrase
+                             * @param m_num_words the number of target words
+                             */
+                            typedef struct {
+                                phrase_uid m_st_uid;
+                                uint64_t m_begin_char;
+                                uint64_t m_begin_word;
+                                uint32_t m_num_chars;
+                                prob_weight m_total_weight;
+                                prob_weight m_lm_weight;
+                                phrase_length m_num_words;
+                            } s_target;
+
+                            /**
+                             * Allows to get the model type unique identifier, it also accounts for
+                             * the hashing policies as the phrase uids depend on them
+                             * @param model_type the model type
+                             * @return the model type unique identifier
+                             */
+                            template<typename model_type>
+                            static inline uint64_t get_model_type_uid() {
+                                const string name = string(typeid (model_type).name()) + string("/") +
+                                        str_hash_policy::get_name() + string("/") + int_hash_policy::get_name();
+                                return compute_hash(name);
+                            }
+
+                            /**
+                             * Allows to create the header for the given model parameters
+                             * @param model_type the model type
+                             * @param params the model parameters
+                             * @param header [out] the header to fill in, the counts are not set
+                             */
+                            template<typename model_type>
+                            static inline void set_header(const tm_parameters & params, s_header & header) {
+                                //Clear the header, including the padding, as it is compared
+                                memset(&header, 0, sizeof (header));
+                                memcpy(header.m_magic, MAGIC, MAGIC_LENGTH);
+                                header.m_version = VERSION;
+                                header.m_word_uid_size = sizeof (word_uid);
+                                header.m_prob_weight_size = sizeof (prob_weight);
+                                header.m_is_tuning_mode = IS_SERVER_TUNING_MODE;
+                                header.m_model_type_uid = get_model_type_uid<model_type>();
+                                header.m_trans_limit = params.m_trans_limit;
+                                header.m_min_tran_prob = params.m_min_tran_prob;
+                                header.m_wp_lambda = params.m_wp_lambda;
+                                header.m_num_lambdas = params.m_num_lambdas;
+                                memcpy(header.m_lambdas, params.m_lambdas, params.m_num_lambdas * sizeof (float));
+                                memcpy(header.m_unk_features, params.m_unk_features, params.m_num_unk_features * sizeof (float));
+                            }
+
+                            /**
+                             * Allows to read and check the snapshot header
+                             * @param model_type the model type
+                             * @param params the model parameters
+                             * @param file the memory mapped snapshot file
+                             * @param actual [out] the header read from the file
+                             */
+                            template<typename model_type>
+                            static inline void check_header(const tm_parameters & params,
+                                    binary_mmap_reader & file, s_header & actual) {
+                                s_header expected = {};
+                                file.read(actual);
+                                set_header<model_type>(params, expected);
+
+                                ASSERT_CONDITION_THROW((memcmp(actual.m_magic, expected.m_magic, MAGIC_LENGTH) != 0),
+                                        "The file is not a binary translation model snapshot!");
+                                ASSERT_CONDITION_THROW((actual.m_version != expected.m_version),
+                                        string("The snapshot version: ") + to_string(actual.m_version) +
+                                        string(" is not supported, expected: ") + to_string(expected.m_version));
+                                ASSERT_CONDITION_THROW((actual.m_word_uid_size != expected.m_word_uid_size) ||
+                                        (actual.m_prob_weight_size != expected.m_prob_weight_size) ||
+                                        (actual.m_is_tuning_mode != expected.m_is_tuning_mode) ||
+                                        (actual.m_model_type_uid != expected.m_model_type_uid),
+                                        "The snapshot was created for a different build configuration or model type, re-compile it!");
+                                ASSERT_CONDITION_THROW((actual.m_trans_limit != expected.m_trans_limit) ||
+                                        (actual.m_min_tran_prob != expected.m_min_tran_prob) ||
+                                        (actual.m_wp_lambda != expected.m_wp_lambda) ||
+                                        (actual.m_num_lambdas != expected.m_num_lambdas) ||
+                                        (memcmp(actual.m_lambdas, expected.m_lambdas, sizeof (expected.m_lambdas)) != 0) ||
+                                        (memcmp(actual.m_unk_features, expected.m_unk_features, sizeof (expected.m_unk_features)) != 0),
+                                        string("The snapshot was created with the ") + tm_parameters::TM_WEIGHTS_PARAM_NAME +
+                                        string(", ") + tm_parameters::TM_UNK_FEATURE_PARAM_NAME + string(", ") +
+                                        tm_parameters::TM_TRANS_LIM_PARAM_NAME + string(", ") +
+                                        tm_parameters::TM_MIN_TRANS_PROB_PARAM_NAME + string(" or ") +
+                                        tm_parameters::TM_WORD_PENALTY_PARAM_NAME +
+                                        string(" which differ from the configured ones, re-compile it!"));
+                            }
+
+                            /**
+                             * Allows to check that the snapshot LM weights of a sample of the
+                             * targets, and of the unk target, are the current language model ones.
+                             * @param header the snapshot header
+                             * @param targets the snapshot targets
+                             * @param word_ids the snapshot word ids
+                             * @param lm_query the query proxy of the current language model
+                             */
+                            static inline void check_lm_weights(const s_header & header, const s_target * targets,
+                                    const word_uid * word_ids, lm_fast_query_proxy & lm_query) {
+                                //The unk target is the last one
+                                const uint64_t num_targets = header.m_num_targets - 1;
+                                const size_t num_checks = min<uint64_t>(num_targets, NUM_LM_CHECK_TARGETS);
+
+                                bool is_good = (targets[num_targets].m_lm_weight == lm_query.get_unk_word_prob());
+                                for (size_t idx = 0; is_good && (idx < num_checks); ++idx) {
+                                    const s_target & target = targets[(idx * num_targets) / num_checks];
+                                    is_good = (target.m_lm_weight == lm_query.execute(target.m_num_words, word_ids + target.m_begin_word));
+                                }
+
+                                ASSERT_CONDITION_THROW(!is_good, string("The snapshot was created with a different ") +
+                                        string("language model or its parameters, re-compile it!"));
+                            }
+                        }
+
+                        /**
+                         * This is a binary snapshot builder of the translation model. Instead
+                         * of parsing the text model it reads the finalized model data from the
+                         * memory mapped binary snapshot file, as previously created by the
+                         * tm_snapshot_writer. The language model is only used to check, on a
+                         * sample of targets, that the snapshot LM weights are the ones of the
+                         * current language model.
+                         */
+                        template<typename model_type>
+                        class tm_snapshot_builder {
+                        public:
+
+                            /**
+                             * The basic constructor
+                             * @params params the model parameters
+                             * @param model the model to put the data into
+                             * @param file the memory mapped snapshot file
+                             * @param lm_model the language model to check the LM weights with
+                             */
+                            tm_snapshot_builder(const tm_parameters & params, model_type & model,
+                                    binary_mmap_reader & file, lm_proxy & lm_model)
+                            : m_params(params), m_model(model), m_file(file), m_lm_model(lm_model),
+                            m_lm_query(m_lm_model.allocate_fast_query_proxy()) {
+                            }
+
+                            /**
+                             * The basic destructor
+                             */
+                            ~tm_snapshot_builder() {
+                                //Dispose the query proxy
+                                m_lm_model.dispose_fast_query_proxy(m_lm_query);
+                            }
+
+                            /**
+                             * Allows to check whether the given file is a binary snapshot file
+                             * @param file_name the name of the file to check
+                             * @return true if the file starts with the snapshot magic value
+                             */
+                            static inline bool is_snapshot_file(const string & file_name) {
+                                char magic[__tm_snapshot::MAGIC_LENGTH] = {};
+                                bool result = false;
+                                FILE * file_ptr = fopen(file_name.c_str(), "rb");
+                                if (file_ptr != NULL) {
+                                    result = (fread(magic, 1, __tm_snapshot::MAGIC_LENGTH, file_ptr) == __tm_snapshot::MAGIC_LENGTH)
+                                            && (memcmp(magic, __tm_snapshot::MAGIC, __tm_snapshot::MAGIC_LENGTH) == 0);
+                                    fclose(file_ptr);
+                                }
+                                return result;
+                            }
+
+                            /**
+                             * Allows to build the model from the snapshot data
+                             */
+                            void build() {
+                                //Set the number of TM features
+                                tm_target_entry::set_num_features(m_params.m_num_lambdas);
+
+                                //Check that the snapshot is compatible
+                                __tm_snapshot::s_header header = {};
+                                __tm_snapshot::check_header<model_type>(m_params, m_file, header);
+
+                                //Get the snapshot data, it is read sequentially
+                                m_file.advise(MADV_SEQUENTIAL);
+                                const __tm_snapshot::s_source * sources = m_file.get<__tm_snapshot::s_source>(header.m_num_sources);
+                                const __tm_snapshot::s_target * targets = m_file.get<__tm_snapshot::s_target>(header.m_num_targets);
+                                const word_uid * word_ids = m_file.get<word_uid>(header.m_num_word_ids);
+                                const char * chars = m_file.get<char>(header.m_num_chars);
+                                const prob_weight * pure_features = NULL;
+#if IS_SERVER_TUNING_MODE
+                                pure_features = m_file.get<prob_weight>(header.m_num_targets * header.m_num_lambdas);
+#endif
+                                ASSERT_CONDITION_THROW(!m_file.is_eof(), "The binary snapshot file contains unexpected trailing data!");
+                                ASSERT_CONDITION_THROW((header.m_num_sources == 0) ||
+                                        (sources[header.m_num_sources - 1].m_source_uid != UNKNOWN_PHRASE_ID),
+                                        "The binary snapshot file has no unk entry!");
+
+                                logger::start_progress_bar(string("Reading the phrase translations snapshot"));
+
+                                //Set the number of entries into the model, the unk entry is the last one
+                                const uint64_t num_entries = header.m_num_sources - 1;
+                                m_model.set_num_entries(num_entries);
+                                m_model.reserve_targets(header.m_num_targets, header.m_num_chars, header.m_num_word_ids);
+
+                                //Add the source entries and the unk entry
+                                for (uint64_t src_idx = 0; src_idx <= num_entries; ++src_idx) {
+                                    const __tm_snapshot::s_source & source = sources[src_idx];
+                                    ASSERT_CONDITION_THROW((source.m_begin_target + source.m_num_targets > header.m_num_targets),
+                                            "The binary snapshot file is corrupted, a source entry is out of range!");
+
+                                    //Open the new source entry
+                                    tm_source_entry * source_entry = (src_idx == num_entries) ?
+                                            m_model.begin_unk_entry(source.m_num_targets) :
+                                            m_model.begin_entry(source.m_source_uid, source.m_num_targets);
+
+                                    //Add the translation entries
+                                    for (uint64_t trg_idx = source.m_begin_target;
+                                            trg_idx != (source.m_begin_target + source.m_num_targets); ++trg_idx) {
+                                        const __tm_snapshot::s_target & target = targets[trg_idx];
+                                        ASSERT_CONDITION_THROW((target.m_begin_char + target.m_num_chars > header.m_num_chars) ||
+                                                (target.m_begin_word + target.m_num_words > header.m_num_word_ids),
+                                                "The binary snapshot file is corrupted, a target entry is out of range!");
+
+                                        source_entry->add_target(target.m_st_uid, chars + target.m_begin_char,
+                                                target.m_num_chars, target.m_num_words, word_ids + target.m_begin_word,
+                                                target.m_total_weight, target.m_lm_weight,
+                                                (pure_features == NULL) ? NULL : pure_features + trg_idx * header.m_num_lambdas);
+                                    }
+
+                                    //Finalize the source entry
+                                    if (src_idx == num_entries) {
+                                        source_entry->finalize();
+                                    } else {
+                                        m_model.finalize_entry(source.m_source_uid);
+                                    }
+
+                                    ASSERT_CONDITION_THROW((source_entry->get_min_cost() != source.m_min_cost),
+                                            "The binary snapshot file is corrupted, the minimum translation cost differs!");
+
+                                    //Update the progress bar status
+                                    logger::update_progress_bar();
+                                }
+
+                                //Stop the progress bar in case of no exception
+                                logger::stop_progress_bar();
+
+                                //Check that the LM weights are the ones of the current language model
+                                __tm_snapshot::check_lm_weights(header, targets, word_ids, m_lm_query);
+
+                                LOG_USAGE << "The binary translation model snapshot is read, " << num_entries
+                                        << " source entries." << END_LOG;
+                            }
+
+                        private:
+                            //Stores the reference to the model parameters
+                            const tm_parameters & m_params;
+                            //Stores the reference to the model
+                            model_type & m_model;
+                            //Stores the reference to the snapshot file
+                            binary_mmap_reader & m_file;
+                            //Stores the reference to the language model
+                            lm_proxy & m_lm_model;
+                            //Stores the reference to the LM query proxy
+                            lm_fast_query_proxy & m_lm_query;
+                        };
+
+                        /**
+                         * This is a binary snapshot writer of the translation model. It allows
+                         * to dump a fully loaded model into a binary snapshot file that can
+                         * later be read by the tm_snapshot_builder.
+                         */
+                        template<typename model_type>
+                        class tm_snapshot_writer {
+                        public:
+
+                            /**
+                             * The basic constructor
+                             * @params params the model parameters the model was built with
+                             * @param model the model to write
+                             * @param file the snapshot file writer
+                             */
+                            tm_snapshot_writer(const tm_parameters & params, const model_type & model, binary_file_writer & file)
+                            : m_params(params), m_model(model), m_file(file), m_sources(), m_targets(),
+                            m_word_ids(), m_chars(), m_pure_features() {
+                            }
+
+                            /**
+                             * Allows to write the snapshot
+                             */
+                            void write() {
+                                //Collect the source entries, the unk entry is the last one
+                                const size_t num_entries = m_model.get_num_entries();
+                                tm_const_source_entry * entries = m_model.get_entries();
+                                for (size_t idx = 0; idx < num_entries; ++idx) {
+                                    add_source(entries[idx]);
+                                }
+                                add_source(*m_model.get_unk_entry());
+
+                                //Sort the sources by their uids, the unk entry stays the last one
+                                sort(m_sources.begin(), m_sources.end() - 1, __tm_snapshot::is_less_source);
+
+                                //Write the header first
+                                __tm_snapshot::s_header header = {};
+                                __tm_snapshot::set_header<model_type>(m_params, header);
+                                header.m_num_sources = m_sources.size();
+                                header.m_num_targets = m_targets.size();
+                                header.m_num_word_ids = m_word_ids.size();
+                                header.m_num_chars = m_chars.size();
+                                m_file.write(header);
+
+                                //Write the model data
+                                m_file.write(m_sources.data(), m_sources.size());
+                                m_file.write(m_targets.data(), m_targets.size());
+                                m_file.write(m_word_ids.data(), m_word_ids.size());
+                                m_file.write(m_chars.data(), m_chars.size());
+#if IS_SERVER_TUNING_MODE
+                                m_file.write(m_pure_features.data(), m_pure_features.size());
+#endif
+
+                                LOG_USAGE << "The binary translation model snapshot is written, "
+                                        << m_file.get_num_bytes() << " bytes." << END_LOG;
+                            }
+
+                        private:
+                            //Stores the reference to the model parameters
+                            const tm_parameters & m_params;
+                            //Stores the reference to the model
+                            const model_type & m_model;
+                            //Stores the reference to the snapshot file
+                            binary_file_writer & m_file;
+                            //Stores the collected source entries
+                            vector<__tm_snapshot::s_source> m_sources;
+                            //Stores the collected target entries
+                            vector<__tm_snapshot::s_target> m_targets;
+                            //Stores the collected target word ids
+                            vector<word_uid> m_word_ids;
+                            //Stores the collected target phrase characters
+                            vector<char> m_chars;
+                            //Stores the collected pure features, for the tuning mode
+                            vector<prob_weight> m_pure_features;
+
+                            /**
+                             * Allows to collect the source entry and its targets
+                             * @param entry the source entry
+                             */
+                            inline void add_source(tm_const_source_entry & entry) {
+                                //Clear the record, including the padding, for the file to be reproducible
+                                __tm_snapshot::s_source source;
+                                memset(&source, 0, sizeof (source));
+                                source.m_source_uid = entry.get_source_uid();
+                                source.m_begin_target = m_targets.size();
+                                source.m_num_targets = entry.num_targets();
+                                source.m_min_cost = entry.get_min_cost();
+                                m_sources.push_back(source);
+
+                                tm_const_target_entry * entries = entry.get_targets();
+                                for (size_t idx = 0; idx < entry.num_targets(); ++idx) {
+                                    add_target(entries[idx]);
+                                }
+                            }
+
+                            /**
+                             * Allows to collect the target entry
+                             * @param entry the target entry
+                             */
+                            inline void add_target(tm_const_target_entry & entry) {
+                                const char * phrase = entry.get_target_phrase();
+                                const size_t phrase_len = entry.get_target_phrase_len();
+
+                                //Clear the record, including the padding, for the file to be reproducible
+                                __tm_snapshot::s_target target;
+                                memset(&target, 0, sizeof (target));
+                                target.m_st_uid = entry.get_st_uid();
+                                target.m_begin_char = m_chars.size();
+                                target.m_begin_word = m_word_ids.size();
+                                target.m_num_chars = phrase_len;
+                                target.m_total_weight = entry.get_tm_cost<false>();
+                                target.m_lm_weight = entry.get_lm_weight();
+                                target.m_num_words = entry.get_num_words();
+                                m_targets.push_back(target);
+
+                                m_chars.insert(m_chars.end(), phrase, phrase + phrase_len);
+                                m_word_ids.insert(m_word_ids.end(), entry.get_word_ids(), entry.get_word_ids() + entry.get_num_words());
+#if IS_SERVER_TUNING_MODE
+                                m_pure_features.insert(m_pure_features.end(), entry.get_pure_features(),
+                                        entry.get_pure_features() + m_params.m_num_lambdas);
+#endif
+                            }
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* TM_SNAPSHOT_BUILDER_HPP */
@@ -26,6 +26,8 @@
 #ifndef TM_BASIC_MODEL_HPP
 #define TM_BASIC_MODEL_HPP
 
+#include <type_traits>  // std::conditional
+
 #include "common/utils/exceptions.hpp"
 #include "common/utils/logging/logger.hpp"
 
@@ -36,6 +38,7 @@
 #include "server/tm/models/tm_query.hpp"
 
 #include "common/utils/containers/fixed_size_hashmap.hpp"
+#include "common/utils/containers/fingerprint_hashmap.hpp"
 
 using namespace std;
 
@@ -65,12 +68,14 @@ namespace uva {
                         class tm_basic_model {
                         public:
                             //Define the translations data map. It represents possible translations for some source phrase.
-                            typedef fixed_size_hashmap<tm_source_entry, const phrase_uid &> tm_source_entry_map;
+                            typedef conditional<__tm_basic_model::IS_FINGERPRINT_HASHMAP,
+                            fingerprint_hashmap<tm_source_entry, const phrase_uid &>,
+                            fixed_size_hashmap<tm_source_entry, const phrase_uid &> >::type tm_source_entry_map;
 
                             /**
                              * The basic class constructor
                              */
-                            tm_basic_model() : m_tm_data(NULL), m_unk_entry(NULL) {
+                            tm_basic_model() : m_tm_data(NULL), m_unk_entry(NULL), m_arena() {
                             }
 
                             /**
@@ -101,12 +106,8 @@ namespace uva {
                              */
                             void set_unk_entry(word_uid unk_word_id, feature_array unk_features, const prob_weight wp_lambda,
                                     const prob_weight lm_weight, const prob_weight * pure_features = NULL) {
-                                //Initialize the UNK entry
-                                m_unk_entry = new tm_source_entry();
-                                //Set thew source id
-                                m_unk_entry->set_source_uid(UNKNOWN_PHRASE_ID);
-                                //Start adding the translations to the entry, there will be just one
-                                m_unk_entry->begin(1);
+                                //Initialize the UNK entry, there will be just one translation
+                                begin_unk_entry(1);
 
                                 //Declare and initialize the word ids array
                                 const phrase_length num_words = 1;
@@ -129,6 +130,46 @@ namespace uva {
                                 LOG_DEBUG << "The UNK translation total weight is: " << m_unk_entry->get_targets()[0].get_tm_cost() << END_LOG;
                             }
 
+                            /**
+                             * Allows to open the unk entry, the translations are to be
+                             * added to it and then it is to be finalized
+                             * @param num_elems the number of translations
+                             * @return the unk entry
+                             */
+                            inline tm_source_entry * begin_unk_entry(const size_t num_elems) {
+                                //Initialize the UNK entry
+                                m_unk_entry = new tm_source_entry();
+                                //Set thew source id
+                                m_unk_entry->set_source_uid(UNKNOWN_PHRASE_ID);
+                                //Start adding the translations to the entry
+                                m_unk_entry->begin(num_elems, m_arena);
+                                return m_unk_entry;
+                            }
+
+                            /**
+                             * Allows to get the unk entry
+                             * @return the unk entry
+                             */
+                            inline tm_const_source_entry * get_unk_entry() const {
+                                return m_unk_entry;
+                            }
+
+                            /**
+                             * Allows to get the number of source entries, excluding the unk entry
+                             * @return the number of source entries
+                             */
+                            inline size_t get_num_entries() const {
+                                return m_tm_data->get_num_elements();
+                            }
+
+                            /**
+                             * Allows to get the source entries, excluding the unk entry
+                             * @return the pointer to the first of the get_num_entries() entries
+                             */
+                            inline tm_const_source_entry * get_entries() const {
+                                return m_tm_data->get_elements();
+                            }
+
                             /**
                              * This method allows to detect if the number of entries
                              * (source phrases) is needed before the translation
@@ -152,6 +193,18 @@ namespace uva {
                                 m_tm_data = new tm_source_entry_map(__tm_basic_model::SOURCES_BUCKETS_FACTOR, num_entries);
                             }
 
+                            /**
+                             * Allows to reserve the memory for the target entries, is to be
+                             * called before adding the translation entries if the amount of
+                             * their data, including the unk entry, is known beforehand.
+                             * @param num_targets the number of target entries
+                             * @param num_chars the number of target phrase characters
+                             * @param num_word_ids the number of target phrase word ids
+                             */
+                            inline void reserve_targets(const size_t num_targets, const size_t num_chars, const size_t num_word_ids) {
+                                m_arena.reserve(num_targets, num_chars, num_word_ids);
+                            }
+
                             /**
                              * Allows to open a new source entry, i.e. the entry for the new source phrase
                              * @param entry_id the source phrase id for which the entry is to be started
@@ -171,7 +224,7 @@ namespace uva {
                                 LOG_DEBUG1 << "Initializing the entry: " << entry_id << " with the number of translations." << END_LOG;
 
                                 //Initialize the entry with the number of translations
-                                entry.begin(num_elems);
+                                entry.begin(num_elems, m_arena);
 
                                 LOG_DEBUG1 << "Adding the new source entry for uid: " << entry_id << " - DONE!" << END_LOG;
 
@@ -244,6 +297,8 @@ namespace uva {
                             tm_source_entry_map * m_tm_data;
                             //Stores the pointer to the UNK entry
                             tm_source_entry_ptr m_unk_entry;
+                            //Stores the target entries data of all the source entries
+                            tm_target_arena m_arena;
                         };
                     }
                 }
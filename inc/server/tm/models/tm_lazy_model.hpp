@@ -0,0 +1,300 @@
+/*
+ * File:   tm_lazy_model.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 3:10 AM
+ */
+
+#ifndef TM_LAZY_MODEL_HPP
+#define TM_LAZY_MODEL_HPP
+
+#include <memory>       // std::shared_ptr
+#include <algorithm>    // std::lower_bound, std::min
+#include <atomic>       // std::atomic
+#include <chrono>       // std::chrono
+
+#include "common/utils/exceptions.hpp"
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/file/binary_mmap_reader.hpp"
+#include "common/utils/containers/concurrent_lru_cache.hpp"
+
+#include "server/lm/proxy/lm_proxy.hpp"
+
+#include "server/tm/tm_consts.hpp"
+#include "server/tm/tm_parameters.hpp"
+#include "server/tm/models/tm_source_entry.hpp"
+#include "server/tm/builders/tm_snapshot_builder.hpp"
+
+using namespace std;
+
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+using namespace uva::utils::file;
+using namespace uva::utils::containers;
+
+using namespace uva::smt::bpbd::server::lm::proxy;
+using namespace uva::smt::bpbd::server::tm::builders;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace tm {
+                    namespace models {
+
+                        /**
+                         * This structure stores a lazily loaded source entry
+                         * together with the arena storing its translations.
+                         */
+                        struct tm_lazy_source_entry {
+                            //Stores the target entries data of the source entry
+                            tm_target_arena m_arena;
+                            //Stores the source entry
+                            tm_source_entry m_entry;
+                        };
+
+                        //Define the shared pointer to the lazily loaded source entry,
+                        //the entry is freed once it is evicted and no longer used
+                        typedef shared_ptr<const tm_lazy_source_entry> tm_lazy_source_entry_ptr;
+
+                        /**
+                         * This class represents the lazily loaded translation model. The model
+                         * uses the binary snapshot file, as written by the tm_snapshot_writer,
+                         * in place. The file is memory mapped and the source entries are only
+                         * read from it when requested, they are found by a binary search as the
+                         * snapshot sources are sorted by their uids. The read source entries
+                         * are kept in the bounded least recently used cache, so the model can
+                         * be much larger than the available memory as long as the phrases of
+                         * the translated sentences fit into the cache.
+                         * @param model_type the type of the model the snapshot was written from
+                         */
+                        template<typename model_type>
+                        class tm_lazy_model {
+                        public:
+
+                            /**
+                             * The basic constructor, maps and checks the snapshot file
+                             * @param params the model parameters
+                             * @param lm_model the language model to check the snapshot LM weights with
+                             */
+                            tm_lazy_model(const tm_parameters & params, lm_proxy & lm_model)
+                            : m_file(params.m_conn_string), m_header(), m_sources(NULL), m_targets(NULL),
+                            m_word_ids(NULL), m_chars(NULL), m_pure_features(NULL), m_num_entries(0), m_unk_entry(),
+                            m_cache(params.m_lazy_cache_size, min(params.m_lazy_cache_size, __tm_lazy_model::CACHE_NUM_SHARDS)),
+                            m_num_loads(0), m_num_absent(0), m_load_time_ns(0) {
+                                //Set the number of TM features
+                                tm_target_entry::set_num_features(params.m_num_lambdas);
+
+                                //Check that the snapshot is compatible
+                                __tm_snapshot::check_header<model_type>(params, m_file, m_header);
+
+                                //Get the snapshot data pointers, the data is read on demand
+                                m_sources = m_file.get<__tm_snapshot::s_source>(m_header.m_num_sources);
+                                m_targets = m_file.get<__tm_snapshot::s_target>(m_header.m_num_targets);
+                                m_word_ids = m_file.get<word_uid>(m_header.m_num_word_ids);
+                                m_chars = m_file.get<char>(m_header.m_num_chars);
+#if IS_SERVER_TUNING_MODE
+                                m_pure_features = m_file.get<prob_weight>(m_header.m_num_targets * m_header.m_num_lambdas);
+#endif
+                                ASSERT_CONDITION_THROW(!m_file.is_eof(), "The binary snapshot file contains unexpected trailing data!");
+                                ASSERT_CONDITION_THROW((m_header.m_num_sources == 0) ||
+                                        (m_sources[m_header.m_num_sources - 1].m_source_uid != UNKNOWN_PHRASE_ID),
+                                        "The binary snapshot file has no unk entry!");
+                                m_num_entries = m_header.m_num_sources - 1;
+
+                                //Check that the LM weights are the ones of the current language model
+                                lm_fast_query_proxy & lm_query = lm_model.allocate_fast_query_proxy();
+                                try {
+                                    __tm_snapshot::check_lm_weights(m_header, m_targets, m_word_ids, lm_query);
+                                } catch (...) {
+                                    lm_model.dispose_fast_query_proxy(lm_query);
+                                    throw;
+                                }
+                                lm_model.dispose_fast_query_proxy(lm_query);
+
+                                //The source entries are read in a random order
+                                m_file.advise(MADV_RANDOM);
+
+                                //The unk entry is always kept in memory
+                                m_unk_entry = load_source_entry(m_num_entries);
+
+                                LOG_USAGE << "The binary translation model snapshot is mapped, " << m_num_entries
+                                        << " source entries, the cache size is " << params.m_lazy_cache_size << END_LOG;
+                            }
+
+                            /**
+                             * Allows to get the source entry for the given entry id, the entry
+                             * is taken from the cache or is read from the snapshot file
+                             * @param entry_id the source phrase id
+                             * @return the source phrase entry or an empty pointer if the entry is not found
+                             */
+                            inline tm_lazy_source_entry_ptr get_source_entry(const phrase_uid entry_id) {
+                                tm_lazy_source_entry_ptr entry;
+
+                                //The absent entries are also cached, as empty pointers
+                                if (!m_cache.get(entry_id, entry)) {
+                                    entry = find_source_entry(entry_id);
+                                    m_cache.put(entry_id, entry);
+                                }
+
+                                return entry;
+                            }
+
+                            /**
+                             * Allows to read the source entry for the given entry id from the
+                             * snapshot file, the cache is not used
+                             * @param entry_id the source phrase id
+                             * @return the source phrase entry or an empty pointer if the entry is not found
+                             */
+                            inline tm_lazy_source_entry_ptr find_source_entry(const phrase_uid entry_id) {
+                                const __tm_snapshot::s_source * end = m_sources + m_num_entries;
+                                const __tm_snapshot::s_source * source =
+                                        lower_bound(m_sources, end, entry_id, __tm_snapshot::is_less_source_uid);
+
+                                if ((source != end) && (source->m_source_uid == entry_id)) {
+                                    return load_source_entry(source - m_sources);
+                                } else {
+                                    m_num_absent.fetch_add(1, memory_order_relaxed);
+                                    return tm_lazy_source_entry_ptr();
+                                }
+                            }
+
+                            /**
+                             * Allows to get the unk entry
+                             * @return the unk entry
+                             */
+                            inline const tm_lazy_source_entry_ptr & get_unk_entry() const {
+                                return m_unk_entry;
+                            }
+
+                            /**
+                             * Allows to report the cache hit rate and the source entries loading latency
+                             */
+                            inline void report_run_time_info() const {
+                                const uint64_t num_hits = m_cache.get_num_hits();
+                                const uint64_t num_misses = m_cache.get_num_misses();
+                                const uint64_t num_total = num_hits + num_misses;
+                                const uint64_t num_loads = m_num_loads.load(memory_order_relaxed);
+                                const uint64_t load_time_ns = m_load_time_ns.load(memory_order_relaxed);
+
+                                LOG_USAGE << "TM lazy cache: #entries: " << m_cache.get_size() << ", #hits: " << num_hits
+                                        << ", #misses: " << num_misses << ", hit rate: "
+                                        << ((num_total == 0) ? 0.0 : (100.0 * num_hits) / num_total) << "%" << END_LOG;
+                                LOG_USAGE << "TM lazy loading: #loaded: " << num_loads << ", #absent: "
+                                        << m_num_absent.load(memory_order_relaxed) << ", average load time: "
+                                        << ((num_loads == 0) ? 0.0 : (load_time_ns / 1000.0) / num_loads)
+                                        << " mu sec." << END_LOG;
+                            }
+
+                            /**
+                             * Allows to log the model type info
+                             */
+                            inline void log_model_type_info() const {
+                                LOG_USAGE << "Using the lazily loaded translation model: " << __FILENAME__ << END_LOG;
+                            }
+
+                        private:
+                            //Stores the memory mapped snapshot file
+                            binary_mmap_reader m_file;
+                            //Stores the snapshot header
+                            __tm_snapshot::s_header m_header;
+                            //Stores the pointer to the snapshot sources
+                            const __tm_snapshot::s_source * m_sources;
+                            //Stores the pointer to the snapshot targets
+                            const __tm_snapshot::s_target * m_targets;
+                            //Stores the pointer to the snapshot word ids
+                            const word_uid * m_word_ids;
+                            //Stores the pointer to the snapshot characters
+                            const char * m_chars;
+                            //Stores the pointer to the snapshot pure features, for the tuning mode
+                            const prob_weight * m_pure_features;
+                            //Stores the number of source entries, excluding the unk entry
+                            uint64_t m_num_entries;
+                            //Stores the unk entry
+                            tm_lazy_source_entry_ptr m_unk_entry;
+                            //Stores the cache of the source entries
+                            concurrent_lru_cache<phrase_uid, tm_lazy_source_entry_ptr> m_cache;
+                            //Stores the number of the source entries read from the file
+                            atomic<uint64_t> m_num_loads;
+                            //Stores the number of the requested source entries absent in the file
+                            atomic<uint64_t> m_num_absent;
+                            //Stores the total time of reading the source entries in nano seconds
+                            atomic<uint64_t> m_load_time_ns;
+
+                            /**
+                             * Allows to read the source entry with the given index from the snapshot file
+                             * @param src_idx the source entry index
+                             * @return the read source entry
+                             */
+                            inline tm_lazy_source_entry_ptr load_source_entry(const uint64_t src_idx) {
+                                const chrono::steady_clock::time_point start_time = chrono::steady_clock::now();
+
+                                const __tm_snapshot::s_source & source = m_sources[src_idx];
+                                ASSERT_CONDITION_THROW((source.m_begin_target + source.m_num_targets > m_header.m_num_targets),
+                                        "The binary snapshot file is corrupted, a source entry is out of range!");
+                                const __tm_snapshot::s_target * targets = m_targets + source.m_begin_target;
+
+                                //Count the target entries data, to allocate it at once
+                                size_t num_chars = 0, num_word_ids = 0;
+                                for (uint32_t trg_idx = 0; trg_idx != source.m_num_targets; ++trg_idx) {
+                                    const __tm_snapshot::s_target & target = targets[trg_idx];
+                                    ASSERT_CONDITION_THROW((target.m_begin_char + target.m_num_chars > m_header.m_num_chars) ||
+                                            (target.m_begin_word + target.m_num_words > m_header.m_num_word_ids),
+                                            "The binary snapshot file is corrupted, a target entry is out of range!");
+                                    num_chars += target.m_num_chars;
+                                    num_word_ids += target.m_num_words;
+                                }
+
+                                //Create the source entry and add the translation entries
+                                tm_lazy_source_entry * result = new tm_lazy_source_entry();
+                                tm_lazy_source_entry_ptr entry(result);
+                                result->m_arena.reserve(source.m_num_targets, num_chars, num_word_ids);
+                                result->m_entry.set_source_uid(source.m_source_uid);
+                                result->m_entry.begin(source.m_num_targets, result->m_arena);
+                                for (uint32_t trg_idx = 0; trg_idx != source.m_num_targets; ++trg_idx) {
+                                    const __tm_snapshot::s_target & target = targets[trg_idx];
+                                    result->m_entry.add_target(target.m_st_uid, m_chars + target.m_begin_char,
+                                            target.m_num_chars, target.m_num_words, m_word_ids + target.m_begin_word,
+                                            target.m_total_weight, target.m_lm_weight, (m_pure_features == NULL) ? NULL :
+                                            m_pure_features + (source.m_begin_target + trg_idx) * m_header.m_num_lambdas);
+                                }
+                                result->m_entry.finalize();
+
+                                ASSERT_CONDITION_THROW((result->m_entry.get_min_cost() != source.m_min_cost),
+                                        "The binary snapshot file is corrupted, the minimum translation cost differs!");
+
+                                //Update the statistics
+                                m_num_loads.fetch_add(1, memory_order_relaxed);
+                                m_load_time_ns.fetch_add(chrono::duration_cast<chrono::nanoseconds>(
+                                        chrono::steady_clock::now() - start_time).count(), memory_order_relaxed);
+
+                                return entry;
+                            }
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* TM_LAZY_MODEL_HPP */
+
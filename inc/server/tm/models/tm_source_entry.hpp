@@ -69,17 +69,8 @@ namespace uva {
                              * The basic constructor
                              */
                             tm_source_entry()
-                            : m_source_uid(UNDEFINED_PHRASE_ID), m_capacity(0), m_targets(NULL), m_next_idx(0), m_min_cost(UNKNOWN_LOG_PROB_WEIGHT) {
-                            }
-
-                            /**
-                             * The basic destructor
-                             */
-                            ~tm_source_entry() {
-                                if (m_targets != NULL) {
-                                    delete[] m_targets;
-                                    m_targets = NULL;
-                                }
+                            : m_source_uid(UNDEFINED_PHRASE_ID), m_targets(NULL), m_arena(NULL),
+                            m_capacity(0), m_next_idx(0), m_min_cost(UNKNOWN_LOG_PROB_WEIGHT) {
                             }
 
                             /**
@@ -100,7 +91,7 @@ namespace uva {
                              * Allows to get the source phrase id
                              * @return the source phrase id
                              */
-                            inline phrase_uid get_source_uid() {
+                            inline phrase_uid get_source_uid() const {
                                 return m_source_uid;
                             }
 
@@ -115,12 +106,14 @@ namespace uva {
                             /**
                              * Should be called to start the source entry, i.e. initialize the memory
                              * @param capacity the number of translations for this entry
+                             * @param arena the arena to allocate the translations data from
                              */
-                            inline void begin(const size_t capacity) {
+                            inline void begin(const size_t capacity, tm_target_arena & arena) {
                                 //Store the number of translation entries
                                 m_capacity = capacity;
-                                //Instantiate the translations array
-                                m_targets = new tm_target_entry[m_capacity]();
+                                //Allocate the translations array from the arena
+                                m_arena = &arena;
+                                m_targets = m_arena->allocate_targets(m_capacity);
                             }
 
                             /**
@@ -136,10 +129,9 @@ namespace uva {
 
                             /**
                              * Allows to add a new translation to the source entry for the given target phrase
-                             * @param target [in/out] the translation target entry to be moved into the internal data storage
-                             * all the dynamically allocated memory of the entry will be moved to internal storage and set to NULL in the original entry.
+                             * @param target the translation target entry to be copied into the arena
                              */
-                            inline void emplace_target(tm_tmp_target_entry & target) {
+                            inline void emplace_target(const tm_target_entry & target) {
                                 //Perform a sanity check
                                 ASSERT_SANITY_THROW((m_next_idx >= m_capacity),
                                         string("Exceeding the source entry capacity: ") + to_string(m_capacity));
@@ -147,11 +139,11 @@ namespace uva {
                                 //Get the next free entry for the target phrase
                                 tm_target_entry & entry = m_targets[m_next_idx++];
 
-                                //Copy the data from the given target entry to storage
-                                entry.move_from(target);
+                                //Copy the data from the given target entry to the arena
+                                m_arena->copy_target(target, entry);
 
                                 //Compute the minimum cost which in log space is a maximum value
-                                update_minimum_cost(entry, target.get_lm_weight());
+                                update_minimum_cost(entry);
                             }
 
                             /**
@@ -170,20 +162,41 @@ namespace uva {
                                     const prob_weight * features, const phrase_length num_words,
                                     const word_uid * word_ids, const prob_weight wp_lambda,
                                     const prob_weight lm_weight, const prob_weight * pure_features = NULL) {
-                                //Perform a sanity check
-                                ASSERT_SANITY_THROW((m_next_idx >= m_capacity),
-                                        string("Exceeding the source entry capacity: ") + to_string(m_capacity));
-
-                                //Get the next free entry for the target phrase
-                                tm_target_entry & entry = m_targets[m_next_idx++];
-
                                 //Set the entry's target phrase and its id
+                                tm_tmp_target_entry entry;
                                 entry.set_data(m_source_uid, target, target_uid,
                                         features, num_words, word_ids,
                                         wp_lambda, pure_features);
+                                entry.set_lm_weight(lm_weight);
 
-                                //Compute the minimum cost which in log space is a maximum value
-                                update_minimum_cost(entry, lm_weight);
+                                //Add the entry
+                                emplace_target(entry);
+                            }
+
+                            /**
+                             * Allows to add a new translation with the already computed data,
+                             * e.g. as stored in the binary snapshot of the translation model
+                             * @param st_uid the source/target phrase uid
+                             * @param target_phrase the pointer to the target phrase characters
+                             * @param phrase_len the number of target phrase characters
+                             * @param num_words the number of words in the target translation
+                             * @param word_ids the LM word ids for the target phrase
+                             * @param total_weight the total features weight, including the word penalty
+                             * @param lm_weight the cost of the target translation from the LM model
+                             * @param pure_features the feature values without the lambda weights,
+                             *        to be stored for server tuning mode, default is NULL
+                             */
+                            inline void add_target(const phrase_uid st_uid, const char * target_phrase,
+                                    const size_t phrase_len, const phrase_length num_words,
+                                    const word_uid * word_ids, const prob_weight total_weight,
+                                    const prob_weight lm_weight, const prob_weight * pure_features = NULL) {
+                                //Set the entry's data
+                                tm_target_entry entry;
+                                entry.set_data(st_uid, target_phrase, phrase_len, num_words,
+                                        word_ids, total_weight, lm_weight, pure_features);
+
+                                //Add the entry
+                                emplace_target(entry);
                             }
 
                             /**
@@ -279,12 +292,14 @@ namespace uva {
                         private:
                             //Stores the unique identifier of the given source
                             phrase_uid m_source_uid;
-                            //Stores the number of translation entries
-                            size_t m_capacity;
-                            //Stores the target entries array pointer
+                            //Stores the target entries array pointer, the array is in the arena
                             tm_target_entry * m_targets;
+                            //Stores the pointer to the arena storing the target entries data
+                            tm_target_arena * m_arena;
+                            //Stores the number of translation entries
+                            uint32_t m_capacity;
                             //Stores the next index for the translation entry
-                            size_t m_next_idx;
+                            uint32_t m_next_idx;
                             //Stores the maximum cost of all translations
                             prob_weight m_min_cost;
 
@@ -293,11 +308,10 @@ namespace uva {
                              * We use the total weight (including the phrase penalty) the language model cost of
                              * the target phrase, and the word penalty
                              * @param entry the target entry to consider
-                             * @param lm_weight the language model weight of the given target entry
                              */
-                            inline void update_minimum_cost(tm_target_entry & entry, const prob_weight lm_weight) {
+                            inline void update_minimum_cost(const tm_target_entry & entry) {
                                 //Compute the cost for the new entry
-                                const prob_weight new_cost = entry.get_tm_cost<false>() + lm_weight;
+                                const prob_weight new_cost = entry.get_tm_cost<false>() + entry.get_lm_weight();
                                 
                                 //Take the minimum of the two costs
                                 m_min_cost = max(m_min_cost, new_cost);
@@ -32,11 +32,13 @@
 #include "common/utils/exceptions.hpp"
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/hashing_utils.hpp"
+#include "common/utils/containers/arena_pool.hpp"
 
 #include "server/lm/proxy/lm_fast_query_proxy.hpp"
 
 #include "server/common/models/phrase_uid.hpp"
 
+#include "server/tm/tm_consts.hpp"
 #include "server/tm/tm_parameters.hpp"
 
 using namespace std;
@@ -44,6 +46,7 @@ using namespace std;
 using namespace uva::utils::exceptions;
 using namespace uva::utils::logging;
 using namespace uva::utils::hashing;
+using namespace uva::utils::containers;
 
 using namespace uva::smt::bpbd::server::common::models;
 using namespace uva::smt::bpbd::server::lm::proxy;
@@ -62,7 +65,10 @@ namespace uva {
                          * for more details on the weights. Note that for this entry
                          * we have a uid that is a unique identifier of the target
                          * phrase string. The latter can be a hash value but then
-                         * there is a possibility for the hash collisions
+                         * there is a possibility for the hash collisions.
+                         * The entry does not own its target phrase, word ids and
+                         * features, it only points to them. For the model entries
+                         * they are stored in the pools of the tm_target_arena.
                          */
                         class tm_target_entry {
                         public:
@@ -73,8 +79,9 @@ namespace uva {
                              * The basic constructor
                              */
                             tm_target_entry()
-                            : m_target_phrase(""), m_num_words(0), m_word_ids(NULL),
-                            m_st_uid(UNDEFINED_PHRASE_ID), m_total_weight(UNKNOWN_LOG_PROB_WEIGHT) {
+                            : m_st_uid(UNDEFINED_PHRASE_ID), m_target_phrase(""), m_word_ids(NULL),
+                            m_total_weight(UNKNOWN_LOG_PROB_WEIGHT), m_lm_weight(UNKNOWN_LOG_PROB_WEIGHT),
+                            m_phrase_len(0), m_num_words(0) {
                                 //Check that the number of features is set
                                 ASSERT_SANITY_THROW((NUMBER_OF_TM_FEATURES == 0),
                                         "The NUMBER_OF_TM_FEATURES has not been set!");
@@ -84,86 +91,44 @@ namespace uva {
                             }
 
                             /**
-                             * The basic destructor
-                             */
-                            ~tm_target_entry() {
-                                //Deallocate the word ids
-                                if (m_word_ids != NULL) {
-                                    delete[] m_word_ids;
-                                    m_word_ids = NULL;
-                                }
-#if IS_SERVER_TUNING_MODE
-                                if (m_pure_features != NULL) {
-                                    delete m_pure_features;
-                                    m_pure_features = NULL;
-                                }
-#endif
-                            }
-
-                            /**
-                             * Allows to set the target phrase and its id
-                             * @param source_uid store the source uid for being combined with the
-                             *                   target phrase into the source/target pair uid
-                             * @param target_phrase the target phrase
-                             * @param target_uid the uid of the target phrase
-                             * @param features the weights to be set into the entry
+                             * Allows to set the already computed data of the target entry, e.g.
+                             * as stored in the binary snapshot of the translation model. The
+                             * target phrase, word ids and pure features are not copied, the
+                             * entry only points to them so they must outlive the entry.
+                             * @param st_uid the source/target phrase uid
+                             * @param target_phrase the pointer to the target phrase characters
+                             * @param phrase_len the number of target phrase characters
                              * @param num_words the number of words in the target translation
                              * @param word_ids the LM word ids for the target phrase 
-                             * @param wp_lambda the word penalty lambda weight
+                             * @param total_weight the total features weight, including the word penalty
+                             * @param lm_weight the cost of the target translation from the LM model
                              * @param pure_features the feature values without the lambda weights,
                              *        to be stored for server tuning mode, default is NULL
                              */
-                            inline void set_data(const phrase_uid source_uid,
-                                    const string & target_phrase, const phrase_uid target_uid,
-                                    const prob_weight * features, const phrase_length num_words,
-                                    const word_uid * word_ids, const prob_weight wp_lambda,
+                            inline void set_data(const phrase_uid st_uid,
+                                    const char * target_phrase, const size_t phrase_len,
+                                    const phrase_length num_words, const word_uid * word_ids,
+                                    const prob_weight total_weight, const prob_weight lm_weight,
                                     const prob_weight * pure_features = NULL) {
                                 //Store the target phrase
                                 m_target_phrase = target_phrase;
+                                m_phrase_len = phrase_len;
 
                                 //Store the number of words and the corresponding word ids
                                 m_num_words = num_words;
-                                m_word_ids = new word_uid[m_num_words];
-                                memcpy(m_word_ids, word_ids, m_num_words * sizeof (word_uid));
-
-                                //Compute and store the source/target phrase uid
-                                m_st_uid = combine_phrase_uids(source_uid, target_uid);
+                                m_word_ids = word_ids;
 
-                                //Set the features 
-                                set_features(features, wp_lambda, pure_features);
-
-                                LOG_DEBUG1 << "Adding the source/target (" << source_uid << "/"
-                                        << target_uid << ") entry with id" << m_st_uid << END_LOG;
-                            }
-
-                            /**
-                             * This method allows to move the data from the given target entry to this one.
-                             * The dynamically allocated data from the given entry is moved to this one,
-                             * the rest is copied.
-                             * @param other the other entry to move the values from
-                             */
-                            inline void move_from(tm_target_entry & other) {
-                                //Copy the target phrase
-                                m_target_phrase = other.m_target_phrase;
-
-                                //Copy the number of words in the source phrase and the word ids
-                                m_num_words = other.m_num_words;
-                                m_word_ids = other.m_word_ids;
-
-                                //Set the word ids to null so that the original
-                                //class can not modify/destroy it.
-                                other.m_word_ids = NULL;
-
-                                //Copy the source/target uid
-                                m_st_uid = other.m_st_uid;
-                                //Copy the total weight
-                                m_total_weight = other.m_total_weight;
+                                //Store the computed values
+                                m_st_uid = st_uid;
+                                m_total_weight = total_weight;
+                                m_lm_weight = lm_weight;
 
 #if IS_SERVER_TUNING_MODE
-                                m_pure_features = other.m_pure_features;
-                                //Make sure the features in the target
-                                //entry we move from are discarded
-                                other.m_pure_features = NULL;
+                                //Check that the pure features list is present
+                                ASSERT_SANITY_THROW((pure_features == NULL), "The pure_features is NULL!");
+
+                                //Store the individual feature weights
+                                m_pure_features = pure_features;
 #endif
                             }
 
@@ -176,13 +141,22 @@ namespace uva {
                             }
 
                             /**
-                             * Allows to get the target phrase
-                             * @return the reference to the const target phrase
+                             * Allows to get the target phrase, for the model
+                             * entries the phrase is zero terminated
+                             * @return the pointer to the const target phrase characters
                              */
-                            const string & get_target_phrase() const {
+                            inline const char * get_target_phrase() const {
                                 return m_target_phrase;
                             }
 
+                            /**
+                             * Allows to get the target phrase length
+                             * @return the number of target phrase characters
+                             */
+                            inline size_t get_target_phrase_len() const {
+                                return m_phrase_len;
+                            }
+
                             /**
                              * Allows to retrieve the source/target phrase pair uid
                              * @return the source/target phrase pair uid
@@ -218,6 +192,33 @@ namespace uva {
                                 return m_total_weight;
                             }
 
+                            /**
+                             * Allows to set the language model weight of the target
+                             * @param lm_target_weight the language model weight of the target
+                             */
+                            inline void set_lm_weight(const prob_weight lm_target_weight) {
+                                m_lm_weight = lm_target_weight;
+                            }
+
+                            /**
+                             * Allows to retrieve the language model weight of the target 
+                             * @return the language model weight of the target 
+                             */
+                            inline prob_weight get_lm_weight() const {
+                                return m_lm_weight;
+                            }
+
+#if IS_SERVER_TUNING_MODE
+
+                            /**
+                             * Allows to get the feature values without the lambda weights
+                             * @return the pointer to the feature values
+                             */
+                            inline const prob_weight * get_pure_features() const {
+                                return m_pure_features;
+                            }
+#endif
+
                             /**
                              * Allows to get the number of words in the target translation
                              * @return the number of words
@@ -263,47 +264,37 @@ namespace uva {
                         protected:
 
                             /**
-                             * Allows to set the weights into the target entry.
+                             * Allows to compute the total weight of the target entry.
                              * \todo Get rid of magic constants in this function!
-                             * @param features the weights to be set into the entry
+                             * @param features the weights of the entry
                              * @param wp_lambda the word penalty lambda weight
-                             * @param pure_features the feature values without the lambda weights,
-                             *        to be stored for server tuning mode, default is NULL
+                             * @param num_words the number of words in the target translation
                              * This is an array of translation weights, as we have here:
                              * features[0] = lambda_0 * p(f|e);
                              * features[1] = lambda_1 * lex(p(f|e));
                              * features[2] = lambda_2 * p(e|f);
                              * features[3] = lambda_3 * lex(p(e|f));
                              * features[4] = lambda_4 * phrase penalty;
+                             * @return the total weight, including the word penalty
                              */
-                            inline void set_features(const prob_weight * features, const prob_weight wp_lambda, const prob_weight * pure_features = NULL) {
-#if IS_SERVER_TUNING_MODE
-                                //Check that the pure features list is present
-                                ASSERT_SANITY_THROW((pure_features == NULL), "The pure_features is NULL!");
-
-                                //Allocate the features storage
-                                m_pure_features = new prob_weight[NUMBER_OF_TM_FEATURES]();
-                                //Store the individual feature weights
-                                memcpy(m_pure_features, pure_features, sizeof (prob_weight) * NUMBER_OF_TM_FEATURES);
-
-                                LOG_DEBUG1 << this << ": The features: "
-                                        << array_to_string<prob_weight>(NUMBER_OF_TM_FEATURES, m_pure_features) << END_LOG;
-#endif
-
+                            static inline prob_weight get_total_weight(const prob_weight * features,
+                                    const prob_weight wp_lambda, const phrase_length num_words) {
                                 //Compute the total weight
-                                m_total_weight = 0.0; //First re-set to zero
+                                prob_weight total_weight = 0.0;
                                 for (int8_t idx = 0; idx < NUMBER_OF_TM_FEATURES; ++idx) {
-                                    m_total_weight += features[idx];
+                                    total_weight += features[idx];
                                 }
 
                                 //Add the word penalty to the total score!
-                                m_total_weight -= wp_lambda * m_num_words;
+                                total_weight -= wp_lambda * num_words;
 
                                 //Check that we have enough features
                                 //ToDo: Why 3 and 2, later on? We shall change this into
                                 //      a constant and this kind of check is also bogus ...
                                 ASSERT_SANITY_THROW((NUMBER_OF_TM_FEATURES < 3),
                                         "The must be at least 3 features, p(e|f) is not known!");
+
+                                return total_weight;
                             }
 
                         private:
@@ -311,23 +302,29 @@ namespace uva {
                             //This value is initialized before the RM model is loaded
                             static int8_t NUMBER_OF_TM_FEATURES;
 
-                            //Stores the target phrase of the translation which a key value
-                            string m_target_phrase;
-                            //Stores the number of words in the translation, maximum should be TM_MAX_TARGET_PHRASE_LEN
-                            phrase_length m_num_words;
-                            //Stores the target phrase Language model word ids 
-                            word_uid * m_word_ids;
-
                             //Stores the source/target phrase id
                             phrase_uid m_st_uid;
 
-                            //Stores the total features weight of the entity
-                            prob_weight m_total_weight;
+                            //Stores the pointer to the target phrase characters
+                            const char * m_target_phrase;
+                            //Stores the target phrase Language model word ids 
+                            const word_uid * m_word_ids;
 
 #if IS_SERVER_TUNING_MODE
                             //Stores the the features
-                            prob_weight * m_pure_features;
+                            const prob_weight * m_pure_features;
 #endif                            
+
+                            //Stores the total features weight of the entity
+                            prob_weight m_total_weight;
+
+                            //Stores the language model weight of the target
+                            prob_weight m_lm_weight;
+
+                            //Stores the number of target phrase characters
+                            uint32_t m_phrase_len;
+                            //Stores the number of words in the translation, maximum should be TM_MAX_TARGET_PHRASE_LEN
+                            phrase_length m_num_words;
                         };
 
                         //Define the constant entry
@@ -337,7 +334,8 @@ namespace uva {
                         typedef prob_weight feature_array[MAX_NUM_TM_FEATURES];
 
                         /**
-                         * This class defines the temporary target entry 
+                         * This class defines the temporary target entry, it is
+                         * used when parsing the phrase table and owns its data
                          */
                         class tm_tmp_target_entry : public tm_target_entry {
                         public:
@@ -356,6 +354,58 @@ namespace uva {
                                 //Nothing to be done here
                             }
 
+                            /**
+                             * Allows to set the target phrase and its id, the data is copied into the entry
+                             * @param source_uid store the source uid for being combined with the
+                             *                   target phrase into the source/target pair uid
+                             * @param target_phrase the target phrase
+                             * @param target_uid the uid of the target phrase
+                             * @param features the weights to be set into the entry
+                             * @param num_words the number of words in the target translation
+                             * @param word_ids the LM word ids for the target phrase 
+                             * @param wp_lambda the word penalty lambda weight
+                             * @param pure_features the feature values without the lambda weights,
+                             *        to be stored for server tuning mode, default is NULL
+                             */
+                            inline void set_data(const phrase_uid source_uid,
+                                    const string & target_phrase, const phrase_uid target_uid,
+                                    const prob_weight * features, const phrase_length num_words,
+                                    const word_uid * word_ids, const prob_weight wp_lambda,
+                                    const prob_weight * pure_features = NULL) {
+                                ASSERT_SANITY_THROW((num_words > TM_MAX_TARGET_PHRASE_LEN),
+                                        string("The number of target words: ") + to_string(num_words) +
+                                        string(" exceeds ") + to_string(TM_MAX_TARGET_PHRASE_LEN));
+
+                                //Store the target phrase and the word ids
+                                m_tmp_phrase = target_phrase;
+                                memcpy(m_tmp_word_ids, word_ids, num_words * sizeof (word_uid));
+
+#if IS_SERVER_TUNING_MODE
+                                //Check that the pure features list is present
+                                ASSERT_SANITY_THROW((pure_features == NULL), "The pure_features is NULL!");
+
+                                //Store the individual feature weights
+                                memcpy(m_tmp_pure_features, pure_features, sizeof (prob_weight) * get_num_features());
+#endif
+
+                                //Compute the source/target phrase uid
+                                const phrase_uid st_uid = combine_phrase_uids(source_uid, target_uid);
+
+                                //Point the entry to the stored data and set the total weight
+                                tm_target_entry::set_data(st_uid, m_tmp_phrase.c_str(), m_tmp_phrase.size(),
+                                        num_words, m_tmp_word_ids, get_total_weight(features, wp_lambda, num_words),
+                                        UNKNOWN_LOG_PROB_WEIGHT,
+#if IS_SERVER_TUNING_MODE
+                                        m_tmp_pure_features
+#else
+                                        NULL
+#endif
+                                        );
+
+                                LOG_DEBUG1 << "Adding the source/target (" << source_uid << "/"
+                                        << target_uid << ") entry with id" << st_uid << END_LOG;
+                            }
+
                             /**
                              * Allows to compare two temporary target entries based on their total weight
                              * @param other the other entry to compare with
@@ -371,18 +421,10 @@ namespace uva {
                              */
                             inline void set_lm_weight(const prob_weight lm_target_weight) {
                                 //Store the lambda weight
-                                m_lm_weight = lm_target_weight;
+                                tm_target_entry::set_lm_weight(lm_target_weight);
                                 //Compute the local total weight based on the tm weight
                                 //of the super class and the lm target weight as given
-                                m_total_weight_plus = this->get_tm_cost<false>() + m_lm_weight;
-                            }
-                            
-                            /**
-                             * Allows to retrieve the lm model weight of the target 
-                             * @return  the lm model weight of the target 
-                             */
-                            inline prob_weight get_lm_weight() const {
-                                return m_lm_weight;
+                                m_total_weight_plus = this->get_tm_cost<false>() + get_lm_weight();
                             }
                             
                         private:
@@ -390,9 +432,119 @@ namespace uva {
                             //The total weight of the translation entry plus
                             //the language model joint probability of the target
                             prob_weight m_total_weight_plus;
-                            
-                            //Stores the language model weight of the target
-                            prob_weight m_lm_weight;
+                            //Stores the target phrase
+                            string m_tmp_phrase;
+                            //Stores the target phrase word ids
+                            word_uid m_tmp_word_ids[TM_MAX_TARGET_PHRASE_LEN];
+#if IS_SERVER_TUNING_MODE
+                            //Stores the feature values without the lambda weights
+                            feature_array m_tmp_pure_features;
+#endif
+                        };
+
+                        /**
+                         * This class stores the data of the translation model target entries.
+                         * The target entries of one source phrase are allocated as one array
+                         * of small records, their target phrases, word ids and pure features
+                         * are stored in the shared pools. So walking the translations of a
+                         * source phrase does not chase pointers all over the heap and the
+                         * model is loaded with just a few large memory allocations. All the
+                         * data is deallocated together with the arena.
+                         */
+                        class tm_target_arena {
+                        public:
+
+                            /**
+                             * The basic constructor
+                             */
+                            tm_target_arena()
+                            : m_targets(__tm_target_arena::TARGETS_BLOCK_SIZE),
+                            m_chars(__tm_target_arena::CHARS_BLOCK_SIZE),
+                            m_word_ids(__tm_target_arena::WORD_IDS_BLOCK_SIZE)
+#if IS_SERVER_TUNING_MODE
+                            , m_pure_features(__tm_target_arena::TARGETS_BLOCK_SIZE * MAX_NUM_TM_FEATURES)
+#endif
+                            {
+                            }
+
+                            /**
+                             * Allows to reserve the memory if the amount of the target entries data
+                             * is known beforehand, then each pool gets a single memory block.
+                             * @param num_targets the number of target entries
+                             * @param num_chars the number of target phrase characters, without the terminating zeros
+                             * @param num_word_ids the number of target phrase word ids
+                             */
+                            inline void reserve(const size_t num_targets, const size_t num_chars, const size_t num_word_ids) {
+                                m_targets.reserve(num_targets);
+                                m_chars.reserve(num_chars + num_targets);
+                                m_word_ids.reserve(num_word_ids);
+#if IS_SERVER_TUNING_MODE
+                                m_pure_features.reserve(num_targets * tm_target_entry::get_num_features());
+#endif
+                            }
+
+                            /**
+                             * Allows to allocate the contiguous array of target entries for a source phrase
+                             * @param num_targets the number of target entries
+                             * @return the pointer to the first target entry
+                             */
+                            inline tm_target_entry * allocate_targets(const size_t num_targets) {
+                                return m_targets.allocate(num_targets);
+                            }
+
+                            /**
+                             * Allows to copy the target entry data into the arena
+                             * @param source the target entry to copy the data from
+                             * @param target the arena target entry to copy the data to
+                             */
+                            inline void copy_target(const tm_target_entry & source, tm_target_entry & target) {
+                                //Copy the target phrase, make it zero terminated
+                                const size_t phrase_len = source.get_target_phrase_len();
+                                char * const phrase = m_chars.allocate(phrase_len + 1);
+                                memcpy(phrase, source.get_target_phrase(), phrase_len);
+                                phrase[phrase_len] = '\0';
+
+                                //Copy the target phrase word ids
+                                const phrase_length num_words = source.get_num_words();
+                                word_uid * const word_ids = m_word_ids.allocate(num_words);
+                                memcpy(word_ids, source.get_word_ids(), num_words * sizeof (word_uid));
+
+                                //Copy the pure features, if needed
+                                prob_weight * pure_features = NULL;
+#if IS_SERVER_TUNING_MODE
+                                const size_t num_features = tm_target_entry::get_num_features();
+                                pure_features = m_pure_features.allocate(num_features);
+                                memcpy(pure_features, source.get_pure_features(), num_features * sizeof (prob_weight));
+#endif
+
+                                //Set the data into the target
+                                target.set_data(source.get_st_uid(), phrase, phrase_len, num_words, word_ids,
+                                        source.get_tm_cost<false>(), source.get_lm_weight(), pure_features);
+                            }
+
+                            /**
+                             * Allows to get the number of bytes allocated by the arena
+                             * @return the number of allocated bytes
+                             */
+                            inline size_t get_num_bytes() const {
+                                return m_targets.get_num_bytes() + m_chars.get_num_bytes() + m_word_ids.get_num_bytes()
+#if IS_SERVER_TUNING_MODE
+                                        + m_pure_features.get_num_bytes()
+#endif
+                                        ;
+                            }
+
+                        private:
+                            //Stores the target entries
+                            arena_pool<tm_target_entry> m_targets;
+                            //Stores the zero terminated target phrases
+                            arena_pool<char> m_chars;
+                            //Stores the target phrase word ids
+                            arena_pool<word_uid> m_word_ids;
+#if IS_SERVER_TUNING_MODE
+                            //Stores the feature values without the lambda weights
+                            arena_pool<prob_weight> m_pure_features;
+#endif
                         };
                     }
                 }
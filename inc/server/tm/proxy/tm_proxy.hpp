@@ -26,8 +26,13 @@
 #ifndef TM_PROXY_HPP
 #define TM_PROXY_HPP
 
+#include <memory>       // std::shared_ptr
+
+#include "server/lm/proxy/lm_proxy.hpp"
 #include "server/tm/proxy/tm_query_proxy.hpp"
 
+using namespace uva::smt::bpbd::server::lm::proxy;
+
 namespace uva {
     namespace smt {
         namespace bpbd {
@@ -45,13 +50,26 @@ namespace uva {
                             /**
                              * Allows to connect to the model object based on the given parameters
                              * @param params the model parameters
+                             * @param lm_model the language model to get the target word ids from
                              */
-                            virtual void connect(const tm_parameters & params) = 0;
+                            virtual void connect(const tm_parameters & params, lm_proxy & lm_model) = 0;
 
                             /**
                              * Allows to disconnect from the trie
                              */
                             virtual void disconnect() = 0;
+
+                            /**
+                             * Allows to write the connected model into a binary snapshot file,
+                             * the latter can be later used as a connection string.
+                             * @param file_name the name of the snapshot file to write
+                             */
+                            virtual void write_snapshot(const string & file_name) = 0;
+
+                            /**
+                             * Allows to report the run time information of the model
+                             */
+                            virtual void report_run_time_info() const = 0;
                             
                             /**
                              * The basic virtual destructor
@@ -70,6 +88,9 @@ namespace uva {
                              */
                             virtual void dispose_query_proxy(tm_query_proxy & query) = 0;
                         };
+
+                        //Define the shared pointer to the translation model proxy
+                        typedef shared_ptr<tm_proxy> tm_proxy_ptr;
                     }
                 }
             }
@@ -0,0 +1,151 @@
+/* 
+ * File:   tm_proxy_lazy.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 3:25 AM
+ */
+
+#ifndef TM_PROXY_LAZY_HPP
+#define TM_PROXY_LAZY_HPP
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+#include "common/utils/monitor/statistics_monitor.hpp"
+
+#include "server/tm/tm_configs.hpp"
+#include "server/tm/proxy/tm_proxy.hpp"
+#include "server/tm/proxy/tm_query_proxy_lazy.hpp"
+
+#include "server/tm/models/tm_lazy_model.hpp"
+#include "server/tm/builders/tm_snapshot_builder.hpp"
+
+using namespace uva::utils::monitor;
+using namespace uva::utils::exceptions;
+using namespace uva::utils::logging;
+
+using namespace uva::smt::bpbd::server::tm;
+using namespace uva::smt::bpbd::server::tm::proxy;
+using namespace uva::smt::bpbd::server::tm::builders;
+using namespace uva::smt::bpbd::server::tm::models;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace tm {
+                    namespace proxy {
+
+                        /**
+                         * This is the lazily loaded implementation of the translation model proxy.
+                         * The model binary snapshot file is used in place and the source entries
+                         * are only read from it when requested, see tm_lazy_model.
+                         */
+                        class tm_proxy_lazy : public tm_proxy {
+                        public:
+                            //Define the model type
+                            typedef tm_lazy_model<tm_model_type> model_type;
+
+                            /**
+                             * The basic proxy constructor
+                             */
+                            tm_proxy_lazy() : m_model(NULL) {
+                            }
+
+                            /**
+                             * The basic destructor
+                             */
+                            virtual ~tm_proxy_lazy() {
+                                //Disconnect, just in case it has not been done before
+                                disconnect();
+                            };
+
+                            /**
+                             * @see tm_proxy
+                             */
+                            virtual void connect(const tm_parameters & params, lm_proxy & lm_model) {
+                                LOG_USAGE << "--------------------------------------------------------" << END_LOG;
+                                LOG_USAGE << "Start mapping the Translation Model binary snapshot ..." << END_LOG;
+                                LOG_USAGE << "Translation Model is located in: " << params.m_conn_string << END_LOG;
+
+                                ASSERT_CONDITION_THROW(!tm_snapshot_builder<tm_model_type>::is_snapshot_file(params.m_conn_string),
+                                        string("The ") + tm_parameters::TM_LAZY_CACHE_SIZE_PARAM_NAME + string(" > 0 requires the ") +
+                                        string("binary translation model snapshot, see the -b option of bpbd-server!"));
+
+                                const double start_time = stat_monitor::get_cpu_time();
+
+                                m_model = new model_type(params, lm_model);
+                                m_model->log_model_type_info();
+
+                                const double end_time = stat_monitor::get_cpu_time();
+                                LOG_USAGE << "Mapping the Translation Model took " << (end_time - start_time) << " CPU seconds." << END_LOG;
+                            }
+
+                            /**
+                             * @see tm_proxy
+                             */
+                            virtual void disconnect() {
+                                if (m_model != NULL) {
+                                    delete m_model;
+                                    m_model = NULL;
+                                }
+                            }
+
+                            /**
+                             * @see tm_proxy
+                             */
+                            virtual void write_snapshot(const string & file_name) {
+                                THROW_EXCEPTION("The lazily loaded translation model is a binary snapshot already!");
+                            }
+
+                            /**
+                             * @see tm_proxy
+                             */
+                            virtual void report_run_time_info() const {
+                                m_model->report_run_time_info();
+                            }
+
+                            /**
+                             * @see tm_proxy
+                             */
+                            virtual tm_query_proxy & allocate_query_proxy() {
+                                return *(new tm_query_proxy_lazy<tm_model_type>(*m_model));
+                            }
+
+                            /**
+                             * @see tm_proxy
+                             */
+                            virtual void dispose_query_proxy(tm_query_proxy & query) {
+                                delete &query;
+                            }
+
+                        private:
+                            //Stores the pointer to the translation model
+                            model_type * m_model;
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* TM_PROXY_LAZY_HPP */
+
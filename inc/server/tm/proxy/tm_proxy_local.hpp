@@ -35,6 +35,7 @@
 #include "server/tm/proxy/tm_query_proxy_local.hpp"
 
 #include "server/tm/builders/tm_basic_builder.hpp"
+#include "server/tm/builders/tm_snapshot_builder.hpp"
 
 using namespace uva::utils::monitor;
 using namespace uva::utils::exceptions;
@@ -64,7 +65,7 @@ namespace uva {
                              * The basic proxy constructor, currently does nothing except for default initialization
                              */
                             tm_proxy_local()
-                            : m_model() {
+                            : m_model(), m_params(NULL) {
                             }
 
                             /**
@@ -78,10 +79,19 @@ namespace uva {
                             /**
                              * @see tm_proxy
                              */
-                            virtual void connect(const tm_parameters & params) {
+                            virtual void connect(const tm_parameters & params, lm_proxy & lm_model) {
+                                //Store the parameters, needed for writing the snapshot
+                                m_params = &params;
+
                                 //The whole purpose of this method connect here is
                                 //just to load the translation model into the memory.
-                                load_model_data<tm_builder_type, tm_model_reader>("Translation Model", params);
+                                if (tm_snapshot_builder<tm_model_type>::is_snapshot_file(params.m_conn_string)) {
+                                    load_snapshot_data("Translation Model", params, lm_model);
+                                } else if ((params.m_num_load_threads > 1) && !params.m_is_streaming_load) {
+                                    load_model_data<tm_parallel_builder_type, tm_parallel_model_reader>("Translation Model", params, lm_model);
+                                } else {
+                                    load_model_data<tm_builder_type, tm_model_reader>("Translation Model", params, lm_model);
+                                }
                             }
 
                             /**
@@ -91,6 +101,26 @@ namespace uva {
                                 //Nothing the be done here yet, the model is allocated on the stack
                             }
 
+                            /**
+                             * @see tm_proxy
+                             */
+                            virtual void write_snapshot(const string & file_name) {
+                                LOG_USAGE << "Writing the binary translation model snapshot into: " << file_name << END_LOG;
+
+                                //Open the file, write the snapshot and close the file
+                                binary_file_writer file(file_name);
+                                tm_snapshot_writer<tm_model_type> writer(*m_params, m_model, file);
+                                writer.write();
+                                file.close();
+                            }
+
+                            /**
+                             * @see tm_proxy
+                             */
+                            virtual void report_run_time_info() const {
+                                //Nothing to be reported, the model is fully loaded
+                            }
+
                             /**
                              * @see tm_proxy
                              */
@@ -109,14 +139,61 @@ namespace uva {
 
                         protected:
 
+                            /**
+                             * Allows to load the model from the binary snapshot file, the finalized
+                             * entries are read from the memory mapped file so neither the text parsing
+                             * nor the language model queries are needed. The file is unmapped once
+                             * the model is loaded, as the data is copied into the model entries.
+                             * @param the name of the model being loaded
+                             * @params params the model parameters
+                             * @param lm_model the language model to check the snapshot LM weights with
+                             */
+                            void load_snapshot_data(char const *model_name, const tm_parameters & params, lm_proxy & lm_model) {
+                                //Declare time variables for CPU times in seconds
+                                double start_time, end_time;
+                                //Declare the statistics monitor and its data
+                                TMemotyUsage mem_stat_start = {}, mem_stat_end = {};
+
+                                LOG_USAGE << "--------------------------------------------------------" << END_LOG;
+                                LOG_USAGE << "Start loading the " << model_name << " binary snapshot ..." << END_LOG;
+                                LOG_USAGE << model_name << " is located in: " << params.m_conn_string << END_LOG;
+
+                                //Log the usage information
+                                m_model.log_model_type_info();
+
+                                LOG_DEBUG << "Getting the memory statistics before loading the " << model_name << " ..." << END_LOG;
+                                stat_monitor::get_mem_stat(mem_stat_start);
+                                start_time = stat_monitor::get_cpu_time();
+
+                                //Allocate the model tables with the configured huge pages policy
+                                huge_page_allocator::scoped_policy huge_pages(params.m_huge_pages);
+
+                                //Map the snapshot file and read the model from it
+                                binary_mmap_reader model_file(params.m_conn_string);
+                                tm_snapshot_builder<tm_model_type> builder(params, m_model, model_file, lm_model);
+                                builder.build();
+                                model_file.close();
+
+                                end_time = stat_monitor::get_cpu_time();
+                                LOG_USAGE << "Reading the " << model_name << " took " << (end_time - start_time) << " CPU seconds." << END_LOG;
+                                LOG_DEBUG << "Getting the memory statistics after loading the " << model_name << " ..." << END_LOG;
+                                stat_monitor::get_mem_stat(mem_stat_end);
+                                const string action_name = string("Loading the ") + string(model_name);
+                                report_memory_usage(action_name.c_str(), mem_stat_start, mem_stat_end, true);
+                                if (params.m_huge_pages != NO_HUGE_PAGES) {
+                                    huge_page_allocator::report_usage();
+                                }
+                            }
+
                             /**
                              * Allows to load the model into the instance of the selected container class
                              * \todo Add the possibility to choose between the file readers from the command line!
                              * @param the name of the model being loaded
                              * @params params the model parameters
+                             * @param lm_model the language model to get the target word ids from
                              */
                             template<typename tm_builder_type, typename file_reader_type>
-                            void load_model_data(char const *model_name, const tm_parameters & params) {
+                            void load_model_data(char const *model_name, const tm_parameters & params, lm_proxy & lm_model) {
                                 const string & model_file_name = params.m_conn_string;
                                 
                                 //Declare time variables for CPU times in seconds
@@ -149,8 +226,11 @@ namespace uva {
                                 ASSERT_CONDITION_THROW(!model_file.is_open(), string("The ") + string(model_name) + string(" file: '")
                                         + model_file_name + string("' does not exist!"));
 
+                                //Allocate the model tables with the configured huge pages policy
+                                huge_page_allocator::scoped_policy huge_pages(params.m_huge_pages);
+
                                 //Create the trie builder and give it the trie
-                                tm_builder_type builder(params, m_model, model_file);
+                                tm_builder_type builder(params, m_model, model_file, lm_model);
                                 //Load the model from the file
                                 builder.build();
 
@@ -162,6 +242,9 @@ namespace uva {
                                 LOG_DEBUG << "Reporting on the memory consumption" << END_LOG;
                                 const string action_name = string("Loading the ") + string(model_name);
                                 report_memory_usage(action_name.c_str(), mem_stat_start, mem_stat_end, true);
+                                if (params.m_huge_pages != NO_HUGE_PAGES) {
+                                    huge_page_allocator::report_usage();
+                                }
 
                                 LOG_DEBUG << "Getting the memory statistics before closing the " << model_name << " file ..." << END_LOG;
                                 stat_monitor::get_mem_stat(mem_stat_start);
@@ -174,6 +257,8 @@ namespace uva {
                         private:
                             //Stores the translation model instance
                             tm_model_type m_model;
+                            //Stores the pointer to the model parameters
+                            const tm_parameters * m_params;
                         };
                     }
                 }
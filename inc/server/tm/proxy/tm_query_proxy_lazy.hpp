@@ -0,0 +1,133 @@
+/* 
+ * File:   tm_query_proxy_lazy.hpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 3:20 AM
+ */
+
+#ifndef TM_QUERY_PROXY_LAZY_HPP
+#define TM_QUERY_PROXY_LAZY_HPP
+
+#include <unordered_map>
+
+#include "server/tm/proxy/tm_query_proxy.hpp"
+#include "server/tm/models/tm_lazy_model.hpp"
+
+using namespace uva::smt::bpbd::server::tm;
+using namespace uva::smt::bpbd::server::tm::models;
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace tm {
+                    namespace proxy {
+
+                        /**
+                         * This is a lazily loaded model implementation of the translation model
+                         * query. The query keeps the retrieved source entries, so they stay valid
+                         * until the query is disposed, even if they are evicted from the cache.
+                         */
+                        template<typename model_type>
+                        class tm_query_proxy_lazy : public tm_query_proxy {
+                        public:
+                            //Define the query map as a mapping from the source phrase
+                            //id to the pointer to the retrieved source entry
+                            typedef unordered_map<phrase_uid, tm_lazy_source_entry_ptr> query_map;
+
+                            /**
+                             * The basic constructor that accepts the translation model reference to query to
+                             * @param model the translation model to query
+                             */
+                            tm_query_proxy_lazy(tm_lazy_model<model_type> & model)
+                            : m_model(model), m_query_data(), m_last_entry() {
+                            }
+
+                            /**
+                             * @see tm_query_proxy
+                             */
+                            virtual void execute(const phrase_uid uid, tm_const_source_entry_ptr & entry_ptr) {
+                                LOG_DEBUG1 << "Requesting the translation for the phrase uid: " << uid << END_LOG;
+
+                                //Check if there has been already retrieved data for this uid
+                                query_map::iterator iter = m_query_data.find(uid);
+
+                                //If there has not been retrieved anything for this phrase then ask the model
+                                if (iter == m_query_data.end()) {
+                                    tm_lazy_source_entry_ptr entry = m_model.get_source_entry(uid);
+                                    if (!entry) {
+                                        LOG_DEBUG1 << "Returning the UNK translation for the source uid: " << uid << END_LOG;
+                                        entry = m_model.get_unk_entry();
+                                    }
+                                    iter = m_query_data.insert(query_map::value_type(uid, entry)).first;
+                                }
+
+                                //Set the pointer to the proper entry
+                                entry_ptr = &iter->second->m_entry;
+                            }
+
+                            /**
+                             * The returned entry is only valid until the next call of this method,
+                             * the source entry cache is not used. This method is used when loading
+                             * the reordering model, which requests all of its source phrases.
+                             * @see tm_query_proxy
+                             */
+                            virtual tm_const_source_entry * get_source_entry(const phrase_uid uid) {
+                                LOG_DEBUG1 << "Getting translations for the phrase uid: " << uid << END_LOG;
+
+                                m_last_entry = m_model.find_source_entry(uid);
+
+                                return m_last_entry ? &m_last_entry->m_entry : NULL;
+                            }
+
+                            /**
+                             * @see tm_query_proxy
+                             */
+                            virtual void get_st_uids(vector<phrase_uid> & st_uids) const {
+                                for (query_map::const_iterator iter = m_query_data.begin(); iter != m_query_data.end(); ++iter) {
+                                    iter->second->m_entry.get_st_uids(st_uids);
+                                }
+                            }
+
+                            /**
+                             * @see tm_query_proxy
+                             */
+                            virtual ~tm_query_proxy_lazy() {
+                                //Nothing to be done, the source entries are released by the shared pointers
+                            }
+
+                        private:
+                            //Stores the reference to the translation model
+                            tm_lazy_model<model_type> & m_model;
+                            //Stores the mapping from the source phrase id to the retrieved source entry
+                            query_map m_query_data;
+                            //Stores the last source entry retrieved by get_source_entry
+                            tm_lazy_source_entry_ptr m_last_entry;
+                        };
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif /* TM_QUERY_PROXY_LAZY_HPP */
+
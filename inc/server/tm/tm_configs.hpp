@@ -56,6 +56,13 @@ namespace uva {
 
                     //Define the builder type:
                     typedef tm_basic_builder<tm_model_type, tm_model_reader> tm_builder_type;
+
+                    //Here we have the model file reader type for the multi-threaded
+                    //loading, the worker threads parse the memory mapped file chunks
+                    typedef memory_mapped_file_reader tm_parallel_model_reader;
+
+                    //Define the multi-threaded loading builder type:
+                    typedef tm_basic_builder<tm_model_type, tm_parallel_model_reader> tm_parallel_builder_type;
                 }
             }
         }
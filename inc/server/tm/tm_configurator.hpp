@@ -26,12 +26,16 @@
 #ifndef TM_CONFIGURATOR_HPP
 #define TM_CONFIGURATOR_HPP
 
+#include <memory>       // std::shared_ptr, std::atomic_load
+
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/exceptions.hpp"
 
+#include "server/lm/lm_configurator.hpp"
 #include "server/tm/tm_parameters.hpp"
 #include "server/tm/proxy/tm_proxy.hpp"
 #include "server/tm/proxy/tm_proxy_local.hpp"
+#include "server/tm/proxy/tm_proxy_lazy.hpp"
 #include "server/tm/proxy/tm_query_proxy.hpp"
 
 using namespace uva::utils::logging;
@@ -63,54 +67,83 @@ namespace uva {
                             //Store the parameters for future use
                             m_params = &params;
 
-                            //At the moment we only support a local proxy
-                            m_model_proxy = new tm_proxy_local();
+                            //Create the model and make it the current one, the model
+                            //is built against the current language model
+                            set_model_proxy(create_model_proxy(*lm_configurator::get_model_proxy()));
+                        }
+
+                        /**
+                         * Allows to create and connect a new instance of the translation model,
+                         * using the connected parameters, e.g. to reload the model files.
+                         * The new instance does not become current until set_model_proxy.
+                         * @param lm_model the language model to get the target word ids from
+                         * @return the new connected model proxy
+                         */
+                        static tm_proxy_ptr create_model_proxy(lm_proxy & lm_model) {
+                            //The model is either lazily loaded from its snapshot or is loaded into memory
+                            tm_proxy_ptr proxy;
+                            if (m_params->m_lazy_cache_size > 0) {
+                                proxy.reset(new tm_proxy_lazy());
+                            } else {
+                                proxy.reset(new tm_proxy_local());
+                            }
 
                             //Connect to the model instance using the given parameters
-                            m_model_proxy->connect(*m_params);
+                            proxy->connect(*m_params, lm_model);
+
+                            return proxy;
                         }
 
                         /**
-                         * Allows to disconnect from the translation model.
+                         * Allows to get the current model proxy, the proxy stays valid
+                         * as long as the returned pointer is kept, even if the model
+                         * is replaced in the mean time.
+                         * @return the current model proxy
                          */
-                        static void disconnect() {
-                            if (m_model_proxy != NULL) {
-                                //Disconnect from the model
-                                m_model_proxy->disconnect();
-                                //Delete the object, free the resources
-                                delete m_model_proxy;
-                                m_model_proxy = NULL;
-                            }
+                        static inline tm_proxy_ptr get_model_proxy() {
+                            return atomic_load(&m_model_proxy);
                         }
 
                         /**
-                         * Allows to return an instance of the query proxy,
-                         * is to be returned by calling the dispose method.
-                         * @return an instance of the query executor.
+                         * Allows to atomically replace the current model proxy, the previous
+                         * one is freed once it is no longer used.
+                         * @param proxy the new model proxy, may be empty
                          */
-                        static inline tm_query_proxy & allocate_query_proxy() {
-                            LOG_DEBUG2 << "Allocating a new TM query proxy" << END_LOG;
+                        static inline void set_model_proxy(const tm_proxy_ptr & proxy) {
+                            atomic_store(&m_model_proxy, proxy);
+                        }
 
-                            //Return the query executor as given by the proxy class
-                            return m_model_proxy->allocate_query_proxy();
+                        /**
+                         * Allows to disconnect from the translation model.
+                         */
+                        static void disconnect() {
+                            //The model is freed once it is no longer used
+                            set_model_proxy(tm_proxy_ptr());
                         }
 
                         /**
-                         * Dispose the previously allocated query object
-                         * @param query the query to dispose
+                         * Allows to write the connected translation model into a binary
+                         * snapshot file. The snapshot file can then be used as the
+                         * connection string for a much faster model loading.
+                         * @param file_name the name of the snapshot file
                          */
-                        static inline void dispose_query_proxy(tm_query_proxy & query) {
-                            m_model_proxy->dispose_query_proxy(query);
+                        static void write_snapshot(const string & file_name) {
+                            get_model_proxy()->write_snapshot(file_name);
                         }
 
-                    protected:
+                        /**
+                         * Allows to report the run time information of the translation model
+                         */
+                        static void report_run_time_info() {
+                            get_model_proxy()->report_run_time_info();
+                        }
 
                     private:
                         //Stores the pointer to the configuration parameters
                         static const tm_parameters * m_params;
 
                         //Store the trie proxy object
-                        static tm_proxy * m_model_proxy;
+                        static tm_proxy_ptr m_model_proxy;
                     };
                 }
             }
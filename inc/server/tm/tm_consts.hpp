@@ -39,6 +39,22 @@ namespace uva {
                         namespace __tm_basic_model {
                             //Influences the number of buckets that will be created for the basic model implementations
                             static constexpr double SOURCES_BUCKETS_FACTOR = 3.0;
+                            //If true then the source entries are stored in the fingerprint_hashmap, otherwise in the fixed_size_hashmap
+                            static constexpr bool IS_FINGERPRINT_HASHMAP = true;
+                        }
+
+                        namespace __tm_target_arena {
+                            //Stores the number of target entries in one memory block of the arena
+                            static constexpr size_t TARGETS_BLOCK_SIZE = 64 * 1024;
+                            //Stores the number of target phrase characters in one memory block of the arena
+                            static constexpr size_t CHARS_BLOCK_SIZE = 1024 * 1024;
+                            //Stores the number of target phrase word ids in one memory block of the arena
+                            static constexpr size_t WORD_IDS_BLOCK_SIZE = 256 * 1024;
+                        }
+
+                        namespace __tm_lazy_model {
+                            //Stores the number of independently locked shards of the source entries cache
+                            static constexpr size_t CACHE_NUM_SHARDS = 16;
                         }
                     }
                 }
@@ -33,6 +33,7 @@
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/exceptions.hpp"
 #include "common/utils/text/string_utils.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
 
 #include "server/server_configs.hpp"
 #include "server/common/feature_id_registry.hpp"
@@ -42,6 +43,7 @@ using namespace std;
 using namespace uva::utils::exceptions;
 using namespace uva::utils::logging;
 using namespace uva::utils::text;
+using namespace uva::utils::containers;
 
 using namespace uva::smt::bpbd::server::common;
 
@@ -77,6 +79,14 @@ namespace uva {
                         static size_t TM_WP_LAMBDA_GLOBAL_ID;
                         //The index of the word penalty parameter lambda
                         static size_t TM_PHRASE_PENALTY_LAMBDA_IDX;
+                        //The huge pages policy parameter name
+                        static const string TM_HUGE_PAGES_PARAM_NAME;
+                        //The number of model loading threads parameter name
+                        static const string TM_LOAD_THREADS_PARAM_NAME;
+                        //The streaming loading flag parameter name
+                        static const string TM_STREAMING_LOAD_PARAM_NAME;
+                        //The lazy loading cache size parameter name
+                        static const string TM_LAZY_CACHE_SIZE_PARAM_NAME;
 
                         //The the connection string needed to connect to the model
                         string m_conn_string;
@@ -106,6 +116,20 @@ namespace uva {
                         //Stores the word penalty lambda - the cost of each target word
                         float m_wp_lambda;
 
+                        //Stores the huge pages policy for the model tables
+                        huge_pages_policy m_huge_pages;
+
+                        //Stores the number of threads to be used for loading the model
+                        size_t m_num_load_threads;
+
+                        //Stores the flag indicating that the model file is sorted by the
+                        //source phrases and is to be loaded in a single streaming pass
+                        bool m_is_streaming_load;
+
+                        //Stores the maximum number of source entries cached by the lazily
+                        //loaded model, if zero then the model is fully loaded into memory
+                        size_t m_lazy_cache_size;
+
                         /**
                          * Allows to get the features weights used in the corresponding model.
                          * @param registry the feature registry entity
@@ -152,6 +176,10 @@ namespace uva {
                                         TM_UNK_FEATURE_PARAM_NAME + string("[") +
                                         to_string(idx) + string("] is zero!"));
                             }
+
+                            //There must be at least one loading thread
+                            ASSERT_CONDITION_THROW((m_num_load_threads == 0),
+                                    string("The value of ") + TM_LOAD_THREADS_PARAM_NAME + string(" must be > 0!"));
                         }
                     };
 
@@ -175,6 +203,12 @@ namespace uva {
                                 << ", " << tm_parameters::TM_TRANS_LIM_PARAM_NAME << " = " << params.m_trans_limit
                                 << ", " << tm_parameters::TM_MIN_TRANS_PROB_PARAM_NAME << " = " << params.m_min_tran_prob
                                 << ", " << tm_parameters::TM_WORD_PENALTY_PARAM_NAME << " = " << params.m_wp_lambda
+                                << ", " << tm_parameters::TM_HUGE_PAGES_PARAM_NAME << " = "
+                                << huge_page_allocator::POLICY_NAMES[params.m_huge_pages]
+                                << ", " << tm_parameters::TM_LOAD_THREADS_PARAM_NAME << " = " << params.m_num_load_threads
+                                << ", " << tm_parameters::TM_STREAMING_LOAD_PARAM_NAME << " = "
+                                << (params.m_is_streaming_load ? "true" : "false")
+                                << ", " << tm_parameters::TM_LAZY_CACHE_SIZE_PARAM_NAME << " = " << params.m_lazy_cache_size
                                 << " ]";
                     }
                 }
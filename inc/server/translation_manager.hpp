@@ -29,6 +29,8 @@
 #include <functional>
 
 #include "server/trans_job.hpp"
+#include "server/lm/lm_configurator.hpp"
+#include "server/tm/tm_configurator.hpp"
 
 #include "common/utils/exceptions.hpp"
 #include "common/utils/logging/logger.hpp"
@@ -50,6 +52,7 @@ using namespace uva::utils::threads;
 
 using namespace uva::smt::bpbd::common::messaging;
 using namespace uva::smt::bpbd::server::messaging;
+using namespace uva::smt::bpbd::server::lm;
 
 namespace uva {
     namespace smt {
@@ -101,6 +104,12 @@ namespace uva {
 
                         //Report data from the tasks pool
                         m_tasks_pool.report_run_time_info("Translation tasks pool");
+
+                        //Report data from the language model
+                        lm_configurator::report_run_time_info();
+
+                        //Report data from the translation model
+                        tm_configurator::report_run_time_info();
                     }
 
                     /**
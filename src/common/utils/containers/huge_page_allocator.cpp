@@ -0,0 +1,213 @@
+/*
+ * File:   huge_page_allocator.cpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 8:55 PM
+ */
+
+#include "common/utils/containers/huge_page_allocator.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sys/mman.h>
+
+namespace uva {
+    namespace utils {
+        namespace containers {
+
+            //The default huge page size, is used if the actual one can not be read
+            static constexpr size_t DEFAULT_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+            //The number of bytes in one Mb
+            static constexpr size_t NUM_BYTES_ONE_MB = 1024 * 1024;
+
+            const char * const huge_page_allocator::POLICY_NAMES[size_huge_pages_policy] = {"none", "thp", "hugetlb"};
+
+            mutex huge_page_allocator::m_lock;
+            huge_pages_policy huge_page_allocator::m_policy = NO_HUGE_PAGES;
+            map<void *, huge_page_allocator::s_block> huge_page_allocator::m_blocks;
+            size_t huge_page_allocator::m_num_bytes[size_alloc_kind] = {};
+            bool huge_page_allocator::m_is_tlb_warned = false;
+
+            /**
+             * Allows to read the Kb value of the given field from the /proc file
+             * @param file_name the /proc file name
+             * @param field the field name, including the colon
+             * @return the value in Kb, zero if the file or the field is not present
+             */
+            static size_t read_proc_kb_value(const char * file_name, const char * field) {
+                size_t value = 0;
+                FILE * file = fopen(file_name, "r");
+                if (file != NULL) {
+                    char line[256];
+                    const size_t field_len = strlen(field);
+                    while (fgets(line, sizeof (line), file) != NULL) {
+                        if (strncmp(line, field, field_len) == 0) {
+                            value = strtoull(line + field_len, NULL, 10);
+                            break;
+                        }
+                    }
+                    fclose(file);
+                }
+                return value;
+            }
+
+            /**
+             * Allows to get the system's default huge page size
+             * @return the huge page size in bytes
+             */
+            static size_t get_huge_page_size() {
+                static const size_t huge_page_kb = read_proc_kb_value("/proc/meminfo", "Hugepagesize:");
+                return (huge_page_kb == 0) ? DEFAULT_HUGE_PAGE_SIZE : huge_page_kb * 1024;
+            }
+
+            /**
+             * Allows to round the number of bytes up to the multiple of the page size
+             * @param num_bytes the number of bytes
+             * @param page_size the page size
+             * @return the rounded number of bytes
+             */
+            static inline size_t round_up(const size_t num_bytes, const size_t page_size) {
+                return ((num_bytes + page_size - 1) / page_size) * page_size;
+            }
+
+            void * huge_page_allocator::allocate_bytes(const size_t num_bytes, const size_t num_elems) {
+                scoped_guard guard(m_lock);
+
+                const size_t huge_page_size = get_huge_page_size();
+                void * ptr = NULL;
+                s_block block = {num_bytes, num_elems, NEW_ALLOC_KIND};
+
+                //Only the tables of at least one huge page are worth it
+                if ((m_policy != NO_HUGE_PAGES) && (num_bytes >= huge_page_size)) {
+#ifdef MAP_HUGETLB
+                    if (m_policy == TLB_HUGE_PAGES) {
+                        //The hugetlbfs mapping length is to be a multiple of the huge page size
+                        const size_t map_bytes = round_up(num_bytes, huge_page_size);
+                        ptr = mmap(NULL, map_bytes, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                        if (ptr != MAP_FAILED) {
+                            block.m_num_bytes = map_bytes;
+                            block.m_kind = TLB_ALLOC_KIND;
+                        } else {
+                            ptr = NULL;
+                            if (!m_is_tlb_warned) {
+                                LOG_WARNING << "Could not get " << map_bytes / NUM_BYTES_ONE_MB
+                                        << " Mb of hugetlbfs pages, check /proc/sys/vm/nr_hugepages, "
+                                        << "falling back to the transparent huge pages!" << END_LOG;
+                                m_is_tlb_warned = true;
+                            }
+                        }
+                    }
+#endif
+#ifdef MADV_HUGEPAGE
+                    if (ptr == NULL) {
+                        //Map one huge page more so that the table can start on the huge page boundary
+                        const size_t map_bytes = round_up(num_bytes, huge_page_size);
+                        void * map_ptr = mmap(NULL, map_bytes + huge_page_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                        if (map_ptr != MAP_FAILED) {
+                            //Un-map the unaligned head and the remaining tail
+                            uint8_t * begin = static_cast<uint8_t *> (map_ptr);
+                            uint8_t * aligned = reinterpret_cast<uint8_t *> (round_up(reinterpret_cast<uintptr_t> (begin), huge_page_size));
+                            if (aligned != begin) {
+                                munmap(begin, aligned - begin);
+                            }
+                            const size_t tail_bytes = huge_page_size - (aligned - begin);
+                            if (tail_bytes != 0) {
+                                munmap(aligned + map_bytes, tail_bytes);
+                            }
+
+                            //Ask for the transparent huge pages, the table is usable even if the advice fails
+                            if (madvise(aligned, map_bytes, MADV_HUGEPAGE) != 0) {
+                                LOG_DEBUG << "The madvise(MADV_HUGEPAGE) call failed, using the regular pages!" << END_LOG;
+                            }
+
+                            ptr = aligned;
+                            block.m_num_bytes = map_bytes;
+                            block.m_kind = THP_ALLOC_KIND;
+                        }
+                    }
+#endif
+                }
+
+                //Fall back to the regular allocation
+                if (ptr == NULL) {
+                    ptr = ::operator new(num_bytes);
+                    memset(ptr, 0, num_bytes);
+                }
+
+                LOG_DEBUG << "Allocated " << block.m_num_bytes << " bytes of kind " << block.m_kind
+                        << " for " << num_elems << " elements" << END_LOG;
+
+                //Register the block
+                m_blocks[ptr] = block;
+                m_num_bytes[block.m_kind] += block.m_num_bytes;
+
+                return ptr;
+            }
+
+            size_t huge_page_allocator::get_num_elems(const void * ptr) {
+                scoped_guard guard(m_lock);
+
+                auto iter = m_blocks.find(const_cast<void *> (ptr));
+                ASSERT_CONDITION_THROW((iter == m_blocks.end()), "The memory block was not allocated by the huge_page_allocator!");
+
+                return iter->second.m_num_elems;
+            }
+
+            void huge_page_allocator::deallocate_bytes(void * ptr) {
+                scoped_guard guard(m_lock);
+
+                auto iter = m_blocks.find(ptr);
+                ASSERT_CONDITION_THROW((iter == m_blocks.end()), "The memory block was not allocated by the huge_page_allocator!");
+
+                const s_block & block = iter->second;
+                if (block.m_kind == NEW_ALLOC_KIND) {
+                    ::operator delete(ptr);
+                } else {
+                    munmap(ptr, block.m_num_bytes);
+                }
+
+                m_num_bytes[block.m_kind] -= block.m_num_bytes;
+                m_blocks.erase(iter);
+            }
+
+            void huge_page_allocator::report_usage() {
+                scoped_guard guard(m_lock);
+
+                const size_t huge_page_size = get_huge_page_size();
+
+                //Report on the tables' memory
+                LOG_USAGE << "Model tables memory: hugetlbfs " << m_num_bytes[TLB_ALLOC_KIND] / NUM_BYTES_ONE_MB
+                        << " Mb, transparent huge pages advised " << m_num_bytes[THP_ALLOC_KIND] / NUM_BYTES_ONE_MB
+                        << " Mb, regular pages " << m_num_bytes[NEW_ALLOC_KIND] / NUM_BYTES_ONE_MB << " Mb" << END_LOG;
+
+                //Report on the huge pages actually used by the process
+                const size_t thp_kb = read_proc_kb_value("/proc/self/smaps_rollup", "AnonHugePages:");
+                const size_t tlb_kb = read_proc_kb_value("/proc/self/smaps_rollup", "Private_Hugetlb:") +
+                        read_proc_kb_value("/proc/self/smaps_rollup", "Shared_Hugetlb:");
+                LOG_USAGE << "Huge pages (" << huge_page_size / 1024 << " Kb) in use: transparent "
+                        << (thp_kb * 1024) / huge_page_size << " (" << thp_kb / 1024 << " Mb), hugetlbfs "
+                        << (tlb_kb * 1024) / huge_page_size << " (" << tlb_kb / 1024 << " Mb)" << END_LOG;
+            }
+        }
+    }
+}
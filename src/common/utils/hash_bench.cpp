@@ -0,0 +1,374 @@
+/*
+ * File:   hash_bench.cpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 2:45 AM
+ */
+
+#include <string>         // std::string
+#include <vector>         // std::vector
+#include <fstream>        // std::ifstream
+#include <sstream>        // std::stringstream
+#include <algorithm>      // std::sort
+#include <unordered_set>  // std::unordered_set
+#include <chrono>         // std::chrono
+#include <iomanip>        // std::setprecision
+
+#include "tclap/CmdLine.h"
+
+#include "main.hpp"
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+#include "common/utils/hashing_utils.hpp"
+
+using namespace std;
+using namespace TCLAP;
+using namespace uva::smt;
+using namespace uva::smt::bpbd::common;
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+using namespace uva::utils::hashing;
+
+/**
+ * This functions does nothing more but printing the program header information
+ */
+static void print_info() {
+    print_info("Hashing Functions Benchmark");
+}
+
+//The pointer to the command line parameters parser
+static CmdLine * p_cmd_args = NULL;
+static ValueArg<string> * p_vocab_arg = NULL;
+static ValueArg<uint32_t> * p_reps_arg = NULL;
+static ValueArg<float> * p_load_arg = NULL;
+static vector<string> debug_levels;
+static ValuesConstraint<string> * p_debug_levels_constr = NULL;
+static ValueArg<string> * p_debug_level_arg = NULL;
+
+//The sink for the benchmarked hash values, prevents the loops from being optimized out
+static volatile uint_fast64_t hash_sink = 0;
+
+/**
+ * This structure stores the benchmark vocabulary, the words are stored in one buffer
+ * @param m_text the words text, one after another
+ * @param m_begins the word begin positions in the text
+ * @param m_lengths the word lengths
+ */
+typedef struct {
+    string m_text;
+    vector<uint32_t> m_begins;
+    vector<uint32_t> m_lengths;
+} s_vocabulary;
+
+/**
+ * Creates and sets up the command line parameters parser
+ */
+void create_arguments_parser() {
+    //Declare the command line arguments parser
+    p_cmd_args = new CmdLine("", ' ', PROGRAM_VERSION_STR);
+
+    //Add the -v the vocabulary file parameter - compulsory
+    p_vocab_arg = new ValueArg<string>("v", "vocabulary", "A back-off language model file in ARPA format, its unigrams are taken, or a text file, its distinct tokens are taken", true, "", "vocabulary file name", *p_cmd_args);
+
+    //Add the -r the number of repetitions parameter - optional
+    p_reps_arg = new ValueArg<uint32_t>("r", "repetitions", "The number of times to hash the vocabulary for the throughput", false, 20, "number of repetitions", *p_cmd_args);
+
+    //Add the -f the hash table load factor parameter - optional
+    p_load_arg = new ValueArg<float>("f", "load-factor", "The hash table load factor for the probe length statistics, in (0, 1)", false, 0.5, "load factor", *p_cmd_args);
+
+    //Add the -d the debug level parameter - optional, default is e.g. USAGE
+    logger::get_reporting_levels(&debug_levels);
+    p_debug_levels_constr = new ValuesConstraint<string>(debug_levels);
+    p_debug_level_arg = new ValueArg<string>("d", "debug", "The debug level to be used", false, USAGE_PARAM_VALUE, p_debug_levels_constr, *p_cmd_args);
+}
+
+/**
+ * Allows to deallocate the parameters parser if it is needed
+ */
+void destroy_arguments_parser() {
+    SAFE_DESTROY(p_vocab_arg);
+    SAFE_DESTROY(p_reps_arg);
+    SAFE_DESTROY(p_load_arg);
+    SAFE_DESTROY(p_debug_levels_constr);
+    SAFE_DESTROY(p_debug_level_arg);
+    SAFE_DESTROY(p_cmd_args);
+}
+
+/**
+ * Allows to read the vocabulary, if the file is an ARPA file then the words
+ * of the unigram section are read, otherwise the distinct tokens of the text
+ * @param file_name the file name
+ * @param vocab [out] the vocabulary to fill in
+ */
+static void read_vocabulary(const string & file_name, s_vocabulary & vocab) {
+    ifstream input(file_name);
+    ASSERT_CONDITION_THROW(!input.is_open(), string("Could not open the vocabulary file: ") + file_name);
+
+    unordered_set<string> words;
+    string line;
+    //Skip the leading empty lines, an ARPA file can start with them
+    while (getline(input, line) && line.empty()) {
+    }
+    if (line.compare(0, 6, "\\data\\") == 0) {
+        LOG_USAGE << "Reading the unigrams of the ARPA file: " << file_name << END_LOG;
+        //Skip to the unigrams section
+        while (getline(input, line) && (line.compare(0, 9, "\\1-grams:") != 0)) {
+        }
+        //Read the unigrams, the word is the second tab separated column
+        while (getline(input, line) && (line.compare(0, 1, "\\") != 0)) {
+            const size_t begin = line.find('\t');
+            if (begin != string::npos) {
+                const size_t end = line.find('\t', begin + 1);
+                words.insert(line.substr(begin + 1, (end == string::npos) ? string::npos : end - begin - 1));
+            }
+        }
+    } else {
+        LOG_USAGE << "Reading the distinct tokens of the text file: " << file_name << END_LOG;
+        do {
+            stringstream tokens(line);
+            string token;
+            while (tokens >> token) {
+                words.insert(token);
+            }
+        } while (getline(input, line));
+    }
+
+    //Put the words into one buffer
+    for (unordered_set<string>::const_iterator iter = words.begin(); iter != words.end(); ++iter) {
+        vocab.m_begins.push_back(vocab.m_text.size());
+        vocab.m_lengths.push_back(iter->size());
+        vocab.m_text += *iter;
+    }
+
+    ASSERT_CONDITION_THROW(vocab.m_begins.empty(), string("No words found in: ") + file_name);
+    LOG_USAGE << "The number of words: " << vocab.m_begins.size() << ", the average word length: "
+            << setprecision(3) << (static_cast<double> (vocab.m_text.size()) / vocab.m_begins.size()) << END_LOG;
+}
+
+/**
+ * Allows to count the collisions among the hash values
+ * @param hashes the hash values, will be sorted
+ * @param mask the mask of the significant hash bits
+ * @return the number of values equal to some previous value
+ */
+static size_t count_collisions(vector<uint_fast64_t> hashes, const uint_fast64_t mask) {
+    for (size_t idx = 0; idx < hashes.size(); ++idx) {
+        hashes[idx] &= mask;
+    }
+    sort(hashes.begin(), hashes.end());
+    size_t num_collisions = 0;
+    for (size_t idx = 1; idx < hashes.size(); ++idx) {
+        if (hashes[idx] == hashes[idx - 1]) {
+            ++num_collisions;
+        }
+    }
+    return num_collisions;
+}
+
+/**
+ * Allows to get the number of nano seconds passed since the given time
+ * @param start the start time
+ * @return the number of nano seconds
+ */
+static inline double get_nano_seconds(const chrono::steady_clock::time_point & start) {
+    return static_cast<double> (chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+}
+
+/**
+ * Allows to benchmark the string hashing policy
+ * @param policy the string hashing policy
+ * @param vocab the vocabulary
+ * @param num_reps the number of repetitions
+ */
+template<typename policy>
+static void bench_string_hash(const s_vocabulary & vocab, const uint32_t num_reps) {
+    const size_t num_words = vocab.m_begins.size();
+    const char * text = vocab.m_text.c_str();
+
+    //Measure the throughput
+    uint_fast64_t sum = 0;
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (uint32_t rep = 0; rep < num_reps; ++rep) {
+        for (size_t idx = 0; idx < num_words; ++idx) {
+            sum += policy::hash(text + vocab.m_begins[idx], vocab.m_lengths[idx]);
+        }
+    }
+    const double nano_secs = get_nano_seconds(start);
+    hash_sink = sum;
+
+    //Compute the quality
+    vector<uint_fast64_t> hashes(num_words);
+    for (size_t idx = 0; idx < num_words; ++idx) {
+        hashes[idx] = policy::hash(text + vocab.m_begins[idx], vocab.m_lengths[idx]);
+    }
+
+    LOG_USAGE << setw(10) << policy::get_name() << ": " << fixed << setprecision(2)
+            << setw(7) << (nano_secs / (num_reps * num_words)) << " ns/word, "
+            << setw(8) << ((1000.0 * num_reps * vocab.m_text.size()) / nano_secs) << " MB/s, collisions 64 bit: "
+            << count_collisions(hashes, UINT64_MAX) << ", lower 32 bit: "
+            << count_collisions(hashes, UINT32_MAX) << END_LOG;
+}
+
+/**
+ * Allows to compute the linear probing statistics for the keys mixed by the
+ * integer hashing policy, in the same way as the fixed size hashmap does
+ * @param policy the integer hashing policy
+ * @param keys the keys to put into the hash table
+ * @param load_factor the hash table load factor
+ * @param avg_probe [out] the average probe length
+ * @param max_probe [out] the maximum probe length
+ */
+template<typename policy>
+static void get_probe_stats(const vector<uint_fast64_t> & keys, const float load_factor,
+        double & avg_probe, size_t & max_probe) {
+    //Compute the power of two capacity
+    size_t capacity = 1;
+    while (capacity * load_factor < keys.size()) {
+        capacity <<= 1;
+    }
+    const uint_fast64_t mask = capacity - 1;
+
+    //Insert the keys with linear probing
+    vector<bool> is_used(capacity, false);
+    size_t total_probe = 0;
+    max_probe = 0;
+    for (size_t idx = 0; idx < keys.size(); ++idx) {
+        uint_fast64_t bucket_idx = policy::mix(keys[idx]) & mask;
+        size_t probe = 1;
+        while (is_used[bucket_idx]) {
+            bucket_idx = (bucket_idx + 1) & mask;
+            ++probe;
+        }
+        is_used[bucket_idx] = true;
+        total_probe += probe;
+        max_probe = max(max_probe, probe);
+    }
+    avg_probe = static_cast<double> (total_probe) / keys.size();
+}
+
+/**
+ * Allows to benchmark the integer hashing policy
+ * @param policy the integer hashing policy
+ * @param word_ids the word ids as computed by the application
+ * @param num_reps the number of repetitions
+ * @param load_factor the hash table load factor
+ */
+template<typename policy>
+static void bench_int_hash(const vector<uint_fast64_t> & word_ids, const uint32_t num_reps, const float load_factor) {
+    const size_t num_keys = word_ids.size();
+
+    //Measure the throughput
+    uint_fast64_t sum = 0;
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (uint32_t rep = 0; rep < num_reps; ++rep) {
+        for (size_t idx = 0; idx < num_keys; ++idx) {
+            sum += policy::mix(word_ids[idx] + rep);
+        }
+    }
+    const double nano_secs = get_nano_seconds(start);
+    hash_sink = sum;
+
+    //The sequential keys, like the array and count based ids, are a harder case
+    vector<uint_fast64_t> seq_ids(num_keys);
+    for (size_t idx = 0; idx < num_keys; ++idx) {
+        seq_ids[idx] = idx;
+    }
+
+    double word_avg = 0.0, seq_avg = 0.0;
+    size_t word_max = 0, seq_max = 0;
+    get_probe_stats<policy>(word_ids, load_factor, word_avg, word_max);
+    get_probe_stats<policy>(seq_ids, load_factor, seq_avg, seq_max);
+
+    LOG_USAGE << setw(10) << policy::get_name() << ": " << fixed << setprecision(2)
+            << setw(7) << (nano_secs / (num_reps * num_keys)) << " ns/key, probe length avg/max word ids: "
+            << word_avg << "/" << word_max << ", sequential ids: " << seq_avg << "/" << seq_max << END_LOG;
+}
+
+/**
+ * The main program entry point
+ */
+int main(int argc, char** argv) {
+    //Declare the return code
+    int returnCode = 0;
+
+    //Set the uncaught exception handler
+    std::set_terminate(handler);
+
+    //First print the program info
+    print_info();
+
+    //Set up possible program arguments
+    create_arguments_parser();
+
+    try {
+        //Parse the arguments
+        try {
+            p_cmd_args->parse(argc, argv);
+        } catch (ArgException &e) {
+            THROW_EXCEPTION(string("Error: ") + e.error() + string(", for argument: ") + e.argId());
+        }
+        logger::set_reporting_level(p_debug_level_arg->getValue());
+
+        const uint32_t num_reps = p_reps_arg->getValue();
+        const float load_factor = p_load_arg->getValue();
+        ASSERT_CONDITION_THROW((num_reps == 0), "The number of repetitions must be positive!");
+        ASSERT_CONDITION_THROW((load_factor <= 0.0) || (load_factor >= 1.0), "The load factor must be in (0, 1)!");
+
+        //Read the vocabulary
+        s_vocabulary vocab;
+        read_vocabulary(p_vocab_arg->getValue(), vocab);
+
+#if defined(__SSE4_2__)
+        LOG_USAGE << "The CRC32C is computed with the SSE4.2 instructions" << END_LOG;
+#else
+        LOG_USAGE << "The CRC32C is computed with the scalar table, compile with -msse4.2 for the SSE4.2 version" << END_LOG;
+#endif
+        LOG_USAGE << "The application is using the '" << str_hash_policy::get_name() << "' string hashing and the '"
+                << int_hash_policy::get_name() << "' integer hashing policies" << END_LOG;
+
+        //Benchmark the string hashing
+        LOG_USAGE << "---------------------- String hashing ----------------------" << END_LOG;
+        bench_string_hash<murmur_str_hash>(vocab, num_reps);
+        bench_string_hash<wyhash_str_hash>(vocab, num_reps);
+        bench_string_hash<crc32c_str_hash>(vocab, num_reps);
+
+        //Benchmark the integer hashing on the word ids of the application
+        vector<uint_fast64_t> word_ids(vocab.m_begins.size());
+        for (size_t idx = 0; idx < word_ids.size(); ++idx) {
+            word_ids[idx] = compute_hash(vocab.m_text.c_str() + vocab.m_begins[idx], vocab.m_lengths[idx]);
+        }
+        LOG_USAGE << "---------------------- Integer hashing, load factor: "
+                << fixed << setprecision(2) << load_factor << " ----------------------" << END_LOG;
+        bench_int_hash<fasthash_int_hash>(word_ids, num_reps, load_factor);
+        bench_int_hash<murmur_int_hash>(word_ids, num_reps, load_factor);
+        bench_int_hash<wyhash_int_hash>(word_ids, num_reps, load_factor);
+    } catch (std::exception & ex) {
+        //The argument's extraction has failed, print the error message and quit
+        LOG_ERROR << ex.what() << END_LOG;
+        returnCode = 1;
+    }
+
+    //Destroy the command line parameters parser
+    destroy_arguments_parser();
+
+    return returnCode;
+}
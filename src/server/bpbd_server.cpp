@@ -51,6 +51,7 @@
 #include "server/lm/lm_configurator.hpp"
 #include "server/tm/tm_configurator.hpp"
 #include "server/rm/rm_configurator.hpp"
+#include "server/server_models.hpp"
 
 using namespace std;
 using namespace TCLAP;
@@ -82,6 +83,7 @@ static ValueArg<string> * p_config_file_arg = NULL;
 static vector<string> debug_levels;
 static ValuesConstraint<string> * p_debug_levels_constr = NULL;
 static ValueArg<string> * p_debug_level_arg = NULL;
+static ValueArg<string> * p_tm_snapshot_arg = NULL;
 #if IS_SERVER_TUNING_MODE
 static SwitchArg * p_gen_fmap_arg = NULL;
 #endif
@@ -101,6 +103,10 @@ void create_arguments_parser() {
     p_debug_levels_constr = new ValuesConstraint<string>(debug_levels);
     p_debug_level_arg = new ValueArg<string>("d", "debug", "The debug level to be used", false, RESULT_PARAM_VALUE, p_debug_levels_constr, *p_cmd_args);
 
+    //Add the -b the translation model snapshot parameter - optional
+    p_tm_snapshot_arg = new ValueArg<string>("b", "binary-tm", string("Only compile the translation model into ") +
+            string("the given binary snapshot file, to be used as tm_conn_string"), false, "", "tm snapshot file name", *p_cmd_args);
+
 #if IS_SERVER_TUNING_MODE
     //Add the translation details switch parameter - ostring(optional, default is false
     p_gen_fmap_arg = new SwitchArg("f", "feature", string("Only generate the feature id to name mapping file for the search lattice") +
@@ -115,6 +121,7 @@ void destroy_arguments_parser() {
     SAFE_DESTROY(p_config_file_arg);
     SAFE_DESTROY(p_debug_levels_constr);
     SAFE_DESTROY(p_debug_level_arg);
+    SAFE_DESTROY(p_tm_snapshot_arg);
 #if IS_SERVER_TUNING_MODE
     SAFE_DESTROY(p_gen_fmap_arg);
 #endif
@@ -191,6 +198,11 @@ static void parse_confiog_file(const string & config_file_name, server_parameter
                 params.m_lm_params.m_num_lambdas,
                 LM_FEATURE_WEIGHTS_DELIMITER_STR);
         params.m_lm_params.m_unk_word_log_e_prob = get_float(ini, section, lm_parameters::LM_UNK_WORD_LOG_E_PROB_PARAM_NAME);
+        params.m_lm_params.m_num_load_threads = get_integer<size_t>(ini, section, lm_parameters::LM_LOAD_THREADS_PARAM_NAME, "1", false);
+        params.m_lm_params.m_query_cache_bits = get_integer<size_t>(ini, section, lm_parameters::LM_QUERY_CACHE_BITS_PARAM_NAME, "0", false);
+        params.m_lm_params.m_huge_pages = huge_page_allocator::get_policy(
+                get_string(ini, section, lm_parameters::LM_HUGE_PAGES_PARAM_NAME, "none", false));
+        params.m_lm_params.m_shm_name = get_string(ini, section, lm_parameters::LM_SHM_NAME_PARAM_NAME, "", false);
 
         section = tm_parameters::TM_CONFIG_SECTION_NAME;
         params.m_tm_params.m_conn_string = get_string(ini, section, tm_parameters::TM_CONN_STRING_PARAM_NAME);
@@ -207,6 +219,16 @@ static void parse_confiog_file(const string & config_file_name, server_parameter
         params.m_tm_params.m_trans_limit = get_integer<size_t>(ini, section, tm_parameters::TM_TRANS_LIM_PARAM_NAME);
         params.m_tm_params.m_min_tran_prob = get_float(ini, section, tm_parameters::TM_MIN_TRANS_PROB_PARAM_NAME);
         params.m_tm_params.m_wp_lambda = get_float(ini, section, tm_parameters::TM_WORD_PENALTY_PARAM_NAME);
+        params.m_tm_params.m_huge_pages = huge_page_allocator::get_policy(
+                get_string(ini, section, tm_parameters::TM_HUGE_PAGES_PARAM_NAME, "none", false));
+        params.m_tm_params.m_num_load_threads = get_integer<size_t>(ini, section, tm_parameters::TM_LOAD_THREADS_PARAM_NAME, "1", false);
+        params.m_tm_params.m_is_streaming_load = get_bool(ini, section, tm_parameters::TM_STREAMING_LOAD_PARAM_NAME, "false", false);
+        params.m_tm_params.m_lazy_cache_size = get_integer<size_t>(ini, section, tm_parameters::TM_LAZY_CACHE_SIZE_PARAM_NAME, "0", false);
+
+        //Filter the LM m-grams by the phrase table target vocabulary, if requested
+        if (get_bool(ini, lm_parameters::LM_CONFIG_SECTION_NAME, lm_parameters::LM_TM_VOCAB_FILTER_PARAM_NAME, "false", false)) {
+            params.m_lm_params.m_vocab_file_name = params.m_tm_params.m_conn_string;
+        }
 
         section = rm_parameters::RM_CONFIG_SECTION_NAME;
         params.m_rm_params.m_conn_string = get_string(ini, section, rm_parameters::RM_CONN_STRING_PARAM_NAME);
@@ -215,6 +237,8 @@ static void parse_confiog_file(const string & config_file_name, server_parameter
                 params.m_rm_params.m_lambdas,
                 params.m_rm_params.m_num_lambdas,
                 RM_FEATURE_WEIGHTS_DELIMITER_STR);
+        params.m_rm_params.m_huge_pages = huge_page_allocator::get_policy(
+                get_string(ini, section, rm_parameters::RM_HUGE_PAGES_PARAM_NAME, "none", false));
 
         section = de_parameters::DE_CONFIG_SECTION_NAME;
         params.m_de_params.m_pruning_threshold = get_float(ini, section, de_parameters::DE_PRUNING_THRESHOLD_PARAM_NAME);
@@ -313,6 +337,9 @@ void connect_to_models(const server_parameters & params) {
  * Allows to disconnect from the models: language, translation, reordering
  */
 void disconnect_from_models() {
+    //Wait until the models reload, if any, is finished
+    server_models::finish_reload();
+
     //Disconnect from the language model
     lm_configurator::disconnect();
 
@@ -351,7 +378,17 @@ int main(int argc, char** argv) {
 
         //Run the server only if we are not requested
         //to only generate the feature to id mapping
-        if (!params.m_is_only_f2id) {
+        if (params.m_is_only_f2id) {
+            LOG_USAGE << "We were only requested to generate the feature to id mapping, exiting!" << END_LOG;
+        } else if (p_tm_snapshot_arg->isSet()) {
+            //The translation model is built against the language model
+            lm_configurator::connect(params.m_lm_params);
+            tm_configurator::connect(params.m_tm_params);
+
+            //Compile the translation model snapshot and exit
+            tm_configurator::write_snapshot(p_tm_snapshot_arg->getValue());
+            LOG_USAGE << "We were only requested to compile the translation model, exiting!" << END_LOG;
+        } else {
             //Initialize connections to the used models
             connect_to_models(params);
 
@@ -366,8 +403,6 @@ int main(int argc, char** argv) {
             //Wait until the server is stopped by pressing and exit button
             server_console cmd(params, server, server_thread);
             cmd.perform_command_loop();
-        } else {
-            LOG_USAGE << "We were only requested to generate the feature to id mapping, exiting!" << END_LOG;
         }
     } catch (std::exception & ex) {
         //The argument's extraction has failed, print the error message and quit
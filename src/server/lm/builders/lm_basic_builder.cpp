@@ -24,6 +24,10 @@
  */
 #include <iostream>
 #include <string>
+#include <cstring>      // std::memchr
+#include <vector>       // std::vector
+#include <thread>       // std::thread
+#include <exception>    // std::exception_ptr
 
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/text/string_utils.hpp"
@@ -56,16 +60,26 @@ namespace uva {
 
                         template<typename TrieType, typename TFileReaderModel>
                         lm_basic_builder<TrieType, TFileReaderModel>::lm_basic_builder(const lm_parameters & params, TrieType & trie, TFileReaderModel & file)
-                        : m_params(params), m_trie(trie), m_file(file), m_line(), m_ng_amount_reg_exp("ngram [[:d:]]+=[[:d:]]+") {
+                        : m_params(params), m_trie(trie), m_file(file), m_line(), m_ng_amount_reg_exp("ngram [[:d:]]+=[[:d:]]+"),
+                        m_is_parallel(false), m_vocab_filter(NULL) {
+                            //Collect the filter vocabulary if the M-grams are to be filtered
+                            if (!m_params.m_vocab_file_name.empty()) {
+                                m_vocab_filter = new lm_vocab_filter(m_params.m_vocab_file_name);
+                            }
                         }
 
                         template<typename TrieType, typename TFileReaderModel>
                         lm_basic_builder<TrieType, TFileReaderModel>::lm_basic_builder(const lm_basic_builder<TrieType, TFileReaderModel>& orig)
-                        : m_params(orig.m_params), m_trie(orig.m_trie), m_file(orig.m_file), m_line(orig.m_line), m_ng_amount_reg_exp("ngram [[:d:]]+=[[:d:]]+") {
+                        : m_params(orig.m_params), m_trie(orig.m_trie), m_file(orig.m_file), m_line(orig.m_line), m_ng_amount_reg_exp("ngram [[:d:]]+=[[:d:]]+"),
+                        m_is_parallel(false), m_vocab_filter(NULL) {
                         }
 
                         template<typename trie_type, typename reader_type>
                         lm_basic_builder<trie_type, reader_type>::~lm_basic_builder() {
+                            if (m_vocab_filter != NULL) {
+                                delete m_vocab_filter;
+                                m_vocab_filter = NULL;
+                            }
                         }
 
                         template<typename TrieType, typename TFileReaderModel>
@@ -206,8 +220,8 @@ namespace uva {
                                     if (m_file.get_first_line(m_line)) {
                                         LOG_DEBUG1 << "Read " << CURR_LEVEL << "-Gram (?) line: '" << m_line.str() << "'" << END_LOG;
 
-                                        //Empty lines will just be skipped
-                                        if (m_line.has_more()) {
+                                        //Empty lines and the filtered out M-grams will just be skipped
+                                        if (m_line.has_more() && ((m_vocab_filter == NULL) || m_vocab_filter->is_kept(m_line))) {
                                             //Pass the given N-gram string to the N-Gram Builder. If the
                                             //N-gram is not matched then stop the loop and move on
                                             if (gram_builder_ptr->parse_line(m_line)) {
@@ -246,6 +260,116 @@ namespace uva {
                             logger::stop_progress_bar();
                         }
 
+                        template<typename TrieType, typename TFileReaderModel>
+                        template<phrase_length CURR_LEVEL, bool is_mult_weight>
+                        void lm_basic_builder<TrieType, TFileReaderModel>::parse_m_gram_chunk(text_piece_reader chunk, exception_ptr & error) {
+                            //Declare the pointer to the N-Grma builder
+                            lm_gram_builder<WordIndexType, CURR_LEVEL, is_mult_weight> *gram_builder_ptr = NULL;
+
+                            try {
+                                lm_gram_builder_factory<TrieType>::template get_concurrent_builder<CURR_LEVEL, is_mult_weight>(m_params, m_trie, &gram_builder_ptr);
+
+                                //Read the chunk N-grams and add them to the trie
+                                text_piece_reader line;
+                                while (chunk.get_first_line(line)) {
+                                    //Empty lines and the filtered out M-grams will just be skipped
+                                    if (line.has_more() && ((m_vocab_filter == NULL) || m_vocab_filter->is_kept(line))) {
+                                        //The chunk is only to contain the N-grams
+                                        ASSERT_CONDITION_THROW(gram_builder_ptr->parse_line(line),
+                                                string("Incorrect ARPA format: Got '") + line.str() +
+                                                string("' inside of the ") + to_string(CURR_LEVEL) +
+                                                string("-grams section!"));
+                                    }
+                                }
+                            } catch (...) {
+                                //Store the exception to be re-thrown from the main thread
+                                error = current_exception();
+                            }
+
+                            //Free the allocated N-gram builder
+                            delete gram_builder_ptr;
+                        }
+
+                        template<typename TrieType, typename TFileReaderModel>
+                        template<phrase_length CURR_LEVEL, bool is_mult_weight>
+                        void lm_basic_builder<TrieType, TFileReaderModel>::read_m_gram_level_parallel() {
+                            //Get the beginning of the section data, right after the section header
+                            const char * const sect_begin = m_file.get_rest_c_str();
+                            const size_t rest_len = m_file.get_rest_len();
+
+                            //Search for the end of the section, that is the first line starting
+                            //with the '\' character, it is either the next section or the end tag
+                            size_t sect_len = 0;
+                            while ((sect_len < rest_len) && (sect_begin[sect_len] != '\\')) {
+                                const char * const nl_ptr = static_cast<const char *> (
+                                        memchr(sect_begin + sect_len, '\n', rest_len - sect_len));
+                                sect_len = (nl_ptr == NULL) ? rest_len : (nl_ptr - sect_begin) + 1;
+                            }
+
+                            LOG_DEBUG << "The " << CURR_LEVEL << "-grams section length is " << sect_len
+                                    << " bytes, splitting it between " << m_params.m_num_load_threads << " threads" << END_LOG;
+
+                            //Split the section into the line aligned chunks, one chunk per thread
+                            const size_t chunk_len = (sect_len / m_params.m_num_load_threads) + 1;
+                            vector<thread> workers;
+                            vector<exception_ptr> errors(m_params.m_num_load_threads);
+                            size_t begin_idx = 0;
+                            while (begin_idx < sect_len) {
+                                //Compute the chunk end, it is right after the end of line
+                                size_t end_idx = min(begin_idx + chunk_len, sect_len);
+                                if (end_idx < sect_len) {
+                                    const char * const nl_ptr = static_cast<const char *> (
+                                            memchr(sect_begin + end_idx, '\n', sect_len - end_idx));
+                                    end_idx = (nl_ptr == NULL) ? sect_len : (nl_ptr - sect_begin) + 1;
+                                }
+
+                                //Start the worker thread for the chunk
+                                workers.push_back(thread(&lm_basic_builder<TrieType, TFileReaderModel>::template parse_m_gram_chunk<CURR_LEVEL, is_mult_weight>,
+                                        this, text_piece_reader(sect_begin + begin_idx, end_idx - begin_idx), ref(errors[workers.size()])));
+
+                                begin_idx = end_idx;
+                            }
+
+                            //Wait until all the chunks are parsed
+                            for (thread & worker : workers) {
+                                worker.join();
+                            }
+
+                            //Re-throw the first of the worker exceptions, if any
+                            for (exception_ptr & error : errors) {
+                                if (error) {
+                                    rethrow_exception(error);
+                                }
+                            }
+
+                            //Skip the parsed section and read the next section header
+                            m_file.skip(sect_len);
+                            if (!m_file.get_first_line(m_line)) {
+                                //If the next line does not exist then it an error as we expect the end of data section any way
+                                stringstream msg;
+                                msg << "Incorrect ARPA format: Unexpected end of file, missing the '" << END_OF_ARPA_FILE << "' tag!";
+                                THROW_EXCEPTION(msg.str());
+                            }
+
+                            LOG_DEBUG << "Finished reading ARPA " << CURR_LEVEL << "-Grams with "
+                                    << workers.size() << " threads." << END_LOG;
+                            //Stop the progress bar in case of no exception
+                            logger::stop_progress_bar();
+                        }
+
+                        template<typename TrieType, typename TFileReaderModel>
+                        bool lm_basic_builder<TrieType, TFileReaderModel>::is_parallel_reading() const {
+                            if (m_params.m_num_load_threads > 1) {
+                                if (m_file.is_in_memory() && m_trie.is_concurrent_add_supported()) {
+                                    return true;
+                                } else {
+                                    LOG_WARNING << "The multi-threaded loading is requested but is not supported by the "
+                                            << "file reader or the trie type, loading with a single thread!" << END_LOG;
+                                }
+                            }
+                            return false;
+                        }
+
                         template<typename TrieType, typename TFileReaderModel>
                         template<phrase_length CURR_LEVEL>
                         void lm_basic_builder<TrieType, TFileReaderModel>::do_post_m_gram_actions() {
@@ -328,10 +452,18 @@ namespace uva {
                                 //Check if we need to multiply with the m-gram weight
                                 if (m_params.m_is_0_lm_weight) {
                                     //Read the M-grams of the given level
-                                    read_m_gram_level<CURR_LEVEL, true>();
+                                    if (m_is_parallel) {
+                                        read_m_gram_level_parallel<CURR_LEVEL, true>();
+                                    } else {
+                                        read_m_gram_level<CURR_LEVEL, true>();
+                                    }
                                 } else {
                                     //Read the M-grams of the given level
-                                    read_m_gram_level<CURR_LEVEL, false>();
+                                    if (m_is_parallel) {
+                                        read_m_gram_level_parallel<CURR_LEVEL, false>();
+                                    } else {
+                                        read_m_gram_level<CURR_LEVEL, false>();
+                                    }
                                 }
 
                                 //If the first M-gram level has been read then do
@@ -433,6 +565,112 @@ namespace uva {
                             read_data(counts);
                         }
 
+                        template<typename TrieType, typename TFileReaderModel>
+                        void lm_basic_builder<TrieType, TFileReaderModel>::count_filtered_m_grams(size_t counts[LM_M_GRAM_LEVEL_MAX]) {
+                            //Check if the M-grams are filtered
+                            if (m_vocab_filter != NULL) {
+                                //Do the progress bard indicator
+                                logger::start_progress_bar(string("Counting filtered M-grams"));
+
+                                //Iterate through the M-gram levels, we are at the 1-grams section header
+                                size_t kept_counts[LM_M_GRAM_LEVEL_MAX] = {};
+                                for (phrase_length level = M_GRAM_LEVEL_1; level <= LM_M_GRAM_LEVEL_MAX; ++level) {
+                                    //Count the level M-grams, if the section is present
+                                    if (m_line == (string("\\") + to_string(level) + string("-grams:"))) {
+                                        while (m_file.get_first_line(m_line)) {
+                                            //Empty lines are skipped, the line starting with '\' ends the section
+                                            if (m_line.has_more()) {
+                                                if (m_line[0] == '\\') {
+                                                    break;
+                                                }
+                                                if (m_vocab_filter->is_kept(m_line)) {
+                                                    ++kept_counts[level - 1];
+                                                }
+                                            }
+
+                                            //Update the progress bar status
+                                            logger::update_progress_bar();
+                                        }
+                                    }
+                                }
+
+                                //Stop the progress bar in case of no exception
+                                logger::stop_progress_bar();
+
+                                LOG_USAGE << "The vocabulary filter keeps " << array_to_string<size_t, LM_M_GRAM_LEVEL_MAX>(kept_counts)
+                                        << " out of " << array_to_string<size_t, LM_M_GRAM_LEVEL_MAX>(counts) << " M-grams" << END_LOG;
+
+                                //Pre-allocate for the kept M-grams only, keep the present levels non-empty
+                                for (phrase_length idx = 0; idx < LM_M_GRAM_LEVEL_MAX; ++idx) {
+                                    counts[idx] = ((counts[idx] != 0) && (kept_counts[idx] == 0)) ? 1 : kept_counts[idx];
+                                }
+
+                                //Rewind to the beginning of the 1-grams section
+                                return_to_grams();
+                            }
+                        }
+
+                        template<typename TrieType, typename TFileReaderModel>
+                        void lm_basic_builder<TrieType, TFileReaderModel>::train_payload_quantizer() {
+                            //Check if the payload quantization is needed
+                            if (m_trie.is_payload_quantized()) {
+                                //Do the progress bard indicator
+                                logger::start_progress_bar(string("Training payload codebooks"));
+
+                                //Typedef the m-gram builder for parsing the lines
+                                typedef lm_gram_builder<WordIndexType, M_GRAM_LEVEL_1, false> gram_builder;
+
+                                //Declare the variables needed to collect the weights
+                                vector<prob_weight> probs, backs;
+                                m_gram_payload payload;
+
+                                //Iterate through the M-gram levels, we are at the 1-grams section header
+                                for (phrase_length level = M_GRAM_LEVEL_1; level <= LM_M_GRAM_LEVEL_MAX; ++level) {
+                                    //Collect the level weights, if the section is present
+                                    if (m_line == (string("\\") + to_string(level) + string("-grams:"))) {
+                                        while (m_file.get_first_line(m_line)) {
+                                            //Empty lines are skipped, the line starting with '\' ends the section
+                                            if (m_line.has_more()) {
+                                                if (m_line[0] == '\\') {
+                                                    break;
+                                                }
+                                                //The filtered out M-grams do not get into the trie
+                                                if ((m_vocab_filter != NULL) && !m_vocab_filter->is_kept(m_line)) {
+                                                    continue;
+                                                }
+                                                text_piece_reader line = m_line;
+                                                ASSERT_CONDITION_THROW(!gram_builder::line_to_log_10_payload(line, payload),
+                                                        string("Incorrect ARPA format: Got '") + m_line.str() + string("' inside of the ") +
+                                                        to_string(level) + string("-grams section!"));
+
+                                                //Convert the weights in the same way as the m-gram builder does, skip the zero probabilities
+                                                if (payload.m_prob > ARPA_ZERO_LOG_10_PROB) {
+                                                    gram_builder::log_10_to_log_e_scale(payload.m_prob);
+                                                    probs.push_back(m_params.m_is_0_lm_weight ? payload.m_prob * m_params.get_0_lm_weight() : payload.m_prob);
+                                                }
+                                                gram_builder::log_10_to_log_e_scale(payload.m_back);
+                                                backs.push_back(m_params.m_is_0_lm_weight ? payload.m_back * m_params.get_0_lm_weight() : payload.m_back);
+                                            }
+
+                                            //Update the progress bar status
+                                            logger::update_progress_bar();
+                                        }
+                                    }
+
+                                    //Train the level codebooks
+                                    m_trie.train_payload_quantizer(level, probs, backs);
+                                    probs.clear();
+                                    backs.clear();
+                                }
+
+                                //Stop the progress bar in case of no exception
+                                logger::stop_progress_bar();
+
+                                //Rewind to the beginning of the 1-grams section
+                                return_to_grams();
+                            }
+                        }
+
                         template<typename TrieType, typename TFileReaderModel>
                         void lm_basic_builder<TrieType, TFileReaderModel>::set_def_unk_word_prob() {
                             //Set the default unk word probability weight
@@ -476,15 +714,24 @@ namespace uva {
                                 //Read the DATA section of ARPA
                                 read_data(counts);
 
+                                //Count the M-grams to keep, if filtered
+                                count_filtered_m_grams(counts);
+
                                 //Pre-allocate memory
                                 pre_allocate(counts);
 
                                 //Get the word counts, if needed
                                 get_word_counts();
 
+                                //Train the payload codebooks, if needed
+                                train_payload_quantizer();
+
                                 //Set the default UNK word data
                                 set_def_unk_word_prob();
 
+                                //Check if the M-grams can be read with multiple threads
+                                m_is_parallel = is_parallel_reading();
+
                                 //Read the N-grams, starting from 1-Grams
                                 read_grams<M_GRAM_LEVEL_1>();
                             } catch (...) {
@@ -513,6 +760,11 @@ namespace uva {
                 template class lm_basic_builder<TC2WArrayTrieOptBasic, TFileReaderModel>; \
                 template class lm_basic_builder<TC2WArrayTrieOptCount, TFileReaderModel>; \
                 template class lm_basic_builder<TC2WArrayTrieHashing, TFileReaderModel>; \
+                template class lm_basic_builder<TC2WPackedTrieBasic, TFileReaderModel>; \
+                template class lm_basic_builder<TC2WPackedTrieCount, TFileReaderModel>; \
+                template class lm_basic_builder<TC2WPackedTrieOptBasic, TFileReaderModel>; \
+                template class lm_basic_builder<TC2WPackedTrieOptCount, TFileReaderModel>; \
+                template class lm_basic_builder<TC2WPackedTrieHashing, TFileReaderModel>; \
                 template class lm_basic_builder<TW2CArrayTrieBasic, TFileReaderModel>; \
                 template class lm_basic_builder<TW2CArrayTrieCount, TFileReaderModel>; \
                 template class lm_basic_builder<TW2CArrayTrieOptBasic, TFileReaderModel>; \
@@ -532,7 +784,22 @@ namespace uva {
                 template class lm_basic_builder<TH2DMapTrieCount, TFileReaderModel>; \
                 template class lm_basic_builder<TH2DMapTrieOptBasic, TFileReaderModel>; \
                 template class lm_basic_builder<TH2DMapTrieOptCount, TFileReaderModel>; \
-                template class lm_basic_builder<TH2DMapTrieHashing, TFileReaderModel>;
+                template class lm_basic_builder<TH2DMapTrieHashing, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_map_trie<basic_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_map_trie<counting_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_map_trie<basic_optimizing_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_map_trie<counting_optimizing_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_map_trie<hashing_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_map_trie<basic_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS, __H2DMapTrie::OTHER_IS_MPH_STORAGE>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_map_trie<counting_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS, __H2DMapTrie::OTHER_IS_MPH_STORAGE>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_map_trie<basic_optimizing_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS, __H2DMapTrie::OTHER_IS_MPH_STORAGE>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_map_trie<counting_optimizing_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS, __H2DMapTrie::OTHER_IS_MPH_STORAGE>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_map_trie<hashing_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS, __H2DMapTrie::OTHER_IS_MPH_STORAGE>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_mph_trie<basic_word_index>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_mph_trie<counting_word_index>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_mph_trie<basic_optimizing_word_index>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_mph_trie<counting_optimizing_word_index>, TFileReaderModel>; \
+                template class lm_basic_builder<h2d_mph_trie<hashing_word_index>, TFileReaderModel>;
 
                         INSTANTIATE_TRIE_BUILDER_FILE_READER(cstyle_file_reader);
                         INSTANTIATE_TRIE_BUILDER_FILE_READER(file_stream_reader);
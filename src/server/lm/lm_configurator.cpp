@@ -32,9 +32,12 @@ namespace uva {
                 namespace lm {
                     //Just give a default initialization
                     const lm_parameters * lm_configurator::m_params = NULL;
+
+                    //Just give a default initialization
+                    lm_parameters lm_configurator::m_shm_params = {};
                     
                     //Just give a default initialization
-                    lm_proxy * lm_configurator::m_model_proxy = NULL;
+                    lm_proxy_ptr lm_configurator::m_model_proxy;
                 }
             }
         }
@@ -38,6 +38,11 @@ namespace uva {
                     };
                     size_t lm_parameters_struct::LM_WEIGHT_GLOBAL_IDS[MAX_NUM_LM_FEATURES] = {};
                     const string lm_parameters_struct::LM_UNK_WORD_LOG_E_PROB_PARAM_NAME = "unk_word_log_e_prob";
+                    const string lm_parameters_struct::LM_LOAD_THREADS_PARAM_NAME = "lm_load_threads";
+                    const string lm_parameters_struct::LM_QUERY_CACHE_BITS_PARAM_NAME = "lm_query_cache_bits";
+                    const string lm_parameters_struct::LM_HUGE_PAGES_PARAM_NAME = "lm_huge_pages";
+                    const string lm_parameters_struct::LM_TM_VOCAB_FILTER_PARAM_NAME = "lm_tm_vocab_filter";
+                    const string lm_parameters_struct::LM_SHM_NAME_PARAM_NAME = "lm_shm_name";
                 }
             }
         }
@@ -68,12 +68,28 @@ static void print_info() {
 static CmdLine * p_cmd_args = NULL;
 static ValueArg<string> * p_model_arg = NULL;
 static ValueArg<string> * p_query_arg = NULL;
+static ValueArg<string> * p_compile_arg = NULL;
 static vector<string> trie_types_vec;
 static vector<string> debug_levels;
 static ValuesConstraint<string> * p_debug_levels_constr = NULL;
 static ValueArg<string> * p_debug_level_arg = NULL;
 static ValueArg<float> * p_lm_lambda = NULL;
 static ValueArg<float> * p_lm_unk_word_log_e_prob = NULL;
+static ValueArg<size_t> * p_lm_load_threads = NULL;
+static SwitchArg * p_quant_report_arg = NULL;
+static SwitchArg * p_fp_report_arg = NULL;
+static vector<string> huge_pages_policies;
+static ValuesConstraint<string> * p_huge_pages_constr = NULL;
+static ValueArg<string> * p_huge_pages_arg = NULL;
+static ValueArg<size_t> * p_query_threads_arg = NULL;
+static vector<string> trie_types;
+static ValuesConstraint<string> * p_trie_types_constr = NULL;
+static ValueArg<string> * p_trie_type_arg = NULL;
+static vector<string> word_index_types;
+static ValuesConstraint<string> * p_word_index_types_constr = NULL;
+static ValueArg<string> * p_word_index_type_arg = NULL;
+static SwitchArg * p_compare_arg = NULL;
+static ValueArg<string> * p_vocab_filter_arg = NULL;
 
 /**
  * Creates and sets up the command line parameters parser
@@ -83,10 +99,13 @@ void create_arguments_parser() {
     p_cmd_args = new CmdLine("", ' ', PROGRAM_VERSION_STR);
 
     //Add the -m the input language model file parameter - compulsory
-    p_model_arg = new ValueArg<string>("m", "model", "A back-off language model file name in ARPA format", true, "", "model file name", *p_cmd_args);
+    p_model_arg = new ValueArg<string>("m", "model", "A back-off language model file name in ARPA format or its binary snapshot", true, "", "model file name", *p_cmd_args);
 
-    //Add the -q the input test queries file parameter - compulsory 
-    p_query_arg = new ValueArg<string>("q", "query", "A text file containing new line separated M-gram queries", true, "", "query file name", *p_cmd_args);
+    //Add the -q the input test queries file parameter - optional if the model is compiled
+    p_query_arg = new ValueArg<string>("q", "query", "A text file containing new line separated M-gram queries", false, "", "query file name", *p_cmd_args);
+
+    //Add the -c the output binary snapshot file parameter - optional
+    p_compile_arg = new ValueArg<string>("c", "compile", "A file name to compile the loaded language model into, as a binary snapshot", false, "", "snapshot file name", *p_cmd_args);
 
     //Add the -d the debug level parameter - optional, default is e.g. RESULT
     logger::get_reporting_levels(&debug_levels);
@@ -98,6 +117,43 @@ void create_arguments_parser() {
 
     //Add the -l the optional LM lambda parameter
     p_lm_unk_word_log_e_prob = new ValueArg<float>("u", "unk", "The Language Model probability for the unknown word in a log_e space", false, -10.0, "lm unk word log_e prob", *p_cmd_args);
+
+    //Add the -p the optional number of model loading threads parameter
+    p_lm_load_threads = new ValueArg<size_t>("p", "load-threads", "The number of threads to parse the ARPA model m-gram sections with", false, 1, "number of loading threads", *p_cmd_args);
+
+    //Add the -x the optional payload quantization report switch
+    p_quant_report_arg = new SwitchArg("x", "quant-report", "Load the ARPA model again with the other payload quantization setting and report the query set perplexity difference", *p_cmd_args, false);
+
+    //Add the -k the optional m-gram id fingerprints report switch
+    p_fp_report_arg = new SwitchArg("k", "fp-report", "Load the ARPA model again with the other m-gram id fingerprint setting and report the query set perplexity difference", *p_cmd_args, false);
+
+    //Add the -g the optional huge pages policy parameter
+    huge_pages_policies.assign(huge_page_allocator::POLICY_NAMES, huge_page_allocator::POLICY_NAMES + size_huge_pages_policy);
+    p_huge_pages_constr = new ValuesConstraint<string>(huge_pages_policies);
+    p_huge_pages_arg = new ValueArg<string>("g", "huge-pages", "The huge pages policy for allocating the model tables", false,
+            huge_page_allocator::POLICY_NAMES[NO_HUGE_PAGES], p_huge_pages_constr, *p_cmd_args);
+
+    //Add the -t the optional number of query threads parameter, for the throughput mode
+    p_query_threads_arg = new ValueArg<size_t>("t", "threads", "The number of threads to execute the queries with in the throughput mode, reports the queries/sec and the latency percentiles instead of the query results", false, 0, "number of query threads", *p_cmd_args);
+
+    //Add the -r the optional trie type parameter
+    trie_types.assign(__executor::TRIE_TYPE_NAMES, __executor::TRIE_TYPE_NAMES + __executor::NUM_TRIE_TYPES);
+    p_trie_types_constr = new ValuesConstraint<string>(trie_types);
+    p_trie_type_arg = new ValueArg<string>("r", "trie", "The trie type to load the ARPA model into", false,
+            __executor::TRIE_TYPE_NAMES[0], p_trie_types_constr, *p_cmd_args);
+
+    //Add the -w the optional word index type parameter
+    word_index_types.push_back(__executor::AUTO_WORD_INDEX_TYPE_NAME);
+    word_index_types.insert(word_index_types.end(), __executor::WORD_INDEX_TYPE_NAMES, __executor::WORD_INDEX_TYPE_NAMES + __executor::NUM_WORD_INDEX_TYPES);
+    p_word_index_types_constr = new ValuesConstraint<string>(word_index_types);
+    p_word_index_type_arg = new ValueArg<string>("w", "word-index", "The word index type to load the ARPA model with, auto for the one recommended for the trie type", false,
+            __executor::AUTO_WORD_INDEX_TYPE_NAME, p_word_index_types_constr, *p_cmd_args);
+
+    //Add the -f the optional phrase table file parameter, for filtering the model m-grams
+    p_vocab_filter_arg = new ValueArg<string>("f", "filter", "A phrase table file, only the ARPA model m-grams consisting of its target words are loaded", false, "", "phrase table file name", *p_cmd_args);
+
+    //Add the -a the optional trie types comparison switch
+    p_compare_arg = new SwitchArg("a", "compare", "Load the ARPA model into all the trie types and report their load time, resident memory and query throughput side by side", *p_cmd_args, false);
 }
 
 /**
@@ -106,6 +162,7 @@ void create_arguments_parser() {
 void destroy_arguments_parser() {
     SAFE_DESTROY(p_model_arg);
     SAFE_DESTROY(p_query_arg);
+    SAFE_DESTROY(p_compile_arg);
 
     SAFE_DESTROY(p_debug_levels_constr);
     SAFE_DESTROY(p_debug_level_arg);
@@ -114,6 +171,24 @@ void destroy_arguments_parser() {
     
     SAFE_DESTROY(p_lm_unk_word_log_e_prob);
 
+    SAFE_DESTROY(p_lm_load_threads);
+
+    SAFE_DESTROY(p_quant_report_arg);
+    SAFE_DESTROY(p_fp_report_arg);
+
+    SAFE_DESTROY(p_huge_pages_constr);
+    SAFE_DESTROY(p_huge_pages_arg);
+
+    SAFE_DESTROY(p_query_threads_arg);
+
+    SAFE_DESTROY(p_trie_types_constr);
+    SAFE_DESTROY(p_trie_type_arg);
+    SAFE_DESTROY(p_word_index_types_constr);
+    SAFE_DESTROY(p_word_index_type_arg);
+    SAFE_DESTROY(p_compare_arg);
+
+    SAFE_DESTROY(p_vocab_filter_arg);
+
     SAFE_DESTROY(p_cmd_args);
 }
 
@@ -136,8 +211,34 @@ static void extract_arguments(const uint argc, char const * const * const argv,
 
     //Store the parsed parameter values
     params.m_query_file_name = p_query_arg->getValue();
+    params.m_snapshot_file_name = p_compile_arg->getValue();
     params.m_lm_params.m_conn_string = p_model_arg->getValue();
 
+    params.m_is_quant_report = p_quant_report_arg->getValue();
+    params.m_is_fp_report = p_fp_report_arg->getValue();
+    params.m_num_query_threads = p_query_threads_arg->getValue();
+    params.m_trie_type = p_trie_type_arg->getValue();
+    params.m_word_index_type = p_word_index_type_arg->getValue();
+    params.m_is_compare = p_compare_arg->getValue();
+
+    //Check that there is something to do
+    ASSERT_CONDITION_THROW(params.m_query_file_name.empty() && params.m_snapshot_file_name.empty(),
+            string("Either the query or the compile file name must be specified!"));
+    ASSERT_CONDITION_THROW(params.m_query_file_name.empty() && params.m_is_quant_report,
+            string("The quantization report requires the query file name to be specified!"));
+    ASSERT_CONDITION_THROW(params.m_query_file_name.empty() && params.m_is_fp_report,
+            string("The fingerprints report requires the query file name to be specified!"));
+
+    //The non default trie and word index types are only used for querying
+    const bool is_default_type = !params.m_is_compare &&
+            (params.m_trie_type == __executor::TRIE_TYPE_NAMES[0]) &&
+            ((params.m_word_index_type == __executor::AUTO_WORD_INDEX_TYPE_NAME) ||
+            (params.m_word_index_type == __executor::WORD_INDEX_TYPE_NAMES[__executor::TRIE_WORD_INDEX_TYPES[0]]));
+    ASSERT_CONDITION_THROW(!is_default_type && (params.m_query_file_name.empty()
+            || !params.m_snapshot_file_name.empty() || params.m_is_quant_report || params.m_is_fp_report),
+            string("The non default trie or word index type as well as the comparison ") +
+            string("require the query file and no snapshot compilation, quantization or fingerprints report!"));
+
     //Get the lambda weight
     params.m_lm_params.m_num_lambdas = 1;
     params.m_lm_params.m_lambdas[0] = p_lm_lambda->getValue();
@@ -145,6 +246,18 @@ static void extract_arguments(const uint argc, char const * const * const argv,
     //Get the unknown word log_e probability
     params.m_lm_params.m_unk_word_log_e_prob = p_lm_unk_word_log_e_prob->getValue();
 
+    //Get the number of model loading threads
+    params.m_lm_params.m_num_load_threads = p_lm_load_threads->getValue();
+
+    //The query cache is only used by the translation server
+    params.m_lm_params.m_query_cache_bits = 0;
+
+    //Get the phrase table file for filtering the model m-grams
+    params.m_lm_params.m_vocab_file_name = p_vocab_filter_arg->getValue();
+
+    //Get the huge pages policy for the model tables
+    params.m_lm_params.m_huge_pages = huge_page_allocator::get_policy(p_huge_pages_arg->getValue());
+
     //Finalize the LM parameters
     params.m_lm_params.finalize();
 }
@@ -0,0 +1,214 @@
+/*
+ * File:   lm_server.cpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 2:25 AM
+ */
+
+#include <string>       // std::string
+
+#include "tclap/CmdLine.h"
+
+#include "main.hpp"
+
+#include "common/utils/logging/logger.hpp"
+#include "common/utils/exceptions.hpp"
+
+#include "server/lm/lm_parameters.hpp"
+#include "server/lm/lm_configurator.hpp"
+#include "server/lm/lm_remote_server.hpp"
+
+using namespace std;
+using namespace TCLAP;
+using namespace uva::smt;
+using namespace uva::smt::bpbd::common;
+using namespace uva::smt::bpbd::server::lm;
+using namespace uva::utils::logging;
+using namespace uva::utils::exceptions;
+
+/**
+ * This functions does nothing more but printing the program header information
+ */
+static void print_info() {
+    print_info("Back Off Language Model Server");
+}
+
+//The pointer to the command line parameters parser
+static CmdLine * p_cmd_args = NULL;
+static ValueArg<string> * p_model_arg = NULL;
+static ValueArg<string> * p_address_arg = NULL;
+static vector<string> debug_levels;
+static ValuesConstraint<string> * p_debug_levels_constr = NULL;
+static ValueArg<string> * p_debug_level_arg = NULL;
+static ValueArg<float> * p_lm_lambda = NULL;
+static ValueArg<float> * p_lm_unk_word_log_e_prob = NULL;
+static ValueArg<size_t> * p_lm_load_threads = NULL;
+static ValueArg<size_t> * p_query_cache_bits = NULL;
+static vector<string> huge_pages_policies;
+static ValuesConstraint<string> * p_huge_pages_constr = NULL;
+static ValueArg<string> * p_huge_pages_arg = NULL;
+static ValueArg<string> * p_shm_name_arg = NULL;
+
+/**
+ * Creates and sets up the command line parameters parser
+ */
+void create_arguments_parser() {
+    //Declare the command line arguments parser
+    p_cmd_args = new CmdLine("", ' ', PROGRAM_VERSION_STR);
+
+    //Add the -m the input language model file parameter - compulsory
+    p_model_arg = new ValueArg<string>("m", "model", "A back-off language model file name in ARPA format or its binary snapshot", true, "", "model file name", *p_cmd_args);
+
+    //Add the -s the server address parameter - compulsory
+    p_address_arg = new ValueArg<string>("s", "socket", "The address to listen on: tcp://[host]:port or unix://path", true, "", "server address", *p_cmd_args);
+
+    //Add the -d the debug level parameter - optional, default is e.g. USAGE
+    logger::get_reporting_levels(&debug_levels);
+    p_debug_levels_constr = new ValuesConstraint<string>(debug_levels);
+    p_debug_level_arg = new ValueArg<string>("d", "debug", "The debug level to be used", false, USAGE_PARAM_VALUE, p_debug_levels_constr, *p_cmd_args);
+
+    //Add the -l the optional LM lambda parameter
+    p_lm_lambda = new ValueArg<float>("l", "lambda", "The Language Model probability lambda weight, must be the lm_feature_weights of the translation servers", false, 1.0, "lm lambda weight", *p_cmd_args);
+
+    //Add the -u the optional unknown word probability parameter
+    p_lm_unk_word_log_e_prob = new ValueArg<float>("u", "unk", "The Language Model probability for the unknown word in a log_e space, must be the unk_word_log_e_prob of the translation servers", false, -10.0, "lm unk word log_e prob", *p_cmd_args);
+
+    //Add the -p the optional number of model loading threads parameter
+    p_lm_load_threads = new ValueArg<size_t>("p", "load-threads", "The number of threads to parse the ARPA model m-gram sections with", false, 1, "number of loading threads", *p_cmd_args);
+
+    //Add the -b the optional query cache size bits parameter
+    p_query_cache_bits = new ValueArg<size_t>("b", "cache-bits", "The number of bits of the per connection query cache size, 0 for no cache", false, 0, "query cache bits", *p_cmd_args);
+
+    //Add the -g the optional huge pages policy parameter
+    huge_pages_policies.assign(huge_page_allocator::POLICY_NAMES, huge_page_allocator::POLICY_NAMES + size_huge_pages_policy);
+    p_huge_pages_constr = new ValuesConstraint<string>(huge_pages_policies);
+    p_huge_pages_arg = new ValueArg<string>("g", "huge-pages", "The huge pages policy for allocating the model tables", false,
+            huge_page_allocator::POLICY_NAMES[NO_HUGE_PAGES], p_huge_pages_constr, *p_cmd_args);
+
+    //Add the -n the optional shared memory segment name parameter
+    p_shm_name_arg = new ValueArg<string>("n", "shm-name", "The name of the shared memory segment to build the model in or to attach it from", false, "", "segment name", *p_cmd_args);
+}
+
+/**
+ * Allows to deallocate the parameters parser if it is needed
+ */
+void destroy_arguments_parser() {
+    SAFE_DESTROY(p_model_arg);
+    SAFE_DESTROY(p_address_arg);
+
+    SAFE_DESTROY(p_debug_levels_constr);
+    SAFE_DESTROY(p_debug_level_arg);
+
+    SAFE_DESTROY(p_lm_lambda);
+    SAFE_DESTROY(p_lm_unk_word_log_e_prob);
+    SAFE_DESTROY(p_lm_load_threads);
+    SAFE_DESTROY(p_query_cache_bits);
+
+    SAFE_DESTROY(p_huge_pages_constr);
+    SAFE_DESTROY(p_huge_pages_arg);
+
+    SAFE_DESTROY(p_shm_name_arg);
+
+    SAFE_DESTROY(p_cmd_args);
+}
+
+/**
+ * This function tries to extract the program arguments
+ * @param argc the number of program arguments
+ * @param argv the array of program arguments
+ * @param params the structure that will be filled in with the parsed program arguments
+ * @param address [out] the address to listen on
+ */
+static void extract_arguments(const uint argc, char const * const * const argv, lm_parameters & params, string & address) {
+    //Parse the arguments
+    try {
+        p_cmd_args->parse(argc, argv);
+    } catch (ArgException &e) {
+        THROW_EXCEPTION(string("Error: ") + e.error() + string(", for argument: ") + e.argId());
+    }
+
+    //Set the logging level right away
+    logger::set_reporting_level(p_debug_level_arg->getValue());
+
+    //Store the parsed parameter values
+    address = p_address_arg->getValue();
+    ASSERT_CONDITION_THROW(!__lm_remote::is_remote(address), string("Invalid LM server address: '")
+            + address + string("', expected tcp://[host]:port or unix://path"));
+
+    params.m_conn_string = p_model_arg->getValue();
+    ASSERT_CONDITION_THROW(__lm_remote::is_remote(params.m_conn_string),
+            "The LM server can not serve a remote language model!");
+
+    params.m_num_lambdas = 1;
+    params.m_lambdas[0] = p_lm_lambda->getValue();
+    params.m_unk_word_log_e_prob = p_lm_unk_word_log_e_prob->getValue();
+    params.m_num_load_threads = p_lm_load_threads->getValue();
+    params.m_query_cache_bits = p_query_cache_bits->getValue();
+    params.m_huge_pages = huge_page_allocator::get_policy(p_huge_pages_arg->getValue());
+    params.m_shm_name = p_shm_name_arg->getValue();
+
+    //Finalize the LM parameters
+    params.finalize();
+}
+
+/**
+ * The main program entry point
+ */
+int main(int argc, char** argv) {
+    //Declare the return code
+    int returnCode = 0;
+
+    //Set the uncaught exception handler
+    std::set_terminate(handler);
+
+    //First print the program info
+    print_info();
+
+    //Set up possible program arguments
+    create_arguments_parser();
+
+    try {
+        //Define en empty parameters structure
+        lm_parameters params = {};
+        string address;
+
+        LOG_INFO << "Checking on the program arguments ..." << END_LOG;
+
+        //Attempt to extract the program arguments
+        extract_arguments(argc, argv, params, address);
+
+        LOG_INFO << params << END_LOG;
+
+        //Load the model and serve it, until the process is terminated
+        lm_configurator::connect(params);
+        lm_remote_server server(params, address);
+        server.run();
+    } catch (std::exception & ex) {
+        //The argument's extraction has failed, print the error message and quit
+        LOG_ERROR << ex.what() << END_LOG;
+        returnCode = 1;
+    }
+
+    //Destroy the command line parameters parser
+    destroy_arguments_parser();
+
+    return returnCode;
+}
@@ -30,6 +30,7 @@
 
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/text/string_utils.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
 
 #include "server/lm/dictionaries/basic_word_index.hpp"
 #include "server/lm/dictionaries/counting_word_index.hpp"
@@ -37,6 +38,7 @@
 
 using namespace uva::smt::bpbd::server::lm::dictionary;
 using namespace uva::utils::text;
+using namespace uva::utils::containers;
 
 namespace uva {
     namespace smt {
@@ -48,7 +50,7 @@ namespace uva {
                     c2d_hybrid_trie<WordIndexType>::c2d_hybrid_trie(WordIndexType & word_index,
                             const float mram_mem_factor,
                             const float ngram_mem_factor)
-                    : layered_trie_base<c2d_hybrid_trie<WordIndexType>, WordIndexType, __C2DHybridTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR>(word_index),
+                    : layered_trie_base<c2d_hybrid_trie<WordIndexType>, WordIndexType, __C2DHybridTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, __C2DHybridTrie::PAYLOAD_QUANT_BITS>(word_index),
                     m_unk_data(NULL), m_mgram_mem_factor(mram_mem_factor), m_ngram_mem_factor(ngram_mem_factor), m_1_gram_data(NULL) {
 
                         //Perform an error check! This container has bounds on the supported trie level
@@ -59,7 +61,7 @@ namespace uva {
                         //Memset the M grams reference and data arrays
                         memset(m_m_gram_alloc_ptrs, 0, BASE::NUM_M_GRAM_LEVELS * sizeof (TMGramAllocator *));
                         memset(m_m_gram_map_ptrs, 0, BASE::NUM_M_GRAM_LEVELS * sizeof (TMGramsMap *));
-                        memset(m_m_gram_data, 0, BASE::NUM_M_GRAM_LEVELS * sizeof (m_gram_payload *));
+                        memset(m_m_gram_data, 0, BASE::NUM_M_GRAM_LEVELS * sizeof (TMGramPayload *));
 
                         //Initialize the array of counters
                         memset(m_M_gram_num_ctx_ids, 0, BASE::NUM_M_GRAM_LEVELS * sizeof (TShortId));
@@ -76,8 +78,7 @@ namespace uva {
                         const size_t num_word_ids = BASE::get_word_index().get_number_of_words(counts[0]);
 
                         //Pre-allocate the 1-Gram data
-                        m_1_gram_data = new m_gram_payload[num_word_ids];
-                        memset(m_1_gram_data, 0, num_word_ids * sizeof (m_gram_payload));
+                        m_1_gram_data = huge_page_allocator::allocate<m_gram_payload>(num_word_ids);
                     }
 
                     template<typename WordIndexType>
@@ -103,8 +104,7 @@ namespace uva {
                             //Get the number of M-gram indexes on this level
                             const uint num_ngram_idx = m_M_gram_num_ctx_ids[idx];
 
-                            m_m_gram_data[idx] = new m_gram_payload[num_ngram_idx];
-                            memset(m_m_gram_data[idx], 0, num_ngram_idx * sizeof (m_gram_payload));
+                            m_m_gram_data[idx] = huge_page_allocator::allocate<TMGramPayload>(num_ngram_idx);
                         }
                     }
 
@@ -146,13 +146,13 @@ namespace uva {
                     c2d_hybrid_trie<WordIndexType>::~c2d_hybrid_trie() {
                         //Deallocate One-Grams
                         if (m_1_gram_data != NULL) {
-                            delete[] m_1_gram_data;
+                            huge_page_allocator::deallocate(m_1_gram_data);
                         }
 
                         //Deallocate M-Grams there are N-2 M-gram levels in the array
                         for (int idx = 0; idx < BASE::NUM_M_GRAM_LEVELS; idx++) {
                             deallocate_container<TMGramsMap, TMGramAllocator>(&m_m_gram_map_ptrs[idx], &m_m_gram_alloc_ptrs[idx]);
-                            delete[] m_m_gram_data[idx];
+                            huge_page_allocator::deallocate(m_m_gram_data[idx]);
                         }
 
                         //Deallocate N-Grams
@@ -49,7 +49,7 @@ namespace uva {
                             WordIndexType & word_index,
                             const float mgram_mem_factor,
                             const float ngram_mem_factor)
-                    : layered_trie_base<c2d_map_trie<WordIndexType>, WordIndexType, __C2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR>(word_index),
+                    : layered_trie_base<c2d_map_trie<WordIndexType>, WordIndexType, __C2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, __C2DMapTrie::PAYLOAD_QUANT_BITS>(word_index),
                     m_unk_data(NULL), m_mgram_mem_factor(mgram_mem_factor), m_ngram_mem_factor(ngram_mem_factor), m_1_gram_data(NULL) {
 
                         //Perform an error check! This container has bounds on the supported trie level
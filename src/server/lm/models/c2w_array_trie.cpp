@@ -29,11 +29,13 @@
 #include "server/lm/lm_consts.hpp"
 #include "common/utils/logging/logger.hpp"
 #include "common/utils/exceptions.hpp"
+#include "common/utils/containers/huge_page_allocator.hpp"
 
 #include "server/lm/dictionaries/basic_word_index.hpp"
 #include "server/lm/dictionaries/counting_word_index.hpp"
 #include "server/lm/dictionaries/optimizing_word_index.hpp"
 
+using namespace uva::utils::containers;
 using namespace uva::smt::bpbd::server::lm::dictionary;
 
 namespace uva {
@@ -42,9 +44,9 @@ namespace uva {
             namespace server {
                 namespace lm {
 
-                    template<typename WordIndexType>
-                    c2w_array_trie<WordIndexType>::c2w_array_trie(WordIndexType & word_index)
-                    : layered_trie_base<c2w_array_trie<WordIndexType>, WordIndexType, __C2WArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR>(word_index),
+                    template<typename WordIndexType, bool IS_BIT_PACKED>
+                    c2w_array_trie<WordIndexType, IS_BIT_PACKED>::c2w_array_trie(WordIndexType & word_index)
+                    : layered_trie_base<c2w_array_trie<WordIndexType, IS_BIT_PACKED>, WordIndexType, __C2WArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR>(word_index),
                     m_unk_data(NULL), m_1_gram_data(NULL), m_n_gram_data(NULL), m_one_gram_arr_size(0) {
 
                         //Perform an error check! This container has bounds on the supported trie level
@@ -61,8 +63,8 @@ namespace uva {
                         memset(m_m_n_gram_next_ctx_id, 0, BASE::NUM_M_N_GRAM_LEVELS * sizeof (TShortId));
                     }
 
-                    template<typename WordIndexType>
-                    void c2w_array_trie<WordIndexType>::pre_allocate(const size_t counts[LM_M_GRAM_LEVEL_MAX]) {
+                    template<typename WordIndexType, bool IS_BIT_PACKED>
+                    void c2w_array_trie<WordIndexType, IS_BIT_PACKED>::pre_allocate(const size_t counts[LM_M_GRAM_LEVEL_MAX]) {
                         //01) Pre-allocate the word index super class call
                         BASE::pre_allocate(counts);
 
@@ -80,8 +82,7 @@ namespace uva {
                         //of 1-Grams is since we want to account for the word indexes that start
                         //from 2, as 0 is given to UNDEFINED and 1 to UNKNOWN (<unk>)
                         m_one_gram_arr_size = BASE::get_word_index().get_number_of_words(counts[0]);
-                        m_1_gram_data = new m_gram_payload[m_one_gram_arr_size];
-                        memset(m_1_gram_data, 0, m_one_gram_arr_size * sizeof (m_gram_payload));
+                        m_1_gram_data = huge_page_allocator::allocate<m_gram_payload>(m_one_gram_arr_size);
 
                         //04) Allocate data for the M-grams
 
@@ -89,49 +90,44 @@ namespace uva {
                         //The number of contexts is the number of words in previous level 1 i.e. counts[0]
                         //Yet we know that the word index begins with 2, due to UNDEFINED and UNKNOWN word ids
                         //Therefore for the 2-gram level contexts array we add two more elements, just to simplify computations
-                        m_m_gram_ctx_2_data[0] = new TSubArrReference[m_one_gram_arr_size];
-                        memset(m_m_gram_ctx_2_data[0], 0, m_one_gram_arr_size * sizeof (TSubArrReference));
+                        m_m_gram_ctx_2_data[0] = huge_page_allocator::allocate<TSubArrReference>(m_one_gram_arr_size);
 
                         //Now also allocate the data for the 2-Grams, the number of 2-grams is m_MN_gram_size[0] 
-                        m_m_gram_data[0] = new TWordIdPBEntry[m_m_n_gram_num_ctx_ids[0]];
-                        memset(m_m_gram_data[0], 0, m_m_n_gram_num_ctx_ids[0] * sizeof (TWordIdPBEntry));
+                        m_m_gram_data[0] = huge_page_allocator::allocate<TWordIdPBEntry>(m_m_n_gram_num_ctx_ids[0]);
 
                         //Now the remaining elements can be added in a loop
                         for (phrase_length i = 1; i < BASE::NUM_M_GRAM_LEVELS; i++) {
                             //Here i is the index of the array, the corresponding M-gram
                             //level M = i + 2. The m_MN_gram_size[i-1] stores the number of elements
                             //on the previous level - the maximum number of possible contexts.
-                            m_m_gram_ctx_2_data[i] = new TSubArrReference[m_m_n_gram_num_ctx_ids[i - 1]];
-                            memset(m_m_gram_ctx_2_data[i], 0, m_m_n_gram_num_ctx_ids[i - 1] * sizeof (TSubArrReference));
+                            m_m_gram_ctx_2_data[i] = huge_page_allocator::allocate<TSubArrReference>(m_m_n_gram_num_ctx_ids[i - 1]);
                             //The m_MN_gram_size[i] stores the number of elements
                             //on the current level - the number of M-Grams.
-                            m_m_gram_data[i] = new TWordIdPBEntry[m_m_n_gram_num_ctx_ids[i]];
-                            memset(m_m_gram_data[i], 0, m_m_n_gram_num_ctx_ids[i] * sizeof (TWordIdPBEntry));
+                            m_m_gram_data[i] = huge_page_allocator::allocate<TWordIdPBEntry>(m_m_n_gram_num_ctx_ids[i]);
                         }
 
                         //05) Allocate the data for the M-Grams.
-                        m_n_gram_data = new TCtxIdProbEntry[m_m_n_gram_num_ctx_ids[BASE::N_GRAM_IDX_IN_M_N_ARR]];
-                        memset(m_n_gram_data, 0, m_m_n_gram_num_ctx_ids[BASE::N_GRAM_IDX_IN_M_N_ARR] * sizeof (TCtxIdProbEntry));
+                        m_n_gram_data = huge_page_allocator::allocate<TCtxIdProbEntry>(m_m_n_gram_num_ctx_ids[BASE::N_GRAM_IDX_IN_M_N_ARR]);
                     }
 
-                    template<typename WordIndexType>
-                    void c2w_array_trie<WordIndexType>::set_def_unk_word_prob(const prob_weight prob) {
+                    template<typename WordIndexType, bool IS_BIT_PACKED>
+                    void c2w_array_trie<WordIndexType, IS_BIT_PACKED>::set_def_unk_word_prob(const prob_weight prob) {
                         //Insert the unknown word data into the allocated array
                         m_unk_data = &m_1_gram_data[UNKNOWN_WORD_ID];
                         m_unk_data->m_prob = prob;
                         m_unk_data->m_back = 0.0;
                     }
 
-                    template<typename WordIndexType>
-                    c2w_array_trie<WordIndexType>::~c2w_array_trie() {
+                    template<typename WordIndexType, bool IS_BIT_PACKED>
+                    c2w_array_trie<WordIndexType, IS_BIT_PACKED>::~c2w_array_trie() {
                         //Check that the one grams were allocated, if yes then the rest must have been either
                         if (m_1_gram_data != NULL) {
-                            delete[] m_1_gram_data;
+                            huge_page_allocator::deallocate(m_1_gram_data);
                             for (phrase_length i = 0; i < BASE::NUM_M_GRAM_LEVELS; i++) {
-                                delete[] m_m_gram_ctx_2_data[i];
-                                delete[] m_m_gram_data[i];
+                                huge_page_allocator::deallocate(m_m_gram_ctx_2_data[i]);
+                                huge_page_allocator::deallocate(m_m_gram_data[i]);
                             }
-                            delete[] m_n_gram_data;
+                            huge_page_allocator::deallocate(m_n_gram_data);
                         }
                     }
 
@@ -141,6 +137,13 @@ namespace uva {
                     INSTANTIATE_LAYERED_TRIE_TEMPLATES_NAME_TYPE(c2w_array_trie, hashing_word_index);
                     INSTANTIATE_LAYERED_TRIE_TEMPLATES_NAME_TYPE(c2w_array_trie, basic_optimizing_word_index);
                     INSTANTIATE_LAYERED_TRIE_TEMPLATES_NAME_TYPE(c2w_array_trie, counting_optimizing_word_index);
+
+                    //Instantiate the bit packed variants
+                    INSTANTIATE_LAYERED_TRIE_TEMPLATES_NAME_TYPE(c2w_array_trie, basic_word_index, true);
+                    INSTANTIATE_LAYERED_TRIE_TEMPLATES_NAME_TYPE(c2w_array_trie, counting_word_index, true);
+                    INSTANTIATE_LAYERED_TRIE_TEMPLATES_NAME_TYPE(c2w_array_trie, hashing_word_index, true);
+                    INSTANTIATE_LAYERED_TRIE_TEMPLATES_NAME_TYPE(c2w_array_trie, basic_optimizing_word_index, true);
+                    INSTANTIATE_LAYERED_TRIE_TEMPLATES_NAME_TYPE(c2w_array_trie, counting_optimizing_word_index, true);
                 }
             }
         }
@@ -44,48 +44,99 @@ namespace uva {
             namespace server {
                 namespace lm {
 
-                    template<typename WordIndexType>
-                    h2d_map_trie<WordIndexType>::h2d_map_trie(WordIndexType & word_index)
-                    : generic_trie_base<h2d_map_trie<WordIndexType>, WordIndexType, __H2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR>(word_index),
+                    template<typename WordIndexType, uint8_t PAYLOAD_QUANT_BITS, uint8_t FINGERPRINT_BITS, bool IS_MPH_STORAGE>
+                    h2d_map_trie<WordIndexType, PAYLOAD_QUANT_BITS, FINGERPRINT_BITS, IS_MPH_STORAGE>::h2d_map_trie(WordIndexType & word_index)
+                    : generic_trie_base<h2d_map_trie<WordIndexType, PAYLOAD_QUANT_BITS, FINGERPRINT_BITS, IS_MPH_STORAGE>, WordIndexType, __H2DMapTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, PAYLOAD_QUANT_BITS>(word_index),
                     m_n_gram_data(NULL) {
                         //Perform an error check! This container has bounds on the supported trie level
                         ASSERT_CONDITION_THROW((LM_M_GRAM_LEVEL_MAX > M_GRAM_LEVEL_6), string("The maximum supported trie level is") + std::to_string(M_GRAM_LEVEL_6));
                         ASSERT_CONDITION_THROW((word_index.is_word_index_continuous()), "This trie can not be used with a continuous word index!");
                         ASSERT_CONDITION_THROW((sizeof (uint32_t) != sizeof (word_uid)) && (sizeof (uint64_t) != sizeof (word_uid)),
                                 string("Only works with a 32 or 64 bit word_uid!"));
+                        ASSERT_CONDITION_THROW(IS_MPH_STORAGE && (FINGERPRINT_BITS == 0),
+                                "The minimal perfect hash storage requires the m-gram id fingerprints!");
 
                         //Clear the M-Gram bucket arrays
                         memset(m_m_gram_data, 0, NUM_M_GRAM_LEVELS * sizeof (TProbBackMap*));
 
-                        LOG_DEBUG << "sizeof(T_M_Gram_PB_Entry)= " << sizeof (T_M_Gram_PB_Entry) << END_LOG;
-                        LOG_DEBUG << "sizeof(T_M_Gram_Prob_Entry)= " << sizeof (T_M_Gram_Prob_Entry) << END_LOG;
+                        LOG_DEBUG << "sizeof(TProbBackMap::TElemType)= " << sizeof (typename TProbBackMap::TElemType) << END_LOG;
+                        LOG_DEBUG << "sizeof(TProbMap::TElemType)= " << sizeof (typename TProbMap::TElemType) << END_LOG;
                         LOG_DEBUG << "sizeof(TProbBackMap)= " << sizeof (TProbBackMap) << END_LOG;
                         LOG_DEBUG << "sizeof(TProbBackMap)= " << sizeof (TProbMap) << END_LOG;
                     };
 
-                    template<typename WordIndexType>
-                    void h2d_map_trie<WordIndexType>::pre_allocate(const size_t counts[LM_M_GRAM_LEVEL_MAX]) {
+                    template<typename WordIndexType, uint8_t PAYLOAD_QUANT_BITS, uint8_t FINGERPRINT_BITS, bool IS_MPH_STORAGE>
+                    void h2d_map_trie<WordIndexType, PAYLOAD_QUANT_BITS, FINGERPRINT_BITS, IS_MPH_STORAGE>::pre_allocate(const size_t counts[LM_M_GRAM_LEVEL_MAX]) {
                         //Call the base-class
                         BASE::pre_allocate(counts);
 
                         //Initialize the m-gram maps
                         for (phrase_length idx = 0; idx < NUM_M_GRAM_LEVELS; idx++) {
-                            m_m_gram_data[idx] = new TProbBackMap(__H2DMapTrie::BUCKETS_FACTOR, counts[idx]);
+                            m_m_gram_data[idx] = new TProbBackMap(get_buckets_factor(), counts[idx]);
                         }
 
                         //Initialize the n-gram's map
-                        m_n_gram_data = new TProbMap(__H2DMapTrie::BUCKETS_FACTOR, counts[LM_M_GRAM_LEVEL_MAX - 1]);
+                        m_n_gram_data = new TProbMap(get_buckets_factor(), counts[LM_M_GRAM_LEVEL_MAX - 1]);
                     };
 
-                    template<typename WordIndexType>
-                    void h2d_map_trie<WordIndexType>::set_def_unk_word_prob(const prob_weight prob) {
+                    template<typename WordIndexType, uint8_t PAYLOAD_QUANT_BITS, uint8_t FINGERPRINT_BITS, bool IS_MPH_STORAGE>
+                    void h2d_map_trie<WordIndexType, PAYLOAD_QUANT_BITS, FINGERPRINT_BITS, IS_MPH_STORAGE>::write_snapshot(binary_file_writer & writer) const {
+                        //The word index must be stateless, otherwise we would need to store it as well
+                        ASSERT_CONDITION_THROW(this->get_word_index().is_word_registering_needed(),
+                                "The binary snapshot is only supported with the hashing word index!");
+
+                        //Write the unknown word payload
+                        writer.write(m_unk_data);
+
+                        //Write the bitmap hash caches if any
+                        BASE::write_bitmap_hash_caches(writer);
+
+                        //Write the payload codebooks if any
+                        this->m_quantizer.write(writer);
+
+                        //Write the m-gram maps
+                        for (phrase_length idx = 0; idx < NUM_M_GRAM_LEVELS; idx++) {
+                            m_m_gram_data[idx]->write(writer);
+                        }
+
+                        //Write the n-gram map
+                        m_n_gram_data->write(writer);
+                    }
+
+                    template<typename WordIndexType, uint8_t PAYLOAD_QUANT_BITS, uint8_t FINGERPRINT_BITS, bool IS_MPH_STORAGE>
+                    void h2d_map_trie<WordIndexType, PAYLOAD_QUANT_BITS, FINGERPRINT_BITS, IS_MPH_STORAGE>::attach_snapshot(binary_mmap_reader & reader) {
+                        //The word index must be stateless, otherwise we would need to restore it as well
+                        ASSERT_CONDITION_THROW(this->get_word_index().is_word_registering_needed(),
+                                "The binary snapshot is only supported with the hashing word index!");
+                        ASSERT_SANITY_THROW((m_n_gram_data != NULL), "The trie data is already allocated!");
+
+                        //Read the unknown word payload
+                        reader.read(m_unk_data);
+
+                        //Attach the bitmap hash caches if any
+                        BASE::attach_bitmap_hash_caches(reader);
+
+                        //Attach the payload codebooks if any
+                        this->m_quantizer.attach(reader);
+
+                        //Attach the m-gram maps
+                        for (phrase_length idx = 0; idx < NUM_M_GRAM_LEVELS; idx++) {
+                            m_m_gram_data[idx] = new TProbBackMap(reader);
+                        }
+
+                        //Attach the n-gram map
+                        m_n_gram_data = new TProbMap(reader);
+                    }
+
+                    template<typename WordIndexType, uint8_t PAYLOAD_QUANT_BITS, uint8_t FINGERPRINT_BITS, bool IS_MPH_STORAGE>
+                    void h2d_map_trie<WordIndexType, PAYLOAD_QUANT_BITS, FINGERPRINT_BITS, IS_MPH_STORAGE>::set_def_unk_word_prob(const prob_weight prob) {
                         //Default initialize the unknown word payload data
                         m_unk_data.m_prob = prob;
                         m_unk_data.m_back = 0.0;
                     }
 
-                    template<typename WordIndexType>
-                    h2d_map_trie<WordIndexType>::~h2d_map_trie() {
+                    template<typename WordIndexType, uint8_t PAYLOAD_QUANT_BITS, uint8_t FINGERPRINT_BITS, bool IS_MPH_STORAGE>
+                    h2d_map_trie<WordIndexType, PAYLOAD_QUANT_BITS, FINGERPRINT_BITS, IS_MPH_STORAGE>::~h2d_map_trie() {
                         //De-allocate M-Grams
                         for (phrase_length idx = 0; idx < NUM_M_GRAM_LEVELS; idx++) {
                             delete m_m_gram_data[idx];
@@ -99,6 +150,27 @@ namespace uva {
                     INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, hashing_word_index);
                     INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, basic_optimizing_word_index);
                     INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, counting_optimizing_word_index);
+
+                    //Instantiate the other payload quantization variant, it is used for comparison
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, basic_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, counting_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, hashing_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, basic_optimizing_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, counting_optimizing_word_index, __H2DMapTrie::OTHER_PAYLOAD_QUANT_BITS);
+
+                    //Instantiate the other m-gram id fingerprint variant, it is used for comparison
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, basic_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS, __H2DMapTrie::OTHER_IS_MPH_STORAGE);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, counting_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS, __H2DMapTrie::OTHER_IS_MPH_STORAGE);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, hashing_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS, __H2DMapTrie::OTHER_IS_MPH_STORAGE);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, basic_optimizing_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS, __H2DMapTrie::OTHER_IS_MPH_STORAGE);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, counting_optimizing_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::OTHER_FINGERPRINT_BITS, __H2DMapTrie::OTHER_IS_MPH_STORAGE);
+
+                    //Instantiate the minimal perfect hashing variant, it is selectable in lm-query
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, basic_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::MPH_FINGERPRINT_BITS, true);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, counting_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::MPH_FINGERPRINT_BITS, true);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, hashing_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::MPH_FINGERPRINT_BITS, true);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, basic_optimizing_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::MPH_FINGERPRINT_BITS, true);
+                    INSTANTIATE_TRIE_TEMPLATE_TYPE(h2d_map_trie, counting_optimizing_word_index, __H2DMapTrie::PAYLOAD_QUANT_BITS, __H2DMapTrie::MPH_FINGERPRINT_BITS, true);
                 }
             }
         }
@@ -46,7 +46,7 @@ namespace uva {
 
                     template<typename WordIndexType>
                     w2c_array_trie<WordIndexType>::w2c_array_trie(WordIndexType & word_index)
-                    : layered_trie_base<w2c_array_trie<WordIndexType>, WordIndexType, __W2CArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR>(word_index),
+                    : layered_trie_base<w2c_array_trie<WordIndexType>, WordIndexType, __W2CArrayTrie::BITMAP_HASH_CACHE_BUCKETS_FACTOR, __W2CArrayTrie::PAYLOAD_QUANT_BITS>(word_index),
                     m_unk_data(NULL), m_num_word_ids(0), m_1_gram_data(NULL), m_n_gram_word_2_data(NULL) {
                         //Perform an error check! This container has bounds on the supported trie level
                         ASSERT_CONDITION_THROW((LM_M_GRAM_LEVEL_MAX < M_GRAM_LEVEL_2), string("The minimum supported trie level is") + std::to_string(M_GRAM_LEVEL_2));
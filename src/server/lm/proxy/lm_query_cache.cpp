@@ -0,0 +1,53 @@
+/* 
+ * File:   lm_query_cache.cpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 17, 2016, 10:14 AM
+ */
+
+#include "server/lm/proxy/lm_query_cache.hpp"
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                namespace lm {
+                    namespace proxy {
+                        //Just give a default initialization
+                        mutex lm_query_cache::m_caches_lock;
+
+                        //Just give a default initialization
+                        set<lm_query_cache *> lm_query_cache::m_caches;
+
+                        //Just give a default initialization
+                        uint64_t lm_query_cache::m_gone_num_hits = 0;
+
+                        //Just give a default initialization
+                        uint64_t lm_query_cache::m_gone_num_misses = 0;
+
+                        //Just give a default initialization
+                        atomic<uint64_t> lm_query_cache::m_last_model_uid(0);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -34,7 +34,7 @@ namespace uva {
                     const rm_parameters * rm_configurator::m_params = NULL;
                     
                     //Just give a default initialization
-                    rm_proxy * rm_configurator::m_model_proxy = NULL;
+                    rm_proxy_ptr rm_configurator::m_model_proxy;
                 }
             }
         }
@@ -33,6 +33,7 @@ namespace uva {
                     const string rm_parameters_struct::RM_CONFIG_SECTION_NAME = "Reordering Models";
                     const string rm_parameters_struct::RM_CONN_STRING_PARAM_NAME = "rm_conn_string";
                     const string rm_parameters_struct::RM_WEIGHTS_PARAM_NAME = "rm_feature_weights";
+                    const string rm_parameters_struct::RM_HUGE_PAGES_PARAM_NAME = "rm_huge_pages";
                     const string rm_parameters_struct::RM_WEIGHT_NAMES[MAX_NUM_RM_FEATURES] = {
                         RM_WEIGHTS_PARAM_NAME + string("[0]"),
                         RM_WEIGHTS_PARAM_NAME + string("[1]"),
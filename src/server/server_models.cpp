@@ -0,0 +1,46 @@
+/*
+ * File:   server_models.cpp
+ * Author: Dr. Ivan S. Zapreev
+ *
+ * Visit my Linked-in profile:
+ *      <https://nl.linkedin.com/in/zapreevis>
+ * Visit my GitHub:
+ *      <https://github.com/ivan-zapreev>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.#
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Created on October 18, 2016, 2:40 AM
+ */
+
+#include "server/server_models.hpp"
+
+namespace uva {
+    namespace smt {
+        namespace bpbd {
+            namespace server {
+                //Just give a default initialization
+                mutex server_models::m_models_lock;
+
+                //Just give a default initialization
+                mutex server_models::m_reload_lock;
+
+                //Just give a default initialization
+                thread server_models::m_reload_thread;
+
+                //Just give a default initialization
+                atomic<bool> server_models::m_is_reloading(false);
+            }
+        }
+    }
+}
@@ -34,7 +34,7 @@ namespace uva {
                     const tm_parameters * tm_configurator::m_params = NULL;
                     
                     //Just give a default initialization
-                    tm_proxy * tm_configurator::m_model_proxy = NULL;
+                    tm_proxy_ptr tm_configurator::m_model_proxy;
                 }
             }
         }
@@ -52,6 +52,10 @@ namespace uva {
                     };
                     size_t tm_parameters_struct::TM_WEIGHT_GLOBAL_IDS[MAX_NUM_TM_FEATURES] = {};
                     const string tm_parameters_struct::TM_WORD_PENALTY_PARAM_NAME = "tm_word_penalty";
+                    const string tm_parameters_struct::TM_HUGE_PAGES_PARAM_NAME = "tm_huge_pages";
+                    const string tm_parameters_struct::TM_LOAD_THREADS_PARAM_NAME = "tm_load_threads";
+                    const string tm_parameters_struct::TM_STREAMING_LOAD_PARAM_NAME = "tm_streaming_load";
+                    const string tm_parameters_struct::TM_LAZY_CACHE_SIZE_PARAM_NAME = "tm_lazy_cache_size";
                     size_t tm_parameters_struct::TM_WP_LAMBDA_GLOBAL_ID = 0;
                     size_t tm_parameters_struct::TM_PHRASE_PENALTY_LAMBDA_IDX = 4;
                 }